@@ -0,0 +1,160 @@
+/*************************************************************************/
+/*  test_alloc.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_alloc.h"
+#include "string_db.h"
+#include "variant.h"
+#include "dictionary.h"
+#include "array.h"
+#include "print_string.h"
+#include "os/os.h"
+#include "os/thread.h"
+#include "os/memory.h"
+
+/**
+ * Allocation heavy workloads to measure the static memory pool, run
+ * single threaded and from several threads at once (which is what the
+ * servers do). Build with thread_cache_alloc=yes/no to compare pools.
+ */
+
+namespace TestAlloc {
+
+enum {
+	THREAD_COUNT=4
+};
+
+static int _string_name_churn(int p_iterations) {
+
+	int hits=0;
+	for(int i=0;i<p_iterations;i++) {
+
+		StringName sn=StringName("churn_"+itos(i%512));
+		if (sn==StringName("churn_0"))
+			hits++;
+	}
+	return hits;
+}
+
+static int _variant_churn(int p_iterations) {
+
+	int total=0;
+	for(int i=0;i<p_iterations;i++) {
+
+		Dictionary d;
+		Array a;
+		for(int j=0;j<8;j++) {
+			a.push_back(Variant(j));
+			a.push_back(Variant(String("item")));
+		}
+		d["array"]=a;
+		d["name"]=String("variant")+itos(i);
+		Variant v=d;
+		Dictionary copy=v;
+		total+=copy.size()+a.size();
+	}
+	return total;
+}
+
+static int _vector_churn(int p_iterations) {
+
+	int total=0;
+	for(int i=0;i<p_iterations;i++) {
+
+		Vector<int> v;
+		for(int j=0;j<(i&63)+1;j++)
+			v.push_back(j);
+
+		Vector<String> s;
+		s.push_back("a");
+		s.push_back("bb");
+		total+=v.size()+s.size();
+	}
+	return total;
+}
+
+struct ThreadData {
+
+	int iterations;
+	int result;
+	Vector<String> *handoff; // strings allocated here, freed by another thread
+};
+
+static void _thread_func(void *p_userdata) {
+
+	ThreadData *td=(ThreadData*)p_userdata;
+	td->result=_string_name_churn(td->iterations)+_variant_churn(td->iterations/8)+_vector_churn(td->iterations);
+
+	td->handoff->clear();
+	for(int i=0;i<td->iterations/4;i++)
+		td->handoff->push_back(itos(i)+" crossed threads");
+}
+
+static void _bench(const String& p_name,int p_threads,int p_iterations) {
+
+	ThreadData data[THREAD_COUNT];
+	Vector<String> handoff[THREAD_COUNT];
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	if (p_threads==1) {
+
+		data[0].iterations=p_iterations;
+		data[0].handoff=&handoff[0];
+		_thread_func(&data[0]);
+	} else {
+
+		Thread *threads[THREAD_COUNT];
+		for(int i=0;i<p_threads;i++) {
+			data[i].iterations=p_iterations;
+			data[i].handoff=&handoff[i];
+			threads[i]=Thread::create(_thread_func,&data[i]);
+		}
+		for(int i=0;i<p_threads;i++) {
+			Thread::wait_to_finish(threads[i]);
+			memdelete(threads[i]);
+		}
+	}
+
+	//free what the workers allocated from this thread
+	for(int i=0;i<p_threads;i++)
+		handoff[i].clear();
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line(p_name+": "+itos(time/1000)+"ms, static usage "+itos(Memory::get_static_mem_usage())+" max "+itos(Memory::get_static_mem_max_usage()));
+}
+
+MainLoop * test() {
+
+	_bench("1 thread ",1,200000);
+	_bench(itos(THREAD_COUNT)+" threads",THREAD_COUNT,200000);
+
+	return NULL;
+}
+
+}
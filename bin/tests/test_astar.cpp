@@ -0,0 +1,279 @@
+/*************************************************************************/
+/*  test_astar.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_astar.h"
+#include "math/a_star.h"
+#include "job_system.h"
+#include "print_string.h"
+
+/**
+ * Checks that AStar keeps scaling the route up to a point by its weight, that
+ * jump point search on AStarGrid finds paths as short as plain A* on random
+ * grids, and that batched queries return the same paths serially and on the
+ * job threads.
+ */
+
+namespace TestAStar {
+
+enum {
+	GRID_SIZE=64,
+	GRID_SEEDS=8,
+	QUERIES=64,
+	GRAPH_POINTS=400,
+	THREADS=4
+};
+
+static bool ok=true;
+
+static void _check(const String& p_what,bool p_cond) {
+
+	if (!p_cond) {
+		print_line(p_what+" FAILED");
+		ok=false;
+	}
+}
+
+static uint32_t _rand(uint32_t &r_seed) {
+
+	r_seed=r_seed*1103515245+12345;
+	return (r_seed>>16)&0x7FFF;
+}
+
+static float _path_length(const Vector2Array& p_path) {
+
+	Vector2Array::Read r=p_path.read();
+	float len=0;
+	for(int i=1;i<p_path.size();i++)
+		len+=r[i-1].distance_to(r[i]);
+	return len;
+}
+
+static bool _path_is_walkable(const Ref<AStarGrid>& p_grid,const Vector2Array& p_path) {
+
+	Vector2Array::Read r=p_path.read();
+	for(int i=0;i<p_path.size();i++) {
+
+		if (p_grid->is_solid(r[i]))
+			return false;
+		if (i==0)
+			continue;
+		Vector2 d=r[i]-r[i-1];
+		if (ABS(d.x)>1 || ABS(d.y)>1 || (d.x==0 && d.y==0))
+			return false;
+		if (d.x && d.y && (p_grid->is_solid(Vector2(r[i-1].x+d.x,r[i-1].y)) || p_grid->is_solid(Vector2(r[i-1].x,r[i-1].y+d.y))))
+			return false;
+	}
+	return true;
+}
+
+static bool _same_paths(const Array& p_a,const Array& p_b) {
+
+	if (p_a.size()!=p_b.size())
+		return false;
+
+	for(int i=0;i<p_a.size();i++) {
+
+		if (p_a[i].get_type()!=p_b[i].get_type())
+			return false;
+		if (p_a[i].get_type()==Variant::INT_ARRAY) {
+
+			IntArray a=p_a[i];
+			IntArray b=p_b[i];
+			if (a.size()!=b.size())
+				return false;
+			for(int j=0;j<a.size();j++) {
+				if (a[j]!=b[j])
+					return false;
+			}
+		} else {
+
+			Vector2Array a=p_a[i];
+			Vector2Array b=p_b[i];
+			if (a.size()!=b.size())
+				return false;
+			for(int j=0;j<a.size();j++) {
+				if (a[j]!=b[j])
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void _test_weights() {
+
+	// 1 -> 2 -> 3 -> 4 is short but passes a heavy point after a long edge,
+	// 1 -> 5 -> 4 is longer but unweighted. The weight scales the distance
+	// walked so far, so the detour wins.
+
+	Ref<AStar> astar = memnew( AStar );
+	astar->add_point(1,Vector3(0,0,0));
+	astar->add_point(2,Vector3(10,0,0));
+	astar->add_point(3,Vector3(11,0,0),3);
+	astar->add_point(4,Vector3(12,0,0));
+	astar->add_point(5,Vector3(6,8,0));
+	astar->connect_points(1,2);
+	astar->connect_points(2,3);
+	astar->connect_points(3,4);
+	astar->connect_points(1,5);
+	astar->connect_points(5,4);
+
+	DVector<int> path=astar->get_id_path(1,4);
+	_check("weight scales the route so far",path.size()==3 && path[0]==1 && path[1]==5 && path[2]==4);
+}
+
+static void _fill_grid(Ref<AStarGrid>& p_grid,uint32_t p_seed) {
+
+	p_grid->set_size(Vector2(GRID_SIZE,GRID_SIZE));
+	for(int y=0;y<GRID_SIZE;y++) {
+		for(int x=0;x<GRID_SIZE;x++) {
+			if (_rand(p_seed)%100<25)
+				p_grid->set_solid(Vector2(x,y),true);
+		}
+	}
+}
+
+static Vector2 _random_free_cell(const Ref<AStarGrid>& p_grid,uint32_t &r_seed) {
+
+	while(true) {
+		Vector2 c(_rand(r_seed)%GRID_SIZE,_rand(r_seed)%GRID_SIZE);
+		if (!p_grid->is_solid(c))
+			return c;
+	}
+}
+
+static void _test_grid() {
+
+	int found=0;
+	int compared=0;
+	bool same_length=true;
+	bool walkable=true;
+	bool same_batches=true;
+
+	for(int s=0;s<GRID_SEEDS;s++) {
+
+		Ref<AStarGrid> grid = memnew( AStarGrid );
+		_fill_grid(grid,s+1);
+
+		uint32_t seed=1000+s;
+		Vector2Array from;
+		Vector2Array to;
+		for(int i=0;i<QUERIES;i++) {
+			from.push_back(_random_free_cell(grid,seed));
+			to.push_back(_random_free_cell(grid,seed));
+		}
+
+		for(int i=0;i<QUERIES;i++) {
+
+			grid->set_jumping_enabled(false);
+			Vector2Array plain=grid->get_path(from[i],to[i]);
+			grid->set_jumping_enabled(true);
+			Vector2Array jps=grid->get_path(from[i],to[i]);
+
+			compared++;
+			if (plain.size()==0 || jps.size()==0) {
+				if (plain.size()!=jps.size())
+					same_length=false;
+				continue;
+			}
+
+			found++;
+			if (Math::abs(_path_length(plain)-_path_length(jps))>0.001)
+				same_length=false;
+			if (!_path_is_walkable(grid,plain) || !_path_is_walkable(grid,jps))
+				walkable=false;
+		}
+
+		for(int j=0;j<2;j++) {
+
+			grid->set_jumping_enabled(j==1);
+			Array serial=grid->get_paths(from,to,false);
+			Array parallel=grid->get_paths(from,to,true);
+			if (!_same_paths(serial,parallel))
+				same_batches=false;
+		}
+	}
+
+	print_line("grid: "+itos(found)+" of "+itos(compared)+" queries reachable");
+	_check("jump point search finds paths as short as A*",same_length);
+	_check("grid paths are walkable",walkable);
+	_check("grid batch matches serial",same_batches);
+}
+
+static void _test_graph_batch() {
+
+	Ref<AStar> astar = memnew( AStar );
+	uint32_t seed=77;
+
+	for(int i=0;i<GRAPH_POINTS;i++) {
+		float w=1.0+(_rand(seed)%100)/100.0;
+		astar->add_point(i,Vector3(_rand(seed)%1000,_rand(seed)%1000,0),w);
+	}
+	for(int i=0;i<GRAPH_POINTS*3;i++) {
+		int a=_rand(seed)%GRAPH_POINTS;
+		int b=_rand(seed)%GRAPH_POINTS;
+		if (a!=b)
+			astar->connect_points(a,b);
+	}
+
+	IntArray from;
+	IntArray to;
+	for(int i=0;i<QUERIES;i++) {
+		from.push_back(_rand(seed)%GRAPH_POINTS);
+		to.push_back(_rand(seed)%GRAPH_POINTS);
+	}
+
+	Array one_by_one;
+	for(int i=0;i<QUERIES;i++)
+		one_by_one.push_back(astar->get_id_path(from[i],to[i]));
+
+	Array serial=astar->get_id_paths(from,to,false);
+	Array parallel=astar->get_id_paths(from,to,true);
+
+	_check("graph batch matches single queries",_same_paths(one_by_one,serial));
+	_check("graph parallel batch matches serial",_same_paths(serial,parallel));
+}
+
+MainLoop * test() {
+
+	JobSystem *js=JobSystem::get_singleton();
+	int prev_threads=js->get_thread_count();
+	js->start(THREADS);
+	ok=true;
+
+	_test_weights();
+	_test_grid();
+	_test_graph_batch();
+
+	js->start(prev_threads);
+
+	print_line(ok ? "astar: ok" : "astar: FAILED");
+	return NULL;
+}
+
+}
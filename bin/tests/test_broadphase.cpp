@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  test_broadphase.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_broadphase.h"
+#include "servers/physics/broad_phase_octree.h"
+#include "servers/physics/broad_phase_bvh.h"
+#include "servers/physics/collision_object_sw.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Compares the 3D broadphases on a crowd of moving objects and on a large
+ * static world crossed by a few dynamic objects. Both backends see the same
+ * objects and motions, so their pair counts must match.
+ */
+
+namespace TestBroadPhase {
+
+class BenchObjectSW : public CollisionObjectSW {
+
+	virtual void _shapes_changed() {}
+public:
+
+	virtual void set_space(SpaceSW *p_space) {}
+
+	BenchObjectSW() : CollisionObjectSW(TYPE_BODY) {}
+};
+
+struct BenchData {
+
+	int pairs;
+	int pair_events;
+};
+
+static void* _pair(CollisionObjectSW *A,int p_subindex_A,CollisionObjectSW *B,int p_subindex_B,void *p_userdata) {
+
+	BenchData *bd=(BenchData*)p_userdata;
+	bd->pairs++;
+	bd->pair_events++;
+	return bd;
+}
+
+static void _unpair(CollisionObjectSW *A,int p_subindex_A,CollisionObjectSW *B,int p_subindex_B,void *p_data,void *p_userdata) {
+
+	BenchData *bd=(BenchData*)p_userdata;
+	bd->pairs--;
+	bd->pair_events++;
+}
+
+static float _randf(uint32_t *r_seed) {
+
+	return (Math::rand_from_seed(r_seed)%65536)/65535.0;
+}
+
+static void _bench(const String& p_name,BroadPhaseSW::CreateFunction p_create,int p_static,int p_dynamic,float p_world_size,bool p_big_static,int p_frames) {
+
+	BroadPhaseSW *bp=p_create();
+	BenchData bd;
+	bd.pairs=0;
+	bd.pair_events=0;
+	bp->set_pair_callback(_pair,&bd);
+	bp->set_unpair_callback(_unpair,&bd);
+
+	int total=p_static+p_dynamic;
+	Vector<BenchObjectSW*> objects;
+	Vector<BroadPhaseSW::ID> ids;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	objects.resize(total);
+	ids.resize(total);
+	aabbs.resize(total);
+	velocities.resize(total);
+
+	uint32_t seed=1234;
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<total;i++) {
+
+		bool is_static=i<p_static;
+		Vector3 pos(_randf(&seed)*p_world_size,_randf(&seed)*4.0,_randf(&seed)*p_world_size);
+		Vector3 size(1,1,1);
+		if (is_static && p_big_static && (i%100)==0)
+			size=Vector3(p_world_size*0.25,8,p_world_size*0.25); //concave mesh style blocks spanning a lot of space
+
+		objects[i]=memnew( BenchObjectSW );
+		ids[i]=bp->create(objects[i],0);
+		bp->set_static(ids[i],is_static);
+		aabbs[i]=AABB(pos,size);
+		bp->move(ids[i],aabbs[i]);
+		velocities[i]=is_static?Vector3():Vector3(_randf(&seed)-0.5,0,_randf(&seed)-0.5)*0.2;
+	}
+
+	uint64_t insert_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	for(int f=0;f<p_frames;f++) {
+
+		for(int i=p_static;i<total;i++) {
+
+			AABB aabb=aabbs[i];
+			aabb.pos+=velocities[i];
+			for(int j=0;j<3;j+=2) {
+				if (aabb.pos[j]<0 || aabb.pos[j]>p_world_size) {
+					Vector3 v=velocities[i];
+					v[j]=-v[j];
+					velocities[i]=v;
+				}
+			}
+			aabbs[i]=aabb;
+			bp->move(ids[i],aabb);
+		}
+	}
+
+	uint64_t move_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	CollisionObjectSW *results[256];
+	int culled=0;
+	for(int i=0;i<2000;i++) {
+
+		Vector3 pos(_randf(&seed)*p_world_size,0,_randf(&seed)*p_world_size);
+		culled+=bp->cull_aabb(AABB(pos,Vector3(4,4,4)),results,256);
+		culled+=bp->cull_segment(pos,pos+Vector3(10,2,10),results,256);
+	}
+
+	uint64_t cull_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<total;i++) {
+		bp->remove(ids[i]);
+		memdelete(objects[i]);
+	}
+
+	uint64_t remove_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line(p_name+": insert "+itos(insert_time/1000)+"ms, "+itos(p_frames)+" frames "+itos(move_time/1000)+"ms, cull "+itos(cull_time/1000)+"ms, remove "+itos(remove_time/1000)+"ms; pair events "+itos(bd.pair_events)+", culled "+itos(culled)+", pairs left "+itos(bd.pairs));
+
+	memdelete(bp);
+}
+
+MainLoop * test() {
+
+	print_line("moving crowd (4000 dynamic, 200 static)");
+	_bench("  octree",BroadPhaseOctree::_create,200,4000,200,false,120);
+	_bench("  bvh   ",BroadPhaseBVH::_create,200,4000,200,false,120);
+
+	print_line("static world (20000 static with large blocks, 500 dynamic)");
+	_bench("  octree",BroadPhaseOctree::_create,20000,500,400,true,120);
+	_bench("  bvh   ",BroadPhaseBVH::_create,20000,500,400,true,120);
+
+	return NULL;
+}
+
+}
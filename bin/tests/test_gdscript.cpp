@@ -519,10 +519,22 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 
 			switch(code[ip]) {
 
-				case GDFunction::OPCODE_OPERATOR: {
+				case GDFunction::OPCODE_OPERATOR:
+				case GDFunction::OPCODE_OPERATOR_INT:
+				case GDFunction::OPCODE_OPERATOR_REAL:
+				case GDFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDFunction::OPCODE_OPERATOR_VECTOR3:
+				case GDFunction::OPCODE_COMPARE_JUMP_IF_NOT: {
 
 					int op = code[ip+1];
-					txt+="op ";
+					switch(code[ip]) {
+						case GDFunction::OPCODE_OPERATOR_INT: txt+="op_int "; break;
+						case GDFunction::OPCODE_OPERATOR_REAL: txt+="op_real "; break;
+						case GDFunction::OPCODE_OPERATOR_VECTOR2: txt+="op_vector2 "; break;
+						case GDFunction::OPCODE_OPERATOR_VECTOR3: txt+="op_vector3 "; break;
+						case GDFunction::OPCODE_COMPARE_JUMP_IF_NOT: txt+="op_compare (fused with next) "; break;
+						default: txt+="op ";
+					}
 
 					String opname = Variant::get_operator_name(Variant::Operator(op));
 
@@ -564,29 +576,37 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 					txt+="[\"";
 					txt+=func.get_global_name(code[ip+2]);
 					txt+="\"]=";
-					txt+=DADDR(3);
-					incr+=4;
+					txt+=DADDR(4);
+					txt+=" (cache "+itos(code[ip+3])+")";
+					incr+=5;
 
 
 				} break;
-				case GDFunction::OPCODE_GET_NAMED: {
+				case GDFunction::OPCODE_GET_NAMED:
+				case GDFunction::OPCODE_GET_NAMED_CALL: {
 
 					txt+=" get_named ";
-					txt+=DADDR(3);
+					txt+=DADDR(4);
 					txt+="=";
 					txt+=DADDR(1);
 					txt+="[\"";
 					txt+=func.get_global_name(code[ip+2]);
 					txt+="\"]";
-					incr+=4;
+					txt+=" (cache "+itos(code[ip+3])+")";
+					if (code[ip]==GDFunction::OPCODE_GET_NAMED_CALL)
+						txt+=" (fused with next)";
+					incr+=5;
 
 				} break;
-				case GDFunction::OPCODE_ASSIGN: {
+				case GDFunction::OPCODE_ASSIGN:
+				case GDFunction::OPCODE_ASSIGN_JUMP: {
 
 					txt+=" assign ";
 					txt+=DADDR(1);
 					txt+="=";
 					txt+=DADDR(2);
+					if (code[ip]==GDFunction::OPCODE_ASSIGN_JUMP)
+						txt+=" (fused with next)";
 					incr+=3;
 
 
@@ -680,7 +700,7 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 
 					int argc=code[ip+1];
 					if (ret) {
-						txt+=DADDR(4+argc)+"=";
+						txt+=DADDR(5+argc)+"=";
 					}
 
 					txt+=DADDR(2)+".";
@@ -693,9 +713,10 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 						txt+=DADDR(4+i);
 					}
 					txt+=")";
+					txt+=" (cache "+itos(code[ip+4+argc])+")";
 
 
-					incr=5+argc;
+					incr=6+argc;
 
 				} break;
 				case GDFunction::OPCODE_CALL_BUILT_IN: {
@@ -813,6 +834,18 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 					txt+=" for-loop "+DADDR(4)+" in "+DADDR(2)+" counter "+DADDR(1)+" end "+itos(code[ip+3]);
 					incr+=5;
 
+				} break;
+				case GDFunction::OPCODE_ITERATE_RANGE_BEGIN: {
+
+					txt+=" for-range-init "+DADDR(8)+" in range("+DADDR(4)+","+DADDR(5)+","+DADDR(6)+") counter "+DADDR(1)+" end "+itos(code[ip+7]);
+					incr+=9;
+
+				} break;
+				case GDFunction::OPCODE_ITERATE_RANGE: {
+
+					txt+=" for-range-loop "+DADDR(5)+" to "+DADDR(2)+" step "+DADDR(3)+" counter "+DADDR(1)+" end "+itos(code[ip+4]);
+					incr+=6;
+
 				} break;
 				case GDFunction::OPCODE_LINE: {
 
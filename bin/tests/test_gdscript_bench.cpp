@@ -0,0 +1,216 @@
+/*************************************************************************/
+/*  test_gdscript_bench.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_bench.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Interpreter benchmarks, to track the speed of the GDScript VM over time:
+ * recursive calls (fib), member and vector math (nbody), string building,
+ * a sort written in script and many coroutines yielding and resuming
+ * every frame (yield). Each benchmark returns a checksum so a
+ * faster VM that computes something else doesn't go unnoticed.
+ * Run headless with: godot -test gdscript_bench
+ */
+
+namespace TestGDScriptBench {
+
+#ifdef GDSCRIPT_ENABLED
+
+struct Bench {
+
+	const char *name;
+	const char *code;
+	int arg;
+	const char *expected;
+};
+
+static const Bench benchmarks[]={
+	{ "fib",
+		"static func fib(n):\n"
+		"\tif n < 2:\n"
+		"\t\treturn n\n"
+		"\treturn fib(n-1) + fib(n-2)\n"
+		"static func run(n):\n"
+		"\treturn fib(n)\n",
+		25, "75025" },
+	{ "nbody",
+		"class Body:\n"
+		"\tvar pos\n"
+		"\tvar vel\n"
+		"\tvar mass\n"
+		"\tfunc _init(p_pos,p_vel,p_mass):\n"
+		"\t\tpos = p_pos\n"
+		"\t\tvel = p_vel\n"
+		"\t\tmass = p_mass\n"
+		"static func run(n):\n"
+		"\tvar bodies = []\n"
+		"\tbodies.append(Body.new(Vector3(0,0,0),Vector3(0,0,0),39.47))\n"
+		"\tbodies.append(Body.new(Vector3(4.84,-1.16,-0.10),Vector3(0.606,2.81,-0.02),0.037))\n"
+		"\tbodies.append(Body.new(Vector3(8.34,4.12,-0.4),Vector3(-1.01,1.82,0.008),0.011))\n"
+		"\tbodies.append(Body.new(Vector3(12.89,-15.11,-0.22),Vector3(1.08,0.868,-0.01),0.0017))\n"
+		"\tbodies.append(Body.new(Vector3(15.37,-25.9,0.179),Vector3(0.979,0.594,-0.034),0.002))\n"
+		"\tvar dt = 0.01\n"
+		"\tvar count = bodies.size()\n"
+		"\tfor step in range(n):\n"
+		"\t\tfor i in range(count):\n"
+		"\t\t\tvar a = bodies[i]\n"
+		"\t\t\tfor j in range(i+1,count):\n"
+		"\t\t\t\tvar b = bodies[j]\n"
+		"\t\t\t\tvar d = a.pos - b.pos\n"
+		"\t\t\t\tvar dist2 = d.dot(d)\n"
+		"\t\t\t\tvar mag = dt / (dist2 * sqrt(dist2))\n"
+		"\t\t\t\ta.vel -= d * (b.mass * mag)\n"
+		"\t\t\t\tb.vel += d * (a.mass * mag)\n"
+		"\t\tfor b in bodies:\n"
+		"\t\t\tb.pos += b.vel * dt\n"
+		"\tvar e = 0.0\n"
+		"\tfor b in bodies:\n"
+		"\t\te += 0.5 * b.mass * b.vel.dot(b.vel)\n"
+		"\treturn int(e * 1000)\n",
+		20000, "171" },
+	{ "strings",
+		"static func run(n):\n"
+		"\tvar s = \"\"\n"
+		"\tvar total = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\ts += str(i % 10)\n"
+		"\t\tif s.length() >= 100:\n"
+		"\t\t\ttotal += s.length()\n"
+		"\t\t\ts = \"\"\n"
+		"\t\tvar name = \"item_\" + str(i) + \"_\" + str(i * 2)\n"
+		"\t\ttotal += name.length()\n"
+		"\treturn total + s.length()\n",
+		100000, "1733335" },
+	{ "sort",
+		"static func quicksort(a, lo, hi):\n"
+		"\twhile lo < hi:\n"
+		"\t\tvar p = a[(lo + hi) / 2]\n"
+		"\t\tvar i = lo\n"
+		"\t\tvar j = hi\n"
+		"\t\twhile i <= j:\n"
+		"\t\t\twhile a[i] < p:\n"
+		"\t\t\t\ti += 1\n"
+		"\t\t\twhile a[j] > p:\n"
+		"\t\t\t\tj -= 1\n"
+		"\t\t\tif i <= j:\n"
+		"\t\t\t\tvar t = a[i]\n"
+		"\t\t\t\ta[i] = a[j]\n"
+		"\t\t\t\ta[j] = t\n"
+		"\t\t\t\ti += 1\n"
+		"\t\t\t\tj -= 1\n"
+		"\t\tif j - lo < hi - i:\n"
+		"\t\t\tquicksort(a, lo, j)\n"
+		"\t\t\tlo = i\n"
+		"\t\telse:\n"
+		"\t\t\tquicksort(a, i, hi)\n"
+		"\t\t\thi = j\n"
+		"static func run(n):\n"
+		"\tvar a = []\n"
+		"\tvar rnd = 12345\n"
+		"\tfor i in range(n):\n"
+		"\t\trnd = (rnd * 75 + 74) % 65537\n"
+		"\t\ta.append(rnd)\n"
+		"\tquicksort(a, 0, n - 1)\n"
+		"\tfor i in range(1, n):\n"
+		"\t\tif a[i-1] > a[i]:\n"
+		"\t\t\treturn -1\n"
+		"\treturn a[0] + a[n / 2] + a[n - 1]\n",
+		100000, "98242" },
+	{ "yield",
+		"static func agent(frames, k):\n"
+		"\tvar acc = 0\n"
+		"\tvar pos = Vector2(k, 0)\n"
+		"\tvar label = \"agent_\" + str(k)\n"
+		"\tfor f in range(frames):\n"
+		"\t\tvar v = yield()\n"
+		"\t\tacc += v\n"
+		"\t\tpos.y += 1\n"
+		"\treturn acc + int(pos.y) - frames\n"
+		"static func run(n):\n"
+		"\tvar states = []\n"
+		"\tfor i in range(1000):\n"
+		"\t\tstates.append(agent(n, i))\n"
+		"\tfor f in range(n):\n"
+		"\t\tfor i in range(states.size()):\n"
+		"\t\t\tstates[i] = states[i].resume(i % 7)\n"
+		"\tvar total = 0\n"
+		"\tfor s in states:\n"
+		"\t\ttotal += s\n"
+		"\treturn total\n",
+		100, "299700" },
+};
+
+#endif
+
+MainLoop * test() {
+
+#ifdef GDSCRIPT_ENABLED
+
+	int count=sizeof(benchmarks)/sizeof(benchmarks[0]);
+	uint64_t total=0;
+
+	for(int i=0;i<count;i++) {
+
+		const Bench &b=benchmarks[i];
+
+		Ref<GDScript> script = memnew( GDScript );
+		script->set_source_code(b.code);
+		if (script->reload()!=OK) {
+			print_line(String(b.name)+": compile FAILED");
+			continue;
+		}
+
+		uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+		Variant ret=static_cast<Object*>(script.ptr())->call("run",b.arg);
+
+		uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+		total+=time;
+
+		String result=ret;
+		if (b.expected && result!=b.expected)
+			result+=" FAILED, expected "+String(b.expected);
+
+		print_line(String(b.name)+": "+itos(time/1000)+"ms (result "+result+")");
+	}
+
+	print_line("total: "+itos(total/1000)+"ms");
+#else
+	print_line("GDScript module is disabled, nothing to test.");
+#endif
+
+	return NULL;
+}
+
+}
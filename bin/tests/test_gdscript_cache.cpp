@@ -0,0 +1,316 @@
+/*************************************************************************/
+/*  test_gdscript_cache.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_cache.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#include "modules/gdscript/gd_compiler.h"
+#include "modules/gdscript/gd_tokenizer.h"
+#endif
+
+/**
+ * Compiles a project worth of generated scripts, stores them the way the exporter
+ * does (token stream plus compiled form) and compares loading them by parsing the
+ * tokens against loading the compiled form. Both must behave the same, the loaded
+ * code must match what the compiler made (line opcodes included), and a compiled
+ * form from another build must fall back to the tokens. Damaged compiled forms
+ * must be refused when loading.
+ */
+
+namespace TestGDScriptCache {
+
+#ifdef GDSCRIPT_ENABLED
+
+enum {
+	SCRIPT_COUNT=500
+};
+
+static String _make_script(int p_index) {
+
+	String i=itos(p_index);
+	String code;
+
+	code+="extends Reference\n";
+	code+="const LIMITS = ["+i+", "+i+"+1, 2.5]\n";
+	code+="const ORIGIN = Vector2("+i+", 1)\n";
+	code+="const TABLE = { \"a\": "+i+", \"b\": [1, 2] }\n";
+	code+="export var speed = "+i+"*0.5\n";
+	code+="export(int, 0, 100) var level = 3\n";
+	code+="var count = 0 setget set_count\n";
+	code+="signal changed(value)\n";
+	code+="class Base:\n";
+	code+="\tvar value = "+i+"\n";
+	code+="\tfunc get_value():\n";
+	code+="\t\treturn value\n";
+	code+="class Derived extends Base:\n";
+	code+="\tvar extra = [1, 2, 3]\n";
+	code+="\tfunc get_value():\n";
+	code+="\t\treturn value * 2 + .get_value() + extra.size()\n";
+	code+="func set_count(v):\n";
+	code+="\tcount = v\n";
+	code+="\temit_signal(\"changed\", v)\n";
+	code+="func _init():\n";
+	code+="\tcount = "+i+"\n";
+	code+="static func scale(a, b=3):\n";
+	code+="\treturn a * b + int(abs(-b))\n";
+
+	//some bulk, like the rest of a real script
+	for(int j=0;j<8;j++) {
+
+		String f=itos(j);
+		code+="func step_"+f+"(delta, target=Vector2()):\n";
+		code+="\tvar pos = ORIGIN * delta\n";
+		code+="\tvar moved = false\n";
+		code+="\tif pos.distance_to(target) > "+f+".5:\n";
+		code+="\t\tpos = pos.linear_interpolate(target, 0.5)\n";
+		code+="\t\tmoved = true\n";
+		code+="\tfor k in range("+f+"):\n";
+		code+="\t\tpos.x += k * speed\n";
+		code+="\twhile pos.y > 100:\n";
+		code+="\t\tpos.y -= 100\n";
+		code+="\tvar names = [\"step\", str("+f+"), \"of\", str(count)]\n";
+		code+="\treturn [pos, moved, names]\n";
+	}
+
+	code+="func run(n):\n";
+	code+="\tvar acc = 0\n";
+	code+="\tfor k in range(n):\n";
+	code+="\t\tacc += k % 7\n";
+	code+="\tvar d = Derived.new()\n";
+	code+="\tacc += d.get_value() + LIMITS[1] + int(ORIGIN.x) + TABLE[\"a\"] + TABLE[\"b\"][1]\n";
+	code+="\tacc += int(speed * 2) + level + scale(2) + scale(2, 5)\n";
+	code+="\tacc += Base.new().get_value()\n";
+	code+="\tacc += step_3(2.0)[0].x\n";
+	code+="\tvar r = Reference.new()\n";
+	code+="\tif r extends Reference:\n";
+	code+="\t\tacc += 1\n";
+	code+="\tself.count = 2\n";
+	code+="\treturn acc + count\n";
+
+	return code;
+}
+
+static Variant _run(Ref<GDScript> p_script) {
+
+	Variant instance = static_cast<Object*>(p_script.ptr())->call("new");
+	Object *obj = instance;
+	if (!obj)
+		return Variant();
+	return obj->call("run",10);
+}
+
+static bool _check_fallback(const Vector<uint8_t>& p_buffer,const Vector<uint8_t>& p_tokens) {
+
+	//a compiled form from another build is not used, but its tokens are still there
+	Vector<uint8_t> other=p_buffer;
+	other[8]^=0xFF;
+
+	Ref<GDScript> script = memnew( GDScript );
+	Vector<uint8_t> tokens;
+	GDCompiler compiler;
+	if (compiler.load_compiled_buffer(other,script.ptr(),tokens)==OK)
+		return false;
+
+	if (tokens.size()!=p_tokens.size())
+		return false;
+	for(int i=0;i<tokens.size();i++) {
+		if (tokens[i]!=p_tokens[i])
+			return false;
+	}
+
+	return !script->is_valid();
+}
+
+static bool _check_same_code(const Ref<GDScript>& p_source,const Ref<GDScript>& p_loaded) {
+
+	//the compiled form keeps the code as is, line opcodes included, so errors and
+	//the sampler still know the line in exported games
+	const Map<StringName,GDFunction*> &source=p_source->get_member_functions();
+	const Map<StringName,GDFunction*> &loaded=p_loaded->get_member_functions();
+	if (source.size()!=loaded.size())
+		return false;
+
+	bool has_lines=false;
+	for (const Map<StringName,GDFunction*>::Element *E=source.front();E;E=E->next()) {
+
+		const Map<StringName,GDFunction*>::Element *L=loaded.find(E->key());
+		if (!L)
+			return false;
+
+		const GDFunction *a=E->get();
+		const GDFunction *b=L->get();
+		if (a->get_code_size()!=b->get_code_size())
+			return false;
+		for(int i=0;i<a->get_code_size();i++) {
+			if (a->get_code()[i]!=b->get_code()[i])
+				return false;
+			if (a->get_code()[i]==GDFunction::OPCODE_LINE)
+				has_lines=true;
+		}
+	}
+
+	return has_lines;
+}
+
+static int _check_damaged(const Vector<uint8_t>& p_buffer) {
+
+	//flips bytes all over a compiled form, loading must never crash. returns how many
+	//were refused, the rest only changed values the VM checks when running
+	int refused=0;
+	for(int i=24;i<p_buffer.size();i+=13) {
+
+		Vector<uint8_t> damaged=p_buffer;
+		damaged[i]^=0x5A;
+
+		Ref<GDScript> script = memnew( GDScript );
+		Vector<uint8_t> tokens;
+		GDCompiler compiler;
+		if (compiler.load_compiled_buffer(damaged,script.ptr(),tokens)!=OK)
+			refused++;
+	}
+
+	return refused;
+}
+
+#endif
+
+MainLoop * test() {
+
+#ifdef GDSCRIPT_ENABLED
+
+	Vector<Vector<uint8_t> > tokens;
+	Vector<Vector<uint8_t> > compiled;
+	Vector<Variant> expected;
+	Vector<Ref<GDScript> > sources;
+
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+
+		String code=_make_script(i);
+
+		Ref<GDScript> script = memnew( GDScript );
+		script->set_source_code(code);
+		if (script->reload()!=OK) {
+			print_line("script "+itos(i)+": compile FAILED");
+			return NULL;
+		}
+
+		tokens.push_back(GDTokenizerBuffer::parse_code_string(code));
+		compiled.push_back(GDCompiler::make_compiled_buffer(script.ptr(),tokens[i]));
+		expected.push_back(_run(script));
+		sources.push_back(script);
+
+		if (compiled[i].empty()) {
+			print_line("script "+itos(i)+": compiled form FAILED");
+			return NULL;
+		}
+	}
+
+	int token_bytes=0;
+	int compiled_bytes=0;
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+		token_bytes+=tokens[i].size();
+		compiled_bytes+=compiled[i].size();
+	}
+
+	print_line(itos(SCRIPT_COUNT)+" scripts, "+itos(token_bytes/1024)+"KiB of tokens, "+itos(compiled_bytes/1024)+"KiB with the compiled form");
+
+	//load from tokens, as before
+
+	Vector<Ref<GDScript> > parsed;
+	parsed.resize(SCRIPT_COUNT);
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+
+		parsed[i] = Ref<GDScript>( memnew( GDScript ) );
+		GDParser parser;
+		GDCompiler compiler;
+		if (parser.parse_bytecode(tokens[i],"","")!=OK || compiler.compile(&parser,parsed[i].ptr())!=OK) {
+			print_line("script "+itos(i)+": parse FAILED");
+			return NULL;
+		}
+	}
+
+	uint64_t parse_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	//load the compiled form
+
+	Vector<Ref<GDScript> > loaded;
+	loaded.resize(SCRIPT_COUNT);
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+
+		loaded[i] = Ref<GDScript>( memnew( GDScript ) );
+		Vector<uint8_t> script_tokens;
+		GDCompiler compiler;
+		if (compiler.load_compiled_buffer(compiled[i],loaded[i].ptr(),script_tokens)!=OK) {
+			print_line("script "+itos(i)+": load FAILED");
+			return NULL;
+		}
+	}
+
+	uint64_t load_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line("parse and compile: "+itos(parse_time/1000)+"ms, "+itos(parse_time/SCRIPT_COUNT)+"us/script");
+	print_line("load compiled: "+itos(load_time/1000)+"ms, "+itos(load_time/SCRIPT_COUNT)+"us/script");
+
+	bool same_code=true;
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+		if (!_check_same_code(sources[i],loaded[i]))
+			same_code=false;
+	}
+
+	bool ok=true;
+	for(int i=0;i<SCRIPT_COUNT;i++) {
+
+		Variant a=_run(parsed[i]);
+		Variant b=_run(loaded[i]);
+		if (a.get_type()==Variant::NIL || a!=expected[i] || b!=expected[i]) {
+			print_line("script "+itos(i)+": expected "+String(expected[i])+", parsed "+String(a)+", loaded "+String(b));
+			ok=false;
+		}
+	}
+
+	print_line("results: "+String(ok?"ok":"FAILED"));
+	print_line("same code with line opcodes: "+String(same_code?"ok":"FAILED"));
+	print_line("fallback to tokens: "+String(_check_fallback(compiled[0],tokens[0])?"ok":"FAILED"));
+	print_line("damaged compiled forms refused: "+itos(_check_damaged(compiled[0]))+" of "+itos((compiled[0].size()-24+12)/13));
+#else
+	print_line("GDScript module is disabled, nothing to test.");
+#endif
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,164 @@
+/*************************************************************************/
+/*  test_gdscript_fold.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_fold.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#include "modules/gdscript/gd_parser.h"
+#endif
+
+/**
+ * Checks that scripts give the same results once constant expressions are
+ * folded and branches on constant conditions are pruned, including names
+ * that shadow a constant and script constants shadowed by a derived class.
+ * Prints the instructions saved and the time of a loop over a folded
+ * expression.
+ */
+
+namespace TestGDScriptFold {
+
+#ifdef GDSCRIPT_ENABLED
+
+static const char *code=
+	"extends Reference\n"
+	"const DEBUG = false\n"
+	"const SCALE = 2\n"
+	"const NAME = \"fold\"\n"
+	"var count = SCALE * 3\n"
+	"func SCALE_of(SCALE):\n" // argument hides the constant
+	"\treturn SCALE + 1\n"
+	"func shadow():\n"
+	"\tvar r = SCALE * 10\n"
+	"\tvar SCALE = 5\n" // so does a local, from here on
+	"\treturn r + SCALE\n"
+	"class Base:\n"
+	"\tconst LIMIT = 1\n"
+	"\tfunc get_limit():\n"
+	"\t\treturn LIMIT * 10\n" // runs on a Derived, so it reads Derived.LIMIT
+	"class Derived extends Base:\n"
+	"\tconst LIMIT = 2\n"
+	"func run():\n"
+	"\tvar r = []\n"
+	"\tr.append(SCALE * 4 + 1)\n"
+	"\tr.append(Vector2(SCALE, SCALE * 2))\n"
+	"\tr.append(NAME + str(SCALE))\n"
+	"\tr.append(1 if DEBUG else 2)\n"
+	"\tif DEBUG:\n"
+	"\t\tr.append(\"debug\")\n"
+	"\telif SCALE > 1:\n"
+	"\t\tvar inner = SCALE * SCALE\n"
+	"\t\tr.append(inner)\n"
+	"\telse:\n"
+	"\t\tr.append(\"else\")\n"
+	"\tif not DEBUG:\n"
+	"\t\tr.append(count)\n"
+	"\twhile DEBUG:\n"
+	"\t\tr.append(\"loop\")\n"
+	"\tvar n = 0\n"
+	"\twhile true:\n"
+	"\t\tn += SCALE\n"
+	"\t\tif n >= 10:\n"
+	"\t\t\tbreak\n"
+	"\t\t\tr.append(\"dead\")\n"
+	"\tr.append(n)\n"
+	"\tr.append(SCALE_of(1))\n"
+	"\tr.append(shadow())\n"
+	"\tr.append(NAME - 1 if DEBUG else 0)\n" // never evaluated, so not a compile error
+	"\tr.append(Derived.new().get_limit())\n"
+	"\tr.append(NOTIFICATION_PREDELETE * 10)\n" // integer constant of the native base
+	"\treturn r\n"
+	"func hot(n):\n"
+	"\tvar x = 0.0\n"
+	"\tfor i in range(n):\n"
+	"\t\tx += i * (SCALE * PI / 180.0) + (SCALE * 0.5 if not DEBUG else 0.0)\n"
+	"\treturn x\n";
+
+#endif
+
+MainLoop * test() {
+
+#ifdef GDSCRIPT_ENABLED
+
+	GDParser parser;
+	if (parser.parse(code)!=OK) {
+		print_line("parse FAILED: "+parser.get_error()+" at line "+itos(parser.get_error_line()));
+		return NULL;
+	}
+	print_line("instructions saved: "+itos(parser.get_saved_instruction_count()));
+
+	Ref<GDScript> script = memnew( GDScript );
+	script->set_source_code(code);
+	if (script->reload()!=OK) {
+		print_line("compile FAILED");
+		return NULL;
+	}
+
+	Ref<Reference> obj = memnew( Reference );
+	obj->set_script(script.get_ref_ptr());
+
+	Array expected;
+	expected.push_back(9);
+	expected.push_back(Vector2(2,4));
+	expected.push_back("fold2");
+	expected.push_back(2);
+	expected.push_back(4);
+	expected.push_back(6);
+	expected.push_back(10);
+	expected.push_back(2);
+	expected.push_back(25);
+	expected.push_back(0);
+	expected.push_back(20);
+	expected.push_back(Object::NOTIFICATION_PREDELETE*10);
+
+	Array result = obj->call("run");
+
+	bool ok = parser.get_saved_instruction_count()>0 && result.size()==expected.size();
+	for(int i=0;ok && i<expected.size();i++) {
+		if (result[i]!=expected[i]) {
+			print_line("mismatch at "+itos(i)+": "+String(result[i])+" expected "+String(expected[i]));
+			ok=false;
+		}
+	}
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	obj->call("hot",1000000);
+	uint64_t to=OS::get_singleton()->get_ticks_usec();
+	print_line("hot loop: "+itos((to-from)/1000)+" msec");
+
+	obj->set_script(RefPtr());
+
+	print_line(ok ? "gdscript_fold: ok" : "gdscript_fold: FAILED");
+#endif
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  test_gdscript_ic.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_ic.h"
+#include "reference.h"
+#include "object_type_db.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Exercises the inline caches of the GDScript VM: named gets, sets and
+ * calls on native objects, on script instances and on both mixed at the
+ * same instruction, then measures a property/method heavy loop.
+ */
+
+namespace TestGDScriptIC {
+
+class TestICTarget : public Reference {
+
+	OBJ_TYPE(TestICTarget,Reference);
+
+	Vector2 value;
+	int calls;
+protected:
+
+	static void _bind_methods() {
+
+		ObjectTypeDB::bind_method(_MD("set_value","value"),&TestICTarget::set_value);
+		ObjectTypeDB::bind_method(_MD("get_value"),&TestICTarget::get_value);
+		ObjectTypeDB::bind_method(_MD("step","amount"),&TestICTarget::step);
+
+		ADD_PROPERTY(PropertyInfo(Variant::VECTOR2,"value"),_SCS("set_value"),_SCS("get_value"));
+	}
+public:
+
+	void set_value(const Vector2& p_value) { value=p_value; }
+	Vector2 get_value() const { return value; }
+	int step(int p_amount) { calls++; return p_amount*3; }
+
+	TestICTarget() { calls=0; }
+};
+
+#ifdef GDSCRIPT_ENABLED
+
+static Ref<GDScript> _compile(const String& p_code) {
+
+	Ref<GDScript> script = memnew( GDScript );
+	script->set_source_code(p_code);
+	if (script->reload()!=OK)
+		return Ref<GDScript>();
+	return script;
+}
+
+static bool _check_semantics() {
+
+	Ref<GDScript> scripted = _compile(
+		"extends Reference\n"
+		"var value = Vector2()\n"
+		"func step(amount):\n"
+		"\treturn amount*5\n");
+
+	Ref<GDScript> runner = _compile(
+		"static func run(objs):\n"
+		"\tvar acc = 0\n"
+		"\tfor o in objs:\n"
+		"\t\to.value += Vector2(1,0)\n"
+		"\t\tacc += o.step(1)\n"
+		"\t\tacc += int(o.value.x)\n"
+		"\treturn acc\n");
+
+	if (scripted.is_null() || runner.is_null())
+		return false;
+
+	Ref<TestICTarget> native = memnew( TestICTarget );
+	Ref<Reference> instance = memnew( Reference );
+	instance->set_script(scripted.get_ref_ptr());
+
+	Array objs;
+	for(int i=0;i<20;i++) {
+		objs.push_back(native); // warm the caches with the native type
+	}
+	for(int i=0;i<20;i++) {
+		objs.push_back(i%2 ? Variant(native) : Variant(instance)); // then alternate types at the same instructions
+	}
+
+	int acc = static_cast<Object*>(runner.ptr())->call("run",objs);
+
+	// native: 30 visits, step gives 3, value.x goes 1..30
+	// scripted: 10 visits, step gives 5, value.x goes 1..10
+	int expected = 30*3 + (30*31)/2 + 10*5 + (10*11)/2;
+	return acc==expected && native->get_value()==Vector2(30,0) && instance->get("value")==Vector2(10,0);
+}
+
+static void _bench_script(int p_iterations) {
+
+	Ref<GDScript> script = _compile(
+		"static func run(obj,n):\n"
+		"\tvar acc = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tobj.value += Vector2(1,0)\n"
+		"\t\tacc += obj.step(1)\n"
+		"\treturn acc\n");
+
+	if (script.is_null()) {
+		print_line("script property loop: compile FAILED");
+		return;
+	}
+
+	Ref<TestICTarget> obj = memnew( TestICTarget );
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	Variant acc=static_cast<Object*>(script.ptr())->call("run",obj,p_iterations);
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line("script property loop: "+itos(p_iterations)+" iterations "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_iterations)+"ns/iteration (acc "+String(acc)+")");
+}
+
+static void _bench_self(int p_iterations) {
+
+	// the type is registered after the language initialized its globals, so expose it to scripts by hand
+	GDScriptLanguage::get_singleton()->add_global_constant("TestICTarget",Ref<GDNativeClass>(memnew( GDNativeClass("TestICTarget") )));
+
+	Ref<GDScript> script = _compile(
+		"extends TestICTarget\n"
+		"func run(n):\n"
+		"\tvar acc = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tself.value += Vector2(1,0)\n"
+		"\t\tacc += self.step(1)\n"
+		"\treturn acc\n");
+
+	if (script.is_null()) {
+		print_line("script self loop: compile FAILED");
+		return;
+	}
+
+	Ref<TestICTarget> obj = memnew( TestICTarget );
+	obj->set_script(script.get_ref_ptr());
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	Variant acc=obj->call("run",p_iterations);
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line("script self loop: "+itos(p_iterations)+" iterations "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_iterations)+"ns/iteration (acc "+String(acc)+")");
+}
+
+#endif
+
+MainLoop * test() {
+
+	ObjectTypeDB::register_type<TestICTarget>();
+
+#ifdef GDSCRIPT_ENABLED
+	print_line("semantics checks: "+String(_check_semantics()?"ok":"FAILED"));
+	_bench_script(1000000);
+	_bench_self(1000000);
+#else
+	print_line("GDScript module is disabled, nothing to test.");
+#endif
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,324 @@
+/*************************************************************************/
+/*  test_gdscript_ops.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_ops.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Checks the results of the type specialized operators of the GDScript VM,
+ * including the cases where the compiler guessed the operand types wrong,
+ * and the counted for loops over range(). Measures int, float, vector and
+ * range loops.
+ */
+
+namespace TestGDScriptOps {
+
+#ifdef GDSCRIPT_ENABLED
+
+static Ref<GDScript> _compile(const String& p_code) {
+
+	Ref<GDScript> script = memnew( GDScript );
+	script->set_source_code(p_code);
+	if (script->reload()!=OK)
+		return Ref<GDScript>();
+	return script;
+}
+
+static bool _check_semantics() {
+
+	Ref<GDScript> script = _compile(
+		"static func run():\n"
+		"\tvar i = 7\n"
+		"\tvar j = 3\n"
+		"\tvar f = 1.5\n"
+		"\tvar v = Vector2(1,2)\n"
+		"\tvar w = Vector3(1,2,3)\n"
+		"\tvar r = []\n"
+		"\tr.append(i+j)\n"
+		"\tr.append(i-j)\n"
+		"\tr.append(i*j)\n"
+		"\tr.append(i/j)\n"
+		"\tr.append(i%j)\n"
+		"\tr.append(-i)\n"
+		"\tr.append(i<j)\n"
+		"\tr.append(i>=j)\n"
+		"\tr.append(i==7)\n"
+		"\tr.append(f+i)\n"
+		"\tr.append(i/f)\n"
+		"\tr.append(f*f)\n"
+		"\tr.append(f<i)\n"
+		"\tr.append(f==1.5)\n"
+		"\tr.append(v+v)\n"
+		"\tr.append(v*2)\n"
+		"\tr.append(0.5*v)\n"
+		"\tr.append(v/2.0)\n"
+		"\tr.append(v*v)\n"
+		"\tr.append(-v)\n"
+		"\tr.append(v==Vector2(1,2))\n"
+		"\tr.append(w-w*2)\n"
+		"\tr.append(w/w)\n"
+		"\tr.append(w!=w)\n"
+		"\tvar k = 1\n"
+		"\tk = 2.5\n" // guessed int, holds a float
+		"\tr.append(k+1)\n"
+		"\tr.append(k*j)\n"
+		"\tvar s = 1.0\n"
+		"\ts = 4\n" // guessed float, holds an int
+		"\tr.append(s/j)\n"
+		"\tvar p = Vector2()\n"
+		"\tp = Vector3(1,1,1)\n" // guessed Vector2, holds a Vector3
+		"\tr.append(p+w)\n"
+		"\tfor n in range(3):\n"
+		"\t\ti += n\n"
+		"\tr.append(i)\n"
+		"\treturn r\n");
+
+	if (script.is_null())
+		return false;
+
+	Array expected;
+	expected.push_back(10);
+	expected.push_back(4);
+	expected.push_back(21);
+	expected.push_back(2);
+	expected.push_back(1);
+	expected.push_back(-7);
+	expected.push_back(false);
+	expected.push_back(true);
+	expected.push_back(true);
+	expected.push_back(8.5);
+	expected.push_back(7/1.5);
+	expected.push_back(2.25);
+	expected.push_back(true);
+	expected.push_back(true);
+	expected.push_back(Vector2(2,4));
+	expected.push_back(Vector2(2,4));
+	expected.push_back(Vector2(0.5,1));
+	expected.push_back(Vector2(0.5,1));
+	expected.push_back(Vector2(1,4));
+	expected.push_back(Vector2(-1,-2));
+	expected.push_back(true);
+	expected.push_back(Vector3(-1,-2,-3));
+	expected.push_back(Vector3(1,1,1));
+	expected.push_back(false);
+	expected.push_back(3.5);
+	expected.push_back(7.5);
+	expected.push_back(1);
+	expected.push_back(Vector3(2,3,4));
+	expected.push_back(10);
+
+	Array result = static_cast<Object*>(script.ptr())->call("run");
+
+	if (result.size()!=expected.size())
+		return false;
+
+	bool ok=true;
+	for(int i=0;i<result.size();i++) {
+
+		if (result[i].get_type()!=expected[i].get_type() || !Variant::evaluate(Variant::OP_EQUAL,result[i],expected[i]).operator bool()) {
+			print_line("result "+itos(i)+" is "+String(result[i])+" ("+Variant::get_type_name(result[i].get_type())+"), expected "+String(expected[i]));
+			ok=false;
+		}
+	}
+
+	return ok;
+}
+
+static bool _check_range() {
+
+	// for loops over range() are counted in place, they must visit the same
+	// values as iterating the array range() returns
+	Ref<GDScript> script = _compile(
+		"static func counted(a,b,c):\n"
+		"\tvar r = []\n"
+		"\tfor i in range(a):\n"
+		"\t\tr.append(i)\n"
+		"\t\ti = 100\n" // must not change the iteration
+		"\tfor i in range(a,b):\n"
+		"\t\tif i==2:\n"
+		"\t\t\tcontinue\n"
+		"\t\tr.append(i)\n"
+		"\tfor i in range(a,b,c):\n"
+		"\t\tr.append(i)\n"
+		"\t\tif i>50:\n"
+		"\t\t\tbreak\n"
+		"\treturn r\n"
+		"static func arrays(a,b,c):\n"
+		"\tvar r = []\n"
+		"\tvar l = range(a)\n"
+		"\tfor i in l:\n"
+		"\t\tr.append(i)\n"
+		"\tl = range(a,b)\n"
+		"\tfor i in l:\n"
+		"\t\tif i==2:\n"
+		"\t\t\tcontinue\n"
+		"\t\tr.append(i)\n"
+		"\tl = range(a,b,c)\n"
+		"\tfor i in l:\n"
+		"\t\tr.append(i)\n"
+		"\t\tif i>50:\n"
+		"\t\t\tbreak\n"
+		"\treturn r\n"
+		"static func not_numbers(a):\n"
+		"\tvar r = []\n"
+		"\tfor i in range(a):\n"
+		"\t\tr.append(i)\n"
+		"\treturn r\n");
+
+	if (script.is_null())
+		return false;
+
+	static const double cases[][3]={
+		{ 5, 10, 1 },
+		{ 0, 10, 3 },
+		{ 10, 0, -3 },
+		{ 3, 3, 1 },
+		{ 10, 0, 2 },
+		{ -5, 5, 4 },
+		{ 0, 100, 7 },
+		{ 2.5, 7.9, 2 },
+	};
+
+	int case_count=sizeof(cases)/sizeof(cases[0]);
+
+	bool ok=true;
+	for(int i=0;i<case_count;i++) {
+
+		Variant a=cases[i][0];
+		Variant b=cases[i][1];
+		Variant c=cases[i][2];
+		if (cases[i][0]==int(cases[i][0]) && cases[i][1]==int(cases[i][1])) {
+			a=int(cases[i][0]);
+			b=int(cases[i][1]);
+			c=int(cases[i][2]);
+		}
+
+		Array counted = static_cast<Object*>(script.ptr())->call("counted",a,b,c);
+		Array arrays = static_cast<Object*>(script.ptr())->call("arrays",a,b,c);
+
+		bool same=counted.size()==arrays.size();
+		for(int j=0;same && j<counted.size();j++)
+			same = counted[j].get_type()==Variant::INT && counted[j].get_type()==arrays[j].get_type() && int(counted[j])==int(arrays[j]);
+
+		if (!same) {
+			print_line("range("+String(a)+","+String(b)+","+String(c)+"): counted "+itos(counted.size())+" values, arrays "+itos(arrays.size()));
+			ok=false;
+		}
+	}
+
+	// like range(), the counted loop refuses arguments that are not numbers, also in release builds
+	Variant not_numbers = static_cast<Object*>(script.ptr())->call("not_numbers","3");
+	if (not_numbers.get_type()!=Variant::NIL) {
+		print_line("range(\"3\"): ran the loop");
+		ok=false;
+	}
+
+	return ok;
+}
+
+static void _bench(const String& p_name,const String& p_code,int p_iterations) {
+
+	Ref<GDScript> script = _compile(p_code);
+	if (script.is_null()) {
+		print_line(p_name+" loop: compile FAILED");
+		return;
+	}
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	Variant ret=static_cast<Object*>(script.ptr())->call("run",p_iterations);
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line(p_name+" loop: "+itos(p_iterations)+" iterations "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_iterations)+"ns/iteration (result "+String(ret)+")");
+}
+
+#endif
+
+MainLoop * test() {
+
+#ifdef GDSCRIPT_ENABLED
+	print_line("semantics checks: "+String(_check_semantics()?"ok":"FAILED"));
+	print_line("range checks: "+String(_check_range()?"ok":"FAILED"));
+
+	_bench("int",
+		"static func run(n):\n"
+		"\tvar i = 0\n"
+		"\tvar acc = 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc = (acc + i * 3 - 1) % 65536\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n",1000000);
+
+	_bench("float",
+		"static func run(n):\n"
+		"\tvar x = 0.0\n"
+		"\tvar speed = 2.5\n"
+		"\tfor i in range(n):\n"
+		"\t\tx = x * 0.5 + speed * 0.016\n"
+		"\t\tif x > 100.0:\n"
+		"\t\t\tx -= 100.0\n"
+		"\treturn x\n",1000000);
+
+	_bench("vector",
+		"static func run(n):\n"
+		"\tvar pos = Vector2()\n"
+		"\tvar vel = Vector2(3,4)\n"
+		"\tvar delta = 0.016\n"
+		"\tfor i in range(n):\n"
+		"\t\tvel = vel * 0.99 + Vector2(0,9.8) * delta\n"
+		"\t\tpos += vel * delta\n"
+		"\treturn pos\n",1000000);
+
+	_bench("range",
+		"static func run(n):\n"
+		"\tvar acc = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tacc += i & 255\n"
+		"\treturn acc\n",1000000);
+
+	_bench("array",
+		"static func run(n):\n"
+		"\tvar acc = 0\n"
+		"\tvar a = range(n)\n"
+		"\tfor i in a:\n"
+		"\t\tacc += i & 255\n"
+		"\treturn acc\n",1000000);
+#else
+	print_line("GDScript module is disabled, nothing to test.");
+#endif
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,121 @@
+/*************************************************************************/
+/*  test_gdscript_sampler.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_sampler.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Runs a script with one obviously hot line, reached from two callers,
+ * under the sampling profiler. Checks that the line comes out on top,
+ * that both call paths show up in the collapsed stacks, and prints the
+ * time taken with and without sampling.
+ */
+
+namespace TestGDScriptSampler {
+
+#ifdef GDSCRIPT_ENABLED
+
+static const char *code=
+	"static func hot(n):\n"
+	"\tvar x = 0.0\n"
+	"\tfor i in range(n):\n"
+	"\t\tx += Vector2(i, i + 1).normalized().x * sqrt(i) + Vector3(i, 1, 2).length()\n"
+	"\treturn x\n"
+	"static func caller_a(n):\n"
+	"\treturn hot(n)\n"
+	"static func caller_b(n):\n"
+	"\treturn hot(n * 2)\n"
+	"static func run(n):\n"
+	"\tvar t = 0.0\n"
+	"\tfor i in range(20):\n"
+	"\t\tt += caller_a(n)\n"
+	"\t\tt += caller_b(n)\n"
+	"\treturn int(t)\n";
+
+static int hot_line=4;
+
+#endif
+
+MainLoop * test() {
+
+#ifdef GDSCRIPT_ENABLED
+
+	Ref<GDScript> script = memnew( GDScript );
+	script->set_source_code(code);
+	if (script->reload()!=OK) {
+		print_line("compile FAILED");
+		return NULL;
+	}
+
+	GDScriptLanguage *lang=GDScriptLanguage::get_singleton();
+	Object *obj=script.ptr();
+	int n=5000;
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+	Variant plain=obj->call("run",n);
+	uint64_t plain_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	lang->sampling_start(500);
+	t=OS::get_singleton()->get_ticks_usec();
+	Variant sampled=obj->call("run",n);
+	uint64_t sampled_time=OS::get_singleton()->get_ticks_usec()-t;
+	lang->sampling_stop();
+
+	print_line("without sampling: "+itos(plain_time/1000)+"ms, while sampling: "+itos(sampled_time/1000)+"ms, "+itos(lang->sampling_get_sample_count())+" samples");
+	if (plain!=sampled)
+		print_line("results differ: FAILED");
+
+	ScriptLanguage::SampledLineInfo lines[8];
+	int count=lang->sampling_get_line_data(lines,8);
+	for(int i=0;i<count;i++) {
+		print_line("\t"+itos(lines[i].self_samples)+"/"+itos(lines[i].total_samples)+"\tline "+itos(lines[i].line)+" in "+String(lines[i].function));
+	}
+
+	if (count==0 || String(lines[0].function)!="hot" || lines[0].line!=hot_line)
+		print_line("hottest line: FAILED, expected line "+itos(hot_line)+" in hot");
+	else
+		print_line("hottest line: ok");
+
+	String stacks=lang->sampling_get_collapsed_stacks();
+	if (stacks.find("caller_a (")==-1 || stacks.find("caller_b (")==-1 || stacks.find(";hot (")==-1)
+		print_line("collapsed stacks: FAILED\n"+stacks);
+	else
+		print_line("collapsed stacks: ok, "+itos(stacks.get_slice_count("\n")-1)+" distinct stacks");
+#else
+	print_line("GDScript module is disabled, nothing to test.");
+#endif
+
+	return NULL;
+}
+
+}
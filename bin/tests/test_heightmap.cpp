@@ -0,0 +1,213 @@
+/*************************************************************************/
+/*  test_heightmap.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_heightmap.h"
+#include "servers/physics/shape_sw.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Compares HeightMapShapeSW against a ConcavePolygonShapeSW built from the
+ * same triangles. Both must report the same faces for AABB culls and the same
+ * hits for raycasts, and faces touching a cull box count as inside it.
+ */
+
+namespace TestHeightMap {
+
+static void _count_face(void *p_userdata,ShapeSW *p_face) {
+
+	(*(int*)p_userdata)++;
+}
+
+static void _bench(int p_size,int p_queries) {
+
+	float cell_size=1.0;
+	int width=p_size;
+	int depth=p_size;
+
+	DVector<float> heights;
+	heights.resize(width*depth);
+	{
+		DVector<float>::Write w=heights.write();
+		for(int i=0;i<depth;i++) {
+			for(int j=0;j<width;j++) {
+				w[i*width+j]=Math::sin(j*0.11)*4.0+Math::cos(i*0.07)*6.0+Math::sin((i+j)*0.31);
+			}
+		}
+	}
+
+	Dictionary d;
+	d["width"]=width;
+	d["depth"]=depth;
+	d["cell_size"]=cell_size;
+	d["heights"]=heights;
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+	HeightMapShapeSW heightmap;
+	heightmap.set_data(d);
+	uint64_t heightmap_setup=OS::get_singleton()->get_ticks_usec()-t;
+
+	DVector<Vector3> faces;
+	faces.resize((width-1)*(depth-1)*6);
+	{
+		DVector<float>::Read r=heights.read();
+		DVector<Vector3>::Write w=faces.write();
+		int idx=0;
+		for(int i=0;i<depth-1;i++) {
+			for(int j=0;j<width-1;j++) {
+				Vector3 p00(j*cell_size,r[i*width+j],i*cell_size);
+				Vector3 p10((j+1)*cell_size,r[i*width+j+1],i*cell_size);
+				Vector3 p01(j*cell_size,r[(i+1)*width+j],(i+1)*cell_size);
+				Vector3 p11((j+1)*cell_size,r[(i+1)*width+j+1],(i+1)*cell_size);
+				w[idx++]=p00; w[idx++]=p10; w[idx++]=p01;
+				w[idx++]=p10; w[idx++]=p11; w[idx++]=p01;
+			}
+		}
+	}
+
+	t=OS::get_singleton()->get_ticks_usec();
+	ConcavePolygonShapeSW concave;
+	concave.set_data(faces);
+	uint64_t concave_setup=OS::get_singleton()->get_ticks_usec()-t;
+
+	int face_count=faces.size()/3;
+	int heightmap_mem=heights.size()*sizeof(real_t);
+	int concave_mem=face_count*sizeof(ConcavePolygonShapeSW::Face)+width*depth*sizeof(Vector3)+(face_count*2)*sizeof(ConcavePolygonShapeSW::BVH);
+
+	print_line(itos(width)+"x"+itos(depth)+" heights, "+itos(face_count)+" faces");
+	print_line("  setup: heightmap "+itos(heightmap_setup/1000)+"ms, concave "+itos(concave_setup/1000)+"ms");
+	print_line("  memory: heightmap ~"+itos(heightmap_mem/1024)+"KB, concave ~"+itos(concave_mem/1024)+"KB");
+
+	Vector<AABB> aabbs;
+	Vector<Vector3> ray_from;
+	Vector<Vector3> ray_to;
+	float extent=(width-1)*cell_size;
+
+	for(int i=0;i<p_queries;i++) {
+
+		Vector3 pos(Math::random(0,extent),Math::random(-12,12),Math::random(0,extent));
+		aabbs.push_back(AABB(pos,Vector3(1,1,1)*Math::random(0.5,4)));
+		ray_from.push_back(Vector3(Math::random(0,extent),30,Math::random(0,extent)));
+		ray_to.push_back(ray_from[i]+Vector3(Math::random(-40,40),-60,Math::random(-40,40)));
+	}
+
+	int heightmap_faces=0;
+	t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<aabbs.size();i++) {
+		heightmap.cull(aabbs[i],_count_face,&heightmap_faces);
+	}
+	uint64_t heightmap_cull=OS::get_singleton()->get_ticks_usec()-t;
+
+	int concave_faces=0;
+	t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<aabbs.size();i++) {
+		concave.cull(aabbs[i],_count_face,&concave_faces);
+	}
+	uint64_t concave_cull=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line("  cull: heightmap "+itos(heightmap_cull/1000)+"ms ("+itos(heightmap_faces)+" faces), concave "+itos(concave_cull/1000)+"ms ("+itos(concave_faces)+" faces)");
+
+	Vector<Vector3> heightmap_hits;
+	heightmap_hits.resize(ray_from.size());
+	int heightmap_hit_count=0;
+	t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<ray_from.size();i++) {
+		Vector3 point,normal;
+		if (heightmap.intersect_segment(ray_from[i],ray_to[i],point,normal)) {
+			heightmap_hits[i]=point;
+			heightmap_hit_count++;
+		}
+	}
+	uint64_t heightmap_ray=OS::get_singleton()->get_ticks_usec()-t;
+
+	Vector<Vector3> concave_hits;
+	concave_hits.resize(ray_from.size());
+	int concave_hit_count=0;
+	t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<ray_from.size();i++) {
+		Vector3 point,normal;
+		if (concave.intersect_segment(ray_from[i],ray_to[i],point,normal)) {
+			concave_hits[i]=point;
+			concave_hit_count++;
+		}
+	}
+	uint64_t concave_ray=OS::get_singleton()->get_ticks_usec()-t;
+
+	int mismatches=0;
+	for(int i=0;i<ray_from.size();i++) {
+		if (heightmap_hits[i].distance_to(concave_hits[i])>0.01)
+			mismatches++;
+	}
+
+	print_line("  raycast: heightmap "+itos(heightmap_ray/1000)+"ms ("+itos(heightmap_hit_count)+" hits), concave "+itos(concave_ray/1000)+"ms ("+itos(concave_hit_count)+" hits), "+itos(mismatches)+" mismatches");
+}
+
+static void _test_touching() {
+
+	// faces that only touch the query box must be reported, or bodies resting
+	// on flat ground fall through it
+
+	int size=8;
+	DVector<float> heights;
+	heights.resize(size*size);
+	{
+		DVector<float>::Write w=heights.write();
+		for(int i=0;i<size*size;i++)
+			w[i]=0;
+	}
+
+	Dictionary d;
+	d["width"]=size;
+	d["depth"]=size;
+	d["cell_size"]=1.0;
+	d["heights"]=heights;
+
+	HeightMapShapeSW heightmap;
+	heightmap.set_data(d);
+
+	int above=0;
+	heightmap.cull(AABB(Vector3(2.25,0,2.25),Vector3(0.5,1,0.5)),_count_face,&above);
+	int below=0;
+	heightmap.cull(AABB(Vector3(2.25,-1,2.25),Vector3(0.5,1,0.5)),_count_face,&below);
+	int apart=0;
+	heightmap.cull(AABB(Vector3(2.25,0.01,2.25),Vector3(0.5,1,0.5)),_count_face,&apart);
+
+	bool ok=above==2 && below==2 && apart==0;
+	print_line("touching cull: "+itos(above)+" faces above, "+itos(below)+" below, "+itos(apart)+" apart: "+(ok?"ok":"FAILED"));
+}
+
+MainLoop * test() {
+
+	_test_touching();
+	_bench(128,20000);
+	_bench(512,20000);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,201 @@
+/*************************************************************************/
+/*  test_job_system.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_job_system.h"
+#include "job_system.h"
+#include "safe_refcount.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#include <time.h>
+
+/**
+ * Runs JobSystem workloads on a few worker threads and checks that every
+ * index of a parallel_for runs once (also nested in jobs), that jobs submitted
+ * after a group only start once all of it finished, and that a thread waiting
+ * on jobs running elsewhere sleeps instead of spinning.
+ */
+
+namespace TestJobSystem {
+
+enum {
+	THREADS=4,
+	FOR_COUNT=100000,
+	NESTED_OUTER=16,
+	NESTED_INNER=1000,
+	DEPENDENCY_JOBS=64,
+	SLEEP_MSEC=200
+};
+
+static bool ok=true;
+
+static void _check(const String& p_what,bool p_cond) {
+
+	if (!p_cond) {
+		print_line(p_what+" FAILED");
+		ok=false;
+	}
+}
+
+static void _count_job(void *p_userdata,uint32_t p_index) {
+
+	((uint32_t*)p_userdata)[p_index]++;
+}
+
+static void _nested_job(void *p_userdata,uint32_t p_index) {
+
+	uint32_t *counts=(uint32_t*)p_userdata;
+	JobSystem::get_singleton()->parallel_for(NESTED_INNER,_count_job,&counts[p_index*NESTED_INNER],64);
+}
+
+struct Dependency {
+
+	volatile uint32_t values[DEPENDENCY_JOBS];
+	volatile uint32_t first_done;
+	volatile uint32_t second_ok;
+	volatile uint32_t third_ok;
+};
+
+static void _first_job(void *p_userdata,uint32_t p_index) {
+
+	Dependency *d=(Dependency*)p_userdata;
+	OS::get_singleton()->delay_usec((p_index%4)*500);
+	d->values[p_index]=p_index+1;
+	atomic_increment(&d->first_done);
+}
+
+static void _second_job(void *p_userdata,uint32_t p_index) {
+
+	Dependency *d=(Dependency*)p_userdata;
+
+	bool all=d->first_done==DEPENDENCY_JOBS;
+	for(int i=0;i<DEPENDENCY_JOBS;i++) {
+		if (d->values[i]!=uint32_t(i+1))
+			all=false;
+	}
+	if (all)
+		atomic_increment(&d->second_ok);
+}
+
+static void _third_job(void *p_userdata,uint32_t p_index) {
+
+	Dependency *d=(Dependency*)p_userdata;
+	if (d->second_ok==DEPENDENCY_JOBS)
+		atomic_increment(&d->third_ok);
+}
+
+static void _sleep_job(void *p_userdata,uint32_t p_index) {
+
+	OS::get_singleton()->delay_usec(SLEEP_MSEC*1000);
+}
+
+MainLoop * test() {
+
+	JobSystem *js=JobSystem::get_singleton();
+	int prev_threads=js->get_thread_count();
+	js->start(THREADS);
+	ok=true;
+
+	// every index once
+
+	Vector<uint32_t> counts;
+	counts.resize(FOR_COUNT);
+	for(int i=0;i<FOR_COUNT;i++)
+		counts[i]=0;
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<10;i++)
+		js->parallel_for(FOR_COUNT,_count_job,counts.ptr(),256);
+	t=OS::get_singleton()->get_ticks_usec()-t;
+
+	bool all=true;
+	for(int i=0;i<FOR_COUNT;i++) {
+		if (counts[i]!=10)
+			all=false;
+	}
+	_check("parallel_for",all);
+	print_line("parallel_for: "+itos(FOR_COUNT)+" indices "+rtos(t/10000.0)+" msec per call, "+itos(js->get_thread_count())+" threads");
+
+	// nested in jobs, the outer jobs wait for the inner ones
+
+	counts.resize(NESTED_OUTER*NESTED_INNER);
+	for(int i=0;i<counts.size();i++)
+		counts[i]=0;
+	js->parallel_for(NESTED_OUTER,_nested_job,counts.ptr());
+
+	all=true;
+	for(int i=0;i<counts.size();i++) {
+		if (counts[i]!=1)
+			all=false;
+	}
+	_check("nested parallel_for",all);
+
+	// a chain of dependent groups
+
+	Dependency d;
+	for(int i=0;i<DEPENDENCY_JOBS;i++)
+		d.values[i]=0;
+	d.first_done=0;
+	d.second_ok=0;
+	d.third_ok=0;
+
+	JobSystem::Group first,second,third;
+	js->submit_range(&first,_first_job,&d,DEPENDENCY_JOBS);
+	for(int i=0;i<DEPENDENCY_JOBS;i++)
+		js->submit_after(&first,&second,_second_job,&d,i);
+	js->wait(&second);
+	for(int i=0;i<DEPENDENCY_JOBS;i++)
+		js->submit_after(&second,&third,_third_job,&d,i);
+	js->wait(&third);
+	js->wait(&first);
+
+	_check("dependent jobs see the finished group",d.second_ok==DEPENDENCY_JOBS);
+	_check("chained groups",d.third_ok==DEPENDENCY_JOBS);
+
+	// waiting for a job that runs on a worker
+
+	JobSystem::Group sleeping;
+	js->submit(&sleeping,_sleep_job,NULL);
+	OS::get_singleton()->delay_usec(10000); // let a worker take it
+	clock_t cpu=clock();
+	t=OS::get_singleton()->get_ticks_usec();
+	js->wait(&sleeping);
+	t=OS::get_singleton()->get_ticks_usec()-t;
+	cpu=clock()-cpu;
+
+	int cpu_msec=int(cpu*1000/CLOCKS_PER_SEC);
+	print_line("waited "+itos(t/1000)+" msec for a job on a worker, "+itos(cpu_msec)+" msec of cpu time");
+	_check("waiting sleeps",cpu_msec<SLEEP_MSEC/4);
+
+	js->start(prev_threads);
+
+	print_line(ok ? "job_system: ok" : "job_system: FAILED");
+	return NULL;
+}
+
+}
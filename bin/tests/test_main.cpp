@@ -47,6 +47,27 @@
 #include "test_shader_lang.h"
 #include "test_gdscript.h"
 #include "test_image.h"
+#include "test_broadphase.h"
+#include "test_rid.h"
+#include "test_alloc.h"
+#include "test_signals.h"
+#include "test_heightmap.h"
+#include "test_visual_cull.h"
+#include "test_variant_pool.h"
+#include "test_gdscript_ic.h"
+#include "test_gdscript_ops.h"
+#include "test_gdscript_cache.h"
+#include "test_gdscript_bench.h"
+#include "test_gdscript_sampler.h"
+#include "test_visual_script_bench.h"
+#include "test_gdscript_fold.h"
+#include "test_process_list.h"
+#include "test_threaded_process.h"
+#include "test_node_path.h"
+#include "test_scene_instance.h"
+#include "test_scene_pool.h"
+#include "test_job_system.h"
+#include "test_astar.h"
 
 
 const char ** tests_get_names()  {
@@ -62,6 +83,27 @@ const char ** tests_get_names()  {
 		"io",
 		"shaderlang",
 		"physics",
+		"broadphase",
+		"rid",
+		"alloc",
+		"signals",
+		"heightmap",
+		"visual_cull",
+		"variant_pool",
+		"gdscript_ic",
+		"gdscript_ops",
+		"gdscript_cache",
+		"gdscript_bench",
+		"gdscript_sampler",
+		"visual_script_bench",
+		"gdscript_fold",
+		"process_list",
+		"threaded_process",
+		"node_path",
+		"scene_instance",
+		"scene_pool",
+		"job_system",
+		"astar",
 		NULL
 	};
 
@@ -91,6 +133,111 @@ MainLoop* test_main(String p_test,const List<String>& p_args) {
 		return TestPhysics::test();
 	}
 
+	if (p_test=="broadphase") {
+
+		return TestBroadPhase::test();
+	}
+
+	if (p_test=="rid") {
+
+		return TestRID::test();
+	}
+
+	if (p_test=="alloc") {
+
+		return TestAlloc::test();
+	}
+
+	if (p_test=="signals") {
+
+		return TestSignals::test();
+	}
+
+	if (p_test=="heightmap") {
+
+		return TestHeightMap::test();
+	}
+
+	if (p_test=="visual_cull") {
+
+		return TestVisualCull::test();
+	}
+
+	if (p_test=="variant_pool") {
+
+		return TestVariantPool::test();
+	}
+
+	if (p_test=="gdscript_ic") {
+
+		return TestGDScriptIC::test();
+	}
+
+	if (p_test=="gdscript_ops") {
+
+		return TestGDScriptOps::test();
+	}
+
+	if (p_test=="gdscript_cache") {
+
+		return TestGDScriptCache::test();
+	}
+
+	if (p_test=="gdscript_bench") {
+
+		return TestGDScriptBench::test();
+	}
+
+	if (p_test=="gdscript_sampler") {
+
+		return TestGDScriptSampler::test();
+	}
+
+	if (p_test=="visual_script_bench") {
+
+		return TestVisualScriptBench::test();
+	}
+
+	if (p_test=="gdscript_fold") {
+
+		return TestGDScriptFold::test();
+	}
+
+	if (p_test=="process_list") {
+
+		return TestProcessList::test();
+	}
+
+	if (p_test=="threaded_process") {
+
+		return TestThreadedProcess::test();
+	}
+
+	if (p_test=="node_path") {
+
+		return TestNodePath::test();
+	}
+
+	if (p_test=="scene_instance") {
+
+		return TestSceneInstance::test();
+	}
+
+	if (p_test=="scene_pool") {
+
+		return TestScenePool::test();
+	}
+
+	if (p_test=="job_system") {
+
+		return TestJobSystem::test();
+	}
+
+	if (p_test=="astar") {
+
+		return TestAStar::test();
+	}
+
 	if (p_test=="physics_2d") {
 
 		return TestPhysics2D::test();
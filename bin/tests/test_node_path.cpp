@@ -0,0 +1,202 @@
+/*************************************************************************/
+/*  test_node_path.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_node_path.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/main/viewport.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Resolves paths through a deep chain of nodes and into a wide parent,
+ * comparing get_node() against a plain scan of the children, and checks that
+ * renaming, moving and removing nodes is seen by paths resolved before.
+ * Then prints the time per lookup for both.
+ */
+
+namespace TestNodePath {
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		DEPTH=20,
+		WIDTH=10000,
+		LOOKUPS=200000
+	};
+
+	bool ok;
+
+	static Node *_scan_path(Node *p_from,const NodePath& p_path) {
+
+		Node *current=p_from;
+		for(int i=0;current && i<p_path.get_name_count();i++) {
+
+			StringName name=p_path.get_name(i);
+			if (name==".")
+				continue;
+			if (name=="..") {
+				current=current->get_parent();
+				continue;
+			}
+
+			Node *next=NULL;
+			for(int j=0;j<current->get_child_count();j++) {
+				if (current->get_child(j)->get_name()==name) {
+					next=current->get_child(j);
+					break;
+				}
+			}
+			current=next;
+		}
+		return current;
+	}
+
+	static Node *_find(Node *p_from,const NodePath& p_path) {
+
+		return p_from->has_node(p_path) ? p_from->get_node(p_path) : NULL;
+	}
+
+	void _check(const String& p_what,Node *p_got,Node *p_expected) {
+
+		if (p_got!=p_expected) {
+			print_line(p_what+" FAILED");
+			ok=false;
+		}
+	}
+
+	void _bench(const String& p_what,Node *p_from,const NodePath& p_path) {
+
+		Node *expected=_scan_path(p_from,p_path);
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<LOOKUPS;i++) {
+			if (_scan_path(p_from,p_path)!=expected)
+				ok=false;
+		}
+		uint64_t scan_usec=OS::get_singleton()->get_ticks_usec()-from;
+
+		from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<LOOKUPS;i++) {
+			if (p_from->get_node(p_path)!=expected)
+				ok=false;
+		}
+		uint64_t get_usec=OS::get_singleton()->get_ticks_usec()-from;
+
+		print_line(p_what+": scan "+rtos(scan_usec*1000.0/LOOKUPS)+" nsec, get_node "+rtos(get_usec*1000.0/LOOKUPS)+" nsec per lookup");
+	}
+
+public:
+
+	virtual void init() {
+
+		SceneTree::init();
+		ok=true;
+
+		Node *deep_root=memnew( Node );
+		deep_root->set_name("deep");
+		get_root()->add_child(deep_root);
+
+		String deep_path;
+		Node *deepest=deep_root;
+		for(int i=0;i<DEPTH;i++) {
+			Node *n=memnew( Node );
+			n->set_name("level"+itos(i));
+			deepest->add_child(n);
+			deepest=n;
+			deep_path+=(i?"/":"")+String("level")+itos(i);
+		}
+
+		Node *wide=memnew( Node );
+		wide->set_name("wide");
+		get_root()->add_child(wide);
+		for(int i=0;i<WIDTH;i++) {
+			Node *n=memnew( Node );
+			n->set_name("child"+itos(i));
+			wide->add_child(n);
+		}
+
+		Node *last=wide->get_child(WIDTH-1);
+		NodePath wide_path("../wide/child"+itos(WIDTH-1));
+
+		_check("deep",deep_root->get_node(deep_path),deepest);
+		_check("deep, again",deep_root->get_node(deep_path),deepest);
+		_check("wide",deep_root->get_node(wide_path),last);
+		_check("wide, again",deep_root->get_node(wide_path),last);
+		_check("up",deepest->get_node(NodePath(String("../../../../level")+itos(DEPTH-4))),deepest->get_parent()->get_parent()->get_parent());
+
+		// a renamed node must not be found by its old name, and its new name must
+		last->set_name("renamed");
+		_check("renamed, old name",_find(deep_root,wide_path),NULL);
+		_check("renamed, new name",_find(deep_root,NodePath("../wide/renamed")),last);
+		last->set_name("child"+itos(WIDTH-1));
+		_check("renamed back",deep_root->get_node(wide_path),last);
+
+		// a name taken by a sibling is resolved to the first child using it
+		Node *middle=wide->get_child(WIDTH/2);
+		NodePath middle_path("../wide/child"+itos(WIDTH/2));
+		_check("middle",deep_root->get_node(middle_path),middle);
+		wide->remove_child(middle);
+		_check("removed",_find(deep_root,middle_path),NULL);
+		wide->add_child(middle);
+		_check("added back",deep_root->get_node(middle_path),middle);
+
+		// moving a level of the chain elsewhere changes what the path resolves to
+		Node *mid_level=deepest->get_parent()->get_parent();
+		Node *mid_parent=mid_level->get_parent();
+		mid_parent->remove_child(mid_level);
+		_check("moved away",_find(deep_root,deep_path),NULL);
+		mid_parent->add_child(mid_level);
+		_check("moved back",deep_root->get_node(deep_path),deepest);
+
+		_bench("deep ("+itos(DEPTH)+" levels)",deep_root,deep_path);
+		_bench("wide ("+itos(WIDTH)+" children)",deep_root,wide_path);
+		_bench("wide, first child",deep_root,NodePath("../wide/child0"));
+
+		if (_scan_path(get_root(),NodePath("wide/child"+itos(WIDTH/2)))!=middle || get_root()->get_node("wide/child"+itos(WIDTH/2))!=middle)
+			ok=false;
+	}
+
+	virtual bool idle(float p_time) {
+
+		quit();
+		return SceneTree::idle(p_time);
+	}
+
+	virtual void finish() {
+
+		print_line(ok ? "node_path: ok" : "node_path: FAILED");
+		SceneTree::finish();
+	}
+};
+
+MainLoop* test() {
+
+	return memnew( TestMainLoop );
+}
+
+}
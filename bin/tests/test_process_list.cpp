@@ -0,0 +1,202 @@
+/*************************************************************************/
+/*  test_process_list.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_process_list.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/main/viewport.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Checks that processing follows tree order regardless of when nodes called
+ * set_process(), that nodes removed while the list is running are skipped
+ * and nodes added wait for the next frame, and that only nodes allowed to
+ * run get processed while the tree is paused. Then prints the time spent
+ * processing a large number of nodes per frame.
+ */
+
+namespace TestProcessList {
+
+static Vector<int> process_log;
+
+class ProcessListNode : public Node {
+
+	OBJ_TYPE(ProcessListNode,Node);
+public:
+
+	int id;
+	Node *stop; // stops processing of this one when processed
+	Node *start; // starts processing of this one when processed
+
+	void _notification(int p_what) {
+
+		if (p_what!=NOTIFICATION_PROCESS)
+			return;
+
+		process_log.push_back(id);
+		if (stop) {
+			stop->set_process(false);
+			stop=NULL;
+		}
+		if (start) {
+			start->set_process(true);
+			start=NULL;
+		}
+	}
+
+	ProcessListNode() { id=0; stop=NULL; start=NULL; }
+};
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		NODE_COUNT=6,
+		BENCH_NODE_COUNT=30000,
+		BENCH_FRAMES=100
+	};
+
+	ProcessListNode *nodes[NODE_COUNT];
+	int frame;
+	bool ok;
+	bool bench;
+	uint64_t bench_usec;
+
+	void _check(const String& p_what,const int *p_expected,int p_count) {
+
+		bool match = process_log.size()==p_count && get_idle_processed_node_count()==p_count;
+		for(int i=0;match && i<p_count;i++) {
+			match = process_log[i]==p_expected[i];
+		}
+
+		if (!match) {
+			String got;
+			for(int i=0;i<process_log.size();i++)
+				got+=" "+itos(process_log[i]);
+			print_line(p_what+" FAILED, processed:"+got);
+			ok=false;
+		}
+		process_log.clear();
+	}
+
+public:
+
+	virtual void init() {
+
+		SceneTree::init();
+
+		for(int i=0;i<NODE_COUNT;i++) {
+			nodes[i]=memnew( ProcessListNode );
+			nodes[i]->id=i;
+			get_root()->add_child(nodes[i]);
+		}
+
+		// enabled in reverse order, must still run in tree order
+		for(int i=NODE_COUNT-2;i>=0;i--) {
+			nodes[i]->set_process(true);
+		}
+
+		frame=0;
+		ok=true;
+		bench=false;
+		bench_usec=0;
+	}
+
+	virtual bool idle(float p_time) {
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		bool quit = SceneTree::idle(p_time);
+		if (bench)
+			bench_usec+=OS::get_singleton()->get_ticks_usec()-from;
+
+		switch(frame++) {
+
+			case 0: {
+				static const int expected[]={0,1,2,3,4};
+				_check("tree order",expected,5);
+
+				nodes[1]->stop=nodes[3];
+				nodes[1]->start=nodes[5];
+				get_root()->move_child(nodes[4],0);
+			} break;
+			case 1: {
+				static const int expected[]={4,0,1,2};
+				_check("change while processing",expected,4);
+			} break;
+			case 2: {
+				static const int expected[]={4,0,1,2,5};
+				_check("added last frame",expected,5);
+
+				nodes[2]->set_pause_mode(Node::PAUSE_MODE_PROCESS);
+				set_pause(true);
+			} break;
+			case 3: {
+				static const int expected[]={2};
+				_check("paused",expected,1);
+
+				set_pause(false);
+				for(int i=0;i<NODE_COUNT;i++) {
+					nodes[i]->queue_delete();
+				}
+
+				Node *bench_root = memnew( Node );
+				get_root()->add_child(bench_root);
+				for(int i=0;i<BENCH_NODE_COUNT;i++) {
+					Node *n = memnew( Node );
+					n->set_process(true);
+					bench_root->add_child(n);
+				}
+			} break;
+			case 4: {
+				// deleted nodes were still processed this frame
+				process_log.clear();
+				bench=true;
+			} break;
+			default: {
+				if (frame!=5+BENCH_FRAMES)
+					break;
+
+				print_line(itos(BENCH_NODE_COUNT)+" processing nodes: "+rtos(bench_usec/double(BENCH_FRAMES)/1000.0)+" msec per frame");
+				if (get_idle_processed_node_count()!=BENCH_NODE_COUNT)
+					ok=false;
+
+				print_line(ok ? "process_list: ok" : "process_list: FAILED");
+				SceneTree::quit();
+				return true;
+			}
+		}
+
+		return quit;
+	}
+};
+
+MainLoop* test() {
+
+	return memnew( TestMainLoop );
+}
+
+}
@@ -0,0 +1,169 @@
+/*************************************************************************/
+/*  test_rid.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_rid.h"
+#include "rid.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Checks RID_Owner stale RID detection and compares its lookup speed against
+ * the HashMap backed owner it replaced.
+ */
+
+namespace TestRID {
+
+template<class T>
+class HashMapRIDOwner : public RID_OwnerBase {
+
+	mutable HashMap<ID,T*> id_map;
+public:
+
+	RID make_rid(T * p_data) {
+
+		ID id = new_ID();
+		id_map[id]=p_data;
+		RID rid;
+		set_id(rid,id);
+		set_ownage(rid);
+		return rid;
+	}
+
+	_FORCE_INLINE_ T * get(const RID& p_rid) {
+
+		T**elem = id_map.getptr(p_rid.get_id());
+		ERR_FAIL_COND_V(!elem,NULL);
+		return *elem;
+	}
+
+	virtual bool owns(const RID& p_rid) const {
+
+		return id_map.getptr(p_rid.get_id())!=NULL;
+	}
+
+	void free(RID p_rid) {
+
+		ERR_FAIL_COND(!owns(p_rid));
+		id_map.erase(p_rid.get_id());
+	}
+
+	virtual void get_owned_list(List<RID> *p_owned) const {}
+};
+
+struct Data {
+
+	int value;
+};
+
+static bool _check_slot_map() {
+
+	RID_Owner<Data> owner;
+	Data a,b;
+	a.value=1;
+	b.value=2;
+
+	RID ra=owner.make_rid(&a);
+	if (owner.get(ra)!=&a)
+		return false;
+
+	owner.free(ra);
+	if (owner.owns(ra))
+		return false;
+
+	RID rb=owner.make_rid(&b); //reuses the slot of ra
+	if (owner.owns(ra) || owner.get(rb)!=&b)
+		return false;
+
+	RID_Owner<Data> other;
+	RID rc=other.make_rid(&a);
+	if (owner.owns(rc) || other.owns(rb))
+		return false;
+
+	List<RID> owned;
+	owner.get_owned_list(&owned);
+	if (owned.size()!=1 || owned.front()->get()!=rb)
+		return false;
+
+	return !owner.owns(RID());
+}
+
+template<class O>
+static void _bench(const String& p_name,int p_count,int p_lookups) {
+
+	O owner;
+	Vector<Data> data;
+	Vector<RID> rids;
+	data.resize(p_count);
+	rids.resize(p_count);
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<p_count;i++) {
+		data[i].value=i;
+		rids[i]=owner.make_rid(&data[i]);
+	}
+
+	uint64_t make_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	uint32_t seed=1234;
+	int sum=0;
+	for(int i=0;i<p_lookups;i++) {
+		sum+=owner.get(rids[Math::rand_from_seed(&seed)%p_count])->value;
+	}
+
+	uint64_t get_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<p_count;i++) {
+		owner.free(rids[i]);
+	}
+
+	uint64_t free_time=OS::get_singleton()->get_ticks_usec()-t;
+
+	print_line(p_name+": make "+itos(make_time/1000)+"ms, "+itos(p_lookups)+" gets "+itos(get_time/1000)+"ms, free "+itos(free_time/1000)+"ms (checksum "+itos(sum)+")");
+}
+
+MainLoop * test() {
+
+	print_line("slot map checks: "+String(_check_slot_map()?"ok":"FAILED"));
+
+	for(int i=1000;i<=1000000;i*=10) {
+
+		print_line(itos(i)+" rids");
+		_bench< HashMapRIDOwner<Data> >("  hashmap  ",i,4000000);
+		_bench< RID_Owner<Data> >("  slot map ",i,4000000);
+		_bench< RID_Owner<Data,true> >("  slot map (thread safe)",i,4000000);
+	}
+
+	return NULL;
+}
+
+}
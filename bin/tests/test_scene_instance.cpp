@@ -0,0 +1,156 @@
+/*************************************************************************/
+/*  test_scene_instance.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_scene_instance.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/resources/packed_scene.h"
+#include "scene/2d/node_2d.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Packs a 60 node scene with a few changed properties per node and checks
+ * that an instance has the same property values, names and groups as the
+ * packed nodes. Then prints how many times per second it can be spawned.
+ */
+
+namespace TestSceneInstance {
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		NODE_COUNT=60,
+		SPAWNS=2000
+	};
+
+	bool ok;
+
+	Ref<PackedScene> _make_scene(Node **r_root) {
+
+		Node2D *root = memnew( Node2D );
+		root->set_name("enemy");
+
+		for(int i=1;i<NODE_COUNT;i++) {
+
+			Node2D *n = memnew( Node2D );
+			n->set_name("part"+itos(i));
+			n->set_pos(Vector2(i,i*2));
+			n->set_rot(i*0.1);
+			n->set_scale(Vector2(1,1+i*0.01));
+			n->set_z(i%8);
+			n->set_opacity(0.5);
+			n->add_to_group("parts",true);
+
+			// a few levels deep, like the parts of a character
+			Node *parent = i>4 ? root->get_child((i-1)%4) : root;
+			parent->add_child(n);
+			n->set_owner(root);
+		}
+
+		Ref<PackedScene> scene = memnew( PackedScene );
+		if (scene->pack(root)!=OK)
+			ok=false;
+		*r_root=root;
+		return scene;
+	}
+
+	void _compare(Node *p_a,Node *p_b) {
+
+		List<PropertyInfo> plist;
+		p_a->get_property_list(&plist);
+		for(List<PropertyInfo>::Element *E=plist.front();E;E=E->next()) {
+
+			if (!(E->get().usage&PROPERTY_USAGE_STORAGE))
+				continue;
+			if (p_a->get(E->get().name)!=p_b->get(E->get().name)) {
+				print_line("property "+E->get().name+" of "+String(p_a->get_name())+" differs");
+				ok=false;
+			}
+		}
+
+		if (p_a->get_child_count()!=p_b->get_child_count() || p_a->get_name()!=p_b->get_name() || p_a->is_in_group("parts")!=p_b->is_in_group("parts")) {
+			ok=false;
+			return;
+		}
+
+		for(int i=0;i<p_a->get_child_count();i++)
+			_compare(p_a->get_child(i),p_b->get_child(i));
+	}
+
+	double _spawns_per_second(const Ref<PackedScene>& p_scene) {
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<SPAWNS;i++) {
+			Node *n=p_scene->instance();
+			memdelete(n);
+		}
+		uint64_t usec=OS::get_singleton()->get_ticks_usec()-from;
+		return SPAWNS*1000000.0/MAX(usec,1);
+	}
+
+public:
+
+	virtual void init() {
+
+		SceneTree::init();
+		ok=true;
+
+		Node *source=NULL;
+		Ref<PackedScene> scene=_make_scene(&source);
+
+		Node *instance=scene->instance();
+		if (!instance) {
+			ok=false;
+		} else {
+			_compare(source,instance);
+			memdelete(instance);
+		}
+		memdelete(source);
+
+		print_line(itos(NODE_COUNT)+" node scene: "+rtos(_spawns_per_second(scene))+" spawns/s");
+	}
+
+	virtual bool idle(float p_time) {
+
+		quit();
+		return SceneTree::idle(p_time);
+	}
+
+	virtual void finish() {
+
+		print_line(ok ? "scene_instance: ok" : "scene_instance: FAILED");
+		SceneTree::finish();
+	}
+};
+
+MainLoop* test() {
+
+	return memnew( TestMainLoop );
+}
+
+}
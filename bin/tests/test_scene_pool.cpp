@@ -0,0 +1,201 @@
+/*************************************************************************/
+/*  test_scene_pool.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_scene_pool.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/packed_scene.h"
+#include "scene/2d/node_2d.h"
+#include "print_string.h"
+#include "message_queue.h"
+#include "os/os.h"
+
+/**
+ * Checks that instances released to a PackedScene pool leave the tree, come
+ * back with the values of a fresh instance (stored and default ones), that
+ * instances whose structure changed are queued for deletion instead of
+ * pooled (the node may be releasing itself from a callback), that nodes
+ * from other scenes or being deleted are refused, and that the pool
+ * statistics follow. Then prints the time per spawn and release
+ * cycle with and without the pool.
+ */
+
+namespace TestScenePool {
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		PARTS=10,
+		POOL_SIZE=8,
+		CYCLES=5000
+	};
+
+	bool ok;
+	ObjectID unpooled_id;
+
+	void _check(const String& p_what,bool p_cond) {
+
+		if (!p_cond) {
+			print_line(p_what+" FAILED");
+			ok=false;
+		}
+	}
+
+	Ref<PackedScene> _make_scene() {
+
+		Node2D *root = memnew( Node2D );
+		root->set_name("bullet");
+		for(int i=0;i<PARTS;i++) {
+			Node2D *n = memnew( Node2D );
+			n->set_name("part"+itos(i));
+			n->set_pos(Vector2(i,0));
+			root->add_child(n);
+			n->set_owner(root);
+		}
+
+		Ref<PackedScene> scene = memnew( PackedScene );
+		_check("pack",scene->pack(root)==OK);
+		memdelete(root);
+		return scene;
+	}
+
+public:
+
+	virtual void init() {
+
+		SceneTree::init();
+		ok=true;
+		unpooled_id=0;
+
+		Ref<PackedScene> scene=_make_scene();
+		scene->set_pool_max_size(POOL_SIZE);
+
+		int pooled_before=PackedScene::get_pooled_instance_count();
+		uint64_t reuses_before=PackedScene::get_pool_reuse_count();
+
+		scene->fill_pool();
+		_check("fill",scene->get_pooled_count()==POOL_SIZE && PackedScene::get_pooled_instance_count()==pooled_before+POOL_SIZE);
+
+		Node2D *a=scene->instance_from_pool()->cast_to<Node2D>();
+		_check("reuse",a && scene->get_pooled_count()==POOL_SIZE-1 && PackedScene::get_pool_reuse_count()==reuses_before+1);
+		if (!a) {
+			return;
+		}
+
+		// change a stored value, a default value and the name, then give it back
+		get_root()->add_child(a);
+		a->set_pos(Vector2(100,100)); // default, not stored in the scene
+		Node2D *part=a->get_child(3)->cast_to<Node2D>();
+		part->set_pos(Vector2(-1,-1)); // stored in the scene
+		a->set_name("renamed");
+		scene->release_to_pool(a);
+		_check("released leaves the tree",!a->is_inside_tree() && scene->get_pooled_count()==POOL_SIZE);
+
+		Node2D *b=scene->instance_from_pool()->cast_to<Node2D>();
+		_check("same instance",b==a);
+		_check("default value reset",b->get_pos()==Vector2());
+		_check("stored value reset",part->get_pos()==Vector2(3,0));
+		_check("name reset",b->get_name()=="bullet");
+
+		// an instance with a different structure can't be reset, it's deleted with the tree's queue
+		b->add_child(memnew( Node ));
+		scene->release_to_pool(b);
+		_check("changed structure not pooled",scene->get_pooled_count()==POOL_SIZE-1);
+		_check("changed structure queued for deletion",b->is_queued_for_deletion() && !b->is_inside_tree());
+		unpooled_id=b->get_instance_ID();
+
+		// nodes that are not live instances of the scene are refused and left alone
+		Node2D *other=memnew( Node2D );
+		other->set_filename("res://other.scn");
+		scene->release_to_pool(other);
+		_check("other scene refused",scene->get_pooled_count()==POOL_SIZE-1);
+		other->set_filename("");
+		Node *wrong_type=memnew( Node );
+		scene->release_to_pool(wrong_type);
+		_check("other type refused",scene->get_pooled_count()==POOL_SIZE-1);
+		memdelete(other);
+		memdelete(wrong_type);
+
+		Node *deleted=scene->instance_from_pool();
+		get_root()->add_child(deleted);
+		deleted->queue_delete();
+		scene->release_to_pool(deleted);
+		_check("queued for deletion refused",scene->get_pooled_count()==POOL_SIZE-2 && deleted->is_inside_tree());
+
+		scene->clear_pool();
+		_check("clear",scene->get_pooled_count()==0 && PackedScene::get_pooled_instance_count()==pooled_before);
+
+		Node *parent=memnew( Node );
+		get_root()->add_child(parent);
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<CYCLES;i++) {
+			Node *n=scene->instance();
+			parent->add_child(n);
+			parent->remove_child(n);
+			memdelete(n);
+			MessageQueue::get_singleton()->flush(); // one spawn per frame, the canvas updates would fill the queue
+		}
+		uint64_t instance_usec=OS::get_singleton()->get_ticks_usec()-from;
+
+		from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<CYCLES;i++) {
+			Node *n=scene->instance_from_pool();
+			parent->add_child(n);
+			scene->release_to_pool(n);
+			MessageQueue::get_singleton()->flush();
+		}
+		uint64_t pool_usec=OS::get_singleton()->get_ticks_usec()-from;
+
+		print_line(itos(PARTS+1)+" node scene: instance/free "+rtos(instance_usec/double(CYCLES))+" usec, pool "+rtos(pool_usec/double(CYCLES))+" usec per spawn");
+		_check("pooled after cycles",scene->get_pooled_count()==1);
+
+		parent->queue_delete();
+	}
+
+	virtual bool idle(float p_time) {
+
+		bool quit_tree=SceneTree::idle(p_time);
+		_check("changed structure deleted",!ObjectDB::get_instance(unpooled_id));
+		quit();
+		return quit_tree;
+	}
+
+	virtual void finish() {
+
+		print_line(ok ? "scene_pool: ok" : "scene_pool: FAILED");
+		SceneTree::finish();
+	}
+};
+
+MainLoop* test() {
+
+	return memnew( TestMainLoop );
+}
+
+}
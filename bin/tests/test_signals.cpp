@@ -0,0 +1,156 @@
+/*************************************************************************/
+/*  test_signals.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_signals.h"
+#include "object.h"
+#include "object_type_db.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Checks signal emission corner cases (disconnecting from a callback,
+ * oneshot, binds) and measures emission with 0, 1 and many connections.
+ */
+
+namespace TestSignals {
+
+class SignalReceiver : public Object {
+
+	OBJ_TYPE(SignalReceiver,Object);
+public:
+
+	int count;
+	int sum;
+	Object *disconnect_from;
+
+	void _received() {
+
+		count++;
+		if (disconnect_from)
+			disconnect_from->disconnect("fired",this,"_received");
+	}
+
+	void _received_args(int p_a,int p_b) {
+
+		count++;
+		sum+=p_a+p_b;
+	}
+
+	static void _bind_methods() {
+
+		ObjectTypeDB::bind_method(_MD("_received"),&SignalReceiver::_received);
+		ObjectTypeDB::bind_method(_MD("_received_args","a","b"),&SignalReceiver::_received_args);
+	}
+
+	SignalReceiver() { count=0; sum=0; disconnect_from=NULL; }
+};
+
+static bool _check_emission() {
+
+	Object emitter;
+	emitter.add_user_signal(MethodInfo("fired"));
+	emitter.add_user_signal(MethodInfo("fired_args",PropertyInfo(Variant::INT,"a")));
+
+	SignalReceiver a,b,c;
+
+	//a disconnects itself while the signal is being emitted, b must still be called
+	a.disconnect_from=&emitter;
+	emitter.connect("fired",&a,"_received");
+	emitter.connect("fired",&b,"_received");
+	emitter.emit_signal("fired");
+	emitter.emit_signal("fired");
+	if (a.count!=1 || b.count!=2 || emitter.is_connected("fired",&a,"_received"))
+		return false;
+
+	emitter.connect("fired",&c,"_received",Vector<Variant>(),Object::CONNECT_ONESHOT);
+	emitter.emit_signal("fired");
+	emitter.emit_signal("fired");
+	if (c.count!=1 || emitter.is_connected("fired",&c,"_received"))
+		return false;
+
+	Vector<Variant> binds;
+	binds.push_back(10);
+	emitter.connect("fired_args",&c,"_received_args",binds);
+	emitter.emit_signal("fired_args",5);
+	return c.count==2 && c.sum==15;
+}
+
+static void _bench(const String& p_name,int p_connections,int p_binds,int p_emits) {
+
+	Object emitter;
+	emitter.add_user_signal(MethodInfo("fired"));
+
+	Vector<SignalReceiver*> receivers;
+	for(int i=0;i<p_connections;i++) {
+
+		SignalReceiver *r = memnew( SignalReceiver );
+		receivers.push_back(r);
+
+		if (p_binds) {
+			Vector<Variant> binds;
+			for(int j=0;j<p_binds;j++)
+				binds.push_back(j);
+			emitter.connect("fired",r,"_received_args",binds);
+		} else {
+			emitter.connect("fired",r,"_received");
+		}
+	}
+
+	StringName fired="fired";
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<p_emits;i++) {
+		emitter.emit_signal(fired);
+	}
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+
+	int calls=0;
+	for(int i=0;i<receivers.size();i++) {
+		calls+=receivers[i]->count;
+		memdelete(receivers[i]);
+	}
+
+	print_line(p_name+": "+itos(p_emits)+" emits "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_emits)+"ns/emit ("+itos(calls)+" calls)");
+}
+
+MainLoop * test() {
+
+	ObjectTypeDB::register_type<SignalReceiver>();
+
+	print_line("emission checks: "+String(_check_emission()?"ok":"FAILED"));
+
+	_bench("0 connections",0,0,1000000);
+	_bench("1 connection",1,0,1000000);
+	_bench("1 connection, 2 binds",1,2,1000000);
+	_bench("16 connections",16,0,100000);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,327 @@
+/*************************************************************************/
+/*  test_threaded_process.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_threaded_process.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/main/viewport.h"
+#include "scene/2d/node_2d.h"
+#include "job_system.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Benchmark scene: 50k agents steer towards a target that moves on the main
+ * thread. Agents only read the target and write their own position, kept in
+ * a script variable so no server is called from worker threads. They run on
+ * the main thread first, then with threaded processing, and the time spent in
+ * each phase is printed. Positions must come out the same both ways. One agent
+ * adds a child from _process, which must wait until the threaded phase ends.
+ * Then a few Node2D agents that move themselves ask for threaded processing,
+ * they must be refused and keep moving on the main thread. Last, an agent frees
+ * its processing siblings from a threaded _process, they must stay alive until
+ * the threaded phase ends and be deleted afterwards.
+ */
+
+namespace TestThreadedProcess {
+
+#ifdef GDSCRIPT_ENABLED
+
+static const char *agent_code=
+	"extends Node\n"
+	"var target\n"
+	"var pos = Vector2()\n"
+	"var speed = 1.0\n"
+	"var spawn = false\n"
+	"func _process(delta):\n"
+	"\tvar to = target.get_pos() - pos\n"
+	"\tif to.length() > 1.0:\n"
+	"\t\tpos += to.normalized() * speed\n"
+	"\tif spawn:\n"
+	"\t\tspawn = false\n"
+	"\t\tadd_child(Node.new())\n";
+
+static const char *killer_code=
+	"extends Node\n"
+	"var victims = []\n"
+	"func _process(delta):\n"
+	"\tfor v in victims:\n"
+	"\t\tv.free()\n"
+	"\tvictims = []\n";
+
+static const char *victim_code=
+	"extends Node\n"
+	"var frames = 0\n"
+	"func _process(delta):\n"
+	"\tframes += 1\n";
+
+static const char *node2d_agent_code=
+	"extends Node2D\n"
+	"func _process(delta):\n"
+	"\tset_pos(get_pos() + Vector2(1, 2))\n";
+
+class TestMainLoop : public SceneTree {
+
+	enum {
+		AGENT_COUNT=50000,
+		BENCH_FRAMES=50,
+		NODE2D_AGENT_COUNT=4,
+		NODE2D_FRAMES=10,
+		VICTIM_COUNT=10000,
+		FREE_FRAMES=3
+	};
+
+	Node2D *target;
+	Vector<Node*> agents;
+	Vector<Node2D*> node2d_agents;
+	Node *killer;
+	Vector<ObjectID> victims;
+	Vector<Point2> serial_result;
+	int frame;
+	uint64_t usec;
+	bool ok;
+
+	void _move_target(int p_frame) {
+
+		target->set_pos(Point2(Math::sin(p_frame*0.1)*100.0,Math::cos(p_frame*0.1)*100.0));
+	}
+
+	void _reset_agents(bool p_threaded) {
+
+		for(int i=0;i<agents.size();i++) {
+			agents[i]->set("pos",Point2(i%250,i/250));
+			agents[i]->set_process_threaded(p_threaded);
+		}
+	}
+
+public:
+
+	virtual void init() {
+
+		SceneTree::init();
+
+		Ref<GDScript> script = memnew( GDScript );
+		script->set_source_code(agent_code);
+		script->reload();
+
+		target = memnew( Node2D );
+		get_root()->add_child(target);
+
+		agents.resize(AGENT_COUNT);
+		for(int i=0;i<AGENT_COUNT;i++) {
+			Node *agent = memnew( Node );
+			agent->set_script(script.get_ref_ptr());
+			agent->set("target",target);
+			agent->set("speed",1.0+(i%7)*0.25);
+			agent->set_process(true);
+			get_root()->add_child(agent);
+			agents[i]=agent;
+		}
+
+		_reset_agents(false);
+		killer=NULL;
+		frame=0;
+		usec=0;
+		ok=true;
+	}
+
+	void _add_node2d_agents() {
+
+		Ref<GDScript> script = memnew( GDScript );
+		script->set_source_code(node2d_agent_code);
+		script->reload();
+
+		for(int i=0;i<NODE2D_AGENT_COUNT;i++) {
+			Node2D *agent = memnew( Node2D );
+			agent->set_script(script.get_ref_ptr());
+			agent->set_process(true);
+			get_root()->add_child(agent);
+			agent->set_process_threaded(true); // prints an error, transforms can't change on threads
+			node2d_agents.push_back(agent);
+		}
+	}
+
+	void _add_killer() {
+
+		Ref<GDScript> killer_script = memnew( GDScript );
+		killer_script->set_source_code(killer_code);
+		killer_script->reload();
+
+		Ref<GDScript> victim_script = memnew( GDScript );
+		victim_script->set_source_code(victim_code);
+		victim_script->reload();
+
+		killer = memnew( Node );
+		killer->set_script(killer_script.get_ref_ptr());
+		killer->set_process(true);
+		killer->set_process_threaded(true);
+		get_root()->add_child(killer);
+
+		Array list;
+		for(int i=0;i<VICTIM_COUNT;i++) {
+			Node *victim = memnew( Node );
+			victim->set_script(victim_script.get_ref_ptr());
+			victim->set_process(true);
+			victim->set_process_threaded(true);
+			get_root()->add_child(victim);
+			victims.push_back(victim->get_instance_ID());
+			list.push_back(victim);
+		}
+		killer->set("victims",list);
+	}
+
+	bool _idle_free(float p_time) {
+
+		bool quit = SceneTree::idle(p_time);
+		frame++;
+
+		int free_frame=frame-(BENCH_FRAMES*2+NODE2D_FRAMES);
+
+		if (free_frame==1) {
+			// freed during the threaded phase, deletion waits for the main thread
+			for(int i=0;i<victims.size();i++) {
+				Object *obj=ObjectDB::get_instance(victims[i]);
+				Node *victim=obj ? obj->cast_to<Node>() : NULL;
+				if (!victim || victim->get_parent()!=get_root()) {
+					print_line("victim "+itos(i)+" was deleted during the threaded phase");
+					ok=false;
+					break;
+				}
+			}
+		}
+
+		if (free_frame!=FREE_FRAMES)
+			return quit;
+
+		for(int i=0;i<victims.size();i++) {
+			if (ObjectDB::get_instance(victims[i])) {
+				print_line("victim "+itos(i)+" was not deleted");
+				ok=false;
+				break;
+			}
+		}
+		if (killer->get_parent()!=get_root()) {
+			print_line("killer was removed");
+			ok=false;
+		}
+
+		print_line(ok ? "threaded_process: ok" : "threaded_process: FAILED");
+		SceneTree::quit();
+		return true;
+	}
+
+	bool _idle_node2d(float p_time) {
+
+		bool quit = SceneTree::idle(p_time);
+		frame++;
+
+		if (frame!=BENCH_FRAMES*2+NODE2D_FRAMES)
+			return quit;
+
+		for(int i=0;i<node2d_agents.size();i++) {
+			if (node2d_agents[i]->is_processing_threaded() || node2d_agents[i]->get_pos()!=Point2(NODE2D_FRAMES,NODE2D_FRAMES*2)) {
+				print_line("node2d agent "+itos(i)+": threaded "+itos(node2d_agents[i]->is_processing_threaded())+", at "+String(node2d_agents[i]->get_pos()));
+				ok=false;
+			}
+		}
+
+		_add_killer();
+		return quit;
+	}
+
+	virtual bool idle(float p_time) {
+
+		if (frame>=BENCH_FRAMES*2+NODE2D_FRAMES)
+			return _idle_free(p_time);
+		if (frame>=BENCH_FRAMES*2)
+			return _idle_node2d(p_time);
+
+		int bench_frame=frame%BENCH_FRAMES;
+		bool threaded=frame>=BENCH_FRAMES;
+
+		if (threaded && bench_frame==0) {
+			serial_result.resize(agents.size());
+			for(int i=0;i<agents.size();i++)
+				serial_result[i]=agents[i]->get("pos");
+			_reset_agents(true);
+			usec=0;
+			agents[0]->set("spawn",true);
+		}
+
+		_move_target(bench_frame);
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		bool quit = SceneTree::idle(p_time);
+		usec+=OS::get_singleton()->get_ticks_usec()-from;
+		frame++;
+
+		if (threaded && bench_frame==0 && agents[0]->get_child_count()!=0) {
+			print_line("child added while threaded was not deferred");
+			ok=false;
+		}
+
+		if (bench_frame<BENCH_FRAMES-1)
+			return quit;
+
+		print_line(String(threaded?"threaded":"serial")+" ("+itos(JobSystem::get_singleton()->get_thread_count())+" threads): "+rtos(usec/double(BENCH_FRAMES)/1000.0)+" msec per frame, "+itos(get_idle_processed_node_count())+" nodes");
+
+		if (!threaded)
+			return quit;
+
+		for(int i=0;i<agents.size();i++) {
+			Point2 pos=agents[i]->get("pos");
+			if (pos!=serial_result[i]) {
+				print_line("agent "+itos(i)+" differs: "+String(pos)+" expected "+String(serial_result[i]));
+				ok=false;
+				break;
+			}
+		}
+		if (agents[0]->get_child_count()!=1) {
+			print_line("deferred child was not added");
+			ok=false;
+		}
+
+		_add_node2d_agents();
+		return quit;
+	}
+};
+
+#endif
+
+MainLoop* test() {
+
+#ifdef GDSCRIPT_ENABLED
+	return memnew( TestMainLoop );
+#else
+	return NULL;
+#endif
+}
+
+}
@@ -0,0 +1,205 @@
+/*************************************************************************/
+/*  test_variant_pool.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_variant_pool.h"
+#include "variant.h"
+#include "print_string.h"
+#include "os/os.h"
+#include "os/keyboard.h"
+#include "os/memory_pool_static.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/**
+ * Checks that Variants holding heap backed types (Transform, Matrix3, AABB,
+ * Matrix32, InputEvent) keep their value semantics, and measures the kind of
+ * transform heavy loops scripts run every frame. Besides the time, the live
+ * allocation count of the static pool is reported around each loop, and the
+ * Variant loop is run once more sampling it after every step, to see how often
+ * it still reaches the allocator. The counts need a build with
+ * DEBUG_MEMORY_ENABLED, they stay at 0 otherwise.
+ */
+
+namespace TestVariantPool {
+
+static bool _check_semantics() {
+
+	Transform t(Matrix3(Vector3(0,1,0),0.5),Vector3(1,2,3));
+
+	Variant a=t;
+	Variant b=a;
+	b=Transform(); // same type assignment must not touch a
+	if (a.operator Transform()!=t || b.operator Transform()!=Transform())
+		return false;
+
+	b=a;
+	a=AABB(Vector3(1,1,1),Vector3(2,2,2)); // type change
+	if (b.operator Transform()!=t || a.operator AABB()!=AABB(Vector3(1,1,1),Vector3(2,2,2)))
+		return false;
+
+	Variant c=Matrix32(0.3,Vector2(4,5));
+	Variant d=Matrix3(Vector3(1,0,0),0.2);
+	c=d;
+	if (c.get_type()!=Variant::MATRIX3 || c.operator Matrix3()!=d.operator Matrix3())
+		return false;
+
+	InputEvent ie;
+	ie.type=InputEvent::KEY;
+	ie.key.scancode=KEY_A;
+	Variant e=ie;
+	Variant f=e;
+	e=InputEvent();
+	InputEvent fe=f;
+	if (fe.type!=InputEvent::KEY || fe.key.scancode!=KEY_A)
+		return false;
+
+	bool valid;
+	Variant g=b;
+	g.set("origin",Vector3(7,8,9),&valid);
+	return valid && g.operator Transform().origin==Vector3(7,8,9) && b.operator Transform()==t;
+}
+
+static int _alloc_count() {
+
+	return MemoryPoolStatic::get_singleton()->get_alloc_count();
+}
+
+static String _alloc_report(int p_before,int p_after) {
+
+	return "live allocations "+itos(p_before)+" before, "+itos(p_after)+" after";
+}
+
+// changes of the live allocation count between the steps of the loop, a lower bound of the allocator calls
+static int _count_allocator_calls(int p_iterations) {
+
+	Variant xform=Transform();
+	Variant step=Transform(Matrix3(Vector3(0,1,0),0.01),Vector3(0.1,0,0));
+	Vector3 acc;
+	int calls=0;
+	int last=_alloc_count();
+
+#define SAMPLE_ALLOCS { int c=_alloc_count(); calls+=ABS(c-last); last=c; }
+
+	for(int i=0;i<p_iterations;i++) {
+
+		Variant copy=xform;
+		SAMPLE_ALLOCS
+		xform=Variant::evaluate(Variant::OP_MULTIPLY,copy,step);
+		SAMPLE_ALLOCS
+		acc+=xform.get("origin");
+		Variant box=AABB(acc,Vector3(1,1,1));
+		SAMPLE_ALLOCS
+		Variant basis=xform.get("basis");
+		SAMPLE_ALLOCS
+	}
+	SAMPLE_ALLOCS
+
+#undef SAMPLE_ALLOCS
+
+	return calls;
+}
+
+static void _bench_variant(int p_iterations) {
+
+	Variant xform=Transform();
+	Variant step=Transform(Matrix3(Vector3(0,1,0),0.01),Vector3(0.1,0,0));
+	Vector3 acc;
+
+	int allocs_before=_alloc_count();
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<p_iterations;i++) {
+
+		Variant copy=xform;
+		xform=Variant::evaluate(Variant::OP_MULTIPLY,copy,step);
+		acc+=xform.get("origin");
+		Variant box=AABB(acc,Vector3(1,1,1));
+		Variant basis=xform.get("basis");
+	}
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+	int allocs_after=_alloc_count();
+
+	print_line("variant transform loop: "+itos(p_iterations)+" iterations "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_iterations)+"ns/iteration (acc "+String(acc)+")");
+	print_line("  "+_alloc_report(allocs_before,allocs_after));
+
+	int sampled=p_iterations/100;
+	print_line("  "+itos(_count_allocator_calls(sampled))+" allocator calls in "+itos(sampled)+" sampled iterations");
+}
+
+#ifdef GDSCRIPT_ENABLED
+
+static void _bench_script(int p_iterations) {
+
+	String code=
+		"static func run(n):\n"
+		"\tvar xform = Transform()\n"
+		"\tvar step = Transform(Matrix3(Vector3(0,1,0),0.01),Vector3(0.1,0,0))\n"
+		"\tvar acc = Vector3()\n"
+		"\tfor i in range(n):\n"
+		"\t\txform = xform * step\n"
+		"\t\tacc += xform.origin\n"
+		"\t\tvar basis = xform.basis\n"
+		"\treturn acc\n";
+
+	Ref<GDScript> script = memnew( GDScript );
+	script->set_source_code(code);
+	if (script->reload()!=OK) {
+		print_line("script loop: compile FAILED");
+		return;
+	}
+
+	int allocs_before=_alloc_count();
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+
+	Variant acc=static_cast<Object*>(script.ptr())->call("run",p_iterations);
+
+	uint64_t time=OS::get_singleton()->get_ticks_usec()-t;
+	int allocs_after=_alloc_count();
+
+	print_line("script transform loop: "+itos(p_iterations)+" iterations "+itos(time/1000)+"ms, "+rtos(double(time)*1000.0/p_iterations)+"ns/iteration (acc "+String(acc)+")");
+	print_line("  "+_alloc_report(allocs_before,allocs_after));
+}
+
+#endif
+
+MainLoop * test() {
+
+	print_line("semantics checks: "+String(_check_semantics()?"ok":"FAILED"));
+
+	_bench_variant(1000000);
+#ifdef GDSCRIPT_ENABLED
+	_bench_script(1000000);
+#endif
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,163 @@
+/*************************************************************************/
+/*  test_visual_cull.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_visual_cull.h"
+#include "servers/visual_server.h"
+#include "camera_matrix.h"
+#include "globals.h"
+#include "job_system.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/**
+ * Draws a crowded scenario with shadow casting lights with serial and
+ * parallel culling, and checks both produce the same culled instances in the
+ * same order. Meant to run headless on the server platform (dummy rasterizer).
+ */
+
+namespace TestVisualCull {
+
+static void _set_parallel(bool p_enable) {
+
+	Globals::get_singleton()->set("render/parallel_cull",p_enable);
+	VisualServer::get_singleton()->draw(); // the setting is read when drawing
+}
+
+static uint64_t _time_frames(int p_frames) {
+
+	uint64_t t=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<p_frames;i++)
+		VisualServer::get_singleton()->draw();
+	return OS::get_singleton()->get_ticks_usec()-t;
+}
+
+MainLoop * test() {
+
+	VisualServer *vs=VisualServer::get_singleton();
+
+	int threads=JobSystem::get_singleton()?JobSystem::get_singleton()->get_thread_count():1;
+	print_line("job threads: "+itos(threads)+(threads>1?"":" (parallel culling falls back to serial)"));
+
+	RID scenario=vs->scenario_create();
+
+	Vector3Array vertices;
+	vertices.push_back(Vector3(-1,-1,-1));
+	vertices.push_back(Vector3(1,-1,1));
+	vertices.push_back(Vector3(-1,1,1));
+	Array arrays;
+	arrays.resize(VS::ARRAY_MAX);
+	arrays[VS::ARRAY_VERTEX]=vertices;
+
+	RID mesh=vs->mesh_create();
+	vs->mesh_add_surface(mesh,VS::PRIMITIVE_TRIANGLES,arrays);
+
+	Vector<RID> instances;
+	for(int i=0;i<20000;i++) {
+
+		RID instance=vs->instance_create2(mesh,scenario);
+		vs->instance_set_transform(instance,Transform(Matrix3(),Vector3(Math::random(-200,200),Math::random(-20,20),Math::random(-200,200))));
+		instances.push_back(instance);
+	}
+
+	Vector<RID> lights;
+	for(int i=0;i<4;i++) {
+
+		RID light=vs->light_create(VS::LIGHT_DIRECTIONAL);
+		vs->light_set_shadow(light,true);
+		RID instance=vs->instance_create2(light,scenario);
+		vs->instance_set_transform(instance,Transform(Matrix3(Vector3(1,0,0),-0.5-i*0.2).rotated(Vector3(0,1,0),i*1.3),Vector3()));
+		lights.push_back(light);
+		instances.push_back(instance);
+	}
+
+	RID camera=vs->camera_create();
+	vs->camera_set_perspective(camera,60,0.1,300);
+
+	RID viewport=vs->viewport_create();
+	VS::ViewportRect rect;
+	rect.width=1024;
+	rect.height=600;
+	vs->viewport_set_rect(viewport,rect);
+	vs->viewport_attach_camera(viewport,camera);
+	vs->viewport_set_scenario(viewport,scenario);
+	vs->viewport_attach_to_screen(viewport);
+
+	int mismatches=0;
+	uint64_t serial_time=0;
+	uint64_t parallel_time=0;
+
+	for(int i=0;i<8;i++) {
+
+		Transform camera_xform;
+		camera_xform.basis.rotate(Vector3(0,1,0),i*Math_PI/4.0);
+		camera_xform.origin=Vector3(0,10,0);
+		vs->camera_set_transform(camera,camera_xform);
+
+		CameraMatrix cm;
+		cm.set_perspective(60,1024/600.0,0.1,300);
+		Vector<Plane> planes=cm.get_projection_planes(camera_xform);
+
+		_set_parallel(false);
+		serial_time+=_time_frames(10);
+		Vector<RID> serial=vs->instances_cull_convex(planes,scenario);
+
+		_set_parallel(true);
+		parallel_time+=_time_frames(10);
+		Vector<RID> parallel=vs->instances_cull_convex(planes,scenario);
+
+		if (serial.size()!=parallel.size()) {
+			mismatches++;
+			continue;
+		}
+
+		for(int j=0;j<serial.size();j++) {
+			if (serial[j]!=parallel[j]) {
+				mismatches++;
+				break;
+			}
+		}
+	}
+
+	print_line("serial: "+itos(serial_time/80)+"us/frame, parallel: "+itos(parallel_time/80)+"us/frame");
+	print_line("cull results: "+String(mismatches?"MISMATCH":"identical"));
+
+	Globals::get_singleton()->set("render/parallel_cull",false);
+
+	vs->free(viewport);
+	vs->free(camera);
+	for(int i=0;i<instances.size();i++)
+		vs->free(instances[i]);
+	for(int i=0;i<lights.size();i++)
+		vs->free(lights[i]);
+	vs->free(mesh);
+	vs->free(scenario);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,163 @@
+/*************************************************************************/
+/*  test_visual_script_bench.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_visual_script_bench.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef MODULE_VISUAL_SCRIPT_ENABLED
+#include "modules/visual_script/visual_script.h"
+#include "modules/visual_script/visual_script_nodes.h"
+#include "modules/visual_script/visual_script_flow_control.h"
+#endif
+
+/**
+ * Builds a small visual script that sums the squares of an array in a
+ * loop and stores the result in a member variable, then runs it through the node interpreter and through the
+ * compiled steps. Both must return the same value, the time taken by
+ * each is printed.
+ */
+
+namespace TestVisualScriptBench {
+
+#ifdef MODULE_VISUAL_SCRIPT_ENABLED
+
+enum {
+	ARRAY_SIZE=1000,
+	CALLS=1000
+};
+
+static Ref<VisualScript> _make_script() {
+
+	Ref<VisualScript> vs = memnew( VisualScript );
+	vs->add_variable("total",0);
+	vs->add_function("run");
+
+	Ref<VisualScriptFunction> func = memnew( VisualScriptFunction );
+	vs->add_node("run",1,func);
+
+	Ref<VisualScriptLocalVarSet> init = memnew( VisualScriptLocalVarSet );
+	init->set_var_name("sum");
+	vs->add_node("run",2,init);
+	init->set_default_input_value(0,0);
+
+	Array values;
+	for(int i=0;i<ARRAY_SIZE;i++)
+		values.push_back(i);
+
+	Ref<VisualScriptIterator> iter = memnew( VisualScriptIterator );
+	vs->add_node("run",3,iter);
+	iter->set_default_input_value(0,values);
+
+	Ref<VisualScriptLocalVarSet> acc = memnew( VisualScriptLocalVarSet );
+	acc->set_var_name("sum");
+	vs->add_node("run",4,acc);
+
+	Ref<VisualScriptOperator> add = memnew( VisualScriptOperator );
+	add->set_operator(Variant::OP_ADD);
+	vs->add_node("run",5,add);
+
+	Ref<VisualScriptLocalVar> sum = memnew( VisualScriptLocalVar );
+	sum->set_var_name("sum");
+	vs->add_node("run",6,sum);
+
+	Ref<VisualScriptOperator> mul = memnew( VisualScriptOperator );
+	mul->set_operator(Variant::OP_MULTIPLY);
+	vs->add_node("run",7,mul);
+
+	Ref<VisualScriptVariableSet> store = memnew( VisualScriptVariableSet );
+	store->set_variable("total");
+	vs->add_node("run",8,store);
+
+	Ref<VisualScriptLocalVar> result = memnew( VisualScriptLocalVar );
+	result->set_var_name("sum");
+	vs->add_node("run",9,result);
+
+	vs->sequence_connect("run",1,0,2);
+	vs->sequence_connect("run",2,0,3);
+	vs->sequence_connect("run",3,0,4); // each
+	vs->sequence_connect("run",3,1,8); // exit
+
+	vs->data_connect("run",6,0,5,0);
+	vs->data_connect("run",3,0,7,0);
+	vs->data_connect("run",3,0,7,1);
+	vs->data_connect("run",7,0,5,1);
+	vs->data_connect("run",5,0,4,0);
+	vs->data_connect("run",9,0,8,0);
+
+	return vs;
+}
+
+static bool _run(const String& p_name,bool p_compiled,int64_t p_expected) {
+
+	VisualScriptLanguage::singleton->compile_functions=p_compiled;
+
+	Ref<VisualScript> vs = _make_script();
+	Ref<Reference> obj = memnew( Reference );
+	obj->set_script(vs.get_ref_ptr());
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<CALLS;i++) {
+		obj->call("run");
+	}
+	uint64_t to=OS::get_singleton()->get_ticks_usec();
+
+	int64_t result=obj->get("total");
+
+	print_line(p_name+": "+itos((to-from)/1000)+" msec, result "+itos(result));
+	obj->set_script(RefPtr());
+	return result==p_expected;
+}
+
+#endif
+
+MainLoop * test() {
+
+#ifdef MODULE_VISUAL_SCRIPT_ENABLED
+
+	int64_t expected=0;
+	for(int64_t i=0;i<ARRAY_SIZE;i++)
+		expected+=i*i;
+
+	bool compile=VisualScriptLanguage::singleton->compile_functions;
+	bool ok=true;
+
+	ok = _run("interpreted",false,expected) && ok;
+	ok = _run("compiled",true,expected) && ok;
+
+	VisualScriptLanguage::singleton->compile_functions=compile;
+
+	print_line(ok ? "visual_script_bench: ok" : "visual_script_bench: FAILED");
+#else
+	print_line("visual_script module not enabled");
+#endif
+
+	return NULL;
+}
+
+}
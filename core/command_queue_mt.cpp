@@ -77,6 +77,8 @@ CommandQueueMT::CommandQueueMT(bool p_sync){
 
 	read_ptr=0;
 	write_ptr=0;
+	alloc_ptr=0;
+	sync_stalls=0;
 	mutex = Mutex::create();
 
 	for(int i=0;i<SYNC_SEMAPHORES;i++) {
@@ -34,6 +34,7 @@
 #include "os/mutex.h"
 #include "os/memory.h"
 #include "simple_type.h"
+#include "safe_refcount.h"
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
@@ -453,54 +454,66 @@ class CommandQueueMT {
 		SYNC_SEMAPHORES=8
 	};
 
+	/* The ring buffer has a single consumer (the server thread) and is
+	 * lock-free between producer and consumer: the producer only publishes
+	 * write_ptr once a command is complete and the consumer only publishes
+	 * read_ptr once a command was destroyed. Producers still take the mutex
+	 * among themselves, which is uncontended unless other threads (such as
+	 * resource loaders) submit at the same time. */
 
 	uint8_t command_mem[COMMAND_MEM_SIZE];
-	uint32_t read_ptr;
-	uint32_t write_ptr;
+	volatile uint32_t read_ptr; // published by the consumer
+	volatile uint32_t write_ptr; // published by the producer
+	uint32_t alloc_ptr; // producer side, commands past write_ptr are not visible yet
+	volatile uint32_t sync_stalls;
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
 	Mutex *mutex;
 	Semaphore *sync;
 
+	// the atomic helpers act as full barriers, so commands are complete before their offsets are seen
+	_FORCE_INLINE_ static uint32_t _load(volatile uint32_t *p_ptr) { return atomic_add(p_ptr,0); }
+	_FORCE_INLINE_ static void _store(volatile uint32_t *p_ptr,uint32_t p_value) { atomic_add(p_ptr,p_value-*p_ptr); }
 
 	template<class T>
 	T* allocate() {
 
 		// alloc size is size+T+safeguard
 		uint32_t alloc_size=sizeof(T)+sizeof(uint32_t);
+		uint32_t read=_load(&read_ptr);
 
 		tryagain:
 
-		if (write_ptr < read_ptr) {
+		if (alloc_ptr < read) {
 			// behind read_ptr, check that there is room
-			if ( (read_ptr-write_ptr) <= alloc_size )
+			if ( (read-alloc_ptr) <= alloc_size )
 				return NULL;
-		} else if (write_ptr >= read_ptr) {
+		} else if (alloc_ptr >= read) {
 			// ahead of read_ptr, check that there is room
 
 
-			if ( (COMMAND_MEM_SIZE-write_ptr) < alloc_size+4 ) {
+			if ( (COMMAND_MEM_SIZE-alloc_ptr) < alloc_size+4 ) {
 				// no room at the end, wrap down;
 
-				if (read_ptr==0) // dont want write_ptr to become read_ptr
+				if (read==0) // dont want write_ptr to become read_ptr
 					return NULL;
 
 				// if this happens, it's a bug
-				ERR_FAIL_COND_V( (COMMAND_MEM_SIZE-write_ptr) < sizeof(uint32_t), NULL );
+				ERR_FAIL_COND_V( (COMMAND_MEM_SIZE-alloc_ptr) < sizeof(uint32_t), NULL );
 				// zero means, wrap to begining
 
-				uint32_t * p = (uint32_t*)&command_mem[write_ptr];
+				uint32_t * p = (uint32_t*)&command_mem[alloc_ptr];
 				*p=0;
-				write_ptr=0;
+				alloc_ptr=0;
 				goto tryagain;
 			}
 		}
 		// allocate the size
-		uint32_t * p = (uint32_t*)&command_mem[write_ptr];
+		uint32_t * p = (uint32_t*)&command_mem[alloc_ptr];
 		*p=sizeof(T);
-		write_ptr+=sizeof(uint32_t);
+		alloc_ptr+=sizeof(uint32_t);
 		// allocate the command
-		T* cmd = memnew_placement( &command_mem[write_ptr], T );
-		write_ptr+=sizeof(T);
+		T* cmd = memnew_placement( &command_mem[alloc_ptr], T );
+		alloc_ptr+=sizeof(T);
 		return cmd;
 
 	}
@@ -513,8 +526,10 @@ class CommandQueueMT {
 
 		while ( (ret=allocate<T>())==NULL ) {
 
+			// full, make whatever is pending visible and let the consumer catch up
+			_publish();
 			unlock();
-			// sleep a little until fetch happened and some room is made
+			atomic_increment(&sync_stalls);
 			wait_for_flush();
 			lock();
 
@@ -523,31 +538,54 @@ class CommandQueueMT {
 		return ret;
 	}
 
+	void _publish() {
+
+		if (write_ptr==alloc_ptr)
+			return;
+		_store(&write_ptr,alloc_ptr);
+		if (sync) sync->post();
+	}
+
+	void commit_and_unlock() {
+
+		_publish();
+		unlock();
+	}
+
+	void wait_sync(SyncSemaphore *p_sem) {
+
+		atomic_increment(&sync_stalls);
+		p_sem->sem->wait();
+	}
+
 
 	bool flush_one() {
 
+		uint32_t read=read_ptr;
+
 		tryagain:
 
 		// tried to read an empty queue
-		if (read_ptr == write_ptr )
+		if (read == _load(&write_ptr) )
 			return false;
 
-		uint32_t size = *(uint32_t*)( &command_mem[read_ptr] );
+		uint32_t size = *(uint32_t*)( &command_mem[read] );
 
 		if (size==0) {
 			//end of ringbuffer, wrap
-			read_ptr=0;
+			read=0;
 			goto tryagain;
 		}
 
-		read_ptr+=sizeof(uint32_t);
+		read+=sizeof(uint32_t);
 
-		CommandBase *cmd = reinterpret_cast<CommandBase*>( &command_mem[read_ptr] );
+		CommandBase *cmd = reinterpret_cast<CommandBase*>( &command_mem[read] );
 
 		cmd->call();
 		cmd->~CommandBase();
 
-		read_ptr+=size;
+		read+=size;
+		_store(&read_ptr,read);
 
 		return true;
 	}
@@ -571,9 +609,7 @@ public:
 		cmd->instance=p_instance;
 		cmd->method=p_method;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1>
@@ -585,9 +621,7 @@ public:
 		cmd->method=p_method;
 		cmd->p1=p1;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2>
@@ -600,9 +634,7 @@ public:
 		cmd->p1=p1;
 		cmd->p2=p2;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3>
@@ -616,9 +648,7 @@ public:
 		cmd->p2=p2;
 		cmd->p3=p3;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4>
@@ -633,9 +663,7 @@ public:
 		cmd->p3=p3;
 		cmd->p4=p4;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5>
@@ -651,9 +679,7 @@ public:
 		cmd->p4=p4;
 		cmd->p5=p5;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6>
@@ -670,9 +696,7 @@ public:
 		cmd->p5=p5;
 		cmd->p6=p6;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7>
@@ -690,9 +714,7 @@ public:
 		cmd->p6=p6;
 		cmd->p7=p7;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7,class P8>
@@ -711,9 +733,7 @@ public:
 		cmd->p7=p7;
 		cmd->p8=p8;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit_and_unlock();
 	}
 	/*** PUSH AND RET COMMANDS ***/
 
@@ -729,10 +749,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1,class R>
@@ -747,10 +765,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2,class R>
@@ -766,10 +782,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3,class R>
@@ -786,10 +800,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4,class R>
@@ -807,10 +819,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5,class R>
@@ -829,10 +839,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6,class R>
@@ -852,10 +860,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6,class P7,class R>
@@ -876,10 +882,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6,class P7,class P8,class R>
@@ -901,10 +905,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 
@@ -919,10 +921,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1>
@@ -937,10 +937,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2>
@@ -956,10 +954,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3>
@@ -976,10 +972,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4>
@@ -997,10 +991,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5>
@@ -1019,10 +1011,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6>
@@ -1042,10 +1032,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6,class P7>
@@ -1066,10 +1054,8 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
-
-		if (sync) sync->post();
-		ss->sem->wait();
+		commit_and_unlock();
+		wait_sync(ss);
 	}
 
 	template<class T, class M, class P1, class P2, class P3, class P4, class P5, class P6,class P7,class P8>
@@ -1091,30 +1077,32 @@ public:
 		SyncSemaphore *ss=_alloc_sync_sem();
 		cmd->sync=ss;
 
-		unlock();
+		commit_and_unlock();
+		wait_sync(ss);
+	}
 
-		if (sync) sync->post();
-		ss->sem->wait();
+	// times a producer had to wait for the consumer (results, syncs or a full buffer)
+	uint32_t get_and_reset_sync_stalls() {
+
+		uint32_t stalls=_load(&sync_stalls);
+		atomic_add(&sync_stalls,-stalls);
+		return stalls;
 	}
 
-	void wait_and_flush_one() {
+	void wait_and_flush() {
 		ERR_FAIL_COND(!sync);
 		sync->wait();
-		lock();
-		flush_one();
-		unlock();
+		while(flush_one()) {}
 	}
 
 	void flush_all() {
 
 		//ERR_FAIL_COND(sync);
-		lock();
 		while (true) {
 			bool exit = !flush_one();
 			if (exit)
 				break;
 		}
-		unlock();
 	}
 
 	CommandQueueMT(bool p_sync);
@@ -0,0 +1,519 @@
+/*************************************************************************/
+/*  job_system.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "job_system.h"
+#include "safe_refcount.h"
+#include "os/os.h"
+#include "script_language.h"
+
+JobSystem *JobSystem::singleton=NULL;
+
+JobSystem *JobSystem::get_singleton() {
+
+	return singleton;
+}
+
+int JobSystem::_get_queue_index() const {
+
+	if (worker_count==0)
+		return 0;
+
+	Thread::ID caller=Thread::get_caller_ID();
+	for(int i=0;i<worker_count;i++) {
+		if (workers[i].id==caller)
+			return i;
+	}
+
+	return worker_count;
+}
+
+void JobSystem::_push(int p_queue,const Job& p_job) {
+
+	Queue &q=queues[p_queue];
+
+	if (q.count==q.capacity) {
+
+		// grow, unwrapping the ring
+		uint32_t new_capacity=q.capacity?q.capacity*2:64;
+		Job *new_jobs=memnew_arr(Job,new_capacity);
+		for(uint32_t i=0;i<q.count;i++)
+			new_jobs[i]=q.jobs[(q.head+i)&(q.capacity-1)];
+		if (q.jobs)
+			memdelete_arr(q.jobs);
+		q.jobs=new_jobs;
+		q.capacity=new_capacity;
+		q.head=0;
+	}
+
+	q.jobs[(q.head+q.count)&(q.capacity-1)]=p_job;
+	q.count++;
+}
+
+bool JobSystem::_pop(int p_queue,Job *r_job) {
+
+	Queue &q=queues[p_queue];
+	if (q.count==0)
+		return false;
+
+	bool found=false;
+	q.mutex->lock();
+	if (q.count>0) {
+		q.count--;
+		*r_job=q.jobs[(q.head+q.count)&(q.capacity-1)];
+		found=true;
+	}
+	q.mutex->unlock();
+
+	return found;
+}
+
+bool JobSystem::_steal(int p_queue,Job *r_job) {
+
+	Queue &q=queues[p_queue];
+	if (q.count==0)
+		return false;
+
+	bool found=false;
+	q.mutex->lock();
+	if (q.count>0) {
+		*r_job=q.jobs[q.head];
+		q.head=(q.head+1)&(q.capacity-1);
+		q.count--;
+		found=true;
+	}
+	q.mutex->unlock();
+
+	return found;
+}
+
+bool JobSystem::_take(int p_queue,Job *r_job) {
+
+	if (_pop(p_queue,r_job))
+		return true;
+
+	int queue_count=worker_count+1;
+	for(int i=1;i<queue_count;i++) {
+		if (_steal((p_queue+i)%queue_count,r_job))
+			return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::_has_jobs() const {
+
+	for(int i=0;i<=worker_count;i++) {
+		if (queues[i].count>0)
+			return true;
+	}
+	return false;
+}
+
+void JobSystem::_wake(int p_count) {
+
+	// full barrier, a worker about to sleep increments sleeping before checking the queues
+	int count=MIN((int)atomic_add(&sleeping,0),p_count);
+	for(int i=0;i<count;i++)
+		wake_sem->post();
+}
+
+void JobSystem::_run(const Job& p_job) {
+
+	for(uint32_t i=p_job.from;i<p_job.to;i++)
+		p_job.func(p_job.userdata,i);
+
+	_finish(p_job.group);
+}
+
+void JobSystem::_finish(Group *p_group) {
+
+	if (atomic_decrement(&p_group->pending)>0)
+		return;
+
+	// last job, waiters don't return before done is set so the group is still alive
+	group_mutex->lock();
+	Dependent *d=p_group->dependents;
+	p_group->dependents=NULL;
+	Waiter *w=p_group->waiters;
+	while(w) {
+		// woken waiters take the mutex before returning, so the list stays valid
+		Waiter *next=w->next;
+		w->semaphore->post();
+		w=next;
+	}
+	p_group->waiters=NULL;
+	atomic_increment(&p_group->done); // with a barrier, nothing can be written to the group after it
+	group_mutex->unlock();
+
+	while(d) {
+		Dependent *next=d->next;
+		_enqueue(&d->job,1);
+		memdelete(d);
+		d=next;
+	}
+}
+
+void JobSystem::_begin_jobs(Group *p_group,uint32_t p_count) {
+
+	p_group->done=0;
+	atomic_add(&p_group->pending,p_count);
+}
+
+void JobSystem::_enqueue(const Job *p_jobs,int p_count) {
+
+	int queue=_get_queue_index();
+
+	queues[queue].mutex->lock();
+	for(int i=0;i<p_count;i++)
+		_push(queue,p_jobs[i]);
+	queues[queue].mutex->unlock();
+
+	_wake(p_count);
+}
+
+void JobSystem::_worker_func(void *p_userdata) {
+
+	Worker *w=(Worker*)p_userdata;
+	JobSystem *js=w->job_system;
+
+	w->id=Thread::get_caller_ID();
+
+	if (w->pin) {
+		// the main thread keeps the first core
+		Thread::set_affinity((w->index+1)%OS::get_singleton()->get_processor_count());
+	}
+
+	while(!js->exit) {
+
+		Job job;
+		if (js->_take(w->index,&job)) {
+			js->_run(job);
+			continue;
+		}
+
+		atomic_increment(&js->sleeping);
+		if (!js->_has_jobs() && !js->exit)
+			js->wake_sem->wait();
+		atomic_decrement(&js->sleeping);
+	}
+}
+
+void JobSystem::submit(Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_index) {
+
+	ERR_FAIL_COND(!p_group);
+
+	Job job;
+	job.func=p_func;
+	job.userdata=p_userdata;
+	job.from=p_index;
+	job.to=p_index+1;
+	job.group=p_group;
+
+	_begin_jobs(p_group,1);
+	_enqueue(&job,1);
+}
+
+void JobSystem::submit_range(Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_count,uint32_t p_batch) {
+
+	ERR_FAIL_COND(!p_group);
+	ERR_FAIL_COND(p_batch==0);
+
+	if (p_count==0)
+		return;
+
+	uint32_t job_count=(p_count+p_batch-1)/p_batch;
+	_begin_jobs(p_group,job_count);
+
+	int queue=_get_queue_index();
+
+	queues[queue].mutex->lock();
+	for(uint32_t i=0;i<job_count;i++) {
+
+		Job job;
+		job.func=p_func;
+		job.userdata=p_userdata;
+		job.from=i*p_batch;
+		job.to=MIN(job.from+p_batch,p_count);
+		job.group=p_group;
+		_push(queue,job);
+	}
+	queues[queue].mutex->unlock();
+
+	_wake(job_count);
+}
+
+void JobSystem::submit_after(Group *p_dependency,Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_index) {
+
+	ERR_FAIL_COND(!p_dependency);
+	ERR_FAIL_COND(!p_group);
+
+	Job job;
+	job.func=p_func;
+	job.userdata=p_userdata;
+	job.from=p_index;
+	job.to=p_index+1;
+	job.group=p_group;
+
+	_begin_jobs(p_group,1);
+
+	group_mutex->lock();
+	bool ready=p_dependency->pending==0;
+	if (!ready) {
+		Dependent *d=memnew(Dependent);
+		d->job=job;
+		d->next=p_dependency->dependents;
+		p_dependency->dependents=d;
+	}
+	group_mutex->unlock();
+
+	if (ready)
+		_enqueue(&job,1);
+}
+
+void JobSystem::wait(Group *p_group) {
+
+	ERR_FAIL_COND(!p_group);
+
+	int queue=_get_queue_index();
+
+	while(!p_group->is_done()) {
+
+		Job job;
+		if (_take(queue,&job)) {
+			_run(job);
+			continue;
+		}
+
+		if (worker_count==0) {
+			ERR_EXPLAIN("Waiting on a group whose jobs can never run (they depend on a group with no jobs queued).");
+			ERR_FAIL();
+		}
+
+		// the remaining jobs are running on other threads, sleep until the last one is done
+		Waiter waiter;
+		group_mutex->lock();
+		bool sleep=!p_group->done;
+		if (sleep) {
+			if (wait_semaphores.size()) {
+				waiter.semaphore=wait_semaphores[wait_semaphores.size()-1];
+				wait_semaphores.resize(wait_semaphores.size()-1);
+			} else {
+				waiter.semaphore=Semaphore::create();
+			}
+			waiter.next=p_group->waiters;
+			p_group->waiters=&waiter;
+		}
+		group_mutex->unlock();
+
+		if (!sleep)
+			break;
+
+		waiter.semaphore->wait();
+
+		group_mutex->lock();
+		wait_semaphores.push_back(waiter.semaphore);
+		group_mutex->unlock();
+	}
+}
+
+void JobSystem::parallel_for(uint32_t p_count,JobFunc p_func,void *p_userdata,uint32_t p_batch) {
+
+	if (worker_count==0 || p_count<=p_batch) {
+
+		for(uint32_t i=0;i<p_count;i++)
+			p_func(p_userdata,i);
+		return;
+	}
+
+	Group group;
+	submit_range(&group,p_func,p_userdata,p_count,p_batch);
+	wait(&group);
+}
+
+struct JobSystem::ScriptMap {
+
+	Object *instance;
+	StringName method;
+	const Array *array;
+	Variant userdata;
+	Variant *results;
+};
+
+void JobSystem::_script_map_job(void *p_userdata,uint32_t p_index) {
+
+	ScriptMap *sm=(ScriptMap*)p_userdata;
+
+	const Variant *args[2]={&(*sm->array)[p_index],&sm->userdata};
+	int argcount=sm->userdata.get_type()==Variant::NIL?1:2;
+
+	Variant::CallError ce;
+	sm->results[p_index]=sm->instance->call(sm->method,args,argcount,ce);
+
+	if (ce.error!=Variant::CallError::CALL_OK) {
+		ERR_PRINTS("JobSystem.map_array: "+Variant::get_call_error_text(sm->instance,sm->method,args,argcount,ce));
+	}
+}
+
+Array JobSystem::map_array(Object *p_instance,const StringName& p_method,const Array& p_array,const Variant& p_userdata) {
+
+	ERR_FAIL_NULL_V(p_instance,Array());
+
+	Vector<Variant> results;
+	results.resize(p_array.size());
+
+	ScriptMap sm;
+	sm.instance=p_instance;
+	sm.method=p_method;
+	sm.array=&p_array;
+	sm.userdata=p_userdata;
+	sm.results=results.ptr();
+
+	ScriptServer::begin_threaded_calls();
+	parallel_for(p_array.size(),_script_map_job,&sm);
+	ScriptServer::end_threaded_calls();
+
+	Array ret;
+	ret.resize(results.size());
+	for(int i=0;i<results.size();i++)
+		ret[i]=results[i];
+
+	return ret;
+}
+
+int JobSystem::get_thread_count() const {
+
+	return worker_count+1;
+}
+
+void JobSystem::start(int p_threads,bool p_pin_threads) {
+
+	finish();
+
+	if (p_threads<=0)
+		p_threads=MIN(OS::get_singleton()->get_processor_count(),int(AUTO_THREADS_MAX));
+
+	if (p_threads<=1)
+		return;
+
+	for(int i=0;i<=worker_count;i++) {
+		if (queues[i].jobs)
+			memdelete_arr(queues[i].jobs);
+		memdelete(queues[i].mutex);
+	}
+	memdelete_arr(queues);
+
+	worker_count=p_threads-1;
+	exit=false;
+
+	queues=memnew_arr(Queue,worker_count+1);
+	for(int i=0;i<=worker_count;i++) {
+		queues[i].mutex=Mutex::create();
+		queues[i].jobs=NULL;
+		queues[i].capacity=0;
+		queues[i].head=0;
+		queues[i].count=0;
+	}
+
+	workers=memnew_arr(Worker,worker_count);
+	for(int i=0;i<worker_count;i++) {
+		workers[i].job_system=this;
+		workers[i].id=0;
+		workers[i].index=i;
+		workers[i].pin=p_pin_threads;
+		workers[i].thread=Thread::create(_worker_func,&workers[i]);
+	}
+}
+
+void JobSystem::finish() {
+
+	if (worker_count==0)
+		return;
+
+	exit=true;
+	for(int i=0;i<worker_count;i++)
+		wake_sem->post();
+
+	for(int i=0;i<worker_count;i++) {
+		Thread::wait_to_finish(workers[i].thread);
+		memdelete(workers[i].thread);
+	}
+
+	memdelete_arr(workers);
+	workers=NULL;
+
+	// back to a single shared queue
+	for(int i=1;i<=worker_count;i++) {
+		if (queues[i].jobs)
+			memdelete_arr(queues[i].jobs);
+		memdelete(queues[i].mutex);
+	}
+	worker_count=0;
+}
+
+void JobSystem::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("map_array","instance","method","array","userdata"),&JobSystem::map_array,DEFVAL(Variant()));
+	ObjectTypeDB::bind_method(_MD("get_thread_count"),&JobSystem::get_thread_count);
+}
+
+JobSystem::JobSystem() {
+
+	singleton=this;
+
+	worker_count=0;
+	workers=NULL;
+	exit=false;
+	sleeping=0;
+
+	queues=memnew_arr(Queue,1);
+	queues[0].mutex=Mutex::create();
+	queues[0].jobs=NULL;
+	queues[0].capacity=0;
+	queues[0].head=0;
+	queues[0].count=0;
+
+	wake_sem=Semaphore::create();
+	group_mutex=Mutex::create();
+}
+
+JobSystem::~JobSystem() {
+
+	finish();
+
+	if (queues[0].jobs)
+		memdelete_arr(queues[0].jobs);
+	memdelete(queues[0].mutex);
+	memdelete_arr(queues);
+
+	memdelete(wake_sem);
+	memdelete(group_mutex);
+	for(int i=0;i<wait_semaphores.size();i++)
+		memdelete(wait_semaphores[i]);
+
+	singleton=NULL;
+}
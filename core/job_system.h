@@ -0,0 +1,182 @@
+/*************************************************************************/
+/*  job_system.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "object.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+#include "os/semaphore.h"
+
+/**
+ * Shared worker pool. Every worker owns a job deque: it pushes and pops at the
+ * back, idle workers steal from the front of the others. Threads that are not
+ * workers submit to an extra shared deque. Threads waiting on a group run jobs
+ * meanwhile, so waiting from inside a job does not deadlock.
+ *
+ * Jobs are counted by a Group; jobs can also be made to depend on another
+ * group, they are queued once that group has no pending jobs left.
+ *
+ * Waiting threads that find nothing to run sleep until the last job of the
+ * group finishes.
+ *
+ * With no worker threads (core/job_threads=1, or before start()), jobs simply
+ * run on the thread that waits for them.
+ */
+
+class JobSystem : public Object {
+
+	OBJ_TYPE(JobSystem,Object);
+public:
+
+	typedef void (*JobFunc)(void *p_userdata,uint32_t p_index);
+
+	class Group;
+
+private:
+
+	struct Job {
+
+		JobFunc func;
+		void *userdata;
+		uint32_t from;
+		uint32_t to;
+		Group *group;
+	};
+
+	struct Dependent {
+
+		Job job;
+		Dependent *next;
+	};
+
+	struct Waiter {
+
+		Semaphore *semaphore;
+		Waiter *next;
+	};
+
+public:
+
+	class Group {
+	friend class JobSystem;
+
+		volatile uint32_t pending;
+		volatile uint32_t done; // set by the last job once it no longer uses the group
+		Dependent *dependents;
+		Waiter *waiters; // threads sleeping in wait(), on their stack
+	public:
+
+		_FORCE_INLINE_ bool is_done() const { return done!=0; }
+
+		Group() { pending=0; done=1; dependents=NULL; waiters=NULL; }
+		~Group() { ERR_FAIL_COND(pending>0); }
+	};
+
+private:
+
+	struct Queue {
+
+		Mutex *mutex;
+		Job *jobs;
+		uint32_t capacity;
+		uint32_t head;
+		volatile uint32_t count;
+	};
+
+	struct Worker {
+
+		JobSystem *job_system;
+		Thread *thread;
+		Thread::ID id;
+		int index;
+		bool pin;
+	};
+
+	enum {
+		AUTO_THREADS_MAX=8 // start(0) uses one thread per processor, up to this many
+	};
+
+	static JobSystem *singleton;
+
+	Queue *queues; // one per worker, plus a shared one for other threads
+	Worker *workers;
+	int worker_count;
+	bool exit;
+
+	Semaphore *wake_sem;
+	volatile uint32_t sleeping;
+
+	Mutex *group_mutex; // dependents and waiters of groups
+	Vector<Semaphore*> wait_semaphores; // for threads sleeping in wait(), reused
+
+	static void _worker_func(void *p_userdata);
+
+	int _get_queue_index() const;
+	void _push(int p_queue,const Job& p_job);
+	bool _pop(int p_queue,Job *r_job);
+	bool _steal(int p_queue,Job *r_job);
+	bool _take(int p_queue,Job *r_job);
+	bool _has_jobs() const;
+	void _wake(int p_count);
+	void _run(const Job& p_job);
+	void _finish(Group *p_group);
+	void _enqueue(const Job *p_jobs,int p_count);
+	void _begin_jobs(Group *p_group,uint32_t p_count);
+
+	struct ScriptMap;
+	static void _script_map_job(void *p_userdata,uint32_t p_index);
+
+protected:
+
+	static void _bind_methods();
+
+public:
+
+	static JobSystem *get_singleton();
+
+	void start(int p_threads,bool p_pin_threads=false);
+	void finish();
+
+	int get_thread_count() const;
+
+	void submit(Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_index=0);
+	void submit_range(Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_count,uint32_t p_batch=1);
+	void submit_after(Group *p_dependency,Group *p_group,JobFunc p_func,void *p_userdata,uint32_t p_index=0);
+	void wait(Group *p_group);
+
+	void parallel_for(uint32_t p_count,JobFunc p_func,void *p_userdata,uint32_t p_batch=1);
+
+	Array map_array(Object *p_instance,const StringName& p_method,const Array& p_array,const Variant& p_userdata=Variant());
+
+	JobSystem();
+	~JobSystem();
+};
+
+#endif // JOB_SYSTEM_H
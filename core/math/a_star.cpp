@@ -28,7 +28,175 @@
 /*************************************************************************/
 #include "a_star.h"
 #include "geometry.h"
+#include "job_system.h"
+
+/**
+ * Scratch data of a single query, so several queries can run at once. The
+ * open list is a binary heap of point indices ordered by estimated total
+ * cost, heap_pos tells where a point sits in it (-1 once it was expanded) so
+ * a cheaper route can move it up in place. Arrays are reset lazily by bumping
+ * the pass number.
+ */
+
+struct AStarSearch {
+
+	uint32_t pass;
+	int size;
+
+	uint32_t *visited_pass;
+	float *g_cost;
+	float *f_cost;
+	int *prev;
+	int *heap_pos;
+	int *heap;
+	int heap_size;
+
+	void _free() {
+
+		if (!size)
+			return;
+		memdelete_arr(visited_pass);
+		memdelete_arr(g_cost);
+		memdelete_arr(f_cost);
+		memdelete_arr(prev);
+		memdelete_arr(heap_pos);
+		memdelete_arr(heap);
+		size=0;
+	}
+
+	void begin(int p_size) {
+
+		if (p_size>size) {
+
+			_free();
+			visited_pass=memnew_arr(uint32_t,p_size);
+			g_cost=memnew_arr(float,p_size);
+			f_cost=memnew_arr(float,p_size);
+			prev=memnew_arr(int,p_size);
+			heap_pos=memnew_arr(int,p_size);
+			heap=memnew_arr(int,p_size);
+			size=p_size;
+			pass=0;
+			for(int i=0;i<size;i++)
+				visited_pass[i]=0;
+		}
+
+		pass++;
+		if (pass==0) {
+			//wrapped around
+			for(int i=0;i<size;i++)
+				visited_pass[i]=0;
+			pass=1;
+		}
+
+		heap_size=0;
+	}
+
+	void _sift_up(int p_pos) {
+
+		int point=heap[p_pos];
+		float f=f_cost[point];
+
+		while(p_pos>0) {
+
+			int parent=(p_pos-1)>>1;
+			int parent_point=heap[parent];
+			if (f_cost[parent_point]<=f)
+				break;
+			heap[p_pos]=parent_point;
+			heap_pos[parent_point]=p_pos;
+			p_pos=parent;
+		}
+
+		heap[p_pos]=point;
+		heap_pos[point]=p_pos;
+	}
+
+	void _sift_down(int p_pos) {
+
+		int point=heap[p_pos];
+		float f=f_cost[point];
+
+		while(true) {
 
+			int child=(p_pos<<1)+1;
+			if (child>=heap_size)
+				break;
+			if (child+1<heap_size && f_cost[heap[child+1]]<f_cost[heap[child]])
+				child++;
+			int child_point=heap[child];
+			if (f<=f_cost[child_point])
+				break;
+			heap[p_pos]=child_point;
+			heap_pos[child_point]=p_pos;
+			p_pos=child;
+		}
+
+		heap[p_pos]=point;
+		heap_pos[point]=p_pos;
+	}
+
+	void _push(int p_point) {
+
+		heap[heap_size]=p_point;
+		heap_pos[p_point]=heap_size;
+		heap_size++;
+		_sift_up(heap_size-1);
+	}
+
+	int pop() {
+
+		int point=heap[0];
+		heap_pos[point]=-1;
+		heap_size--;
+		if (heap_size>0) {
+			heap[0]=heap[heap_size];
+			heap_pos[heap[0]]=0;
+			_sift_down(0);
+		}
+		return point;
+	}
+
+	void relax(int p_point,int p_prev,float p_g,float p_h) {
+
+		if (visited_pass[p_point]!=pass) {
+
+			visited_pass[p_point]=pass;
+			g_cost[p_point]=p_g;
+			f_cost[p_point]=p_g+p_h;
+			prev[p_point]=p_prev;
+			_push(p_point);
+
+		} else if (p_g<g_cost[p_point]) {
+
+			g_cost[p_point]=p_g;
+			f_cost[p_point]=p_g+p_h;
+			prev[p_point]=p_prev;
+			if (heap_pos[p_point]>=0)
+				_sift_up(heap_pos[p_point]);
+			else
+				_push(p_point); //reopen, only happens with weights below 1
+		}
+	}
+
+	AStarSearch() {
+
+		pass=0;
+		size=0;
+		heap_size=0;
+		visited_pass=NULL;
+		g_cost=NULL;
+		f_cost=NULL;
+		prev=NULL;
+		heap_pos=NULL;
+		heap=NULL;
+	}
+
+	~AStarSearch() {
+
+		_free();
+	}
+};
 
 int AStar::get_available_point_id() const {
 
@@ -36,76 +204,97 @@ int AStar::get_available_point_id() const {
 		return 1;
 	}
 
-	return points.back()->key()+1;
+	int max_id=0;
+	for(int i=0;i<points.size();i++) {
+		if (points[i].id>max_id)
+			max_id=points[i].id;
+	}
+
+	return max_id+1;
 }
 
 void AStar::add_point(int p_id, const Vector3 &p_pos, float p_weight_scale) {
 	ERR_FAIL_COND(p_id<0);
-	if (!points.has(p_id)) {
-		Point *pt = memnew( Point );
-		pt->id=p_id;
-		pt->pos=p_pos;
-		pt->weight_scale=p_weight_scale;
-		pt->prev_point=NULL;
-		pt->last_pass=0;
-		points[p_id]=pt;
+	int idx=_get_index(p_id);
+	if (idx<0) {
+		Point pt;
+		pt.id=p_id;
+		pt.pos=p_pos;
+		pt.weight_scale=p_weight_scale;
+		point_index[p_id]=points.size();
+		points.push_back(pt);
 	} else {
-		points[p_id]->pos=p_pos;
-		points[p_id]->weight_scale=p_weight_scale;
+		points[idx].pos=p_pos;
+		points[idx].weight_scale=p_weight_scale;
 	}
 }
 
 Vector3 AStar::get_point_pos(int p_id) const{
 
-	ERR_FAIL_COND_V(!points.has(p_id),Vector3());
+	int idx=_get_index(p_id);
+	ERR_FAIL_COND_V(idx<0,Vector3());
 
-	return points[p_id]->pos;
+	return points[idx].pos;
 
 }
 float AStar::get_point_weight_scale(int p_id) const{
 
-	ERR_FAIL_COND_V(!points.has(p_id),0);
+	int idx=_get_index(p_id);
+	ERR_FAIL_COND_V(idx<0,0);
 
-	return points[p_id]->weight_scale;
+	return points[idx].weight_scale;
 
 }
 void AStar::remove_point(int p_id){
 
-	ERR_FAIL_COND(!points.has(p_id));
+	int idx=_get_index(p_id);
+	ERR_FAIL_COND(idx<0);
 
-	Point* p = points[p_id];
+	Point *pts=points.ptr();
 
-	for(int i=0;i<p->neighbours.size();i++) {
+	for(int i=0;i<pts[idx].neighbours.size();i++) {
 
-		Segment s(p_id,p->neighbours[i]->id);
+		int n=pts[idx].neighbours[i];
+		Segment s(p_id,pts[n].id);
 		segments.erase(s);
-		p->neighbours[i]->neighbours.erase(p);
+		pts[n].neighbours.erase(idx);
 	}
 
-	memdelete(p);
-	points.erase(p_id);
+	//keep the array dense, move the last point into the hole
+	int last=points.size()-1;
+	if (idx!=last) {
+
+		pts[idx]=pts[last];
+		point_index[pts[idx].id]=idx;
+
+		for(int i=0;i<pts[idx].neighbours.size();i++) {
+
+			Vector<int> &nn=pts[pts[idx].neighbours[i]].neighbours;
+			int pos=nn.find(last);
+			if (pos>=0)
+				nn[pos]=idx;
+		}
+	}
+
+	points.resize(last);
+	point_index.erase(p_id);
 }
 
 void AStar::connect_points(int p_id,int p_with_id){
 
-	ERR_FAIL_COND(!points.has(p_id));
-	ERR_FAIL_COND(!points.has(p_with_id));
+	int a=_get_index(p_id);
+	int b=_get_index(p_with_id);
+	ERR_FAIL_COND(a<0);
+	ERR_FAIL_COND(b<0);
 	ERR_FAIL_COND(p_id==p_with_id);
 
 
-	Point* a = points[p_id];
-	Point* b = points[p_with_id];
-	a->neighbours.push_back(b);
-	b->neighbours.push_back(a);
-
 	Segment s(p_id,p_with_id);
-	if (s.from==p_id) {
-		s.from_point=a;
-		s.to_point=b;
-	} else {
-		s.from_point=b;
-		s.to_point=a;
-	}
+	if (segments.has(s))
+		return;
+
+	points[a].neighbours.push_back(b);
+	points[b].neighbours.push_back(a);
 
 	segments.insert(s);
 
@@ -119,10 +308,10 @@ void AStar::disconnect_points(int p_id,int p_with_id){
 
 	segments.erase(s);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.erase(b);
-	b->neighbours.erase(a);
+	int a=_get_index(p_id);
+	int b=_get_index(p_with_id);
+	points[a].neighbours.erase(b);
+	points[b].neighbours.erase(a);
 
 }
 bool AStar::are_points_connected(int p_id,int p_with_id) const{
@@ -133,12 +322,9 @@ bool AStar::are_points_connected(int p_id,int p_with_id) const{
 
 void AStar::clear(){
 
-	for (const Map<int,Point*>::Element *E=points.front();E;E=E->next()) {
-
-		memdelete(E->get());
-	}
 	segments.clear();
 	points.clear();
+	point_index.clear();
 }
 
 
@@ -147,12 +333,12 @@ int AStar::get_closest_point(const Vector3& p_point) const{
 	int closest_id=-1;
 	float closest_dist=1e20;
 
-	for (const Map<int,Point*>::Element *E=points.front();E;E=E->next()) {
+	for (int i=0;i<points.size();i++) {
 
-		float d = p_point.distance_squared_to(E->get()->pos);
+		float d = p_point.distance_squared_to(points[i].pos);
 		if (closest_id<0 || d<closest_dist) {
 			closest_dist=d;
-			closest_id=E->key();
+			closest_id=points[i].id;
 		}
 	}
 
@@ -170,8 +356,8 @@ Vector3 AStar::get_closest_pos_in_segment(const Vector3& p_point) const {
 	for (const Set<Segment>::Element *E=segments.front();E;E=E->next()) {
 
 		Vector3 segment[2]={
-			E->get().from_point->pos,
-			E->get().to_point->pos,
+			points[_get_index(E->get().from)].pos,
+			points[_get_index(E->get().to)].pos,
 		};
 
 		Vector3 p = Geometry::get_closest_point_to_segment(p_point,segment);
@@ -187,254 +373,659 @@ Vector3 AStar::get_closest_pos_in_segment(const Vector3& p_point) const {
 	return closest_point;
 }
 
-bool AStar::_solve(Point* begin_point, Point* end_point) {
+bool AStar::_solve(AStarSearch *p_search,int p_from,int p_to) const {
 
-	pass++;
+	const Point *pts=points.ptr();
+	const Vector3 &end_pos=pts[p_to].pos;
 
-	SelfList<Point>::List open_list;
+	p_search->begin(points.size());
+	p_search->relax(p_from,-1,0,pts[p_from].pos.distance_to(end_pos));
 
-	bool found_route=false;
+	while(p_search->heap_size) {
 
+		int p=p_search->pop();
+		if (p==p_to)
+			return true;
 
-	for(int i=0;i<begin_point->neighbours.size();i++) {
+		const Point &point=pts[p];
+		float g=p_search->g_cost[p];
+		int es=point.neighbours.size();
+		const int *neighbours=point.neighbours.ptr();
 
-		Point *n = begin_point->neighbours[i];
-		n->prev_point=begin_point;
-		n->distance=n->pos.distance_to(begin_point->pos);
-		n->distance*=n->weight_scale;
-		n->last_pass=pass;
-		open_list.add(&n->list);
+		for(int i=0;i<es;i++) {
 
-		if (end_point==n) {
-			found_route=true;
-			break;
+			const Point &e=pts[neighbours[i]];
+			//the weight scales the whole route up to the point, as it always did
+			float distance=(g+point.pos.distance_to(e.pos))*e.weight_scale;
+			p_search->relax(neighbours[i],p,distance,e.pos.distance_to(end_pos));
 		}
 	}
 
-	while(!found_route) {
+	//could not find path sadly
+	return false;
+}
 
-		if (open_list.first()==NULL) {
-			//could not find path sadly
-			break;
+void AStar::_get_path(AStarSearch *p_search,int p_from,int p_to,Vector<int>& r_path) const {
+
+	r_path.clear();
+
+	if (p_from==p_to) {
+		r_path.push_back(p_from);
+		return;
+	}
+
+	if (!_solve(p_search,p_from,p_to))
+		return;
+
+	int pc=0;
+	for(int p=p_to;p!=-1;p=p_search->prev[p])
+		pc++;
+
+	r_path.resize(pc);
+	int idx=pc-1;
+	for(int p=p_to;p!=-1;p=p_search->prev[p])
+		r_path[idx--]=p;
+}
+
+DVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
+
+	int a=_get_index(p_from_id);
+	int b=_get_index(p_to_id);
+	ERR_FAIL_COND_V(a<0,DVector<Vector3>());
+	ERR_FAIL_COND_V(b<0,DVector<Vector3>());
+
+	Vector<int> route;
+	_get_path(search,a,b,route);
+
+	DVector<Vector3> path;
+	path.resize(route.size());
+
+	{
+		DVector<Vector3>::Write w = path.write();
+		for(int i=0;i<route.size();i++)
+			w[i]=points[route[i]].pos;
+	}
+
+	return path;
+
+}
+
+
+DVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
+
+	int a=_get_index(p_from_id);
+	int b=_get_index(p_to_id);
+	ERR_FAIL_COND_V(a<0,DVector<int>());
+	ERR_FAIL_COND_V(b<0,DVector<int>());
+
+	Vector<int> route;
+	_get_path(search,a,b,route);
+
+	DVector<int> path;
+	path.resize(route.size());
+
+	{
+		DVector<int>::Write w = path.write();
+		for(int i=0;i<route.size();i++)
+			w[i]=points[route[i]].id;
+	}
+
+	return path;
+}
+
+struct AStar::Batch {
+
+	const AStar *astar;
+	const int *from;
+	const int *to;
+	int count;
+	int chunks;
+	Vector<int> *paths;
+};
+
+void AStar::_batch_job(void *p_userdata,uint32_t p_index) {
+
+	Batch *b=(Batch*)p_userdata;
+	AStarSearch search;
+
+	int from=p_index*b->count/b->chunks;
+	int to=(p_index+1)*b->count/b->chunks;
+
+	for(int i=from;i<to;i++) {
+		if (b->from[i]>=0 && b->to[i]>=0)
+			b->astar->_get_path(&search,b->from[i],b->to[i],b->paths[i]);
+	}
+}
+
+void AStar::_solve_batch(const IntArray& p_from_ids,const IntArray& p_to_ids,bool p_parallel,Vector< Vector<int> >& r_paths) {
+
+	ERR_FAIL_COND(p_from_ids.size()!=p_to_ids.size());
+
+	int count=p_from_ids.size();
+
+	Vector<int> from;
+	Vector<int> to;
+	from.resize(count);
+	to.resize(count);
+	r_paths.resize(count);
+
+	{
+		IntArray::Read rf=p_from_ids.read();
+		IntArray::Read rt=p_to_ids.read();
+		for(int i=0;i<count;i++) {
+			from[i]=_get_index(rf[i]);
+			to[i]=_get_index(rt[i]);
 		}
-		//check open list
+	}
 
-		SelfList<Point> *least_cost_point=NULL;
-		float least_cost=1e30;
+	Batch b;
+	b.astar=this;
+	b.from=from.ptr();
+	b.to=to.ptr();
+	b.count=count;
+	b.paths=r_paths.ptr();
 
-		//this could be faster (cache previous results)
-		for (SelfList<Point> *E=open_list.first();E;E=E->next()) {
+	JobSystem *js=JobSystem::get_singleton();
 
-			Point *p=E->self();
+	if (p_parallel && js && js->get_thread_count()>1 && count>1) {
 
-			float cost=p->distance;
-			cost+=p->pos.distance_to(end_point->pos);
-			cost*=p->weight_scale;
+		b.chunks=MIN(count,js->get_thread_count()*4); //each chunk reuses one search
+		js->parallel_for(b.chunks,_batch_job,&b);
+	} else {
 
-			if (cost<least_cost) {
+		for(int i=0;i<count;i++) {
+			if (from[i]>=0 && to[i]>=0)
+				_get_path(search,from[i],to[i],r_paths[i]);
+		}
+	}
+}
 
-				least_cost_point=E;
-				least_cost=cost;
-			}
+Array AStar::get_point_paths(const IntArray& p_from_ids, const IntArray& p_to_ids,bool p_parallel) {
+
+	Vector< Vector<int> > routes;
+	_solve_batch(p_from_ids,p_to_ids,p_parallel,routes);
+
+	Array ret;
+	ret.resize(routes.size());
+	for(int i=0;i<routes.size();i++) {
+
+		const Vector<int> &route=routes[i];
+		DVector<Vector3> path;
+		path.resize(route.size());
+		{
+			DVector<Vector3>::Write w = path.write();
+			for(int j=0;j<route.size();j++)
+				w[j]=points[route[j]].pos;
 		}
+		ret[i]=path;
+	}
 
+	return ret;
+}
 
-		Point *p=least_cost_point->self();
-		//open the neighbours for search
-		int es = p->neighbours.size();
+Array AStar::get_id_paths(const IntArray& p_from_ids, const IntArray& p_to_ids,bool p_parallel) {
 
-		for(int i=0;i<es;i++) {
+	Vector< Vector<int> > routes;
+	_solve_batch(p_from_ids,p_to_ids,p_parallel,routes);
+
+	Array ret;
+	ret.resize(routes.size());
+	for(int i=0;i<routes.size();i++) {
+
+		const Vector<int> &route=routes[i];
+		DVector<int> path;
+		path.resize(route.size());
+		{
+			DVector<int>::Write w = path.write();
+			for(int j=0;j<route.size();j++)
+				w[j]=points[route[j]].id;
+		}
+		ret[i]=path;
+	}
+
+	return ret;
+}
+
+void AStar::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("get_available_point_id"),&AStar::get_available_point_id);
+	ObjectTypeDB::bind_method(_MD("add_point","id","pos","weight_scale"),&AStar::add_point,DEFVAL(1.0));
+	ObjectTypeDB::bind_method(_MD("get_point_pos","id"),&AStar::get_point_pos);
+	ObjectTypeDB::bind_method(_MD("get_point_weight_scale","id"),&AStar::get_point_weight_scale);
+	ObjectTypeDB::bind_method(_MD("remove_point","id"),&AStar::remove_point);
 
+	ObjectTypeDB::bind_method(_MD("connect_points","id","to_id"),&AStar::connect_points);
+	ObjectTypeDB::bind_method(_MD("disconnect_points","id","to_id"),&AStar::disconnect_points);
+	ObjectTypeDB::bind_method(_MD("are_points_connected","id","to_id"),&AStar::are_points_connected);
+
+	ObjectTypeDB::bind_method(_MD("clear"),&AStar::clear);
+
+	ObjectTypeDB::bind_method(_MD("get_closest_point","to_pos"),&AStar::get_closest_point);
+	ObjectTypeDB::bind_method(_MD("get_closest_pos_in_segment","to_pos"),&AStar::get_closest_pos_in_segment);
+
+	ObjectTypeDB::bind_method(_MD("get_point_path","from_id","to_id"),&AStar::get_point_path);
+	ObjectTypeDB::bind_method(_MD("get_id_path","from_id","to_id"),&AStar::get_id_path);
+
+	ObjectTypeDB::bind_method(_MD("get_point_paths","from_ids","to_ids","parallel"),&AStar::get_point_paths,DEFVAL(false));
+	ObjectTypeDB::bind_method(_MD("get_id_paths","from_ids","to_ids","parallel"),&AStar::get_id_paths,DEFVAL(false));
+
+}
+
+
+AStar::AStar() {
+
+	search=memnew( AStarSearch );
+}
 
-			Point* e=p->neighbours[i];
 
+AStar::~AStar() {
+
+	memdelete(search);
+}
 
-			float distance = p->pos.distance_to(e->pos) + p->distance;
-			distance*=e->weight_scale;
+/////////////////////////////////////////////
 
+static const float ASTAR_DIAGONAL_COST=1.41421356;
 
+float AStarGrid::_heuristic(int p_x,int p_y,int p_to_x,int p_to_y) const {
+
+	int dx=ABS(p_to_x-p_x);
+	int dy=ABS(p_to_y-p_y);
+
+	if (!diagonal)
+		return dx+dy;
+
+	//octile distance
+	return MAX(dx,dy)+(ASTAR_DIAGONAL_COST-1.0)*MIN(dx,dy);
+}
 
-			if (e->last_pass==pass) {
-				//oh this was visited already, can we win the cost?
+int AStarGrid::_jump(int p_x,int p_y,int p_dx,int p_dy,int p_to_x,int p_to_y) const {
 
-				if (e->distance>distance) {
+	//walk until something forces a turn, returns the cell index of the jump point or -1
+	int x=p_x;
+	int y=p_y;
 
-					e->prev_point=p;
-					e->distance=distance;
+	while(true) {
+
+		if (!_is_free(x,y))
+			return -1;
+
+		if (x==p_to_x && y==p_to_y)
+			return y*width+x;
+
+		if (p_dx && p_dy) {
+
+			//diagonal moves stop where a straight jump finds something
+			if (_jump(x+p_dx,y,p_dx,0,p_to_x,p_to_y)>=0 || _jump(x,y+p_dy,0,p_dy,p_to_x,p_to_y)>=0)
+				return y*width+x;
+
+		} else if (p_dx) {
+
+			if ((_is_free(x,y-1) && !_is_free(x-p_dx,y-1)) || (_is_free(x,y+1) && !_is_free(x-p_dx,y+1)))
+				return y*width+x;
+		} else {
+
+			if ((_is_free(x-1,y) && !_is_free(x-1,y-p_dy)) || (_is_free(x+1,y) && !_is_free(x+1,y-p_dy)))
+				return y*width+x;
+		}
+
+		//no corner cutting
+		if (!_is_free(x+p_dx,y) || !_is_free(x,y+p_dy))
+			return -1;
+
+		x+=p_dx;
+		y+=p_dy;
+	}
+}
+
+bool AStarGrid::_solve(AStarSearch *p_search,int p_from,int p_to) const {
+
+	int to_x=p_to%width;
+	int to_y=p_to/width;
+
+	p_search->begin(width*height);
+	p_search->relax(p_from,-1,0,_heuristic(p_from%width,p_from/width,to_x,to_y));
+
+	bool jps=jumping && diagonal;
+
+	while(p_search->heap_size) {
+
+		int p=p_search->pop();
+		if (p==p_to)
+			return true;
+
+		int x=p%width;
+		int y=p/width;
+		float g=p_search->g_cost[p];
+
+		//candidate directions
+		int dirs[8][2];
+		int dir_count=0;
+
+		int prev=p_search->prev[p];
+
+		if (jps && prev>=0) {
+
+			//prune the neighbours that a path through the parent reaches at least as cheaply
+			int px=prev%width;
+			int py=prev/width;
+			int dx=CLAMP(x-px,-1,1);
+			int dy=CLAMP(y-py,-1,1);
+
+			if (dx && dy) {
+
+				bool free_y=_is_free(x,y+dy);
+				bool free_x=_is_free(x+dx,y);
+				if (free_y) { dirs[dir_count][0]=0; dirs[dir_count][1]=dy; dir_count++; }
+				if (free_x) { dirs[dir_count][0]=dx; dirs[dir_count][1]=0; dir_count++; }
+				if (free_x && free_y) { dirs[dir_count][0]=dx; dirs[dir_count][1]=dy; dir_count++; }
+
+			} else if (dx) {
+
+				bool next=_is_free(x+dx,y);
+				bool top=_is_free(x,y+1);
+				bool bottom=_is_free(x,y-1);
+				if (next) {
+					dirs[dir_count][0]=dx; dirs[dir_count][1]=0; dir_count++;
+					if (top) { dirs[dir_count][0]=dx; dirs[dir_count][1]=1; dir_count++; }
+					if (bottom) { dirs[dir_count][0]=dx; dirs[dir_count][1]=-1; dir_count++; }
 				}
+				if (top) { dirs[dir_count][0]=0; dirs[dir_count][1]=1; dir_count++; }
+				if (bottom) { dirs[dir_count][0]=0; dirs[dir_count][1]=-1; dir_count++; }
+
 			} else {
-				//add to open neighbours
 
-				e->prev_point=p;
-				e->distance=distance;
-				e->last_pass=pass; //mark as used
-				open_list.add(&e->list);
+				bool next=_is_free(x,y+dy);
+				bool right=_is_free(x+1,y);
+				bool left=_is_free(x-1,y);
+				if (next) {
+					dirs[dir_count][0]=0; dirs[dir_count][1]=dy; dir_count++;
+					if (right) { dirs[dir_count][0]=1; dirs[dir_count][1]=dy; dir_count++; }
+					if (left) { dirs[dir_count][0]=-1; dirs[dir_count][1]=dy; dir_count++; }
+				}
+				if (right) { dirs[dir_count][0]=1; dirs[dir_count][1]=0; dir_count++; }
+				if (left) { dirs[dir_count][0]=-1; dirs[dir_count][1]=0; dir_count++; }
+			}
 
-				if (e==end_point) {
-					//oh my reached end! stop algorithm
-					found_route=true;
-					break;
+		} else {
+
+			static const int all_dirs[8][2]={ {1,0},{-1,0},{0,1},{0,-1},{1,1},{-1,1},{1,-1},{-1,-1} };
+			int count=diagonal?8:4;
+			for(int i=0;i<count;i++) {
+				int dx=all_dirs[i][0];
+				int dy=all_dirs[i][1];
+				if (!_is_free(x+dx,y+dy))
+					continue;
+				if (dx && dy && (!_is_free(x+dx,y) || !_is_free(x,y+dy)))
+					continue;
+				dirs[dir_count][0]=dx;
+				dirs[dir_count][1]=dy;
+				dir_count++;
+			}
+		}
 
-				}
+		for(int i=0;i<dir_count;i++) {
 
+			int dx=dirs[i][0];
+			int dy=dirs[i][1];
+			int n;
+
+			if (jps) {
+				n=_jump(x+dx,y+dy,dx,dy,to_x,to_y);
+				if (n<0)
+					continue;
+			} else {
+				n=(y+dy)*width+(x+dx);
 			}
+
+			int nx=n%width;
+			int ny=n/width;
+			int steps=MAX(ABS(nx-x),ABS(ny-y)); //jumps are straight or diagonal lines
+			float cost=(dx && dy)?steps*ASTAR_DIAGONAL_COST:steps;
+
+			p_search->relax(n,p,g+cost,_heuristic(nx,ny,to_x,to_y));
 		}
+	}
+
+	return false;
+}
+
+void AStarGrid::_get_path(AStarSearch *p_search,int p_from,int p_to,Vector<Vector2>& r_path) const {
 
-		if (found_route)
+	r_path.clear();
+
+	if (!_solve(p_search,p_from,p_to))
+		return;
+
+	//walk back from the end, filling the cells between jump points
+	Vector<Vector2> reversed;
+	int p=p_to;
+	while(true) {
+
+		int x=p%width;
+		int y=p/width;
+		reversed.push_back(Vector2(x,y));
+
+		int prev=p_search->prev[p];
+		if (prev<0)
 			break;
 
-		open_list.remove(least_cost_point);
-	}
+		int px=prev%width;
+		int py=prev/width;
+		int dx=CLAMP(px-x,-1,1);
+		int dy=CLAMP(py-y,-1,1);
+		x+=dx;
+		y+=dy;
+		while(x!=px || y!=py) {
+			reversed.push_back(Vector2(x,y));
+			x+=dx;
+			y+=dy;
+		}
 
-	//clear the openf list
-	while(open_list.first()) {
-		open_list.remove( open_list.first() );
+		p=prev;
 	}
 
-	return found_route;
+	int count=reversed.size();
+	r_path.resize(count);
+	for(int i=0;i<count;i++)
+		r_path[i]=reversed[count-i-1];
+}
+
+void AStarGrid::set_size(const Vector2& p_size) {
+
+	ERR_FAIL_COND(p_size.x<0 || p_size.y<0);
 
+	width=p_size.x;
+	height=p_size.y;
+	solid.resize(width*height);
+	clear();
 }
 
-DVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
+Vector2 AStarGrid::get_size() const {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id),DVector<Vector3>());
-	ERR_FAIL_COND_V(!points.has(p_to_id),DVector<Vector3>());
+	return Vector2(width,height);
+}
 
+void AStarGrid::set_solid(const Vector2& p_cell,bool p_solid) {
 
-	pass++;
+	int x=p_cell.x;
+	int y=p_cell.y;
+	ERR_FAIL_INDEX(x,width);
+	ERR_FAIL_INDEX(y,height);
 
-	Point* a = points[p_from_id];
-	Point* b = points[p_to_id];
+	solid[y*width+x]=p_solid;
+}
 
-	if (a==b) {
-		DVector<Vector3> ret;
-		ret.push_back(a->pos);
-		return ret;
-	}
+bool AStarGrid::is_solid(const Vector2& p_cell) const {
 
+	int x=p_cell.x;
+	int y=p_cell.y;
+	ERR_FAIL_INDEX_V(x,width,true);
+	ERR_FAIL_INDEX_V(y,height,true);
 
-	Point *begin_point=a;
-	Point *end_point=b;
+	return solid[y*width+x];
+}
 
-	bool found_route=_solve(begin_point,end_point);
+void AStarGrid::set_diagonal_enabled(bool p_enable) {
 
-	if (!found_route)
-		return DVector<Vector3>();
+	diagonal=p_enable;
+}
 
-	//midpoints
-	Point *p=end_point;
-	int pc=1; //begin point
-	while(p!=begin_point) {
-		pc++;
-		p=p->prev_point;
-	}
+bool AStarGrid::is_diagonal_enabled() const {
 
-	DVector<Vector3> path;
-	path.resize(pc);
+	return diagonal;
+}
 
-	{
-		DVector<Vector3>::Write w = path.write();
+void AStarGrid::set_jumping_enabled(bool p_enable) {
 
-		Point *p=end_point;
-		int idx=pc-1;
-		while(p!=begin_point) {
-			w[idx--]=p->pos;
-			p=p->prev_point;
-		}
+	jumping=p_enable;
+}
 
-		w[0]=p->pos; //assign first
+bool AStarGrid::is_jumping_enabled() const {
 
-	}
+	return jumping;
+}
 
-	return path;
+void AStarGrid::clear() {
 
+	uint8_t *w=solid.ptr();
+	for(int i=0;i<solid.size();i++)
+		w[i]=0;
 }
 
+Vector2Array AStarGrid::get_path(const Vector2& p_from,const Vector2& p_to) {
 
-DVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
+	ERR_FAIL_COND_V(!_is_free(p_from.x,p_from.y),Vector2Array());
+	ERR_FAIL_COND_V(!_is_free(p_to.x,p_to.y),Vector2Array());
+
+	Vector<Vector2> route;
+	_get_path(search,int(p_from.y)*width+int(p_from.x),int(p_to.y)*width+int(p_to.x),route);
+
+	Vector2Array path;
+	path.resize(route.size());
+	{
+		Vector2Array::Write w=path.write();
+		for(int i=0;i<route.size();i++)
+			w[i]=route[i];
+	}
+
+	return path;
+}
+
+struct AStarGrid::Batch {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id),DVector<int>());
-	ERR_FAIL_COND_V(!points.has(p_to_id),DVector<int>());
+	const AStarGrid *grid;
+	const int *from;
+	const int *to;
+	int count;
+	int chunks;
+	Vector<Vector2> *paths;
+};
 
+void AStarGrid::_batch_job(void *p_userdata,uint32_t p_index) {
 
-	pass++;
+	Batch *b=(Batch*)p_userdata;
+	AStarSearch search;
 
-	Point* a = points[p_from_id];
-	Point* b = points[p_to_id];
+	int from=p_index*b->count/b->chunks;
+	int to=(p_index+1)*b->count/b->chunks;
 
-	if (a==b) {
-		DVector<int> ret;
-		ret.push_back(a->id);
-		return ret;
+	for(int i=from;i<to;i++) {
+		if (b->from[i]>=0 && b->to[i]>=0)
+			b->grid->_get_path(&search,b->from[i],b->to[i],b->paths[i]);
 	}
+}
 
+Array AStarGrid::get_paths(const Vector2Array& p_from,const Vector2Array& p_to,bool p_parallel) {
 
-	Point *begin_point=a;
-	Point *end_point=b;
+	ERR_FAIL_COND_V(p_from.size()!=p_to.size(),Array());
 
-	bool found_route=_solve(begin_point,end_point);
+	int count=p_from.size();
 
-	if (!found_route)
-		return DVector<int>();
+	Vector<int> from;
+	Vector<int> to;
+	Vector< Vector<Vector2> > routes;
+	from.resize(count);
+	to.resize(count);
+	routes.resize(count);
 
-	//midpoints
-	Point *p=end_point;
-	int pc=1; //begin point
-	while(p!=begin_point) {
-		pc++;
-		p=p->prev_point;
+	{
+		Vector2Array::Read rf=p_from.read();
+		Vector2Array::Read rt=p_to.read();
+		for(int i=0;i<count;i++) {
+			from[i]=_is_free(rf[i].x,rf[i].y)?int(rf[i].y)*width+int(rf[i].x):-1;
+			to[i]=_is_free(rt[i].x,rt[i].y)?int(rt[i].y)*width+int(rt[i].x):-1;
+		}
 	}
 
-	DVector<int> path;
-	path.resize(pc);
+	Batch b;
+	b.grid=this;
+	b.from=from.ptr();
+	b.to=to.ptr();
+	b.count=count;
+	b.paths=routes.ptr();
 
-	{
-		DVector<int>::Write w = path.write();
+	JobSystem *js=JobSystem::get_singleton();
 
-		p=end_point;
-		int idx=pc-1;
-		while(p!=begin_point) {
-			w[idx--]=p->id;
-			p=p->prev_point;
+	if (p_parallel && js && js->get_thread_count()>1 && count>1) {
+
+		b.chunks=MIN(count,js->get_thread_count()*4); //each chunk reuses one search
+		js->parallel_for(b.chunks,_batch_job,&b);
+	} else {
+
+		for(int i=0;i<count;i++) {
+			if (from[i]>=0 && to[i]>=0)
+				_get_path(search,from[i],to[i],routes[i]);
 		}
+	}
 
-		w[0]=p->id; //assign first
+	Array ret;
+	ret.resize(count);
+	for(int i=0;i<count;i++) {
 
+		Vector2Array path;
+		path.resize(routes[i].size());
+		{
+			Vector2Array::Write w=path.write();
+			for(int j=0;j<routes[i].size();j++)
+				w[j]=routes[i][j];
+		}
+		ret[i]=path;
 	}
 
-	return path;
+	return ret;
 }
 
-void AStar::_bind_methods() {
+void AStarGrid::_bind_methods() {
 
-	ObjectTypeDB::bind_method(_MD("get_available_point_id"),&AStar::get_available_point_id);
-	ObjectTypeDB::bind_method(_MD("add_point","id","pos","weight_scale"),&AStar::add_point,DEFVAL(1.0));
-	ObjectTypeDB::bind_method(_MD("get_point_pos","id"),&AStar::get_point_pos);
-	ObjectTypeDB::bind_method(_MD("get_point_weight_scale","id"),&AStar::get_point_weight_scale);
-	ObjectTypeDB::bind_method(_MD("remove_point","id"),&AStar::remove_point);
+	ObjectTypeDB::bind_method(_MD("set_size","size"),&AStarGrid::set_size);
+	ObjectTypeDB::bind_method(_MD("get_size"),&AStarGrid::get_size);
 
-	ObjectTypeDB::bind_method(_MD("connect_points","id","to_id"),&AStar::connect_points);
-	ObjectTypeDB::bind_method(_MD("disconnect_points","id","to_id"),&AStar::disconnect_points);
-	ObjectTypeDB::bind_method(_MD("are_points_connected","id","to_id"),&AStar::are_points_connected);
+	ObjectTypeDB::bind_method(_MD("set_solid","cell","solid"),&AStarGrid::set_solid);
+	ObjectTypeDB::bind_method(_MD("is_solid","cell"),&AStarGrid::is_solid);
 
-	ObjectTypeDB::bind_method(_MD("clear"),&AStar::clear);
+	ObjectTypeDB::bind_method(_MD("set_diagonal_enabled","enable"),&AStarGrid::set_diagonal_enabled);
+	ObjectTypeDB::bind_method(_MD("is_diagonal_enabled"),&AStarGrid::is_diagonal_enabled);
 
-	ObjectTypeDB::bind_method(_MD("get_closest_point","to_pos"),&AStar::get_closest_point);
-	ObjectTypeDB::bind_method(_MD("get_closest_pos_in_segment","to_pos"),&AStar::get_closest_pos_in_segment);
+	ObjectTypeDB::bind_method(_MD("set_jumping_enabled","enable"),&AStarGrid::set_jumping_enabled);
+	ObjectTypeDB::bind_method(_MD("is_jumping_enabled"),&AStarGrid::is_jumping_enabled);
 
-	ObjectTypeDB::bind_method(_MD("get_point_path","from_id","to_id"),&AStar::get_point_path);
-	ObjectTypeDB::bind_method(_MD("get_id_path","from_id","to_id"),&AStar::get_id_path);
+	ObjectTypeDB::bind_method(_MD("clear"),&AStarGrid::clear);
 
+	ObjectTypeDB::bind_method(_MD("get_path","from","to"),&AStarGrid::get_path);
+	ObjectTypeDB::bind_method(_MD("get_paths","from","to","parallel"),&AStarGrid::get_paths,DEFVAL(false));
 }
 
+AStarGrid::AStarGrid() {
 
-AStar::AStar() {
-
-	pass=1;
+	width=0;
+	height=0;
+	diagonal=true;
+	jumping=false;
+	search=memnew( AStarSearch );
 }
 
+AStarGrid::~AStarGrid() {
 
-AStar::~AStar() {
-
-	pass=1;
+	memdelete(search);
 }
@@ -30,37 +30,29 @@
 #define ASTAR_H
 
 #include "reference.h"
-#include "self_list.h"
+#include "hash_map.h"
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
 
+struct AStarSearch;
+
 class AStar: public Reference {
 
 	OBJ_TYPE(AStar,Reference)
 
 
-	uint64_t pass;
-
 	struct Point {
 
-		SelfList<Point> list;
-
 		int id;
 		Vector3 pos;
 		float weight_scale;
-		uint64_t last_pass;
-
-		Vector<Point*> neighbours;
-
-		//used for pathfinding
-		Point *prev_point;
-		float distance;
 
-		Point() : list(this) {}
+		Vector<int> neighbours; // indices in points
 	};
 
-	Map<int,Point*> points;
+	Vector<Point> points;
+	HashMap<int,int> point_index;
 
 	struct Segment {
 		union {
@@ -71,9 +63,6 @@ class AStar: public Reference {
 			uint64_t key;
 		};
 
-		Point *from_point;
-		Point *to_point;
-
 		bool operator<(const Segment& p_s) const { return key<p_s.key; }
 		Segment() { key=0; }
 		Segment(int p_from,int p_to) {
@@ -89,7 +78,16 @@ class AStar: public Reference {
 
 	Set<Segment> segments;
 
-	bool _solve(Point *begin_point, Point *end_point);
+	AStarSearch *search;
+
+	struct Batch;
+
+	_FORCE_INLINE_ int _get_index(int p_id) const { const int *idx=point_index.getptr(p_id); return idx?*idx:-1; }
+
+	bool _solve(AStarSearch *p_search,int p_from,int p_to) const;
+	void _get_path(AStarSearch *p_search,int p_from,int p_to,Vector<int>& r_path) const;
+	void _solve_batch(const IntArray& p_from_ids,const IntArray& p_to_ids,bool p_parallel,Vector< Vector<int> >& r_paths);
+	static void _batch_job(void *p_userdata,uint32_t p_index);
 
 protected:
 
@@ -116,8 +114,67 @@ public:
 	DVector<Vector3> get_point_path(int p_from_id, int p_to_id);
 	DVector<int> get_id_path(int p_from_id, int p_to_id);
 
+	Array get_point_paths(const IntArray& p_from_ids, const IntArray& p_to_ids,bool p_parallel=false);
+	Array get_id_paths(const IntArray& p_from_ids, const IntArray& p_to_ids,bool p_parallel=false);
+
 	AStar();
 	~AStar();
 };
 
+/**
+ * A* over a uniform grid of cells, which are either free or solid. Moving
+ * diagonally costs sqrt(2) and is only allowed when both cells next to the
+ * corner are free. Jump point search skips most of the cells on open ground
+ * and finds paths of the same length; it needs diagonal movement.
+ */
+
+class AStarGrid: public Reference {
+
+	OBJ_TYPE(AStarGrid,Reference)
+
+	int width;
+	int height;
+	Vector<uint8_t> solid;
+
+	bool diagonal;
+	bool jumping;
+
+	AStarSearch *search;
+
+	struct Batch;
+
+	_FORCE_INLINE_ bool _is_free(int p_x,int p_y) const { return p_x>=0 && p_y>=0 && p_x<width && p_y<height && !solid.ptr()[p_y*width+p_x]; }
+	_FORCE_INLINE_ float _heuristic(int p_x,int p_y,int p_to_x,int p_to_y) const;
+
+	int _jump(int p_x,int p_y,int p_dx,int p_dy,int p_to_x,int p_to_y) const;
+	bool _solve(AStarSearch *p_search,int p_from,int p_to) const;
+	void _get_path(AStarSearch *p_search,int p_from,int p_to,Vector<Vector2>& r_path) const;
+	static void _batch_job(void *p_userdata,uint32_t p_index);
+
+protected:
+
+	static void _bind_methods();
+public:
+
+	void set_size(const Vector2& p_size);
+	Vector2 get_size() const;
+
+	void set_solid(const Vector2& p_cell,bool p_solid);
+	bool is_solid(const Vector2& p_cell) const;
+
+	void set_diagonal_enabled(bool p_enable);
+	bool is_diagonal_enabled() const;
+
+	void set_jumping_enabled(bool p_enable);
+	bool is_jumping_enabled() const;
+
+	void clear();
+
+	Vector2Array get_path(const Vector2& p_from,const Vector2& p_to);
+	Array get_paths(const Vector2Array& p_from,const Vector2Array& p_to,bool p_parallel=false);
+
+	AStarGrid();
+	~AStarGrid();
+};
+
 #endif // ASTAR_H
@@ -52,6 +52,12 @@ public:
 	typedef void* (*PairCallback)(void*,OctreeElementID, T*,int,OctreeElementID, T*,int);
 	typedef void (*UnpairCallback)(void*,OctreeElementID, T*,int,OctreeElementID, T*,int,void*);
 
+	struct CullCandidate {
+
+		T *userdata;
+		const AABB *aabb;
+	};
+
 private:
 	enum {
 
@@ -356,6 +362,7 @@ private:
 	};
 
 	void _cull_convex(Octant *p_octant,_CullConvexData *p_cull);
+	void _cull_convex_candidates(Octant *p_octant,_CullConvexData *p_cull,CullCandidate *p_candidates);
 	void _cull_AABB(Octant *p_octant,const AABB& p_aabb, T** p_result_array,int *p_result_idx,int p_result_max,int *p_subindex_array,uint32_t p_mask);
 	void _cull_segment(Octant *p_octant,const Vector3& p_from, const Vector3& p_to,T** p_result_array,int *p_result_idx,int p_result_max,int *p_subindex_array,uint32_t p_mask);
 	void _cull_point(Octant *p_octant,const Vector3& p_point,T** p_result_array,int *p_result_idx,int p_result_max,int *p_subindex_array,uint32_t p_mask);
@@ -385,6 +392,7 @@ public:
 	int get_subindex(OctreeElementID p_id) const;
 
 	int cull_convex(const Vector<Plane>& p_convex,T** p_result_array,int p_result_max,uint32_t p_mask=0xFFFFFFFF);
+	int cull_convex_candidates(const Vector<Plane>& p_convex,Vector<CullCandidate>& r_candidates,uint32_t p_mask=0xFFFFFFFF);
 	int cull_AABB(const AABB& p_aabb,T** p_result_array,int p_result_max,int *p_subindex_array=NULL,uint32_t p_mask=0xFFFFFFFF);
 	int cull_segment(const Vector3& p_from, const Vector3& p_to,T** p_result_array,int p_result_max,int *p_subindex_array=NULL,uint32_t p_mask=0xFFFFFFFF);
 
@@ -1128,6 +1136,55 @@ void Octree<T,use_pairs,AL>::_cull_convex(Octant *p_octant,_CullConvexData *p_cu
 }
 
 
+template<class T,bool use_pairs,class AL>
+void Octree<T,use_pairs,AL>::_cull_convex_candidates(Octant *p_octant,_CullConvexData *p_cull,CullCandidate *p_candidates) {
+
+	if (!p_octant->elements.empty()) {
+
+		typename List< Element*,AL >::Element *I;
+		I=p_octant->elements.front();
+
+		for(;I;I=I->next()) {
+
+			Element *e=I->get();
+
+			if (e->last_pass==pass || (use_pairs && !(e->pairable_type&p_cull->mask)))
+				continue;
+			e->last_pass=pass;
+
+			p_candidates[*p_cull->result_idx].userdata=e->userdata;
+			p_candidates[*p_cull->result_idx].aabb=&e->aabb;
+			(*p_cull->result_idx)++;
+		}
+	}
+
+	if (use_pairs && !p_octant->pairable_elements.empty()) {
+
+		typename List< Element*,AL >::Element *I;
+		I=p_octant->pairable_elements.front();
+
+		for(;I;I=I->next()) {
+
+			Element *e=I->get();
+
+			if (e->last_pass==pass || (use_pairs && !(e->pairable_type&p_cull->mask)))
+				continue;
+			e->last_pass=pass;
+
+			p_candidates[*p_cull->result_idx].userdata=e->userdata;
+			p_candidates[*p_cull->result_idx].aabb=&e->aabb;
+			(*p_cull->result_idx)++;
+		}
+	}
+
+	for (int i=0;i<8;i++) {
+
+		if (p_octant->children[i] && p_octant->children[i]->aabb.intersects_convex_shape(p_cull->planes,p_cull->plane_count)) {
+			_cull_convex_candidates(p_octant->children[i],p_cull,p_candidates);
+		}
+	}
+}
+
 template<class T,bool use_pairs,class AL>
 void Octree<T,use_pairs,AL>::_cull_AABB(Octant *p_octant,const AABB& p_aabb, T** p_result_array,int *p_result_idx,int p_result_max,int *p_subindex_array,uint32_t p_mask) {
 
@@ -1375,6 +1432,33 @@ int Octree<T,use_pairs,AL>::cull_convex(const Vector<Plane>& p_convex,T** p_resu
 
 
 
+/* Gathers the elements of the octants touching the convex, in the same order
+ * cull_convex() visits them, but leaves the per element test to the caller so
+ * it can be split across threads. The AABB pointers stay valid until the
+ * octree is modified. */
+template<class T,bool use_pairs,class AL>
+int Octree<T,use_pairs,AL>::cull_convex_candidates(const Vector<Plane>& p_convex,Vector<CullCandidate>& r_candidates,uint32_t p_mask) {
+
+	if (!root)
+		return 0;
+
+	r_candidates.resize(element_map.size());
+
+	int result_count=0;
+	pass++;
+	_CullConvexData cdata;
+	cdata.planes=&p_convex[0];
+	cdata.plane_count=p_convex.size();
+	cdata.result_array=NULL;
+	cdata.result_max=r_candidates.size();
+	cdata.result_idx=&result_count;
+	cdata.mask=p_mask;
+
+	_cull_convex_candidates(root,&cdata,r_candidates.ptr());
+
+	return result_count;
+}
+
 template<class T,bool use_pairs,class AL>
 int Octree<T,use_pairs,AL>::cull_AABB(const AABB& p_aabb,T** p_result_array,int p_result_max,int *p_subindex_array,uint32_t p_mask) {
 
@@ -53,10 +53,16 @@ struct _ObjectDebugLock {
 
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
+#define OBJ_WRITE_CHECK(m_name) if (write_check_func) write_check_func(this,m_name);
+
+Object::WriteCheckFunc Object::write_check_func=NULL;
+
 #else
 
 #define OBJ_DEBUG_LOCK
 
+#define OBJ_WRITE_CHECK(m_name)
+
 #endif
 
 
@@ -338,6 +344,9 @@ Object::Connection::Connection(const Variant& p_variant) {
 
 bool Object::_predelete() {
 
+	if (!_can_delete_now())
+		return false;
+
 	_predelete_ok=1;
 	notification(NOTIFICATION_PREDELETE,true);
 	if (_predelete_ok) {
@@ -392,6 +401,8 @@ void Object::set(const String& p_name, const Variant& p_value) {
 
 void Object::set(const StringName& p_name, const Variant& p_value, bool *r_valid) {
 
+	OBJ_WRITE_CHECK(p_name);
+
 #ifdef TOOLS_ENABLED
 
 	_edited=true;
@@ -945,6 +956,7 @@ Variant Object::call(const StringName& p_method,const Variant** p_args,int p_arg
 		}
 
 #endif
+		OBJ_WRITE_CHECK(p_method);
 		//must be here, must be before everything,
 		memdelete(this);
 		r_error.error=Variant::CallError::CALL_OK;
@@ -975,6 +987,9 @@ Variant Object::call(const StringName& p_method,const Variant** p_args,int p_arg
 
 	if (method) {
 
+		if (!method->is_const()) {
+			OBJ_WRITE_CHECK(p_method);
+		}
 		ret=method->call(this,p_args,p_argcount,r_error);
 	} else {
 		r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
@@ -984,6 +999,41 @@ Variant Object::call(const StringName& p_method,const Variant** p_args,int p_arg
 }
 
 
+Variant Object::call_method_bind(MethodBind *p_method,const Variant** p_args,int p_argcount,Variant::CallError &r_error) {
+
+	r_error.error=Variant::CallError::CALL_OK;
+	OBJ_DEBUG_LOCK
+	if (!p_method->is_const()) {
+		OBJ_WRITE_CHECK(p_method->get_name());
+	}
+	return p_method->call(this,p_args,p_argcount,r_error);
+}
+
+void Object::set_property_bind(MethodBind *p_setter,int p_index,const Variant& p_value,bool *r_valid) {
+
+	OBJ_WRITE_CHECK(p_setter->get_name());
+
+#ifdef TOOLS_ENABLED
+
+	_edited=true;
+#endif
+
+	Variant::CallError ce;
+	ce.error=Variant::CallError::CALL_OK;
+
+	if (p_index>=0) {
+		Variant index=p_index;
+		const Variant* arg[2]={&index,&p_value};
+		p_setter->call(this,arg,2,ce);
+	} else {
+		const Variant* arg[1]={&p_value};
+		p_setter->call(this,arg,1,ce);
+	}
+
+	if (r_valid)
+		*r_valid=ce.error==Variant::CallError::CALL_OK;
+}
+
 void Object::notification(int p_notification,bool p_reversed) {
 
 
@@ -1152,14 +1202,6 @@ bool Object::_has_user_signal(const StringName& p_name) const {
 	return signal_map[p_name].user.name.length()>0;
 }
 
-struct _ObjectSignalDisconnectData {
-
-	StringName signal;
-	Object *target;
-	StringName method;
-
-};
-
 #if 0
 void Object::_emit_signal(const StringName& p_name,const Array& p_pargs){
 
@@ -1208,6 +1250,8 @@ Variant Object::_emit_signal(const Variant** p_args, int p_argcount, Variant::Ca
 }
 
 
+#define EMIT_SIGNAL_BIND_STACK_MAX 16
+
 void Object::emit_signal(const StringName& p_name,const Variant** p_args,int p_argcount) {
 
 	if (_block_signals)
@@ -1228,20 +1272,20 @@ void Object::emit_signal(const StringName& p_name,const Variant** p_args,int p_a
 	}
 
 
-	List<_ObjectSignalDisconnectData> disconnect_data;
-
-
-	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Signal::Target,Signal::Slot> slot_map = s->slot_map;
+	//the snapshot shares the slot array by reference count and is only read
+	//through const access, so emitting never copies it. If a callee connects
+	//or disconnects, copy on write gives the signal a new array instead.
+	const VMap<Signal::Target,Signal::Slot> slot_map = s->slot_map;
 
 	int ssize = slot_map.size();
 
 	OBJ_DEBUG_LOCK
 
-	Vector<const Variant*> bind_mem;
+	//arguments plus binds are assembled on the stack unless there are many binds
+	const Variant *bind_stack[EMIT_SIGNAL_BIND_STACK_MAX];
+	Vector<const Variant*> bind_heap;
 
+	bool has_oneshot=false;
 
 	for(int i=0;i<ssize;i++) {
 
@@ -1261,17 +1305,21 @@ void Object::emit_signal(const StringName& p_name,const Variant** p_args,int p_a
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount+c.binds.size());
+			argc=p_argcount+c.binds.size();
+
+			if (argc<=EMIT_SIGNAL_BIND_STACK_MAX) {
+				args=bind_stack;
+			} else {
+				bind_heap.resize(argc);
+				args=bind_heap.ptr();
+			}
 
 			for(int j=0;j<p_argcount;j++) {
-				bind_mem[j]=p_args[j];
+				args[j]=p_args[j];
 			}
 			for(int j=0;j<c.binds.size();j++) {
-				bind_mem[p_argcount+j]=&c.binds[j];
+				args[p_argcount+j]=&c.binds[j];
 			}
-
-			args=bind_mem.ptr();
-			argc=bind_mem.size();
 		}
 
 		if (c.flags&CONNECT_DEFERRED) {
@@ -1290,21 +1338,24 @@ void Object::emit_signal(const StringName& p_name,const Variant** p_args,int p_a
 		}
 
 		if (c.flags&CONNECT_ONESHOT) {
-			_ObjectSignalDisconnectData dd;
-			dd.signal=p_name;
-			dd.target=target;
-			dd.method=c.method;
-			disconnect_data.push_back(dd);
+			has_oneshot=true;
 		}
 
 	}
 
+	if (!has_oneshot)
+		return;
+
+	//oneshot connections are removed once all slots ran, walking the snapshot again
+	for(int i=0;i<ssize;i++) {
 
-	while (!disconnect_data.empty()) {
+		const Connection &c = slot_map.getv(i).conn;
+		if (!(c.flags&CONNECT_ONESHOT))
+			continue;
 
-		const _ObjectSignalDisconnectData &dd = disconnect_data.front()->get();
-		disconnect(dd.signal,dd.target,dd.method);
-		disconnect_data.pop_front();
+		Object *target = ObjectDB::get_instance(slot_map.getk(i)._id);
+		if (target && is_connected(p_name,target,c.method))
+			disconnect(p_name,target,c.method);
 	}
 
 }
@@ -335,6 +335,7 @@ virtual String get_save_type() const { return #m_type; }\
 private:
 
 class ScriptInstance;
+class MethodBind;
 typedef uint32_t ObjectID;
 
 class Object {
@@ -464,6 +465,7 @@ protected:
 
 
 	void cancel_delete();
+	virtual bool _can_delete_now() { return true; } // false keeps the object alive, checked before NOTIFICATION_PREDELETE
 
 	virtual void _changed_callback(Object *p_changed,const char *p_prop);
 
@@ -591,6 +593,16 @@ public:
 	Variant call(const StringName& p_name, VARIANT_ARG_LIST); // C++ helper
 	void call_multilevel(const StringName& p_name, VARIANT_ARG_LIST); // C++ helper
 
+	// used by script VMs that already resolved a method or setter of this object's type, skip the lookups done by call() and set()
+	Variant call_method_bind(MethodBind *p_method,const Variant** p_args,int p_argcount,Variant::CallError &r_error);
+	void set_property_bind(MethodBind *p_setter,int p_index,const Variant& p_value,bool *r_valid=NULL);
+
+#ifdef DEBUG_ENABLED
+	// when set, called with the object and the property or method name before set(), a call to a non const method or free() modify an object
+	typedef void (*WriteCheckFunc)(Object *p_object,const StringName& p_name);
+	static WriteCheckFunc write_check_func;
+#endif
+
 	void notification(int p_notification,bool p_reversed=false);
 
 	//used mainly by script, get and set all INCLUDING string
@@ -925,6 +925,24 @@ bool ObjectTypeDB::get_property(Object* p_object,const StringName& p_property, V
 	return false;
 }
 
+const ObjectTypeDB::PropertySetGet* ObjectTypeDB::get_property_setget(const StringName& p_type, const StringName& p_property) {
+
+	TypeInfo *type=types.getptr(p_type);
+	TypeInfo *check=type;
+	while(check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg)
+			return psg;
+
+		if (check->constant_map.has(p_property))
+			return NULL; //get_property() finds the constant first
+
+		check=check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 Variant::Type ObjectTypeDB::get_property_type(const StringName& p_type, const StringName& p_property,bool *r_is_valid) {
 
 	TypeInfo *type=types.getptr(p_type);
@@ -481,6 +481,7 @@ public:
 	static bool set_property(Object* p_object, const StringName& p_property, const Variant& p_value, bool *r_valid=NULL);
 	static bool get_property(Object* p_object,const StringName& p_property, Variant& r_value);
 	static Variant::Type get_property_type(const StringName& p_type, const StringName& p_property,bool *r_is_valid=NULL);
+	static const PropertySetGet* get_property_setget(const StringName& p_type, const StringName& p_property);
 
 
 
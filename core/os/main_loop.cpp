@@ -56,6 +56,11 @@ void MainLoop::_bind_methods() {
 
 };
 
+bool MainLoop::queue_signal_resume(const StringName& p_signal,const Ref<Reference>& p_state) {
+
+	return false;
+}
+
 void MainLoop::set_init_script(const Ref<Script>& p_init_script) {
 
 	init_script=p_init_script;
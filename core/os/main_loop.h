@@ -66,6 +66,10 @@ public:
 
 	virtual void drop_files(const Vector<String>& p_files,int p_from_screen=0);
 
+	// a script waiting for a signal of the main loop can hand over its state instead of
+	// connecting, resume() is called on it right after the signal. false if not batched.
+	virtual bool queue_signal_resume(const StringName& p_signal,const Ref<Reference>& p_state);
+
 	void set_init_script(const Ref<Script>& p_init_script);
 
 	MainLoop();
@@ -61,6 +61,8 @@ public:
 
 	virtual void dump_mem_to_file(const char* p_file)=0;
 
+	virtual void thread_exit() {} ///< Called by threads before they finish, pools with per thread data can release it here
+
 	MemoryPoolStatic();
 	virtual ~MemoryPoolStatic();
 
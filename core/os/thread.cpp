@@ -33,6 +33,7 @@ Thread* (*Thread::create_func)(ThreadCreateCallback,void *,const Settings&)=NULL
 Thread::ID (*Thread::get_thread_ID_func)()=NULL;
 void (*Thread::wait_to_finish_func)(Thread*)=NULL;
 Error (*Thread::set_name_func)(const String&)=NULL;
+Error (*Thread::set_affinity_func)(int)=NULL;
 
 Thread::ID Thread::_main_thread_id=0;
 
@@ -67,6 +68,14 @@ Error Thread::set_name(const String &p_name) {
 	return ERR_UNAVAILABLE;
 };
 
+Error Thread::set_affinity(int p_core) {
+
+	if (set_affinity_func)
+		return set_affinity_func(p_core);
+
+	return ERR_UNAVAILABLE;
+}
+
 Thread::Thread()
 {
 }
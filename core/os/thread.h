@@ -66,6 +66,7 @@ protected:
 	static ID (*get_thread_ID_func)();
 	static void (*wait_to_finish_func)(Thread*);
 	static Error (*set_name_func)(const String&);
+	static Error (*set_affinity_func)(int);
 
 	friend class Main;
 
@@ -78,6 +79,7 @@ public:
 	virtual ID get_ID() const=0;
 
 	static Error set_name(const String &p_name);
+	static Error set_affinity(int p_core); ///< pin the caller thread to a processor core
 	_FORCE_INLINE_ static ID get_main_ID() { return _main_thread_id; } ///< get the ID of the main thread
 	static ID get_caller_ID(); ///< get the ID of the caller function ID
 	static void wait_to_finish(Thread *p_thread); ///< waits until thread is finished, and deallocates it.
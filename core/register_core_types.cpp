@@ -154,6 +154,7 @@ void register_core_types() {
 	ObjectTypeDB::register_type<PackedDataContainer>();
 	ObjectTypeDB::register_virtual_type<PackedDataContainerRef>();
 	ObjectTypeDB::register_type<AStar>();
+	ObjectTypeDB::register_type<AStarGrid>();
 
 	ip = IP::create();
 
@@ -226,6 +227,8 @@ void unregister_core_types() {
 	CoreStringNames::free();
 	StringName::cleanup();
 
+	Variant::release_thread_pools();
+
 	if (_global_mutex) {
 		memdelete(_global_mutex);
 		_global_mutex=NULL; //still needed at a few places
@@ -35,6 +35,8 @@
 #include "os/memory.h"
 #include "hash_map.h"
 #include "list.h"
+#include "vector.h"
+#include "os/mutex.h"
 
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
@@ -47,6 +49,7 @@ typedef uint32_t ID;
 class RID {
 friend class RID_OwnerBase;
 	ID _id;
+	uint32_t _index;
 	RID_OwnerBase *owner;
 public:
 
@@ -79,6 +82,7 @@ public:
 
 	_FORCE_INLINE_ RID() {
 		_id = 0;
+		_index = 0;
 		owner=0;
 	}
 };
@@ -88,6 +92,8 @@ class RID_OwnerBase {
 protected:
 friend class RID;
 	void set_id(RID& p_rid, ID p_id) const { p_rid._id=p_id; }
+	void set_index(RID& p_rid, uint32_t p_index) const { p_rid._index=p_index; }
+	_FORCE_INLINE_ static uint32_t get_index(const RID& p_rid) { return p_rid._index; }
 	void set_ownage(RID& p_rid) const { p_rid.owner=const_cast<RID_OwnerBase*>(this); }
 	ID new_ID();
 public:
@@ -100,6 +106,18 @@ public:
 	virtual ~RID_OwnerBase() {}
 };
 
+/**
+ * Slot map. Data lives in fixed size chunks of slots that never move, and
+ * every RID carries the index of its slot next to its ID, so lookups are a
+ * direct array access. IDs are still unique across all owners and are never
+ * reused, so the ID stored in the slot doubles as the generation: a stale RID
+ * (freed, or whose slot was recycled) simply fails to match.
+ *
+ * When thread_safe is true, only make_rid, free and get_owned_list lock.
+ * get and owns read without locking: chunks are never freed or moved and
+ * replaced chunk tables are kept alive until the owner is destroyed.
+ */
+
 template<class T,bool thread_safe=false>
 class RID_Owner : public RID_OwnerBase {
 public:
@@ -107,8 +125,63 @@ public:
 	typedef void (*ReleaseNotifyFunc)(void*user,T *p_data);
 private:
 
+	enum {
+		CHUNK_SHIFT=8,
+		CHUNK_SIZE=1<<CHUNK_SHIFT,
+		CHUNK_MASK=CHUNK_SIZE-1,
+		FREE_LIST_END=0xFFFFFFFF
+	};
+
+	struct Slot {
+
+		volatile ID id; // 0 when free
+		uint32_t next_free;
+		T *data;
+	};
+
 	Mutex *mutex;
-	mutable HashMap<ID,T*> id_map;
+	Slot ** volatile chunks;
+	volatile uint32_t slot_count;
+	uint32_t chunk_table_size;
+	uint32_t free_list;
+	Vector<Slot**> retired_tables;
+
+	void _grow() {
+
+		uint32_t chunk_count = slot_count>>CHUNK_SHIFT;
+
+		if (chunk_count==chunk_table_size) {
+
+			uint32_t new_size = chunk_table_size ? chunk_table_size*2 : 4;
+			Slot **new_table = (Slot**)memalloc(sizeof(Slot*)*new_size);
+			for(uint32_t i=0;i<chunk_count;i++)
+				new_table[i]=chunks[i];
+
+			if (chunks)
+				retired_tables.push_back(chunks); // lock-free readers may still hold it
+			chunks=new_table;
+			chunk_table_size=new_size;
+		}
+
+		Slot *chunk = (Slot*)memalloc(sizeof(Slot)*CHUNK_SIZE);
+		for(uint32_t i=0;i<CHUNK_SIZE;i++) {
+			chunk[i].id=0;
+			chunk[i].next_free=FREE_LIST_END;
+			chunk[i].data=NULL;
+		}
+		chunks[chunk_count]=chunk;
+	}
+
+	_FORCE_INLINE_ Slot* _get_slot(const RID& p_rid) const {
+
+		uint32_t idx = get_index(p_rid);
+		if (idx>=slot_count)
+			return NULL;
+		Slot *slot = &chunks[idx>>CHUNK_SHIFT][idx&CHUNK_MASK];
+		if (slot->id!=p_rid.get_id() || slot->id==0)
+			return NULL;
+		return slot;
+	}
 
 public:
 
@@ -118,10 +191,29 @@ public:
 			mutex->lock();
 		}
 
+		uint32_t idx;
+		if (free_list!=FREE_LIST_END) {
+
+			idx=free_list;
+			free_list=chunks[idx>>CHUNK_SHIFT][idx&CHUNK_MASK].next_free;
+		} else {
+
+			if ((slot_count&CHUNK_MASK)==0)
+				_grow();
+			idx=slot_count;
+		}
+
+		Slot &slot=chunks[idx>>CHUNK_SHIFT][idx&CHUNK_MASK];
 		ID id = new_ID();
-		id_map[id]=p_data;
+		slot.data=p_data;
+		slot.next_free=FREE_LIST_END;
+		slot.id=id;
+		if (idx==slot_count)
+			slot_count++;
+
 		RID rid;
 		set_id(rid,id);
+		set_index(rid,idx);
 		set_ownage(rid);
 
 		if (thread_safe) {
@@ -133,44 +225,39 @@ public:
 
 	_FORCE_INLINE_ T * get(const RID& p_rid) {
 
-		if (thread_safe) {
-			mutex->lock();
-		}
-
-		T**elem = id_map.getptr(p_rid.get_id());
-
-		if (thread_safe) {
-			mutex->unlock();
-		}
+		Slot *slot = _get_slot(p_rid);
 
-		ERR_FAIL_COND_V(!elem,NULL);
+		ERR_FAIL_COND_V(!slot,NULL);
 
-		return *elem;
+		return slot->data;
 
 	}
 
 	virtual bool owns(const RID& p_rid) const {
 
-		if (thread_safe) {
-			mutex->lock();
-		}
+		return _get_slot(p_rid)!=NULL;
+	}
 
-		T**elem = id_map.getptr(p_rid.get_id());
+	virtual void free(RID p_rid) {
 
 		if (thread_safe) {
 			mutex->lock();
 		}
 
-		return elem!=NULL;
-	}
+		Slot *slot = _get_slot(p_rid);
 
-	virtual void free(RID p_rid) {
+		if (slot) {
+			slot->id=0;
+			slot->data=NULL;
+			slot->next_free=free_list;
+			free_list=get_index(p_rid);
+		}
 
 		if (thread_safe) {
-			mutex->lock();
+			mutex->unlock();
 		}
-		ERR_FAIL_COND(!owns(p_rid));
-		id_map.erase(p_rid.get_id());
+
+		ERR_FAIL_COND(!slot);
 	}
 	virtual void get_owned_list(List<RID> *p_owned) const {
 
@@ -178,23 +265,32 @@ public:
 			mutex->lock();
 		}
 
-		const ID*id=NULL;
-		while((id=id_map.next(id))) {
+		for(uint32_t i=0;i<slot_count;i++) {
+
+			const Slot &slot=chunks[i>>CHUNK_SHIFT][i&CHUNK_MASK];
+			if (slot.id==0)
+				continue;
 
 			RID rid;
-			set_id(rid,*id);
+			set_id(rid,slot.id);
+			set_index(rid,i);
 			set_ownage(rid);
 			p_owned->push_back(rid);
 
 		}
 
 		if (thread_safe) {
-			mutex->lock();
+			mutex->unlock();
 		}
 
 	}
 	RID_Owner() {
 
+		chunks=NULL;
+		slot_count=0;
+		chunk_table_size=0;
+		free_list=FREE_LIST_END;
+
 		if (thread_safe) {
 
 			mutex = Mutex::create();
@@ -205,6 +301,14 @@ public:
 
 	~RID_Owner() {
 
+		uint32_t chunk_count = (slot_count+CHUNK_MASK)>>CHUNK_SHIFT;
+		for(uint32_t i=0;i<chunk_count;i++)
+			memfree(chunks[i]);
+		if (chunks)
+			memfree(chunks);
+		for(int i=0;i<retired_tables.size();i++)
+			memfree(retired_tables[i]);
+
 		if (thread_safe) {
 
 			memdelete(mutex);
@@ -52,4 +52,20 @@ long atomic_decrement( register long * pw ) {
 	return InterlockedDecrement( pw );
 }
 
+#ifndef NO_THREADS
+
+uint32_t atomic_increment(volatile uint32_t *pw) {
+	return InterlockedIncrement( (LONG volatile*)pw );
+}
+
+uint32_t atomic_decrement(volatile uint32_t *pw) {
+	return InterlockedDecrement( (LONG volatile*)pw );
+}
+
+uint32_t atomic_add(volatile uint32_t *pw, uint32_t p_value) {
+	return InterlockedExchangeAdd( (LONG volatile*)pw, p_value ) + p_value;
+}
+
+#endif
+
 #endif
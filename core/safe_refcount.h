@@ -30,6 +30,7 @@
 #define SAFE_REFCOUNT_H
 
 #include "os/mutex.h"
+#include "typedefs.h"
 /* x86/x86_64 GCC */
 
 #include "platform_config.h"
@@ -376,4 +377,29 @@ public:
 
 #endif // no thread safe
 
+
+/* Plain atomic counters, for code that distributes work between threads
+   without taking a mutex. They return the new value and act as full
+   memory barriers. */
+
+#if defined( NO_THREADS )
+
+_FORCE_INLINE_ uint32_t atomic_increment(volatile uint32_t *pw) { return ++(*pw); }
+_FORCE_INLINE_ uint32_t atomic_decrement(volatile uint32_t *pw) { return --(*pw); }
+_FORCE_INLINE_ uint32_t atomic_add(volatile uint32_t *pw, uint32_t p_value) { return (*pw)+=p_value; }
+
+#elif defined( __GNUC__ )
+
+_FORCE_INLINE_ uint32_t atomic_increment(volatile uint32_t *pw) { return __sync_add_and_fetch(pw,1); }
+_FORCE_INLINE_ uint32_t atomic_decrement(volatile uint32_t *pw) { return __sync_sub_and_fetch(pw,1); }
+_FORCE_INLINE_ uint32_t atomic_add(volatile uint32_t *pw, uint32_t p_value) { return __sync_add_and_fetch(pw,p_value); }
+
+#else
+
+uint32_t atomic_increment(volatile uint32_t *pw);
+uint32_t atomic_decrement(volatile uint32_t *pw);
+uint32_t atomic_add(volatile uint32_t *pw, uint32_t p_value);
+
+#endif
+
 #endif
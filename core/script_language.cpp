@@ -27,12 +27,14 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "script_language.h"
+#include "safe_refcount.h"
 
 ScriptLanguage *ScriptServer::_languages[MAX_LANGUAGES];
 int ScriptServer::_language_count=0;
 
 bool ScriptServer::scripting_enabled=true;
 bool ScriptServer::reload_scripts_on_save=false;
+volatile uint32_t ScriptServer::threaded_calls=0;
 ScriptEditRequestFunction ScriptServer::edit_request_func=NULL;
 
 void Script::_notification( int p_what) {
@@ -129,7 +131,17 @@ void ScriptServer::thread_exit() {
 	for(int i=0;i<_language_count;i++) {
 		_languages[i]->thread_exit();
 	}
+}
+
+void ScriptServer::begin_threaded_calls() {
+
+	atomic_increment(&threaded_calls);
+}
+
+void ScriptServer::end_threaded_calls() {
 
+	ERR_FAIL_COND(threaded_calls==0);
+	atomic_decrement(&threaded_calls);
 }
 
 
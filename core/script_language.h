@@ -50,6 +50,7 @@ class ScriptServer {
 	static int _language_count;
 	static bool scripting_enabled;
 	static bool reload_scripts_on_save;
+	static volatile uint32_t threaded_calls;
 public:
 
 	static ScriptEditRequestFunction edit_request_func;
@@ -67,6 +68,11 @@ public:
 	static void thread_enter();
 	static void thread_exit();
 
+	// between these, scripts may run on several threads at once
+	static void begin_threaded_calls();
+	static void end_threaded_calls();
+	static _FORCE_INLINE_ bool is_calling_threaded() { return threaded_calls>0; }
+
 	static void init_languages();
 };
 
@@ -278,6 +284,21 @@ public:
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr,int p_info_max)=0;
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_info_max)=0;
 
+	struct SampledLineInfo {
+		String source;
+		StringName function;
+		int line;
+		uint64_t self_samples; // the line was running
+		uint64_t total_samples; // the line was anywhere in the call stack
+	};
+
+	// sampling profiler, a thread records what the main thread is running every p_interval_usec
+	virtual void sampling_start(int p_interval_usec) {}
+	virtual void sampling_stop() {}
+	virtual uint64_t sampling_get_sample_count() const { return 0; } // includes samples taken while no script was running
+	virtual int sampling_get_line_data(SampledLineInfo *p_info_arr,int p_info_max) { return 0; } // by self samples, highest first
+	virtual String sampling_get_collapsed_stacks() { return String(); } // "frame;frame;frame count" lines, as read by flamegraph.pl
+
 
 	virtual void frame();
 
@@ -0,0 +1,90 @@
+/*************************************************************************/
+/*  thread_free_list.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef THREAD_FREE_LIST_H
+#define THREAD_FREE_LIST_H
+
+#include "os/memory.h"
+
+/* Small per thread free lists, for memory blocks that are allocated and released very
+   often. Declare one at file scope with THREAD_FREE_LIST_LOCAL (it starts zeroed), each
+   slot keeps blocks of one size. Blocks that don't fit go back to the allocator, and
+   threads call release() before they finish. THREAD_FREE_LIST_ENABLED is only defined
+   where thread local storage is available, allocate directly otherwise. */
+
+#ifdef NO_THREADS
+#define THREAD_FREE_LIST_ENABLED
+#define THREAD_FREE_LIST_LOCAL
+#elif defined(__GNUC__)
+#define THREAD_FREE_LIST_ENABLED
+#define THREAD_FREE_LIST_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREAD_FREE_LIST_ENABLED
+#define THREAD_FREE_LIST_LOCAL __declspec(thread)
+#endif
+
+template<int SLOTS,int CACHE_SIZE>
+struct ThreadFreeList {
+
+	void *free_list[SLOTS];
+	uint32_t free_count[SLOTS];
+	bool released;
+
+	_FORCE_INLINE_ void *pop(int p_slot) {
+
+		void *mem=free_list[p_slot];
+		if (mem) {
+			free_list[p_slot]=*(void**)mem;
+			free_count[p_slot]--;
+		}
+		return mem;
+	}
+
+	// false if the block has to go back to the allocator
+	_FORCE_INLINE_ bool push(int p_slot,void *p_mem) {
+
+		if (released || free_count[p_slot]>=CACHE_SIZE)
+			return false;
+
+		*(void**)p_mem=free_list[p_slot];
+		free_list[p_slot]=p_mem;
+		free_count[p_slot]++;
+		return true;
+	}
+
+	void release() {
+
+		for(int i=0;i<SLOTS;i++) {
+			while(free_list[i])
+				memfree(pop(i));
+		}
+		released=true; // blocks freed later by this thread go straight back to the allocator
+	}
+};
+
+#endif // THREAD_FREE_LIST_H
@@ -34,6 +34,55 @@
 #include "io/marshalls.h"
 #include "core_string_names.h"
 #include "variant_parser.h"
+#include "thread_free_list.h"
+
+/* Matrix32, AABB, Matrix3, Transform and InputEvent don't fit in _data._mem,
+   so their storage is recycled through small per thread free lists instead of
+   going to the allocator every time a Variant holding one is copied. */
+
+enum {
+	VARIANT_POOL_MATRIX32,
+	VARIANT_POOL_AABB,
+	VARIANT_POOL_MATRIX3,
+	VARIANT_POOL_TRANSFORM,
+	VARIANT_POOL_INPUT_EVENT,
+	VARIANT_POOL_MAX,
+	VARIANT_POOL_CACHE_SIZE=256 // blocks kept per type and thread
+};
+
+#ifdef THREAD_FREE_LIST_ENABLED
+static THREAD_FREE_LIST_LOCAL ThreadFreeList<VARIANT_POOL_MAX,VARIANT_POOL_CACHE_SIZE> _variant_pool_cache;
+#endif
+
+template<class T,int P>
+static _FORCE_INLINE_ T* _variant_pool_new(const T& p_from) {
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	void *mem=_variant_pool_cache.pop(P);
+	if (mem)
+		return memnew_placement(mem,T(p_from));
+#endif
+	return memnew(T(p_from));
+}
+
+template<class T,int P>
+static _FORCE_INLINE_ void _variant_pool_delete(T* p_ptr) {
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	p_ptr->~T();
+	if (!_variant_pool_cache.push(P,p_ptr))
+		memfree(p_ptr);
+#else
+	memdelete(p_ptr);
+#endif
+}
+
+void Variant::release_thread_pools() {
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	_variant_pool_cache.release();
+#endif
+}
 
 
 String Variant::get_type_name(Variant::Type p_type) {
@@ -944,6 +993,18 @@ void Variant::reference(const Variant& p_variant) {
 	if (this == &p_variant)
 		return;
 
+	if (type==p_variant.type) {
+		// same heap backed type, reuse the storage already owned
+		switch(type) {
+			case MATRIX32: *_data._matrix32=*p_variant._data._matrix32; return;
+			case _AABB: *_data._aabb=*p_variant._data._aabb; return;
+			case MATRIX3: *_data._matrix3=*p_variant._data._matrix3; return;
+			case TRANSFORM: *_data._transform=*p_variant._data._transform; return;
+			case INPUT_EVENT: *_data._input_event=*p_variant._data._input_event; return;
+			default: {}
+		}
+	}
+
 	clear();
 
 	type=p_variant.type;
@@ -989,7 +1050,7 @@ void Variant::reference(const Variant& p_variant) {
 		} break;
 		case MATRIX32: {
 
-			_data._matrix32 = memnew( Matrix32( *p_variant._data._matrix32 ) );
+			_data._matrix32=_variant_pool_new<Matrix32,VARIANT_POOL_MATRIX32>(*p_variant._data._matrix32);
 
 		} break;
 		case VECTOR3: {
@@ -1009,7 +1070,7 @@ void Variant::reference(const Variant& p_variant) {
 		} break;*/
 		case _AABB: {
 
-			_data._aabb = memnew( AABB( *p_variant._data._aabb ) );
+			_data._aabb=_variant_pool_new<AABB,VARIANT_POOL_AABB>(*p_variant._data._aabb);
 		} break;
 		case QUAT: {
 
@@ -1018,12 +1079,12 @@ void Variant::reference(const Variant& p_variant) {
 		} break;
 		case MATRIX3: {
 
-			_data._matrix3 = memnew( Matrix3( *p_variant._data._matrix3 ) );
+			_data._matrix3=_variant_pool_new<Matrix3,VARIANT_POOL_MATRIX3>(*p_variant._data._matrix3);
 
 		} break;
 		case TRANSFORM: {
 
-			_data._transform = memnew( Transform( *p_variant._data._transform ) );
+			_data._transform=_variant_pool_new<Transform,VARIANT_POOL_TRANSFORM>(*p_variant._data._transform);
 
 		} break;
 
@@ -1053,7 +1114,7 @@ void Variant::reference(const Variant& p_variant) {
 		} break;
 		case INPUT_EVENT: {
 
-			_data._input_event= memnew( InputEvent( *p_variant._data._input_event ) );
+			_data._input_event=_variant_pool_new<InputEvent,VARIANT_POOL_INPUT_EVENT>(*p_variant._data._input_event);
 
 		} break;
 		case DICTIONARY: {
@@ -1141,21 +1202,21 @@ void Variant::clear() {
 	*/
 		case MATRIX32: {
 
-			memdelete( _data._matrix32 );
+			_variant_pool_delete<Matrix32,VARIANT_POOL_MATRIX32>(_data._matrix32);
 
 		} break;
 		case _AABB: {
 
-			memdelete( _data._aabb );
+			_variant_pool_delete<AABB,VARIANT_POOL_AABB>(_data._aabb);
 
 		} break;
 		case MATRIX3: {
 
-			memdelete( _data._matrix3 );
+			_variant_pool_delete<Matrix3,VARIANT_POOL_MATRIX3>(_data._matrix3);
 		} break;
 		case TRANSFORM: {
 
-			memdelete( _data._transform );
+			_variant_pool_delete<Transform,VARIANT_POOL_TRANSFORM>(_data._transform);
 
 		} break;
 
@@ -1191,7 +1252,7 @@ void Variant::clear() {
 		} break;
 		case INPUT_EVENT: {
 
-			memdelete( _data._input_event );
+			_variant_pool_delete<InputEvent,VARIANT_POOL_INPUT_EVENT>(_data._input_event);
 
 		} break;
 
@@ -2323,13 +2384,13 @@ Variant::Variant(const Plane& p_plane) {
 Variant::Variant(const AABB& p_aabb) {
 
 	type=_AABB;
-	_data._aabb = memnew( AABB( p_aabb ) );
+	_data._aabb=_variant_pool_new<AABB,VARIANT_POOL_AABB>(p_aabb);
 }
 
 Variant::Variant(const Matrix3& p_matrix) {
 
 	type=MATRIX3;
-	_data._matrix3= memnew( Matrix3( p_matrix ) );
+	_data._matrix3=_variant_pool_new<Matrix3,VARIANT_POOL_MATRIX3>(p_matrix);
 
 }
 
@@ -2342,14 +2403,14 @@ Variant::Variant(const Quat& p_quat) {
 Variant::Variant(const Transform& p_transform) {
 
 	type=TRANSFORM;
-	_data._transform = memnew( Transform( p_transform ) );
+	_data._transform=_variant_pool_new<Transform,VARIANT_POOL_TRANSFORM>(p_transform);
 
 }
 
 Variant::Variant(const Matrix32& p_transform) {
 
 	type=MATRIX32;
-	_data._matrix32 = memnew( Matrix32( p_transform ) );
+	_data._matrix32=_variant_pool_new<Matrix32,VARIANT_POOL_MATRIX32>(p_transform);
 
 }
 Variant::Variant(const Color& p_color) {
@@ -2375,7 +2436,7 @@ Variant::Variant(const NodePath& p_node_path) {
 Variant::Variant(const InputEvent& p_input_event) {
 
 	type=INPUT_EVENT;
-	_data._input_event = memnew( InputEvent(p_input_event) );
+	_data._input_event=_variant_pool_new<InputEvent,VARIANT_POOL_INPUT_EVENT>(p_input_event);
 
 }
 
@@ -176,6 +176,17 @@ public:
 	}
 
 
+	// unchecked access to simple types, for script VMs that already checked get_type()
+	_FORCE_INLINE_ int _get_int() const { return _data._int; }
+	_FORCE_INLINE_ double _get_real() const { return _data._real; }
+	_FORCE_INLINE_ const Vector2& _get_vector2() const { return *reinterpret_cast<const Vector2*>(_data._mem); }
+	_FORCE_INLINE_ const Vector3& _get_vector3() const { return *reinterpret_cast<const Vector3*>(_data._mem); }
+	_FORCE_INLINE_ void _set_bool(bool p_bool) { if (type!=BOOL) { if (type!=NIL) clear(); type=BOOL; } _data._bool=p_bool; }
+	_FORCE_INLINE_ void _set_int(int p_int) { if (type!=INT) { if (type!=NIL) clear(); type=INT; } _data._int=p_int; }
+	_FORCE_INLINE_ void _set_real(double p_real) { if (type!=REAL) { if (type!=NIL) clear(); type=REAL; } _data._real=p_real; }
+	_FORCE_INLINE_ void _set_vector2(const Vector2& p_vector2) { if (type!=VECTOR2) { if (type!=NIL) clear(); type=VECTOR2; } *reinterpret_cast<Vector2*>(_data._mem)=p_vector2; }
+	_FORCE_INLINE_ void _set_vector3(const Vector3& p_vector3) { if (type!=VECTOR3) { if (type!=NIL) clear(); type=VECTOR3; } *reinterpret_cast<Vector3*>(_data._mem)=p_vector3; }
+
 	bool is_ref() const;
 	_FORCE_INLINE_ bool is_num() const { return type==INT || type==REAL; };
 	_FORCE_INLINE_ bool is_array() const { return type>=ARRAY; };
@@ -435,6 +446,8 @@ public:
 	String get_construct_string() const;
 	static void construct_from_string(const String& p_string,Variant& r_value,ObjectConstruct p_obj_construct=NULL,void *p_construct_ud=NULL);
 
+	static void release_thread_pools(); // call from threads before they finish
+
 	void operator=(const Variant& p_variant); // only this is enough for all the other types
 	Variant(const Variant& p_variant);
 	_FORCE_INLINE_ Variant() { type=NIL; }
@@ -0,0 +1,510 @@
+/*************************************************************************/
+/*  memory_pool_static_tcache.cpp                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "memory_pool_static_tcache.h"
+#include "error_macros.h"
+#include "os/memory.h"
+#include "os/copymem.h"
+#include "os/os.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef NO_THREADS
+
+#define TCACHE_THREAD_LOCAL
+
+static _FORCE_INLINE_ bool _atomic_cas_ptr(void * volatile *p_target,void *p_expected,void *p_value) {
+
+	if (*p_target!=p_expected)
+		return false;
+	*p_target=p_value;
+	return true;
+}
+
+static _FORCE_INLINE_ void *_atomic_exchange_ptr(void * volatile *p_target,void *p_value) {
+
+	void *old=*p_target;
+	*p_target=p_value;
+	return old;
+}
+
+static _FORCE_INLINE_ intptr_t _atomic_add_intptr(volatile intptr_t *p_target,intptr_t p_value) {
+
+	*p_target+=p_value;
+	return *p_target;
+}
+
+#elif defined(__GNUC__)
+
+#define TCACHE_THREAD_LOCAL __thread
+
+static _FORCE_INLINE_ bool _atomic_cas_ptr(void * volatile *p_target,void *p_expected,void *p_value) {
+
+	return __sync_bool_compare_and_swap(p_target,p_expected,p_value);
+}
+
+static _FORCE_INLINE_ void *_atomic_exchange_ptr(void * volatile *p_target,void *p_value) {
+
+	return __sync_lock_test_and_set(p_target,p_value);
+}
+
+static _FORCE_INLINE_ intptr_t _atomic_add_intptr(volatile intptr_t *p_target,intptr_t p_value) {
+
+	return __sync_add_and_fetch(p_target,p_value);
+}
+
+#elif defined(_MSC_VER)
+
+#include <windows.h>
+
+#define TCACHE_THREAD_LOCAL __declspec(thread)
+
+static _FORCE_INLINE_ bool _atomic_cas_ptr(void * volatile *p_target,void *p_expected,void *p_value) {
+
+	return InterlockedCompareExchangePointer((PVOID volatile*)p_target,p_value,p_expected)==p_expected;
+}
+
+static _FORCE_INLINE_ void *_atomic_exchange_ptr(void * volatile *p_target,void *p_value) {
+
+	return InterlockedExchangePointer((PVOID volatile*)p_target,p_value);
+}
+
+static _FORCE_INLINE_ intptr_t _atomic_add_intptr(volatile intptr_t *p_target,intptr_t p_value) {
+
+#ifdef _WIN64
+	return InterlockedExchangeAdd64((LONGLONG volatile*)p_target,p_value)+p_value;
+#else
+	return InterlockedExchangeAdd((LONG volatile*)p_target,p_value)+p_value;
+#endif
+}
+
+#else
+#error "The thread cache allocator needs atomic operations for this compiler"
+#endif
+
+// the pool is a singleton, so a single thread local slot is enough
+static TCACHE_THREAD_LOCAL void *current_thread_cache=NULL;
+
+const uint32_t MemoryPoolStaticTCache::size_classes[MemoryPoolStaticTCache::SIZE_CLASS_COUNT]={
+	16,32,48,64,80,96,112,128,
+	160,192,224,256,320,384,448,512,
+	640,768,896,1024,1280,1536,1792,2048
+};
+
+MemoryPoolStaticTCache::ThreadCache *MemoryPoolStaticTCache::_get_thread_cache() {
+
+	ThreadCache *tc=(ThreadCache*)current_thread_cache;
+	if (!tc)
+		tc=_acquire_thread_cache();
+	return tc;
+}
+
+MemoryPoolStaticTCache::ThreadCache *MemoryPoolStaticTCache::_acquire_thread_cache() {
+
+	// mutex is NULL while the pool itself allocates it
+	if (mutex)
+		mutex->lock();
+
+	// adopt the cache of a finished thread, so its spans get reused
+	ThreadCache *tc=caches;
+	while(tc && tc->in_use)
+		tc=tc->next;
+
+	if (!tc) {
+
+		tc=(ThreadCache*)::malloc(sizeof(ThreadCache));
+		if (tc) {
+			zeromem(tc,sizeof(ThreadCache));
+			tc->next=caches;
+			caches=tc;
+		}
+	}
+
+	if (tc)
+		tc->in_use=true;
+
+	if (mutex)
+		mutex->unlock();
+
+	ERR_FAIL_COND_V(!tc,NULL);
+
+	current_thread_cache=tc;
+	return tc;
+}
+
+void MemoryPoolStaticTCache::_reclaim_remote(ThreadCache *p_cache) {
+
+	FreeBlock *block=(FreeBlock*)_atomic_exchange_ptr((void * volatile*)&p_cache->remote_free,NULL);
+
+	while(block) {
+
+		FreeBlock *next=block->next;
+		int sc=_get_size_class(((Header*)block)->size);
+		block->next=p_cache->free_list[sc];
+		p_cache->free_list[sc]=block;
+		block=next;
+	}
+}
+
+bool MemoryPoolStaticTCache::_refill(ThreadCache *p_cache,int p_class) {
+
+	Span *span=(Span*)::malloc(SPAN_SIZE);
+	if (!span)
+		return false;
+
+	span->next=p_cache->spans;
+	p_cache->spans=span;
+
+	uint32_t block_size=HEADER_SIZE+size_classes[p_class];
+	int count=(SPAN_SIZE-HEADER_SIZE)/block_size;
+	uint8_t *blocks=((uint8_t*)span)+HEADER_SIZE;
+
+	FreeBlock *list=p_cache->free_list[p_class];
+	for(int i=count-1;i>=0;i--) {
+
+		FreeBlock *block=(FreeBlock*)&blocks[i*block_size];
+		block->next=list;
+		list=block;
+	}
+
+	p_cache->free_list[p_class]=list;
+	return true;
+}
+
+void MemoryPoolStaticTCache::_flush_stats(ThreadCache *p_cache) {
+
+	intptr_t mem=_atomic_add_intptr(&total_mem,p_cache->usage_delta);
+	intptr_t pointers=_atomic_add_intptr(&total_pointers,p_cache->alloc_delta);
+	p_cache->usage_delta=0;
+	p_cache->alloc_delta=0;
+
+	// racy, but these are only statistics
+	if (mem>max_mem)
+		max_mem=mem;
+	if (pointers>max_pointers)
+		max_pointers=pointers;
+}
+
+void MemoryPoolStaticTCache::_add_usage(ThreadCache *p_cache,intptr_t p_bytes,int p_count) {
+
+	p_cache->usage_delta+=p_bytes;
+	p_cache->alloc_delta+=p_count;
+
+	if (p_cache->usage_delta>STATS_FLUSH_THRESHOLD || p_cache->usage_delta<-STATS_FLUSH_THRESHOLD)
+		_flush_stats(p_cache);
+}
+
+void* MemoryPoolStaticTCache::_alloc_big(ThreadCache *p_cache,size_t p_bytes) {
+
+	size_t total;
+	#if defined(_add_overflow)
+		if (_add_overflow(p_bytes, (size_t)HEADER_SIZE, &total)) return NULL;
+	#else
+		total = p_bytes + HEADER_SIZE;
+	#endif
+
+	Header *header=(Header*)::malloc(total);
+
+	if (!header) {
+		printf("**ERROR: out of memory while allocating %lu bytes\n", (unsigned long) p_bytes);
+		printf("**ERROR: memory usage is %lu\n", (unsigned long) total_mem);
+	};
+
+	ERR_FAIL_COND_V(!header,0); //out of memory, or unreasonable request
+
+	header->cache=NULL;
+	header->size=p_bytes;
+	_add_usage(p_cache,p_bytes,1);
+
+	return ((uint8_t*)header)+HEADER_SIZE;
+}
+
+void* MemoryPoolStaticTCache::alloc(size_t p_bytes,const char *p_description) {
+
+	ERR_FAIL_COND_V(p_bytes==0,0);
+
+	ThreadCache *tc=_get_thread_cache();
+	ERR_FAIL_COND_V(!tc,0);
+
+	if (p_bytes>MAX_SMALL_SIZE)
+		return _alloc_big(tc,p_bytes);
+
+	int sc=_get_size_class(p_bytes);
+	FreeBlock *block=tc->free_list[sc];
+
+	if (!block) {
+
+		_reclaim_remote(tc);
+
+		if (!tc->free_list[sc] && !_refill(tc,sc)) {
+			printf("**ERROR: out of memory while allocating %lu bytes by %s?\n", (unsigned long) p_bytes, p_description);
+			ERR_FAIL_V(0);
+		}
+
+		block=tc->free_list[sc];
+	}
+
+	tc->free_list[sc]=block->next;
+
+	Header *header=(Header*)block;
+	header->cache=tc;
+	header->size=p_bytes;
+	_add_usage(tc,p_bytes,1);
+
+	return ((uint8_t*)header)+HEADER_SIZE;
+}
+
+void* MemoryPoolStaticTCache::realloc(void *p_memory,size_t p_bytes) {
+
+	if (p_memory==NULL) {
+
+		return alloc( p_bytes );
+	}
+
+	if (p_bytes==0) {
+
+		this->free(p_memory);
+		return NULL;
+	}
+
+	Header *header=(Header*)(((uint8_t*)p_memory)-HEADER_SIZE);
+	ThreadCache *tc=_get_thread_cache();
+	ERR_FAIL_COND_V(!tc,NULL);
+
+	if (!header->cache) {
+
+		if (p_bytes>MAX_SMALL_SIZE) {
+
+			size_t old_size=header->size;
+			Header *new_header=(Header*)::realloc(header,p_bytes+HEADER_SIZE);
+			ERR_FAIL_COND_V( new_header == 0, NULL ); /// reallocation failed
+
+			new_header->size=p_bytes;
+			_add_usage(tc,(intptr_t)p_bytes-(intptr_t)old_size,0);
+			return ((uint8_t*)new_header)+HEADER_SIZE;
+		}
+
+	} else if (p_bytes<=MAX_SMALL_SIZE && _get_size_class(p_bytes)==_get_size_class(header->size)) {
+
+		// still fits the same block
+		_add_usage(tc,(intptr_t)p_bytes-(intptr_t)header->size,0);
+		header->size=p_bytes;
+		return p_memory;
+	}
+
+	void *new_mem=alloc(p_bytes);
+	ERR_FAIL_COND_V(!new_mem,NULL);
+
+	copymem(new_mem,p_memory,MIN(p_bytes,header->size));
+	this->free(p_memory);
+
+	return new_mem;
+}
+
+void MemoryPoolStaticTCache::free(void *p_ptr) {
+
+	ERR_FAIL_COND(p_ptr==0);
+
+	Header *header=(Header*)(((uint8_t*)p_ptr)-HEADER_SIZE);
+	ThreadCache *tc=_get_thread_cache();
+	ERR_FAIL_COND(!tc);
+
+	_add_usage(tc,-(intptr_t)header->size,-1);
+
+	ThreadCache *owner=header->cache;
+
+	if (!owner) {
+
+		::free(header);
+		return;
+	}
+
+	// the link overwrites the owner, size is kept to find the class again
+	FreeBlock *block=(FreeBlock*)header;
+
+	if (owner==tc) {
+
+		int sc=_get_size_class(header->size);
+		block->next=tc->free_list[sc];
+		tc->free_list[sc]=block;
+	} else {
+
+		FreeBlock *head;
+		do {
+			head=owner->remote_free;
+			block->next=head;
+		} while(!_atomic_cas_ptr((void * volatile*)&owner->remote_free,head,block));
+	}
+}
+
+size_t MemoryPoolStaticTCache::get_available_mem() const {
+
+	return 0xffffffff;
+}
+
+size_t MemoryPoolStaticTCache::get_total_usage() {
+
+	ThreadCache *tc=_get_thread_cache();
+	if (tc)
+		_flush_stats(tc);
+
+	return total_mem;
+}
+
+size_t MemoryPoolStaticTCache::get_max_usage() {
+
+	return max_mem;
+}
+
+int MemoryPoolStaticTCache::get_alloc_count() {
+
+	return total_pointers;
+}
+void * MemoryPoolStaticTCache::get_alloc_ptr(int p_alloc_idx) {
+
+	return 0;
+}
+const char* MemoryPoolStaticTCache::get_alloc_description(int p_alloc_idx) {
+
+	return "";
+}
+size_t MemoryPoolStaticTCache::get_alloc_size(int p_alloc_idx) {
+
+	return 0;
+}
+
+void MemoryPoolStaticTCache::dump_mem_to_file(const char* p_file) {
+
+	FILE *f = fopen(p_file,"wb");
+	ERR_FAIL_COND(!f);
+
+	fprintf(f,"usage %i, max %i, pointers %i\n",(int)get_total_usage(),(int)max_mem,(int)total_pointers);
+
+	if (mutex)
+		mutex->lock();
+
+	int idx=0;
+	for(ThreadCache *tc=caches;tc;tc=tc->next) {
+
+		int spans=0;
+		for(Span *s=tc->spans;s;s=s->next)
+			spans++;
+		fprintf(f,"cache %i%s: %i spans of %i bytes\n",idx++,tc->in_use?"":" (free)",spans,(int)SPAN_SIZE);
+	}
+
+	if (mutex)
+		mutex->unlock();
+
+	fclose(f);
+}
+
+void MemoryPoolStaticTCache::thread_exit() {
+
+	ThreadCache *tc=(ThreadCache*)current_thread_cache;
+	if (!tc)
+		return;
+
+	_flush_stats(tc);
+
+	if (mutex)
+		mutex->lock();
+
+	tc->in_use=false;
+
+	if (mutex)
+		mutex->unlock();
+
+	current_thread_cache=NULL;
+}
+
+MemoryPoolStaticTCache::MemoryPoolStaticTCache() {
+
+	int sc=0;
+	for(int i=0;i<=(MAX_SMALL_SIZE>>4);i++) {
+
+		while(size_classes[sc]<(uint32_t)(i<<4))
+			sc++;
+		size_class_lookup[i]=sc;
+	}
+
+	caches=NULL;
+	total_mem=0;
+	total_pointers=0;
+	max_mem=0;
+	max_pointers=0;
+
+	mutex=NULL;
+#ifndef NO_THREADS
+
+	mutex=Mutex::create(); // at this point, this should work
+#endif
+}
+
+MemoryPoolStaticTCache::~MemoryPoolStaticTCache() {
+
+	Mutex *old_mutex=mutex;
+	mutex=NULL;
+	if (old_mutex)
+		memdelete(old_mutex);
+
+	for(ThreadCache *tc=caches;tc;tc=tc->next)
+		_flush_stats(tc);
+
+#ifdef DEBUG_MEMORY_ENABLED
+
+	if (OS::get_singleton()->is_stdout_verbose()) {
+		if (total_mem > 0 ) {
+			printf("**ERROR: STATIC ALLOC: ** MEMORY LEAKS DETECTED **\n");
+			printf("**ERROR: STATIC ALLOC: %i bytes of memory in use at exit.\n",(int)total_mem);
+			printf("mem - max %i, pointers %i, leaks %i.\n",(int)max_mem,(int)max_pointers,(int)total_mem);
+		} else {
+
+			printf("INFO: mem - max %i, pointers %i, no leaks.\n",(int)max_mem,(int)max_pointers);
+		}
+	}
+
+#endif
+
+	if (total_mem>0)
+		return; // leaked blocks may still be referenced by static objects, keep the spans around
+
+	current_thread_cache=NULL;
+
+	while(caches) {
+
+		ThreadCache *tc=caches;
+		caches=tc->next;
+
+		while(tc->spans) {
+			Span *s=tc->spans;
+			tc->spans=s->next;
+			::free(s);
+		}
+		::free(tc);
+	}
+}
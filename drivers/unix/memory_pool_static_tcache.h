@@ -0,0 +1,134 @@
+/*************************************************************************/
+/*  memory_pool_static_tcache.h                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef MEMORY_POOL_STATIC_TCACHE_H
+#define MEMORY_POOL_STATIC_TCACHE_H
+
+#include "os/memory_pool_static.h"
+#include "os/mutex.h"
+
+/**
+ * Static pool with per thread caches of small size classes. Small blocks are
+ * carved from spans owned by a thread cache, so the common alloc/free path
+ * takes no lock. Blocks freed from another thread are pushed on the owner's
+ * lock-free remote list and reclaimed by it on its next refill. Big blocks go
+ * straight to malloc.
+ *
+ * Usage statistics are accumulated per thread and flushed now and then, so
+ * they are approximate. There is no allocation list, get_alloc_ptr and
+ * friends return nothing.
+ *
+ * Enabled at build time with thread_cache_alloc=yes.
+ */
+
+class MemoryPoolStaticTCache : public MemoryPoolStatic {
+
+	enum {
+		HEADER_SIZE=16,
+		SIZE_CLASS_COUNT=24,
+		MAX_SMALL_SIZE=2048,
+		SPAN_SIZE=64*1024,
+		STATS_FLUSH_THRESHOLD=64*1024
+	};
+
+	struct ThreadCache;
+
+	struct Header {
+
+		ThreadCache *cache; // NULL for big blocks
+		size_t size;
+	};
+
+	struct FreeBlock {
+
+		FreeBlock *next; // overlaps Header::cache, size stays valid
+	};
+
+	struct Span {
+
+		Span *next;
+	};
+
+	struct ThreadCache {
+
+		FreeBlock *free_list[SIZE_CLASS_COUNT];
+		FreeBlock * volatile remote_free;
+		Span *spans;
+		intptr_t usage_delta;
+		intptr_t alloc_delta;
+		bool in_use;
+		ThreadCache *next;
+	};
+
+	static const uint32_t size_classes[SIZE_CLASS_COUNT];
+	uint8_t size_class_lookup[(MAX_SMALL_SIZE>>4)+1];
+
+	ThreadCache *caches;
+
+	volatile intptr_t total_mem;
+	volatile intptr_t total_pointers;
+	intptr_t max_mem;
+	intptr_t max_pointers;
+
+	Mutex *mutex;
+
+	_FORCE_INLINE_ int _get_size_class(size_t p_bytes) const { return size_class_lookup[(p_bytes+15)>>4]; }
+
+	ThreadCache *_get_thread_cache();
+	ThreadCache *_acquire_thread_cache();
+	void _reclaim_remote(ThreadCache *p_cache);
+	bool _refill(ThreadCache *p_cache,int p_class);
+	void _flush_stats(ThreadCache *p_cache);
+	_FORCE_INLINE_ void _add_usage(ThreadCache *p_cache,intptr_t p_bytes,int p_count);
+
+	void* _alloc_big(ThreadCache *p_cache,size_t p_bytes);
+
+public:
+
+	virtual void* alloc(size_t p_bytes,const char *p_description="");
+	virtual void free(void *p_ptr);
+	virtual void* realloc(void *p_memory,size_t p_bytes);
+	virtual size_t get_available_mem() const;
+	virtual size_t get_total_usage();
+	virtual size_t get_max_usage();
+
+	virtual int get_alloc_count();
+	virtual void * get_alloc_ptr(int p_alloc_idx);
+	virtual const char* get_alloc_description(int p_alloc_idx);
+	virtual size_t get_alloc_size(int p_alloc_idx);
+
+	virtual void dump_mem_to_file(const char* p_file);
+
+	virtual void thread_exit();
+
+	MemoryPoolStaticTCache();
+	~MemoryPoolStaticTCache();
+
+};
+
+#endif
@@ -31,6 +31,7 @@
 #ifdef UNIX_ENABLED
 
 #include "memory_pool_static_malloc.h"
+#include "memory_pool_static_tcache.h"
 #include "os/memory_pool_dynamic_static.h"
 #include "thread_posix.h"
 #include "semaphore_posix.h"
@@ -112,7 +113,11 @@ int OS_Unix::unix_initialize_audio(int p_audio_driver) {
 	return 0;
 }
 	
+#ifdef THREAD_CACHE_ALLOC_ENABLED
+static MemoryPoolStaticTCache *mempool_static=NULL;
+#else
 static MemoryPoolStaticMalloc *mempool_static=NULL;
+#endif
 static MemoryPoolDynamicStatic *mempool_dynamic=NULL;
 	
 	
@@ -141,7 +146,11 @@ void OS_Unix::initialize_core() {
 	PacketPeerUDPPosix::make_default();
 	IP_Unix::make_default();
 #endif
+#ifdef THREAD_CACHE_ALLOC_ENABLED
+	mempool_static = new MemoryPoolStaticTCache;
+#else
 	mempool_static = new MemoryPoolStaticMalloc;
+#endif
 	mempool_dynamic = memnew( MemoryPoolDynamicStatic );
 
 	ticks_start=0;
@@ -37,6 +37,10 @@
 
 #include "os/memory.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 Thread::ID ThreadPosix::get_ID() const {
 
 	return id;	
@@ -57,6 +61,10 @@ void *ThreadPosix::thread_callback(void *userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	Variant::release_thread_pools();
+
+	if (MemoryPoolStatic::get_singleton())
+		MemoryPoolStatic::get_singleton()->thread_exit();
 
 	return NULL;
 }
@@ -118,12 +126,28 @@ Error ThreadPosix::set_name_func_posix(const String& p_name) {
 	#endif // PTHREAD_NO_RENAME
 };
 
+Error ThreadPosix::set_affinity_func_posix(int p_core) {
+
+#if defined(__linux__) && defined(CPU_SET)
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(p_core,&set);
+
+	int err = sched_setaffinity(0,sizeof(set),&set); // 0 is the calling thread
+	return err == 0 ? OK : ERR_INVALID_PARAMETER;
+#else
+	return ERR_UNAVAILABLE;
+#endif
+}
+
 void ThreadPosix::make_default() {
 
 	create_func=create_func_posix;
 	get_thread_ID_func=get_thread_ID_func_posix;
 	wait_to_finish_func=wait_to_finish_func_posix;
 	set_name_func = set_name_func_posix;
+	set_affinity_func = set_affinity_func_posix;
 }
 
 ThreadPosix::ThreadPosix() {
@@ -57,6 +57,7 @@ class ThreadPosix : public Thread {
 	static void wait_to_finish_func_posix(Thread* p_thread);	
 
 	static Error set_name_func_posix(const String& p_name);
+	static Error set_affinity_func_posix(int p_core);
 
 	ThreadPosix();	
 public:
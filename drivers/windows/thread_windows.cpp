@@ -53,6 +53,10 @@ DWORD ThreadWindows::thread_callback( LPVOID userdata ) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	Variant::release_thread_pools();
+
+	if (MemoryPoolStatic::get_singleton())
+		MemoryPoolStatic::get_singleton()->thread_exit();
 
 	return 0;
 }
@@ -86,12 +90,19 @@ void ThreadWindows::wait_to_finish_func_windows(Thread* p_thread) {
         //`memdelete(tp);
 }
 
+Error ThreadWindows::set_affinity_func_windows(int p_core) {
+
+	DWORD_PTR mask = ((DWORD_PTR)1)<<p_core;
+	return SetThreadAffinityMask(GetCurrentThread(),mask) ? OK : ERR_INVALID_PARAMETER;
+}
+
 
 void ThreadWindows::make_default() {
 
 	create_func=create_func_windows;
 	get_thread_ID_func=get_thread_ID_func_windows;
 	wait_to_finish_func=wait_to_finish_func_windows;
+	set_affinity_func=set_affinity_func_windows;
 	
 }
 
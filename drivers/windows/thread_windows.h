@@ -56,6 +56,7 @@ class ThreadWindows : public Thread {
 	static Thread* create_func_windows(ThreadCreateCallback p_callback,void *,const Settings&);
 	static ID get_thread_ID_func_windows();
 	static void wait_to_finish_func_windows(Thread* p_thread);	
+	static Error set_affinity_func_windows(int p_core);
 	
 	ThreadWindows();	
 public:
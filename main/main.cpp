@@ -31,6 +31,7 @@
 #include "globals.h"
 #include "splash.h"
 #include "core/register_core_types.h"
+#include "core/job_system.h"
 #include "scene/register_scene_types.h"
 #include "drivers/register_driver_types.h"
 #include "servers/register_server_types.h"
@@ -84,6 +85,7 @@ static bool _start_success=false;
 static ScriptDebugger *script_debugger=NULL;
 
 static MessageQueue *message_queue=NULL;
+static JobSystem *job_system=NULL;
 static Performance *performance = NULL;
 static PathRemap *path_remap;
 static PackedData *packed_data=NULL;
@@ -106,6 +108,7 @@ static int video_driver_idx=-1;
 static int audio_driver_idx=-1;
 static String locale;
 static bool use_debug_profiler=false;
+static String sample_profile_path;
 static bool force_lowdpi=false;
 static int init_screen=-1;
 static bool use_vsync=true;
@@ -175,6 +178,7 @@ void Main::print_help(const char* p_binary) {
 	OS::get_singleton()->print("\t-rdebug ADDRESS : Remote debug (<ip>:<port> host address).\n");
 	OS::get_singleton()->print("\t-fdelay [msec]: Simulate high CPU load (delay each frame by [msec]).\n");
 	OS::get_singleton()->print("\t-timescale [msec]: Simulate high CPU load (delay each frame by [msec]).\n");
+	OS::get_singleton()->print("\t-sample_profile FILE : Sample running scripts every millisecond, save collapsed stacks (flamegraph.pl input) to FILE on exit and print the hottest lines.\n");
 	OS::get_singleton()->print("\t-bp : breakpoint list as source::line comma separated pairs, no spaces (%%20,%%2C,etc instead).\n");
 	OS::get_singleton()->print("\t-v : Verbose stdout mode\n");
 	OS::get_singleton()->print("\t-lang [locale]: Use a specific locale\n");
@@ -494,6 +498,17 @@ Error Main::setup(const char *execpath,int argc, char *argv[],bool p_second_phas
 
 			}
 
+		} else if (I->get()=="-sample_profile") { // sampling script profiler
+
+			if (I->next()) {
+
+				sample_profile_path=I->next()->get();
+				N=I->next()->next();
+			} else {
+				goto error;
+
+			}
+
 		} else if (I->get()=="-timescale") { // resolution
 
 			if (I->next()) {
@@ -829,6 +844,10 @@ Error Main::setup(const char *execpath,int argc, char *argv[],bool p_second_phas
 
 	message_queue = memnew( MessageQueue );
 
+	job_system = memnew( JobSystem );
+	job_system->start(GLOBAL_DEF("core/job_threads",0),GLOBAL_DEF("core/job_pin_threads",false)); //0: one per processor, up to 8
+	globals->add_singleton(Globals::Singleton("JobSystem",job_system));
+
 	Globals::get_singleton()->register_global_defaults();
 
 	if (p_second_phase)
@@ -877,6 +896,8 @@ Error Main::setup(const char *execpath,int argc, char *argv[],bool p_second_phas
 
 	OS::get_singleton()->_cmdline.clear();
 
+	if (job_system)
+		memdelete( job_system );
 	if (message_queue)
 		memdelete( message_queue);
 	OS::get_singleton()->finalize_core();
@@ -1030,6 +1051,12 @@ Error Main::setup2() {
 	if (use_debug_profiler && script_debugger) {
 		script_debugger->profiling_start();
 	}
+
+	if (sample_profile_path!=String()) {
+		for(int i=0;i<ScriptServer::get_language_count();i++) {
+			ScriptServer::get_language(i)->sampling_start(1000);
+		}
+	}
 	_start_success=true;
 	locale=String();
 
@@ -1705,10 +1732,48 @@ void Main::force_redraw() {
 };
 
 
+static void _save_sample_profile() {
+
+	String stacks;
+	uint64_t sample_count=0;
+	Vector<ScriptLanguage::SampledLineInfo> lines;
+	lines.resize(20);
+	int line_count=0;
+
+	for(int i=0;i<ScriptServer::get_language_count();i++) {
+
+		ScriptLanguage *lang=ScriptServer::get_language(i);
+		lang->sampling_stop();
+		stacks+=lang->sampling_get_collapsed_stacks();
+		sample_count=MAX(sample_count,lang->sampling_get_sample_count());
+		if (line_count==0)
+			line_count=lang->sampling_get_line_data(lines.ptr(),lines.size());
+	}
+
+	FileAccess *f=FileAccess::open(sample_profile_path,FileAccess::WRITE);
+	if (!f) {
+		ERR_PRINT(String("Can't save sampled profile to: "+sample_profile_path).utf8().get_data());
+	} else {
+		CharString cs=stacks.utf8();
+		f->store_buffer((const uint8_t*)cs.get_data(),cs.length());
+		memdelete(f);
+	}
+
+	print_line("Sampled profile saved to "+sample_profile_path+", "+itos(sample_count)+" samples. Hottest lines (self/total samples):");
+	for(int i=0;i<line_count;i++) {
+		const ScriptLanguage::SampledLineInfo &l=lines[i];
+		print_line("\t"+itos(l.self_samples)+"/"+itos(l.total_samples)+"\t"+l.source+":"+itos(l.line)+" in "+String(l.function));
+	}
+}
+
 void Main::cleanup() {
 
 	ERR_FAIL_COND(!_start_success);
 
+	if (sample_profile_path!=String()) {
+		_save_sample_profile();
+	}
+
 	if (script_debugger) {
 		if (use_debug_profiler) {
 			script_debugger->profiling_end();
@@ -1734,6 +1799,8 @@ void Main::cleanup() {
 
 	OS::get_singleton()->finalize();
 
+	if (job_system)
+		memdelete(job_system);
 	if (packed_data)
 		memdelete(packed_data);
 	if (file_access_network_client)
@@ -33,6 +33,7 @@
 #include "servers/physics_server.h"
 #include "message_queue.h"
 #include "scene/main/scene_main_loop.h"
+#include "scene/resources/packed_scene.h"
 Performance *Performance::singleton=NULL;
 
 
@@ -69,6 +70,12 @@ void Performance::_bind_methods() {
 	BIND_CONSTANT( PHYSICS_3D_ACTIVE_OBJECTS );
 	BIND_CONSTANT( PHYSICS_3D_COLLISION_PAIRS );
 	BIND_CONSTANT( PHYSICS_3D_ISLAND_COUNT );
+	BIND_CONSTANT( OBJECT_FIXED_PROCESS_COUNT );
+	BIND_CONSTANT( OBJECT_IDLE_PROCESS_COUNT );
+	BIND_CONSTANT( OBJECT_POOLED_INSTANCE_COUNT );
+	BIND_CONSTANT( OBJECT_POOL_REUSE_COUNT );
+	BIND_CONSTANT( OBJECT_POOL_MISS_COUNT );
+	BIND_CONSTANT( RENDER_SYNC_STALLS_IN_FRAME );
 
 	BIND_CONSTANT( MONITOR_MAX );
 
@@ -106,6 +113,12 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/active_objects",
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
+		"object/fixed_processed_nodes",
+		"object/processed_nodes",
+		"object/pooled_instances",
+		"object/pool_reuses",
+		"object/pool_misses",
+		"video/sync_stalls",
 
 	};
 
@@ -139,6 +152,21 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return sml->get_node_count();
 
 		};
+		case OBJECT_FIXED_PROCESS_COUNT:
+		case OBJECT_IDLE_PROCESS_COUNT: {
+
+			MainLoop *ml = OS::get_singleton()->get_main_loop();
+			if (!ml)
+				return 0;
+			SceneTree *sml = ml->cast_to<SceneTree>();
+			if (!sml)
+				return 0;
+			return p_monitor==OBJECT_FIXED_PROCESS_COUNT ? sml->get_fixed_processed_node_count() : sml->get_idle_processed_node_count();
+
+		};
+		case OBJECT_POOLED_INSTANCE_COUNT: return PackedScene::get_pooled_instance_count();
+		case OBJECT_POOL_REUSE_COUNT: return PackedScene::get_pool_reuse_count();
+		case OBJECT_POOL_MISS_COUNT: return PackedScene::get_pool_miss_count();
 		case RENDER_OBJECTS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_OBJECTS_IN_FRAME);
 		case RENDER_VERTICES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_VERTICES_IN_FRAME);
 		case RENDER_MATERIAL_CHANGES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_MATERIAL_CHANGES_IN_FRAME);;
@@ -149,6 +177,7 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case RENDER_TEXTURE_MEM_USED: return VS::get_singleton()->get_render_info(VS::INFO_TEXTURE_MEM_USED);
 		case RENDER_VERTEX_MEM_USED: return VS::get_singleton()->get_render_info(VS::INFO_VERTEX_MEM_USED);
 		case RENDER_USAGE_VIDEO_MEM_TOTAL: return VS::get_singleton()->get_render_info(VS::INFO_USAGE_VIDEO_MEM_TOTAL);
+		case RENDER_SYNC_STALLS_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_SYNC_STALLS_IN_FRAME);
 		case PHYSICS_2D_ACTIVE_OBJECTS: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_ACTIVE_OBJECTS);
 		case PHYSICS_2D_COLLISION_PAIRS: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_2D_ISLAND_COUNT: return Physics2DServer::get_singleton()->get_process_info(Physics2DServer::INFO_ISLAND_COUNT);
@@ -76,6 +76,12 @@ public:
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
+		OBJECT_FIXED_PROCESS_COUNT,
+		OBJECT_IDLE_PROCESS_COUNT,
+		OBJECT_POOLED_INSTANCE_COUNT,
+		OBJECT_POOL_REUSE_COUNT,
+		OBJECT_POOL_MISS_COUNT,
+		RENDER_SYNC_STALLS_IN_FRAME,
 		MONITOR_MAX
 	};
 
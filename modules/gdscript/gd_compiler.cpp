@@ -28,6 +28,9 @@
 /*************************************************************************/
 #include "gd_compiler.h"
 #include "gd_script.h"
+#include "io/marshalls.h"
+#include "hashfuncs.h"
+#include "version.h"
 
 
 void GDCompiler::_set_error(const String& p_error,const GDParser::Node *p_node) {
@@ -45,6 +48,201 @@ void GDCompiler::_set_error(const String& p_error,const GDParser::Node *p_node)
 	}
 }
 
+// Picks the typed operator opcode for operands the compiler expects to be of
+// types p_a and p_b, and the type of the result. The typed opcodes check the
+// real types when run and fall back to the generic operator, so a wrong guess
+// only costs speed.
+static GDFunction::Opcode _get_operator_opcode(Variant::Operator p_op,Variant::Type p_a,Variant::Type p_b,Variant::Type *r_result=NULL) {
+
+	bool compare=false;
+	bool equality=false;
+
+	switch(p_op) {
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL: equality=true; //fallthrough
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL: compare=true; break;
+		case Variant::OP_ADD:
+		case Variant::OP_SUBSTRACT:
+		case Variant::OP_MULTIPLY:
+		case Variant::OP_DIVIDE:
+		case Variant::OP_MODULE:
+		case Variant::OP_NEGATE: break;
+		default: {
+			if (r_result)
+				*r_result=Variant::NIL;
+			return GDFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	bool num_a = p_a==Variant::INT || p_a==Variant::REAL;
+	bool num_b = p_b==Variant::INT || p_b==Variant::REAL;
+
+	GDFunction::Opcode opcode=GDFunction::OPCODE_OPERATOR;
+	Variant::Type result=Variant::NIL;
+
+	if (p_a==Variant::INT && p_b==Variant::INT) {
+
+		opcode=GDFunction::OPCODE_OPERATOR_INT;
+		result=Variant::INT;
+	} else if (num_a && num_b) {
+
+		if (p_op!=Variant::OP_MODULE) {
+			opcode=GDFunction::OPCODE_OPERATOR_REAL;
+			result=Variant::REAL;
+		}
+	} else if (p_a==Variant::VECTOR2 || p_a==Variant::VECTOR3 || p_b==Variant::VECTOR2 || p_b==Variant::VECTOR3) {
+
+		Variant::Type vtype = (p_a==Variant::VECTOR2 || p_a==Variant::VECTOR3) ? p_a : p_b;
+		bool valid=false;
+
+		if (p_a==vtype && p_b==vtype)
+			valid = p_op!=Variant::OP_MODULE && (equality || !compare);
+		else if (p_a==vtype && num_b)
+			valid = p_op==Variant::OP_MULTIPLY || p_op==Variant::OP_DIVIDE;
+		else if (num_a && p_b==vtype)
+			valid = p_op==Variant::OP_MULTIPLY;
+
+		if (valid) {
+			opcode = vtype==Variant::VECTOR2 ? GDFunction::OPCODE_OPERATOR_VECTOR2 : GDFunction::OPCODE_OPERATOR_VECTOR3;
+			result=vtype;
+		}
+	}
+
+	if (r_result)
+		*r_result = (compare && result!=Variant::NIL) ? Variant::BOOL : result;
+	return opcode;
+}
+
+Variant::Type GDCompiler::_guess_expression_type(CodeGen& codegen,const GDParser::Node *p_expression) const {
+
+	switch(p_expression->type) {
+
+		case GDParser::Node::TYPE_CONSTANT: {
+
+			return static_cast<const GDParser::ConstantNode*>(p_expression)->value.get_type();
+		} break;
+		case GDParser::Node::TYPE_IDENTIFIER: {
+
+			StringName identifier = static_cast<const GDParser::IdentifierNode*>(p_expression)->name;
+
+			if (codegen.stack_identifiers.has(identifier)) {
+
+				const Map<int,Variant::Type>::Element *E=codegen.stack_type_guesses.find(codegen.stack_identifiers[identifier]);
+				return E ? E->get() : Variant::NIL;
+			}
+
+			if (codegen.class_node && (!codegen.function_node || !codegen.function_node->_static)) {
+
+				//members initialized to a constant or a built-in type likely keep that type
+				for(int i=0;i<codegen.class_node->variables.size();i++) {
+
+					const GDParser::ClassNode::Member &m=codegen.class_node->variables[i];
+					if (m.identifier!=identifier)
+						continue;
+					if (!m.expression)
+						return Variant::NIL;
+					if (m.expression->type==GDParser::Node::TYPE_CONSTANT)
+						return _guess_expression_type(codegen,m.expression);
+					if (m.expression->type==GDParser::Node::TYPE_OPERATOR) {
+						const GDParser::OperatorNode *on=static_cast<const GDParser::OperatorNode*>(m.expression);
+						if (on->op==GDParser::OperatorNode::OP_CALL && on->arguments[0]->type==GDParser::Node::TYPE_TYPE)
+							return static_cast<const GDParser::TypeNode*>(on->arguments[0])->vtype;
+					}
+					return Variant::NIL;
+				}
+			}
+		} break;
+		case GDParser::Node::TYPE_OPERATOR: {
+
+			const GDParser::OperatorNode *on=static_cast<const GDParser::OperatorNode*>(p_expression);
+			Variant::Operator op=Variant::OP_MAX;
+
+			switch(on->op) {
+
+				case GDParser::OperatorNode::OP_CALL: {
+
+					if (on->arguments[0]->type==GDParser::Node::TYPE_TYPE)
+						return static_cast<const GDParser::TypeNode*>(on->arguments[0])->vtype;
+
+					if (on->arguments[0]->type==GDParser::Node::TYPE_BUILT_IN_FUNCTION) {
+
+						switch(static_cast<const GDParser::BuiltInFunctionNode*>(on->arguments[0])->function) {
+							case GDFunctions::MATH_SIN:
+							case GDFunctions::MATH_COS:
+							case GDFunctions::MATH_TAN:
+							case GDFunctions::MATH_SINH:
+							case GDFunctions::MATH_COSH:
+							case GDFunctions::MATH_TANH:
+							case GDFunctions::MATH_ASIN:
+							case GDFunctions::MATH_ACOS:
+							case GDFunctions::MATH_ATAN:
+							case GDFunctions::MATH_ATAN2:
+							case GDFunctions::MATH_SQRT:
+							case GDFunctions::MATH_FMOD:
+							case GDFunctions::MATH_FPOSMOD:
+							case GDFunctions::MATH_FLOOR:
+							case GDFunctions::MATH_CEIL:
+							case GDFunctions::MATH_ROUND:
+							case GDFunctions::MATH_POW:
+							case GDFunctions::MATH_LOG:
+							case GDFunctions::MATH_EXP:
+							case GDFunctions::MATH_LERP:
+							case GDFunctions::MATH_RANDF:
+							case GDFunctions::MATH_RANDOM:
+							case GDFunctions::MATH_DEG2RAD:
+							case GDFunctions::MATH_RAD2DEG: return Variant::REAL;
+							case GDFunctions::MATH_RAND: return Variant::INT;
+							default: {}
+						}
+					}
+				} break;
+				case GDParser::OperatorNode::OP_INDEX_NAMED: {
+
+					Variant::Type base=_guess_expression_type(codegen,on->arguments[0]);
+					if ((base==Variant::VECTOR2 || base==Variant::VECTOR3) && on->arguments[1]->type==GDParser::Node::TYPE_IDENTIFIER) {
+						StringName name=static_cast<const GDParser::IdentifierNode*>(on->arguments[1])->name;
+						if (name=="x" || name=="y" || (base==Variant::VECTOR3 && name=="z"))
+							return Variant::REAL;
+					}
+				} break;
+				case GDParser::OperatorNode::OP_POS: return _guess_expression_type(codegen,on->arguments[0]);
+				case GDParser::OperatorNode::OP_NOT:
+				case GDParser::OperatorNode::OP_AND:
+				case GDParser::OperatorNode::OP_OR:
+				case GDParser::OperatorNode::OP_IN: return Variant::BOOL;
+				case GDParser::OperatorNode::OP_NEG: op=Variant::OP_NEGATE; break;
+				case GDParser::OperatorNode::OP_EQUAL: op=Variant::OP_EQUAL; break;
+				case GDParser::OperatorNode::OP_NOT_EQUAL: op=Variant::OP_NOT_EQUAL; break;
+				case GDParser::OperatorNode::OP_LESS: op=Variant::OP_LESS; break;
+				case GDParser::OperatorNode::OP_LESS_EQUAL: op=Variant::OP_LESS_EQUAL; break;
+				case GDParser::OperatorNode::OP_GREATER: op=Variant::OP_GREATER; break;
+				case GDParser::OperatorNode::OP_GREATER_EQUAL: op=Variant::OP_GREATER_EQUAL; break;
+				case GDParser::OperatorNode::OP_ADD: op=Variant::OP_ADD; break;
+				case GDParser::OperatorNode::OP_SUB: op=Variant::OP_SUBSTRACT; break;
+				case GDParser::OperatorNode::OP_MUL: op=Variant::OP_MULTIPLY; break;
+				case GDParser::OperatorNode::OP_DIV: op=Variant::OP_DIVIDE; break;
+				case GDParser::OperatorNode::OP_MOD: op=Variant::OP_MODULE; break;
+				default: {}
+			}
+
+			if (op==Variant::OP_MAX)
+				return Variant::NIL;
+
+			Variant::Type a=_guess_expression_type(codegen,on->arguments[0]);
+			Variant::Type b=on->arguments.size()>1 ? _guess_expression_type(codegen,on->arguments[1]) : a;
+			Variant::Type result;
+			_get_operator_opcode(op,a,b,&result);
+			return result;
+		} break;
+		default: {}
+	}
+
+	return Variant::NIL;
+}
+
 bool GDCompiler::_create_unary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size()!=1,false);
@@ -53,7 +251,9 @@ bool GDCompiler::_create_unary_operator(CodeGen& codegen,const GDParser::Operato
 	if (src_address_a<0)
 		return false;
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+	Variant::Type type_a=_guess_expression_type(codegen,on->arguments[0]);
+
+	codegen.opcodes.push_back(_get_operator_opcode(op,type_a,type_a)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -76,8 +276,14 @@ bool GDCompiler::_create_binary_operator(CodeGen& codegen,const GDParser::Operat
 	if (src_address_b<0)
 		return false;
 
+	GDFunction::Opcode opcode=GDFunction::OPCODE_OPERATOR;
+	if (!p_initializer)
+		opcode=_get_operator_opcode(op,_guess_expression_type(codegen,on->arguments[0]),_guess_expression_type(codegen,on->arguments[1]));
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+	if ((opcode==GDFunction::OPCODE_OPERATOR_INT || opcode==GDFunction::OPCODE_OPERATOR_REAL) && op>=Variant::OP_EQUAL && op<=Variant::OP_GREATER_EQUAL)
+		codegen.last_compare=codegen.opcodes.size();
+
+	codegen.opcodes.push_back(opcode); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -499,11 +705,13 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 
 						}
 
+						codegen.fuse_get_named_call(arguments[0]);
 						codegen.opcodes.push_back(p_root?GDFunction::OPCODE_CALL:GDFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size()-2);
 						codegen.alloc_call(on->arguments.size()-2);
 						for(int i=0;i<arguments.size();i++)
 							codegen.opcodes.push_back(arguments[i]);
+						codegen.opcodes.push_back(codegen.alloc_inline_cache());
 					}
 				} break;
 				case GDParser::OperatorNode::OP_YIELD: {
@@ -591,9 +799,13 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 						}
 					}
 
+					if (named)
+						codegen.last_get_named=codegen.opcodes.size();
 					codegen.opcodes.push_back(named?GDFunction::OPCODE_GET_NAMED:GDFunction::OPCODE_GET); // perform operator
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (named)
+						codegen.opcodes.push_back(codegen.alloc_inline_cache());
 
 				} break;
 				case GDParser::OperatorNode::OP_AND: {
@@ -603,8 +815,7 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 					int res = _parse_expression(codegen,on->arguments[0],p_stack_level);
 					if (res<0)
 						return res;
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					codegen.push_jump_if_not(res);
 					int jump_fail_pos=codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -612,15 +823,14 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 					if (res<0)
 						return res;
 
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					codegen.push_jump_if_not(res);
 					int jump_fail_pos2=codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
 					codegen.alloc_stack(p_stack_level); //it will be used..
 					codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN_TRUE);
 					codegen.opcodes.push_back(p_stack_level|GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+					codegen.push_jump();
 					codegen.opcodes.push_back(codegen.opcodes.size()+3);
 					codegen.opcodes[jump_fail_pos]=codegen.opcodes.size();
 					codegen.opcodes[jump_fail_pos2]=codegen.opcodes.size();
@@ -653,7 +863,7 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 					codegen.alloc_stack(p_stack_level); //it will be used..
 					codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN_FALSE);
 					codegen.opcodes.push_back(p_stack_level|GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+					codegen.push_jump();
 					codegen.opcodes.push_back(codegen.opcodes.size()+3);
 					codegen.opcodes[jump_success_pos]=codegen.opcodes.size();
 					codegen.opcodes[jump_success_pos2]=codegen.opcodes.size();
@@ -670,8 +880,7 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 					int res = _parse_expression(codegen,on->arguments[0],p_stack_level);
 					if (res<0)
 						return res;
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
-					codegen.opcodes.push_back(res);
+					codegen.push_jump_if_not(res);
 					int jump_fail_pos=codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 
@@ -681,10 +890,11 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 						return res;
 					
 					codegen.alloc_stack(p_stack_level); //it will be used..
+					codegen.last_assign=codegen.opcodes.size();
 					codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
 					codegen.opcodes.push_back(p_stack_level|GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
 					codegen.opcodes.push_back(res);
-					codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+					codegen.push_jump();
 					int jump_past_pos=codegen.opcodes.size();
 					codegen.opcodes.push_back(0);
 					
@@ -846,6 +1056,8 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 							codegen.opcodes.push_back(named ? GDFunction::OPCODE_GET_NAMED : GDFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
+							if (named)
+								codegen.opcodes.push_back(codegen.alloc_inline_cache());
 							slevel++;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS)|slevel;
@@ -854,6 +1066,8 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 
 							//add in reverse order, since it will be reverted
 							setchain.push_back(dst_pos);
+							if (named)
+								setchain.push_back(codegen.alloc_inline_cache());
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
 							setchain.push_back(named ? GDFunction::OPCODE_SET_NAMED : GDFunction::OPCODE_SET);
@@ -897,15 +1111,13 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 						codegen.opcodes.push_back(named?GDFunction::OPCODE_SET_NAMED:GDFunction::OPCODE_SET);
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
+						if (named)
+							codegen.opcodes.push_back(codegen.alloc_inline_cache());
 						codegen.opcodes.push_back(set_value);
 
-						for(int i=0;i<setchain.size();i+=4) {
-
+						for(int i=0;i<setchain.size();i++) {
 
-							codegen.opcodes.push_back(setchain[i+0]);
-							codegen.opcodes.push_back(setchain[i+1]);
-							codegen.opcodes.push_back(setchain[i+2]);
-							codegen.opcodes.push_back(setchain[i+3]);
+							codegen.opcodes.push_back(setchain[i]); //named sets carry their cache slot, so entries vary in size
 						}
 
 						return retval;
@@ -932,6 +1144,7 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 
 
 
+						codegen.last_assign=codegen.opcodes.size();
 						codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN); // perform operator
 						codegen.opcodes.push_back(dst_address_a); // argument 1
 						codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -1031,8 +1244,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 						if (ret<0)
 							return ERR_PARSE_ERROR;
 
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret);
+						codegen.push_jump_if_not(ret);
 						int else_addr=codegen.opcodes.size();
 						codegen.opcodes.push_back(0); //temporary
 
@@ -1042,7 +1254,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 						if (cf->body_else) {
 
-							codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+							codegen.push_jump();
 							int end_addr=codegen.opcodes.size();
 							codegen.opcodes.push_back(0);
 							codegen.opcodes[else_addr]=codegen.opcodes.size();
@@ -1070,37 +1282,102 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 						int container_pos = (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
 						codegen.alloc_stack(slevel);
 
+						//range() only yields ints, and with one to three arguments it is counted in place
+						bool iter_range=false;
+						const GDParser::OperatorNode *range_call=NULL;
+						if (cf->arguments[1]->type==GDParser::Node::TYPE_OPERATOR) {
+							const GDParser::OperatorNode *con=static_cast<const GDParser::OperatorNode*>(cf->arguments[1]);
+							if (con->op==GDParser::OperatorNode::OP_CALL && con->arguments[0]->type==GDParser::Node::TYPE_BUILT_IN_FUNCTION && static_cast<const GDParser::BuiltInFunctionNode*>(con->arguments[0])->function==GDFunctions::GEN_RANGE) {
+								iter_range=true;
+								if (con->arguments.size()>=2 && con->arguments.size()<=4)
+									range_call=con;
+							}
+						}
+
 						    codegen.push_stack_identifiers();
-						      codegen.add_stack_identifier(static_cast<const GDParser::IdentifierNode*>(cf->arguments[0])->name,iter_stack_pos);
+						      codegen.add_stack_identifier(static_cast<const GDParser::IdentifierNode*>(cf->arguments[0])->name,iter_stack_pos,iter_range?Variant::INT:Variant::NIL);
 
-						int ret = _parse_expression(codegen,cf->arguments[1],slevel,false);
-						if (ret<0)
-							return ERR_COMPILATION_FAILED;
+						int break_pos;
+						int continue_pos;
 
-						//assign container
-						codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(ret);
+						if (range_call) {
 
-						//begin loop
-						codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_BEGIN);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(codegen.opcodes.size()+4);
-						codegen.opcodes.push_back(iterator_pos);
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(codegen.opcodes.size()+8);
-						//break loop
-						int break_pos=codegen.opcodes.size();
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(0); //skip code for next
-						//next loop
-						int continue_pos=codegen.opcodes.size();
-						codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(break_pos);
-						codegen.opcodes.push_back(iterator_pos);
+							int step_pos = (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
+							codegen.alloc_stack(slevel);
+
+							int argc=range_call->arguments.size()-1;
+							int args[3];
+							int arg_level=slevel;
+
+							for(int i=0;i<argc;i++) {
+
+								args[i] = _parse_expression(codegen,range_call->arguments[i+1],arg_level,false);
+								if (args[i]<0)
+									return ERR_COMPILATION_FAILED;
+								if (args[i]&GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS)
+									arg_level++; //keep it until all arguments are evaluated
+							}
+
+							int from_arg = argc>1 ? args[0] : codegen.get_constant_pos(0)|(GDFunction::ADDR_TYPE_LOCAL_CONSTANT<<GDFunction::ADDR_BITS);
+							int to_arg = argc>1 ? args[1] : args[0];
+							int step_arg = argc>2 ? args[2] : codegen.get_constant_pos(1)|(GDFunction::ADDR_TYPE_LOCAL_CONSTANT<<GDFunction::ADDR_BITS);
+
+							//begin loop, the container slot holds the end of the range
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_RANGE_BEGIN);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(from_arg);
+							codegen.opcodes.push_back(to_arg);
+							codegen.opcodes.push_back(step_arg);
+							codegen.opcodes.push_back(codegen.opcodes.size()+4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.push_jump(); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size()+9);
+							//break loop
+							break_pos=codegen.opcodes.size();
+							codegen.push_jump(); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_RANGE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+
+						} else {
+
+							int ret = _parse_expression(codegen,cf->arguments[1],slevel,false);
+							if (ret<0)
+								return ERR_COMPILATION_FAILED;
+
+							//assign container
+							codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(ret);
+
+							//begin loop
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_BEGIN);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(codegen.opcodes.size()+4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.push_jump(); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size()+8);
+							//break loop
+							break_pos=codegen.opcodes.size();
+							codegen.push_jump(); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+						}
 
 
 						Error err = _parse_block(codegen,cf->body,slevel,break_pos,continue_pos);
@@ -1108,7 +1385,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 							return err;
 
 
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(continue_pos);
 						codegen.opcodes[break_pos+1]=codegen.opcodes.size();
 
@@ -1118,23 +1395,32 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 					} break;
 					case GDParser::ControlFlowNode::CF_WHILE: {
 
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(codegen.opcodes.size()+3);
 						int break_addr=codegen.opcodes.size();
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(0);
 						int continue_addr=codegen.opcodes.size();
 
-						int ret = _parse_expression(codegen,cf->arguments[0],p_stack_level,false);
-						if (ret<0)
-							return ERR_PARSE_ERROR;
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
-						codegen.opcodes.push_back(ret);
-						codegen.opcodes.push_back(break_addr);
+						//the parser already removed loops that never run, one that always runs needs no test
+						bool always=false;
+						if (cf->arguments[0]->type==GDParser::Node::TYPE_CONSTANT) {
+							bool valid;
+							always = static_cast<const GDParser::ConstantNode*>(cf->arguments[0])->value.booleanize(valid) && valid;
+						}
+
+						if (!always) {
+
+							int ret = _parse_expression(codegen,cf->arguments[0],p_stack_level,false);
+							if (ret<0)
+								return ERR_PARSE_ERROR;
+							codegen.push_jump_if_not(ret);
+							codegen.opcodes.push_back(break_addr);
+						}
 						Error err = _parse_block(codegen,cf->body,p_stack_level,break_addr,continue_addr);
 						if (err)
 							return err;
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(continue_addr);
 
 						codegen.opcodes[break_addr+1]=codegen.opcodes.size();
@@ -1150,7 +1436,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 							_set_error("'break'' not within loop",cf);
 							return ERR_COMPILATION_FAILED;
 						}
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(p_break_addr);
 
 					} break;
@@ -1162,7 +1448,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 							return ERR_COMPILATION_FAILED;
 						}
 
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
+						codegen.push_jump();
 						codegen.opcodes.push_back(p_continue_addr);
 
 					} break;
@@ -1188,6 +1474,13 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 				}
 			} break;
+			case GDParser::Node::TYPE_BLOCK: {
+				//branch of an if the parser found to be always taken
+
+				Error err = _parse_block(codegen,static_cast<const GDParser::BlockNode*>(s),p_stack_level,p_break_addr,p_continue_addr);
+				if (err)
+					return err;
+			} break;
 			case GDParser::Node::TYPE_ASSERT: {
 				// try subblocks
 
@@ -1211,7 +1504,8 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 				const GDParser::LocalVarNode *lv = static_cast<const GDParser::LocalVarNode*>(s);
 
-				codegen.add_stack_identifier(lv->name,p_stack_level++);
+				Variant::Type type_guess = lv->assign ? _guess_expression_type(codegen,lv->assign) : Variant::NIL;
+				codegen.add_stack_identifier(lv->name,p_stack_level++,type_guess);
 				codegen.alloc_stack(p_stack_level);
 				new_identifiers++;
 
@@ -1242,6 +1536,10 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 	codegen.stack_max=0;
 	codegen.current_line=0;
 	codegen.call_max=0;
+	codegen.inline_cache_count=0;
+	codegen.last_assign=-1;
+	codegen.last_get_named=-1;
+	codegen.last_compare=-1;
 	codegen.debug_stack=ScriptDebugger::get_singleton()!=NULL;
 	Vector<StringName> argnames;
 
@@ -1404,6 +1702,14 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 	gdfunc->_argument_count=p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size=codegen.stack_max;
 	gdfunc->_call_size=codegen.call_max;
+	if (codegen.inline_cache_count) {
+		gdfunc->inline_caches.resize(codegen.inline_cache_count);
+		gdfunc->_inline_caches_ptr=&gdfunc->inline_caches[0];
+		gdfunc->_inline_cache_count=codegen.inline_cache_count;
+	} else {
+		gdfunc->_inline_caches_ptr=NULL;
+		gdfunc->_inline_cache_count=0;
+	}
 	gdfunc->name=func_name;
 #ifdef DEBUG_ENABLED
 	if (ScriptDebugger::get_singleton()){
@@ -1911,6 +2217,8 @@ Error GDCompiler::compile(const GDParser *p_parser,GDScript *p_script,bool p_kee
 
 	source=p_script->get_path();
 
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches(); //members and functions may change
+
 	Error err = _parse_class(p_script,NULL,static_cast<const GDParser::ClassNode*>(root),p_keep_state);
 
 	if (err)
@@ -1920,6 +2228,1187 @@ Error GDCompiler::compile(const GDParser *p_parser,GDScript *p_script,bool p_kee
 
 }
 
+/* Compiled scripts.
+ *
+ * Layout of a compiled buffer: "GDCC", format version, build hash, hash and size of
+ * the token stream, size of the compiled data, the token stream (used whenever the
+ * compiled data can't be) and the compiled data. The compiled data is a table of the
+ * global names the code uses, followed by the root class: name, base, members,
+ * constants, signals, subclasses and functions. Global addresses in the code are
+ * saved as indices in the name table, since global indices depend on registration
+ * order and differ between the editor and the export templates.
+ */
+
+#define COMPILED_VERSION 1
+//bump whenever instructions or operands are laid out differently, custom builds all share a version
+#define COMPILED_CODE_LAYOUT 1
+
+enum {
+	COMPILED_HEADER_SIZE=24,
+	COMPILED_BASE_NONE=0,
+	COMPILED_BASE_NATIVE,
+	COMPILED_BASE_SCRIPT,
+	COMPILED_CONSTANT_VALUE=0,
+	COMPILED_CONSTANT_RESOURCE,
+	COMPILED_CONSTANT_SCRIPT,
+	COMPILED_CONSTANT_ARRAY,
+	COMPILED_CONSTANT_DICTIONARY
+};
+
+static uint32_t _get_compiled_build_hash() {
+
+	//code compiled by another engine version, or with different opcodes, operators or built-in functions can't run here
+	uint32_t h=hash_djb2(VERSION_MKSTRING);
+	h=hash_djb2_one_32(COMPILED_CODE_LAYOUT,h);
+	h=hash_djb2_one_32(GDFunction::OPCODE_END,h);
+	h=hash_djb2_one_32(GDFunction::ADDR_BITS,h);
+	h=hash_djb2_one_32(Variant::VARIANT_MAX,h);
+	h=hash_djb2_one_32(Variant::OP_MAX,h);
+	h=hash_djb2_one_32(GDFunctions::FUNC_MAX,h);
+	h=hash_djb2_one_32(sizeof(real_t),h);
+	return h;
+}
+
+static _FORCE_INLINE_ bool _is_global_address(int p_word) {
+
+	//opcodes and other operands are small, only addresses have type bits
+	return (uint32_t(p_word)>>GDFunction::ADDR_BITS)==GDFunction::ADDR_TYPE_GLOBAL;
+}
+
+//limits operands are checked against when loading, NULL when only the layout is needed
+struct _CompiledLimits {
+
+	int stack_size;
+	int call_size;
+	int member_count;
+	int constant_count;
+	int global_name_count;
+	int inline_cache_count;
+	int global_count;
+};
+
+//layout of one instruction, offsets are relative to its opcode and 0 when unused
+struct _CompiledInstruction {
+
+	int size;
+	int jump; //operand holding a code address
+	int next; //opcode that has to follow, superinstructions and yields rely on it
+	int next_alt;
+};
+
+static bool _check_compiled_address(int p_word,const _CompiledLimits *p_limits) {
+
+	if (!p_limits)
+		return true;
+
+	int idx=p_word&GDFunction::ADDR_MASK;
+	switch(uint32_t(p_word)>>GDFunction::ADDR_BITS) {
+
+		case GDFunction::ADDR_TYPE_SELF:
+		case GDFunction::ADDR_TYPE_CLASS:
+		case GDFunction::ADDR_TYPE_NIL: return idx==0;
+		case GDFunction::ADDR_TYPE_MEMBER: return idx<p_limits->member_count;
+		case GDFunction::ADDR_TYPE_CLASS_CONSTANT: return idx<p_limits->global_name_count;
+		case GDFunction::ADDR_TYPE_LOCAL_CONSTANT: return idx<p_limits->constant_count;
+		case GDFunction::ADDR_TYPE_STACK:
+		case GDFunction::ADDR_TYPE_STACK_VARIABLE: return idx<p_limits->stack_size;
+		case GDFunction::ADDR_TYPE_GLOBAL: return idx<p_limits->global_count;
+	}
+
+	return false;
+}
+
+static bool _get_compiled_instruction(const int *p_code,int p_ip,int p_code_size,const _CompiledLimits *p_limits,_CompiledInstruction& r_inst) {
+
+	const int *c=&p_code[p_ip];
+	int avail=p_code_size-p_ip;
+
+	r_inst.size=1;
+	r_inst.jump=0;
+	r_inst.next=-1;
+	r_inst.next_alt=-1;
+
+	//operands that are addresses, names and caches, in order
+	int addr[9];
+	int addr_count=0;
+	int name=-1;
+	int cache=-1;
+
+#define _CI_SIZE(m_size) { r_inst.size=(m_size); if (r_inst.size<1 || r_inst.size>avail) return false; }
+#define _CI_ADDR(m_ofs) addr[addr_count++]=(m_ofs)
+#define _CI_ARGC(m_ofs) { if (avail<=(m_ofs) || c[m_ofs]<0 || c[m_ofs]>(p_limits ? p_limits->call_size : avail)) return false; }
+
+	switch(c[0]) {
+
+		case GDFunction::OPCODE_OPERATOR:
+		case GDFunction::OPCODE_OPERATOR_INT:
+		case GDFunction::OPCODE_OPERATOR_REAL:
+		case GDFunction::OPCODE_OPERATOR_VECTOR2:
+		case GDFunction::OPCODE_OPERATOR_VECTOR3:
+		case GDFunction::OPCODE_COMPARE_JUMP_IF_NOT: {
+			_CI_SIZE(5);
+			if (c[1]<0 || c[1]>=Variant::OP_MAX)
+				return false;
+			_CI_ADDR(2); _CI_ADDR(3); _CI_ADDR(4);
+			if (c[0]==GDFunction::OPCODE_COMPARE_JUMP_IF_NOT)
+				r_inst.next=GDFunction::OPCODE_JUMP_IF_NOT;
+		} break;
+		case GDFunction::OPCODE_EXTENDS_TEST:
+		case GDFunction::OPCODE_SET:
+		case GDFunction::OPCODE_GET: {
+			_CI_SIZE(4);
+			_CI_ADDR(1); _CI_ADDR(2); _CI_ADDR(3);
+		} break;
+		case GDFunction::OPCODE_SET_NAMED:
+		case GDFunction::OPCODE_GET_NAMED:
+		case GDFunction::OPCODE_GET_NAMED_CALL: {
+			_CI_SIZE(5);
+			_CI_ADDR(1); _CI_ADDR(4);
+			name=2;
+			cache=3;
+			if (c[0]==GDFunction::OPCODE_GET_NAMED_CALL) {
+				r_inst.next=GDFunction::OPCODE_CALL;
+				r_inst.next_alt=GDFunction::OPCODE_CALL_RETURN;
+			}
+		} break;
+		case GDFunction::OPCODE_ASSIGN:
+		case GDFunction::OPCODE_ASSIGN_JUMP: {
+			_CI_SIZE(3);
+			_CI_ADDR(1); _CI_ADDR(2);
+			if (c[0]==GDFunction::OPCODE_ASSIGN_JUMP)
+				r_inst.next=GDFunction::OPCODE_JUMP;
+		} break;
+		case GDFunction::OPCODE_ASSIGN_TRUE:
+		case GDFunction::OPCODE_ASSIGN_FALSE:
+		case GDFunction::OPCODE_YIELD_RESUME:
+		case GDFunction::OPCODE_RETURN:
+		case GDFunction::OPCODE_ASSERT: {
+			_CI_SIZE(2);
+			_CI_ADDR(1);
+		} break;
+		case GDFunction::OPCODE_CONSTRUCT: {
+			if (avail<2 || c[1]<0 || c[1]>=Variant::VARIANT_MAX)
+				return false;
+			_CI_ARGC(2);
+			_CI_SIZE(4+c[2]);
+			for(int i=0;i<c[2]+1;i++)
+				if (!_check_compiled_address(c[3+i],p_limits))
+					return false;
+		} break;
+		case GDFunction::OPCODE_CONSTRUCT_ARRAY:
+		case GDFunction::OPCODE_CONSTRUCT_DICTIONARY: {
+			if (avail<2 || c[1]<0 || c[1]>avail)
+				return false;
+			int args=c[0]==GDFunction::OPCODE_CONSTRUCT_DICTIONARY ? c[1]*2 : c[1];
+			_CI_SIZE(3+args);
+			for(int i=0;i<args+1;i++)
+				if (!_check_compiled_address(c[2+i],p_limits))
+					return false;
+		} break;
+		case GDFunction::OPCODE_CALL:
+		case GDFunction::OPCODE_CALL_RETURN: {
+			_CI_ARGC(1);
+			_CI_SIZE(6+c[1]);
+			for(int i=0;i<c[1];i++)
+				if (!_check_compiled_address(c[4+i],p_limits))
+					return false;
+			_CI_ADDR(2); _CI_ADDR(5+c[1]);
+			name=3;
+			cache=4+c[1];
+		} break;
+		case GDFunction::OPCODE_CALL_BUILT_IN: {
+			if (avail<2 || c[1]<0 || c[1]>=GDFunctions::FUNC_MAX)
+				return false;
+			_CI_ARGC(2);
+			_CI_SIZE(4+c[2]);
+			for(int i=0;i<c[2]+1;i++)
+				if (!_check_compiled_address(c[3+i],p_limits))
+					return false;
+		} break;
+		case GDFunction::OPCODE_CALL_SELF_BASE: {
+			_CI_ARGC(2);
+			_CI_SIZE(4+c[2]);
+			for(int i=0;i<c[2]+1;i++)
+				if (!_check_compiled_address(c[3+i],p_limits))
+					return false;
+			name=1;
+		} break;
+		case GDFunction::OPCODE_YIELD: {
+			r_inst.next=GDFunction::OPCODE_YIELD_RESUME;
+		} break;
+		case GDFunction::OPCODE_YIELD_SIGNAL: {
+			_CI_SIZE(3);
+			_CI_ADDR(1); _CI_ADDR(2);
+			r_inst.next=GDFunction::OPCODE_YIELD_RESUME;
+		} break;
+		case GDFunction::OPCODE_JUMP: {
+			_CI_SIZE(2);
+			r_inst.jump=1;
+		} break;
+		case GDFunction::OPCODE_JUMP_IF:
+		case GDFunction::OPCODE_JUMP_IF_NOT: {
+			_CI_SIZE(3);
+			_CI_ADDR(1);
+			r_inst.jump=2;
+		} break;
+		case GDFunction::OPCODE_ITERATE_BEGIN:
+		case GDFunction::OPCODE_ITERATE: {
+			_CI_SIZE(5);
+			_CI_ADDR(1); _CI_ADDR(2); _CI_ADDR(4);
+			r_inst.jump=3;
+		} break;
+		case GDFunction::OPCODE_ITERATE_RANGE_BEGIN: {
+			_CI_SIZE(9);
+			for(int i=1;i<=6;i++)
+				_CI_ADDR(i);
+			_CI_ADDR(8);
+			r_inst.jump=7;
+		} break;
+		case GDFunction::OPCODE_ITERATE_RANGE: {
+			_CI_SIZE(6);
+			_CI_ADDR(1); _CI_ADDR(2); _CI_ADDR(3); _CI_ADDR(5);
+			r_inst.jump=4;
+		} break;
+		case GDFunction::OPCODE_LINE: {
+			_CI_SIZE(2);
+		} break;
+		case GDFunction::OPCODE_JUMP_TO_DEF_ARGUMENT:
+		case GDFunction::OPCODE_BREAKPOINT:
+		case GDFunction::OPCODE_END: {
+		} break;
+		default: {
+			//OPCODE_CALL_SELF is never emitted
+			return false;
+		}
+	}
+
+#undef _CI_SIZE
+#undef _CI_ADDR
+#undef _CI_ARGC
+
+	if (!p_limits)
+		return true;
+
+	for(int i=0;i<addr_count;i++) {
+		if (!_check_compiled_address(c[addr[i]],p_limits))
+			return false;
+	}
+
+	if (name>=0 && (c[name]<0 || c[name]>=p_limits->global_name_count))
+		return false;
+	if (cache>=0 && (c[cache]<0 || c[cache]>=p_limits->inline_cache_count))
+		return false;
+
+	return true;
+}
+
+struct GDCompiler::CompiledWriter {
+
+	Vector<uint8_t> buf;
+	const GDScript *root;
+	Vector<StringName> runtime_globals; //names of the globals of this run, by index
+	Map<StringName,int> global_map; //globals used by the code, saved in the name table
+	Vector<StringName> global_names;
+
+	void put_u32(uint32_t p_value) {
+
+		int ofs=buf.size();
+		buf.resize(ofs+4);
+		encode_uint32(p_value,&buf[ofs]);
+	}
+
+	void put_string(const String& p_string) {
+
+		CharString cs=p_string.utf8();
+		put_u32(cs.length());
+		for(int i=0;i<cs.length();i++)
+			buf.push_back(cs[i]^0xb6);
+	}
+
+	bool put_variant(const Variant& p_value) {
+
+		int len;
+		if (encode_variant(p_value,NULL,len)!=OK)
+			return false;
+		int ofs=buf.size();
+		buf.resize(ofs+len);
+		encode_variant(p_value,&buf[ofs],len);
+		return true;
+	}
+
+	int get_global_index(int p_runtime_index) {
+
+		ERR_FAIL_INDEX_V(p_runtime_index,runtime_globals.size(),-1);
+		StringName name=runtime_globals[p_runtime_index];
+		if (!global_map.has(name)) {
+			global_map[name]=global_names.size();
+			global_names.push_back(name);
+		}
+		return global_map[name];
+	}
+
+	//how to find an inner class from the file it's in: the file path (empty for the file being saved) and the chain of class names
+	bool get_script_chain(const GDScript *p_script,String& r_path,Vector<StringName>& r_chain) const {
+
+		r_chain.clear();
+		while(p_script->_owner) {
+			r_chain.insert(0,p_script->name);
+			p_script=p_script->_owner;
+		}
+
+		if (p_script==root) {
+			r_path=String();
+			return true;
+		}
+
+		r_path=p_script->get_path();
+		return r_path.begins_with("res://") && r_path.find("::")==-1;
+	}
+};
+
+struct GDCompiler::CompiledReader {
+
+	const uint8_t *ptr;
+	int len;
+	int pos;
+	bool error;
+	GDScript *root;
+	Vector<int> globals; //name table index to global index of this run
+
+	uint32_t get_u32() {
+
+		if (pos+4>len) {
+			error=true;
+			return 0;
+		}
+		uint32_t v=decode_uint32(&ptr[pos]);
+		pos+=4;
+		return v;
+	}
+
+	int get_count() {
+
+		//every element stored takes at least 4 bytes, a damaged count must not size anything past the buffer
+		uint32_t c=get_u32();
+		if (error || c>uint32_t(len-pos)/4) {
+			error=true;
+			return 0;
+		}
+		return c;
+	}
+
+	String get_string() {
+
+		uint32_t l=get_u32();
+		if (error || l>uint32_t(len-pos)) {
+			error=true;
+			return String();
+		}
+
+		CharString cs;
+		cs.resize(l+1);
+		for(uint32_t i=0;i<l;i++)
+			cs[i]=ptr[pos+i]^0xb6;
+		cs[l]=0;
+		pos+=l;
+
+		String s;
+		s.parse_utf8(cs.get_data());
+		return s;
+	}
+
+	bool get_variant(Variant& r_value) {
+
+		int l;
+		if (error || decode_variant(r_value,&ptr[pos],len-pos,&l)!=OK) {
+			error=true;
+			return false;
+		}
+		pos+=l;
+		return true;
+	}
+
+	GDScript *get_script_chain(const String& p_path,const Vector<StringName>& p_chain,Ref<GDScript>& r_file) const {
+
+		GDScript *script=root;
+
+		if (p_path!=String()) {
+			r_file=ResourceLoader::load(p_path);
+			if (r_file.is_null() || !r_file->valid)
+				return NULL;
+			script=r_file.ptr();
+		} else if (p_chain.empty()) {
+			return NULL;
+		}
+
+		for(int i=0;i<p_chain.size();i++) {
+
+			Map<StringName,Ref<GDScript> >::Element *E=script->subclasses.find(p_chain[i]);
+			if (!E)
+				return NULL;
+			script=E->get().ptr();
+		}
+
+		return script;
+	}
+};
+
+bool GDCompiler::_save_compiled_constant(CompiledWriter& w,const Variant& p_value) {
+
+	switch(p_value.get_type()) {
+
+		case Variant::OBJECT: {
+
+			Object *obj=p_value;
+			if (!obj)
+				break;
+
+			GDScript *script=obj->cast_to<GDScript>();
+			if (script) {
+
+				String path;
+				Vector<StringName> chain;
+				if (!w.get_script_chain(script,path,chain))
+					return false;
+
+				w.put_u32(COMPILED_CONSTANT_SCRIPT);
+				w.put_string(path);
+				w.put_u32(chain.size());
+				for(int i=0;i<chain.size();i++)
+					w.put_string(chain[i]);
+				return true;
+			}
+
+			Resource *res=obj->cast_to<Resource>();
+			if (!res || !res->get_path().begins_with("res://") || res->get_path().find("::")!=-1)
+				return false; //only resources that can be loaded again (preloads)
+
+			w.put_u32(COMPILED_CONSTANT_RESOURCE);
+			w.put_string(res->get_path());
+			return true;
+		} break;
+		case Variant::ARRAY: {
+
+			Array array=p_value;
+			w.put_u32(COMPILED_CONSTANT_ARRAY);
+			w.put_u32(array.is_shared());
+			w.put_u32(array.size());
+			for(int i=0;i<array.size();i++) {
+				if (!_save_compiled_constant(w,array[i]))
+					return false;
+			}
+			return true;
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary dict=p_value;
+			List<Variant> keys;
+			dict.get_key_list(&keys);
+
+			w.put_u32(COMPILED_CONSTANT_DICTIONARY);
+			w.put_u32(dict.is_shared());
+			w.put_u32(keys.size());
+			for(List<Variant>::Element *E=keys.front();E;E=E->next()) {
+				if (!_save_compiled_constant(w,E->get()) || !_save_compiled_constant(w,dict[E->get()]))
+					return false;
+			}
+			return true;
+		} break;
+		default: {}
+	}
+
+	w.put_u32(COMPILED_CONSTANT_VALUE);
+	return w.put_variant(p_value);
+}
+
+bool GDCompiler::_load_compiled_constant(CompiledReader& r,Variant& r_value) {
+
+	switch(r.get_u32()) {
+
+		case COMPILED_CONSTANT_VALUE: {
+
+			return r.get_variant(r_value);
+		} break;
+		case COMPILED_CONSTANT_RESOURCE: {
+
+			String path=r.get_string();
+			if (r.error)
+				return false;
+			RES res=ResourceLoader::load(path);
+			if (res.is_null())
+				return false;
+			r_value=res;
+			return true;
+		} break;
+		case COMPILED_CONSTANT_SCRIPT: {
+
+			String path=r.get_string();
+			Vector<StringName> chain;
+			chain.resize(r.get_count());
+			for(int i=0;i<chain.size() && !r.error;i++)
+				chain[i]=r.get_string();
+			if (r.error)
+				return false;
+
+			Ref<GDScript> file;
+			GDScript *script=r.get_script_chain(path,chain,file);
+			if (!script)
+				return false;
+			r_value=Ref<GDScript>(script);
+			return true;
+		} break;
+		case COMPILED_CONSTANT_ARRAY: {
+
+			Array array(r.get_u32()!=0);
+			int size=r.get_u32();
+			for(int i=0;i<size && !r.error;i++) {
+				Variant v;
+				if (!_load_compiled_constant(r,v))
+					return false;
+				array.push_back(v);
+			}
+			r_value=array;
+			return !r.error;
+		} break;
+		case COMPILED_CONSTANT_DICTIONARY: {
+
+			Dictionary dict(r.get_u32()!=0);
+			int size=r.get_u32();
+			for(int i=0;i<size && !r.error;i++) {
+				Variant k,v;
+				if (!_load_compiled_constant(r,k) || !_load_compiled_constant(r,v))
+					return false;
+				dict[k]=v;
+			}
+			r_value=dict;
+			return !r.error;
+		} break;
+	}
+
+	return false;
+}
+
+bool GDCompiler::_save_compiled_function(CompiledWriter& w,const GDFunction *p_func) {
+
+	w.put_string(p_func->name);
+	w.put_u32(p_func->_static);
+	w.put_u32(p_func->rpc_mode);
+	w.put_u32(p_func->_argument_count);
+	w.put_u32(p_func->_stack_size);
+	w.put_u32(p_func->_call_size);
+	w.put_u32(p_func->_inline_cache_count);
+	w.put_u32(p_func->_initial_line);
+
+#ifdef TOOLS_ENABLED
+	w.put_u32(p_func->arg_names.size());
+	for(int i=0;i<p_func->arg_names.size();i++)
+		w.put_string(p_func->arg_names[i]);
+#else
+	w.put_u32(0);
+#endif
+
+	w.put_u32(p_func->constants.size());
+	for(int i=0;i<p_func->constants.size();i++) {
+		if (!_save_compiled_constant(w,p_func->constants[i]))
+			return false;
+	}
+
+	w.put_u32(p_func->global_names.size());
+	for(int i=0;i<p_func->global_names.size();i++)
+		w.put_string(p_func->global_names[i]);
+
+	//line opcodes stay, errors and the sampler report lines from exported games too
+	w.put_u32(p_func->default_arguments.size());
+	for(int i=0;i<p_func->default_arguments.size();i++)
+		w.put_u32(p_func->default_arguments[i]);
+
+	int code_size=p_func->code.size();
+	const int *code=code_size ? &p_func->code[0] : NULL;
+
+	w.put_u32(code_size);
+	for(int ip=0;ip<code_size;) {
+
+		//walk instructions, so only operands can be taken for global addresses
+		_CompiledInstruction inst;
+		if (!_get_compiled_instruction(code,ip,code_size,NULL,inst))
+			return false;
+
+		for(int i=0;i<inst.size;i++) {
+
+			int word=code[ip+i];
+			if (i>0 && i!=inst.jump && _is_global_address(word)) {
+				int idx=w.get_global_index(word&GDFunction::ADDR_MASK);
+				if (idx<0)
+					return false;
+				word=idx|(GDFunction::ADDR_TYPE_GLOBAL<<GDFunction::ADDR_BITS);
+			}
+			w.put_u32(word);
+		}
+		ip+=inst.size;
+	}
+
+	return true;
+}
+
+bool GDCompiler::_verify_compiled_function(const GDFunction *p_func,int p_member_count) {
+
+	//the file may be damaged or made by hand, the VM only checks operands in debug builds
+	_CompiledLimits limits;
+	limits.stack_size=p_func->_stack_size;
+	limits.call_size=p_func->_call_size;
+	limits.member_count=p_member_count;
+	limits.constant_count=p_func->constants.size();
+	limits.global_name_count=p_func->global_names.size();
+	limits.inline_cache_count=p_func->_inline_cache_count;
+	limits.global_count=GDScriptLanguage::get_singleton()->get_global_array_size();
+
+	int code_size=p_func->code.size();
+	const int *code=code_size ? &p_func->code[0] : NULL;
+
+	Vector<bool> boundary;
+	boundary.resize(code_size+1);
+	for(int i=0;i<code_size;i++)
+		boundary[i]=false;
+	boundary[code_size]=true; //jumping to the end returns
+
+	Vector<int> jumps;
+	bool has_def_arg_jump=false;
+
+	for(int ip=0;ip<code_size;) {
+
+		_CompiledInstruction inst;
+		if (!_get_compiled_instruction(code,ip,code_size,&limits,inst))
+			return false;
+
+		boundary[ip]=true;
+		if (inst.jump)
+			jumps.push_back(code[ip+inst.jump]);
+		if (code[ip]==GDFunction::OPCODE_JUMP_TO_DEF_ARGUMENT)
+			has_def_arg_jump=true;
+
+		ip+=inst.size;
+		if (inst.next>=0 && (ip>=code_size || (code[ip]!=inst.next && code[ip]!=inst.next_alt)))
+			return false;
+	}
+
+	if (has_def_arg_jump && p_func->default_arguments.empty())
+		return false;
+
+	for(int i=0;i<p_func->default_arguments.size();i++)
+		jumps.push_back(p_func->default_arguments[i]);
+
+	for(int i=0;i<jumps.size();i++) {
+		if (jumps[i]<0 || jumps[i]>code_size || !boundary[jumps[i]])
+			return false;
+	}
+
+	return true;
+}
+
+bool GDCompiler::_load_compiled_function(CompiledReader& r,GDScript *p_script) {
+
+	StringName func_name=r.get_string();
+	if (r.error || p_script->member_functions.has(func_name))
+		return false;
+
+	GDFunction *gdfunc=memnew(GDFunction);
+	p_script->member_functions[func_name]=gdfunc;
+
+	gdfunc->name=func_name;
+	gdfunc->_static=r.get_u32();
+	gdfunc->rpc_mode=ScriptInstance::RPCMode(r.get_u32());
+	gdfunc->_argument_count=r.get_u32();
+	gdfunc->_stack_size=r.get_u32();
+	gdfunc->_call_size=r.get_u32();
+	int inline_cache_count=r.get_u32();
+	gdfunc->_initial_line=r.get_u32();
+
+	int arg_name_count=r.get_u32();
+	for(int i=0;i<arg_name_count && !r.error;i++) {
+		StringName arg_name=r.get_string();
+#ifdef TOOLS_ENABLED
+		gdfunc->arg_names.push_back(arg_name);
+#endif
+	}
+
+	gdfunc->constants.resize(r.get_count());
+	for(int i=0;i<gdfunc->constants.size() && !r.error;i++) {
+		if (!_load_compiled_constant(r,gdfunc->constants[i]))
+			return false;
+	}
+
+	gdfunc->global_names.resize(r.get_count());
+	for(int i=0;i<gdfunc->global_names.size() && !r.error;i++)
+		gdfunc->global_names[i]=r.get_string();
+
+	gdfunc->default_arguments.resize(r.get_count());
+	for(int i=0;i<gdfunc->default_arguments.size() && !r.error;i++)
+		gdfunc->default_arguments[i]=r.get_u32();
+
+	int code_size=r.get_u32();
+	if (r.error || code_size<0 || code_size>(r.len-r.pos)/4)
+		return false;
+
+	gdfunc->code.resize(code_size);
+	for(int i=0;i<code_size;i++) {
+
+		int word=r.get_u32();
+		if (_is_global_address(word)) {
+			int idx=word&GDFunction::ADDR_MASK;
+			if (idx>=r.globals.size())
+				return false;
+			word=r.globals[idx]|(GDFunction::ADDR_TYPE_GLOBAL<<GDFunction::ADDR_BITS);
+		}
+		gdfunc->code[i]=word;
+	}
+
+	if (r.error || gdfunc->_argument_count<0 || gdfunc->_stack_size<gdfunc->_argument_count || gdfunc->_stack_size>GDFunction::ADDR_MASK || gdfunc->_call_size<0 || gdfunc->_call_size>GDFunction::ADDR_MASK)
+		return false;
+	if (inline_cache_count<0 || inline_cache_count>code_size) //one per instruction at most
+		return false;
+
+	//same setup as _parse_function()
+	gdfunc->_constant_count=gdfunc->constants.size();
+	gdfunc->_constants_ptr=gdfunc->constants.size() ? &gdfunc->constants[0] : NULL;
+	gdfunc->_global_names_count=gdfunc->global_names.size();
+	gdfunc->_global_names_ptr=gdfunc->global_names.size() ? &gdfunc->global_names[0] : NULL;
+	gdfunc->_code_size=gdfunc->code.size();
+	gdfunc->_code_ptr=gdfunc->code.size() ? &gdfunc->code[0] : NULL;
+
+	if (gdfunc->default_arguments.size()) {
+		gdfunc->_default_arg_count=gdfunc->default_arguments.size()-1;
+		gdfunc->_default_arg_ptr=&gdfunc->default_arguments[0];
+	} else {
+		gdfunc->_default_arg_count=0;
+		gdfunc->_default_arg_ptr=NULL;
+	}
+
+	if (inline_cache_count) {
+		gdfunc->inline_caches.resize(inline_cache_count);
+		gdfunc->_inline_caches_ptr=&gdfunc->inline_caches[0];
+		gdfunc->_inline_cache_count=inline_cache_count;
+	}
+
+	if (!_verify_compiled_function(gdfunc,p_script->member_indices.size()))
+		return false;
+
+	gdfunc->_script=p_script;
+	gdfunc->source=source;
+
+#ifdef DEBUG_ENABLED
+	gdfunc->func_cname=(String(source)+" - "+String(func_name)).utf8();
+	gdfunc->_func_cname=gdfunc->func_cname.get_data();
+#endif
+
+#ifdef TOOLS_ENABLED
+	if (gdfunc->_initial_line)
+		p_script->member_lines[func_name]=gdfunc->_initial_line;
+#endif
+
+	return true;
+}
+
+bool GDCompiler::_save_compiled_class(CompiledWriter& w,const GDScript *p_script) {
+
+	w.put_string(p_script->name);
+	w.put_u32(p_script->tool);
+
+	//base
+
+	if (p_script->_base) {
+
+		String path;
+		Vector<StringName> chain;
+		if (!w.get_script_chain(p_script->_base,path,chain))
+			return false;
+
+		w.put_u32(COMPILED_BASE_SCRIPT);
+		w.put_string(path);
+		w.put_u32(chain.size());
+		for(int i=0;i<chain.size();i++)
+			w.put_string(chain[i]);
+
+	} else if (p_script->native.is_valid()) {
+
+		//save the name scripts know the class by, which may differ from the type name
+		int idx=-1;
+		const Variant *globals=GDScriptLanguage::get_singleton()->get_global_array();
+		for(int i=0;i<w.runtime_globals.size();i++) {
+			if (globals[i].get_type()==Variant::OBJECT && (Object*)globals[i]==p_script->native.ptr()) {
+				idx=i;
+				break;
+			}
+		}
+		if (idx<0)
+			return false;
+
+		w.put_u32(COMPILED_BASE_NATIVE);
+		w.put_string(w.runtime_globals[idx]);
+	} else {
+
+		w.put_u32(COMPILED_BASE_NONE);
+	}
+
+	//members declared in this class, inherited ones come from the base
+
+	w.put_u32(p_script->members.size());
+	for(const Set<StringName>::Element *E=p_script->members.front();E;E=E->next()) {
+
+		const Map<StringName,GDScript::MemberInfo>::Element *MI=p_script->member_indices.find(E->get());
+		const Map<StringName,PropertyInfo>::Element *PI=p_script->member_info.find(E->get());
+		ERR_FAIL_COND_V(!MI || !PI,false);
+
+		w.put_string(E->get());
+		w.put_u32(MI->get().index);
+		w.put_string(MI->get().setter);
+		w.put_string(MI->get().getter);
+		w.put_u32(MI->get().rpc_mode);
+		w.put_u32(PI->get().type);
+		w.put_string(PI->get().name);
+		w.put_u32(PI->get().hint);
+		w.put_string(PI->get().hint_string);
+		w.put_u32(PI->get().usage);
+	}
+
+	//constants, except subclasses which are saved below
+
+	int constant_count=0;
+	for(const Map<StringName,Variant>::Element *E=p_script->constants.front();E;E=E->next()) {
+		if (!p_script->subclasses.has(E->key()))
+			constant_count++;
+	}
+
+	w.put_u32(constant_count);
+	for(const Map<StringName,Variant>::Element *E=p_script->constants.front();E;E=E->next()) {
+
+		if (p_script->subclasses.has(E->key()))
+			continue;
+		w.put_string(E->key());
+		if (!_save_compiled_constant(w,E->get()))
+			return false;
+	}
+
+	//signals
+
+	w.put_u32(p_script->_signals.size());
+	for(const Map<StringName,Vector<StringName> >::Element *E=p_script->_signals.front();E;E=E->next()) {
+
+		w.put_string(E->key());
+		w.put_u32(E->get().size());
+		for(int i=0;i<E->get().size();i++)
+			w.put_string(E->get()[i]);
+	}
+
+	//subclasses can extend earlier siblings, so each one is saved after the siblings its classes extend
+
+	Vector<const GDScript*> pending;
+	for(const Map<StringName,Ref<GDScript> >::Element *E=p_script->subclasses.front();E;E=E->next())
+		pending.push_back(E->get().ptr());
+
+	w.put_u32(pending.size());
+	while(pending.size()) {
+
+		int ready=-1;
+		for(int i=0;i<pending.size() && ready<0;i++) {
+
+			ready=i;
+
+			List<const GDScript*> tree;
+			tree.push_back(pending[i]);
+			while(tree.size() && ready==i) {
+
+				const GDScript *sc=tree.front()->get();
+				tree.pop_front();
+				for(const Map<StringName,Ref<GDScript> >::Element *E=sc->subclasses.front();E;E=E->next())
+					tree.push_back(E->get().ptr());
+
+				const GDScript *base=sc->_base;
+				while(base && base->_owner!=p_script)
+					base=base->_owner;
+				if (base && base!=pending[i] && pending.find(base)!=-1)
+					ready=-1;
+			}
+		}
+
+		ERR_FAIL_COND_V(ready<0,false);
+
+		if (!_save_compiled_class(w,pending[ready]))
+			return false;
+		pending.remove(ready);
+	}
+
+	//functions
+
+	w.put_u32(p_script->member_functions.size());
+	for(const Map<StringName,GDFunction*>::Element *E=p_script->member_functions.front();E;E=E->next()) {
+
+		if (!_save_compiled_function(w,E->get()))
+			return false;
+	}
+
+	return true;
+}
+
+bool GDCompiler::_load_compiled_class(CompiledReader& r,GDScript *p_script,GDScript *p_owner) {
+
+	p_script->native=Ref<GDNativeClass>();
+	p_script->base=Ref<GDScript>();
+	p_script->_base=NULL;
+	p_script->members.clear();
+	p_script->constants.clear();
+	for (Map<StringName,GDFunction*>::Element *E=p_script->member_functions.front();E;E=E->next()) {
+		memdelete(E->get());
+	}
+	p_script->member_functions.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->_signals.clear();
+	p_script->initializer=NULL;
+	p_script->subclasses.clear();
+
+	p_script->_owner=p_owner;
+	p_script->name=r.get_string();
+	p_script->tool=r.get_u32();
+
+	//base, resolved like _parse_class() does
+
+	switch(r.get_u32()) {
+
+		case COMPILED_BASE_NONE: {
+		} break;
+		case COMPILED_BASE_NATIVE: {
+
+			StringName name=r.get_string();
+			const Map<StringName,int>::Element *E=GDScriptLanguage::get_singleton()->get_global_map().find(name);
+			if (r.error || !E)
+				return false;
+			Ref<GDNativeClass> native=GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+			if (native.is_null())
+				return false;
+			p_script->native=native;
+		} break;
+		case COMPILED_BASE_SCRIPT: {
+
+			String path=r.get_string();
+			Vector<StringName> chain;
+			chain.resize(r.get_count());
+			for(int i=0;i<chain.size() && !r.error;i++)
+				chain[i]=r.get_string();
+			if (r.error)
+				return false;
+
+			Ref<GDScript> file;
+			GDScript *base=r.get_script_chain(path,chain,file);
+			if (!base || !base->valid)
+				return false;
+
+			p_script->base=Ref<GDScript>(base);
+			p_script->_base=base;
+			p_script->member_indices=base->member_indices;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	//members
+
+	int member_count=r.get_u32();
+	for(int i=0;i<member_count && !r.error;i++) {
+
+		StringName name=r.get_string();
+		GDScript::MemberInfo minfo;
+		minfo.index=r.get_u32();
+		minfo.setter=r.get_string();
+		minfo.getter=r.get_string();
+		minfo.rpc_mode=ScriptInstance::RPCMode(r.get_u32());
+
+		PropertyInfo pinfo;
+		pinfo.type=Variant::Type(r.get_u32());
+		pinfo.name=r.get_string();
+		pinfo.hint=PropertyHint(r.get_u32());
+		pinfo.hint_string=r.get_string();
+		pinfo.usage=r.get_u32();
+
+		if (p_script->member_indices.has(name))
+			return false;
+
+		p_script->member_indices[name]=minfo;
+		p_script->member_info[name]=pinfo;
+		p_script->members.insert(name);
+	}
+
+	//indices must be the ones instances are sized for
+	for(const Map<StringName,GDScript::MemberInfo>::Element *E=p_script->member_indices.front();E;E=E->next()) {
+		if (E->get().index<0 || E->get().index>=p_script->member_indices.size())
+			return false;
+	}
+
+	//constants
+
+	int constant_count=r.get_u32();
+	for(int i=0;i<constant_count && !r.error;i++) {
+
+		StringName name=r.get_string();
+		Variant value;
+		if (!_load_compiled_constant(r,value))
+			return false;
+		p_script->constants.insert(name,value);
+	}
+
+	//signals
+
+	int signal_count=r.get_u32();
+	for(int i=0;i<signal_count && !r.error;i++) {
+
+		StringName name=r.get_string();
+		Vector<StringName> args;
+		args.resize(r.get_count());
+		for(int j=0;j<args.size() && !r.error;j++)
+			args[j]=r.get_string();
+		p_script->_signals[name]=args;
+	}
+
+	//subclasses
+
+	int subclass_count=r.get_u32();
+	for(int i=0;i<subclass_count && !r.error;i++) {
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+
+		if (!_load_compiled_class(r,subclass.ptr(),p_script))
+			return false;
+
+		p_script->constants.insert(subclass->name,subclass);
+		p_script->subclasses.insert(subclass->name,subclass);
+	}
+
+	//functions
+
+	int function_count=r.get_u32();
+	for(int i=0;i<function_count && !r.error;i++) {
+
+		if (!_load_compiled_function(r,p_script))
+			return false;
+	}
+
+	if (r.error)
+		return false;
+
+	const Map<StringName,GDFunction*>::Element *init=p_script->member_functions.find("_init");
+	if (!init)
+		return false;
+	p_script->initializer=init->get();
+
+	p_script->valid=true;
+	return true;
+}
+
+bool GDCompiler::is_compiled_buffer(const Vector<uint8_t>& p_buffer) {
+
+	return p_buffer.size()>=COMPILED_HEADER_SIZE && p_buffer[0]=='G' && p_buffer[1]=='D' && p_buffer[2]=='C' && p_buffer[3]=='C';
+}
+
+Vector<uint8_t> GDCompiler::make_compiled_buffer(const GDScript *p_script,const Vector<uint8_t>& p_tokens) {
+
+	ERR_FAIL_COND_V(!p_script->valid || p_script->_owner,Vector<uint8_t>());
+
+	CompiledWriter w;
+	w.root=p_script;
+
+	const Map<StringName,int> &globals=GDScriptLanguage::get_singleton()->get_global_map();
+	w.runtime_globals.resize(GDScriptLanguage::get_singleton()->get_global_array_size());
+	for(const Map<StringName,int>::Element *E=globals.front();E;E=E->next()) {
+		w.runtime_globals[E->get()]=E->key();
+	}
+
+	//the class goes first, the global name table it fills is written in front of it
+	if (!_save_compiled_class(w,p_script))
+		return Vector<uint8_t>(); //uses something that can't be saved, keep only the tokens
+
+	Vector<uint8_t> compiled=w.buf;
+	w.buf.clear();
+	w.put_u32(w.global_names.size());
+	for(int i=0;i<w.global_names.size();i++)
+		w.put_string(w.global_names[i]);
+	Vector<uint8_t> names=w.buf;
+
+	Vector<uint8_t> buf;
+	buf.resize(COMPILED_HEADER_SIZE+p_tokens.size()+names.size()+compiled.size());
+	buf[0]='G';
+	buf[1]='D';
+	buf[2]='C';
+	buf[3]='C';
+	encode_uint32(COMPILED_VERSION,&buf[4]);
+	encode_uint32(_get_compiled_build_hash(),&buf[8]);
+	encode_uint32(hash_djb2_buffer(p_tokens.ptr(),p_tokens.size()),&buf[12]);
+	encode_uint32(p_tokens.size(),&buf[16]);
+	encode_uint32(names.size()+compiled.size(),&buf[20]);
+
+	uint8_t *dst=&buf[COMPILED_HEADER_SIZE];
+	copymem(dst,p_tokens.ptr(),p_tokens.size());
+	dst+=p_tokens.size();
+	copymem(dst,names.ptr(),names.size());
+	dst+=names.size();
+	copymem(dst,compiled.ptr(),compiled.size());
+
+	return buf;
+}
+
+Error GDCompiler::load_compiled_buffer(const Vector<uint8_t>& p_buffer,GDScript *p_script,Vector<uint8_t>& r_tokens) {
+
+	ERR_FAIL_COND_V(!is_compiled_buffer(p_buffer),ERR_FILE_UNRECOGNIZED);
+
+	const uint8_t *buf=p_buffer.ptr();
+	uint32_t token_size=decode_uint32(&buf[16]);
+	uint32_t compiled_size=decode_uint32(&buf[20]);
+	ERR_FAIL_COND_V(token_size>uint32_t(p_buffer.size()-COMPILED_HEADER_SIZE),ERR_FILE_CORRUPT);
+	ERR_FAIL_COND_V(compiled_size!=uint32_t(p_buffer.size()-COMPILED_HEADER_SIZE)-token_size,ERR_FILE_CORRUPT);
+
+	r_tokens.resize(token_size);
+	if (token_size)
+		copymem(r_tokens.ptr(),&buf[COMPILED_HEADER_SIZE],token_size);
+
+	if (decode_uint32(&buf[4])!=COMPILED_VERSION || decode_uint32(&buf[8])!=_get_compiled_build_hash())
+		return ERR_FILE_UNRECOGNIZED; //compiled by another engine version
+	if (decode_uint32(&buf[12])!=hash_djb2_buffer(r_tokens.ptr(),r_tokens.size()))
+		return ERR_FILE_CORRUPT;
+	if (ScriptDebugger::get_singleton())
+		return ERR_UNAVAILABLE; //the debugger needs the stack info only the compiler generates
+
+	CompiledReader r;
+	r.ptr=&buf[COMPILED_HEADER_SIZE+token_size];
+	r.len=compiled_size;
+	r.pos=0;
+	r.error=false;
+	r.root=p_script;
+
+	const Map<StringName,int> &globals=GDScriptLanguage::get_singleton()->get_global_map();
+	r.globals.resize(r.get_count());
+	for(int i=0;i<r.globals.size() && !r.error;i++) {
+
+		const Map<StringName,int>::Element *E=globals.find(r.get_string());
+		if (!E)
+			return ERR_UNAVAILABLE; //a global the script uses is not registered in this run
+		r.globals[i]=E->get();
+	}
+
+	err_line=-1;
+	err_column=-1;
+	error="";
+	source=p_script->get_path();
+
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches();
+
+	if (!_load_compiled_class(r,p_script,NULL) || r.pos!=r.len) {
+		p_script->valid=false;
+		return ERR_FILE_CORRUPT;
+	}
+
+	return OK;
+}
+
 String GDCompiler::get_error() const {
 
 	return error;
@@ -44,13 +44,15 @@ class GDCompiler {
 
 	        List< Map<StringName,int> > stack_id_stack;
 			Map<StringName,int> stack_identifiers;
+			Map<int,Variant::Type> stack_type_guesses; // type each stack slot is expected to hold, NIL if unknown
 
 	        List<GDFunction::StackDebug> stack_debug;
 	        List< Map<StringName,int> > block_identifier_stack;
 	        Map<StringName,int> block_identifiers;
 
-	        void add_stack_identifier(const StringName& p_id,int p_stackpos) {
+	        void add_stack_identifier(const StringName& p_id,int p_stackpos,Variant::Type p_type_guess=Variant::NIL) {
 	            stack_identifiers[p_id]=p_stackpos;
+	            stack_type_guesses[p_stackpos]=p_type_guess;
 	            if (debug_stack) {
 	                block_identifiers[p_id]=p_stackpos;
 	                GDFunction::StackDebug sd;
@@ -117,10 +119,37 @@ class GDCompiler {
 		Vector<int> opcodes;
 		void alloc_stack(int p_level) { if (p_level >= stack_max) stack_max=p_level+1; }
 		void alloc_call(int p_params) { if (p_params >= call_max) call_max=p_params; }
+		int alloc_inline_cache() { return inline_cache_count++; }
+
+		// superinstructions: when an instruction that can be fused with the next one ends right
+		// where the next one starts, its opcode is replaced by the fused one. both instructions keep
+		// their operands, so code addresses don't change and jumps to the second one still work.
+		int last_assign;
+		int last_get_named;
+		int last_compare;
+
+		void push_jump() {
+			if (last_assign>=0 && last_assign+3==opcodes.size())
+				opcodes[last_assign]=GDFunction::OPCODE_ASSIGN_JUMP;
+			opcodes.push_back(GDFunction::OPCODE_JUMP);
+		}
+
+		void push_jump_if_not(int p_test) {
+			if (last_compare>=0 && last_compare+5==opcodes.size() && opcodes[last_compare+4]==p_test)
+				opcodes[last_compare]=GDFunction::OPCODE_COMPARE_JUMP_IF_NOT;
+			opcodes.push_back(GDFunction::OPCODE_JUMP_IF_NOT);
+			opcodes.push_back(p_test);
+		}
+
+		void fuse_get_named_call(int p_base) {
+			if (last_get_named>=0 && last_get_named+5==opcodes.size() && opcodes[last_get_named+4]==p_base)
+				opcodes[last_get_named]=GDFunction::OPCODE_GET_NAMED_CALL;
+		}
 
         	int current_line;
 		int stack_max;
 		int call_max;
+		int inline_cache_count;
 	};
 
 #if 0
@@ -136,6 +165,19 @@ class GDCompiler {
 
 	void _set_error(const String& p_error,const GDParser::Node *p_node);
 
+	// compiled form of scripts, see make_compiled_buffer()
+	struct CompiledWriter;
+	struct CompiledReader;
+
+	static bool _save_compiled_constant(CompiledWriter& w,const Variant& p_value);
+	static bool _load_compiled_constant(CompiledReader& r,Variant& r_value);
+	static bool _save_compiled_function(CompiledWriter& w,const GDFunction *p_func);
+	static bool _verify_compiled_function(const GDFunction *p_func,int p_member_count);
+	bool _load_compiled_function(CompiledReader& r,GDScript *p_script);
+	static bool _save_compiled_class(CompiledWriter& w,const GDScript *p_script);
+	bool _load_compiled_class(CompiledReader& r,GDScript *p_script,GDScript *p_owner);
+
+	Variant::Type _guess_expression_type(CodeGen& codegen,const GDParser::Node *p_expression) const;
 	bool _create_unary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level,bool p_initializer=false);
 
@@ -154,6 +196,12 @@ public:
 
 	Error compile(const GDParser *p_parser, GDScript *p_script, bool p_keep_state=false);
 
+	// compiled scripts are stored on export together with their token stream, and load
+	// without parsing as long as they were compiled by the same engine build
+	static bool is_compiled_buffer(const Vector<uint8_t>& p_buffer);
+	static Vector<uint8_t> make_compiled_buffer(const GDScript *p_script,const Vector<uint8_t>& p_tokens);
+	Error load_compiled_buffer(const Vector<uint8_t>& p_buffer,GDScript *p_script,Vector<uint8_t>& r_tokens);
+
 	String get_error() const;
 	int get_error_line() const;
 	int get_error_column() const;
@@ -2,6 +2,9 @@
 #include "gd_script.h"
 #include "os/os.h"
 #include "gd_functions.h"
+#include "core_string_names.h"
+#include "os/main_loop.h"
+#include "thread_free_list.h"
 
 Variant *GDFunction::_get_variant(int p_address,GDInstance *p_instance,GDScript *p_script,Variant &self, Variant *p_stack,String& r_error) const{
 
@@ -139,6 +142,502 @@ static String _get_var_type(const Variant* p_type) {
 
 }
 
+// Fast paths for the typed operator opcodes. They return false when the operands
+// are not of the types the compiler guessed, or when the operation must report an
+// error (division by zero), so the caller can fall back to Variant::evaluate().
+
+static _FORCE_INLINE_ bool _evaluate_int(Variant::Operator p_op,const Variant& p_a,const Variant& p_b,Variant& r_dst) {
+
+	if (p_a.get_type()!=Variant::INT || p_b.get_type()!=Variant::INT)
+		return false;
+
+	int a=p_a._get_int();
+	int b=p_b._get_int();
+
+	switch(p_op) {
+
+		case Variant::OP_ADD: r_dst._set_int(a+b); return true;
+		case Variant::OP_SUBSTRACT: r_dst._set_int(a-b); return true;
+		case Variant::OP_MULTIPLY: r_dst._set_int(a*b); return true;
+		case Variant::OP_DIVIDE: if (b==0) return false; r_dst._set_int(a/b); return true;
+		case Variant::OP_MODULE: if (b==0) return false; r_dst._set_int(a%b); return true;
+		case Variant::OP_EQUAL: r_dst._set_bool(a==b); return true;
+		case Variant::OP_NOT_EQUAL: r_dst._set_bool(a!=b); return true;
+		case Variant::OP_LESS: r_dst._set_bool(a<b); return true;
+		case Variant::OP_LESS_EQUAL: r_dst._set_bool(a<=b); return true;
+		case Variant::OP_GREATER: r_dst._set_bool(a>b); return true;
+		case Variant::OP_GREATER_EQUAL: r_dst._set_bool(a>=b); return true;
+		case Variant::OP_NEGATE: r_dst._set_int(-a); return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ bool _evaluate_real(Variant::Operator p_op,const Variant& p_a,const Variant& p_b,Variant& r_dst) {
+
+	Variant::Type ta=p_a.get_type();
+	Variant::Type tb=p_b.get_type();
+
+	if (ta==Variant::INT && tb==Variant::INT)
+		return false; //integer math, division and modulo behave differently
+
+	double a,b;
+
+	if (ta==Variant::REAL)
+		a=p_a._get_real();
+	else if (ta==Variant::INT)
+		a=p_a._get_int();
+	else
+		return false;
+
+	if (tb==Variant::REAL)
+		b=p_b._get_real();
+	else if (tb==Variant::INT)
+		b=p_b._get_int();
+	else
+		return false;
+
+	switch(p_op) {
+
+		case Variant::OP_ADD: r_dst._set_real(a+b); return true;
+		case Variant::OP_SUBSTRACT: r_dst._set_real(a-b); return true;
+		case Variant::OP_MULTIPLY: r_dst._set_real(a*b); return true;
+		case Variant::OP_DIVIDE: r_dst._set_real(a/b); return true;
+		case Variant::OP_EQUAL: r_dst._set_bool(a==b); return true;
+		case Variant::OP_NOT_EQUAL: r_dst._set_bool(a!=b); return true;
+		case Variant::OP_LESS: r_dst._set_bool(a<b); return true;
+		case Variant::OP_LESS_EQUAL: r_dst._set_bool(a<=b); return true;
+		case Variant::OP_GREATER: r_dst._set_bool(a>b); return true;
+		case Variant::OP_GREATER_EQUAL: r_dst._set_bool(a>=b); return true;
+		case Variant::OP_NEGATE: r_dst._set_real(-a); return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ bool _get_number(const Variant& p_value,real_t &r_number) {
+
+	switch(p_value.get_type()) {
+		case Variant::INT: r_number=p_value._get_int(); return true;
+		case Variant::REAL: r_number=p_value._get_real(); return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ bool _evaluate_vector2(Variant::Operator p_op,const Variant& p_a,const Variant& p_b,Variant& r_dst) {
+
+	Variant::Type ta=p_a.get_type();
+	Variant::Type tb=p_b.get_type();
+	real_t n;
+
+	if (ta==Variant::VECTOR2 && tb==Variant::VECTOR2) {
+
+		Vector2 a=p_a._get_vector2();
+		Vector2 b=p_b._get_vector2();
+
+		switch(p_op) {
+
+			case Variant::OP_ADD: r_dst._set_vector2(a+b); return true;
+			case Variant::OP_SUBSTRACT: r_dst._set_vector2(a-b); return true;
+			case Variant::OP_MULTIPLY: r_dst._set_vector2(a*b); return true;
+			case Variant::OP_DIVIDE: r_dst._set_vector2(a/b); return true;
+			case Variant::OP_EQUAL: r_dst._set_bool(a==b); return true;
+			case Variant::OP_NOT_EQUAL: r_dst._set_bool(a!=b); return true;
+			case Variant::OP_NEGATE: r_dst._set_vector2(-a); return true;
+			default: return false;
+		}
+
+	} else if (ta==Variant::VECTOR2 && _get_number(p_b,n)) {
+
+		Vector2 a=p_a._get_vector2();
+
+		switch(p_op) {
+
+			case Variant::OP_MULTIPLY: r_dst._set_vector2(a*n); return true;
+			case Variant::OP_DIVIDE: r_dst._set_vector2(a/n); return true;
+			default: return false;
+		}
+
+	} else if (tb==Variant::VECTOR2 && p_op==Variant::OP_MULTIPLY && _get_number(p_a,n)) {
+
+		r_dst._set_vector2(n*p_b._get_vector2());
+		return true;
+	}
+
+	return false;
+}
+
+static _FORCE_INLINE_ bool _evaluate_vector3(Variant::Operator p_op,const Variant& p_a,const Variant& p_b,Variant& r_dst) {
+
+	Variant::Type ta=p_a.get_type();
+	Variant::Type tb=p_b.get_type();
+	real_t n;
+
+	if (ta==Variant::VECTOR3 && tb==Variant::VECTOR3) {
+
+		Vector3 a=p_a._get_vector3();
+		Vector3 b=p_b._get_vector3();
+
+		switch(p_op) {
+
+			case Variant::OP_ADD: r_dst._set_vector3(a+b); return true;
+			case Variant::OP_SUBSTRACT: r_dst._set_vector3(a-b); return true;
+			case Variant::OP_MULTIPLY: r_dst._set_vector3(a*b); return true;
+			case Variant::OP_DIVIDE: r_dst._set_vector3(a/b); return true;
+			case Variant::OP_EQUAL: r_dst._set_bool(a==b); return true;
+			case Variant::OP_NOT_EQUAL: r_dst._set_bool(a!=b); return true;
+			case Variant::OP_NEGATE: r_dst._set_vector3(-a); return true;
+			default: return false;
+		}
+
+	} else if (ta==Variant::VECTOR3 && _get_number(p_b,n)) {
+
+		Vector3 a=p_a._get_vector3();
+
+		switch(p_op) {
+
+			case Variant::OP_MULTIPLY: r_dst._set_vector3(a*n); return true;
+			case Variant::OP_DIVIDE: r_dst._set_vector3(a/n); return true;
+			default: return false;
+		}
+
+	} else if (tb==Variant::VECTOR3 && p_op==Variant::OP_MULTIPLY && _get_number(p_a,n)) {
+
+		r_dst._set_vector3(n*p_b._get_vector3());
+		return true;
+	}
+
+	return false;
+}
+
+// Numeric comparison for OPCODE_COMPARE_JUMP_IF_NOT, false when the operands are not numbers.
+
+static _FORCE_INLINE_ bool _compare_numbers(Variant::Operator p_op,const Variant& p_a,const Variant& p_b,bool &r_result) {
+
+	Variant::Type ta=p_a.get_type();
+	Variant::Type tb=p_b.get_type();
+
+	if (ta==Variant::INT && tb==Variant::INT) {
+
+		int a=p_a._get_int();
+		int b=p_b._get_int();
+
+		switch(p_op) {
+
+			case Variant::OP_EQUAL: r_result=a==b; return true;
+			case Variant::OP_NOT_EQUAL: r_result=a!=b; return true;
+			case Variant::OP_LESS: r_result=a<b; return true;
+			case Variant::OP_LESS_EQUAL: r_result=a<=b; return true;
+			case Variant::OP_GREATER: r_result=a>b; return true;
+			case Variant::OP_GREATER_EQUAL: r_result=a>=b; return true;
+			default: return false;
+		}
+	}
+
+	double a,b;
+
+	if (ta==Variant::REAL)
+		a=p_a._get_real();
+	else if (ta==Variant::INT)
+		a=p_a._get_int();
+	else
+		return false;
+
+	if (tb==Variant::REAL)
+		b=p_b._get_real();
+	else if (tb==Variant::INT)
+		b=p_b._get_int();
+	else
+		return false;
+
+	switch(p_op) {
+
+		case Variant::OP_EQUAL: r_result=a==b; return true;
+		case Variant::OP_NOT_EQUAL: r_result=a!=b; return true;
+		case Variant::OP_LESS: r_result=a<b; return true;
+		case Variant::OP_LESS_EQUAL: r_result=a<=b; return true;
+		case Variant::OP_GREATER: r_result=a>b; return true;
+		case Variant::OP_GREATER_EQUAL: r_result=a>=b; return true;
+		default: return false;
+	}
+}
+
+Object *GDFunction::_inline_cache_get_object(const Variant *p_base) const {
+
+	if (p_base->get_type()!=Variant::OBJECT)
+		return NULL;
+
+	Object *obj = *p_base;
+#ifdef DEBUG_ENABLED
+	//same validation Variant does before get_named/set_named/call, leave the error reporting to the regular path
+	if (obj && ScriptDebugger::get_singleton() && !p_base->is_ref() && !ObjectDB::instance_validate(obj))
+		return NULL;
+#endif
+	return obj;
+}
+
+bool GDFunction::_inline_cache_hit(const InlineCache& p_cache,Object *p_object,uint32_t p_version) const {
+
+	if (p_cache.kind==InlineCache::KIND_NONE || p_cache.version!=p_version)
+		return false;
+
+	if (p_object->get_type_name()!=p_cache.type)
+		return false;
+
+	ScriptInstance *si = p_object->get_script_instance();
+	if (!si)
+		return p_cache.script==NULL;
+
+	if (!p_cache.script || si->get_language()!=GDScriptLanguage::get_singleton() || si->is_placeholder())
+		return false;
+
+	return static_cast<GDInstance*>(si)->script.ptr()==p_cache.script;
+}
+
+bool GDFunction::_inline_cache_prepare(InlineCache& p_cache,Object *p_object,uint32_t p_version,GDScript **r_script) const {
+
+	//caches are shared by all threads running this function, only fill them while nothing else can read them
+	if (ScriptServer::is_calling_threaded() || Thread::get_caller_ID()!=Thread::get_main_ID())
+		return false;
+
+	p_cache.kind=InlineCache::KIND_NONE;
+
+	if (p_cache.version!=p_version) {
+		p_cache.version=p_version;
+		p_cache.misses=0;
+	} else if (p_cache.misses>=INLINE_CACHE_MAX_MISSES) {
+		return false;
+	}
+
+	p_cache.misses++;
+
+	if (p_object->cast_to<Script>())
+		return false; //scripts override call() and resolve names on their own
+
+	*r_script=NULL;
+
+	ScriptInstance *si = p_object->get_script_instance();
+	if (si) {
+		if (si->get_language()!=GDScriptLanguage::get_singleton() || si->is_placeholder())
+			return false;
+		*r_script=static_cast<GDInstance*>(si)->script.ptr();
+	}
+
+	p_cache.type=p_object->get_type_name();
+	p_cache.script=*r_script;
+	return true;
+}
+
+bool GDFunction::_inline_cache_script_has_function(const GDScript *p_script,const StringName& p_name) {
+
+	while(p_script) {
+		if (p_script->member_functions.has(p_name))
+			return true;
+		p_script=p_script->_base;
+	}
+	return false;
+}
+
+bool GDFunction::_inline_cache_fill_get(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const {
+
+	GDScript *script;
+	if (!_inline_cache_prepare(p_cache,p_object,p_version,&script))
+		return false;
+
+	if (script) {
+		//mirror GDInstance::get()
+		const Map<StringName,GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
+		if (E) {
+			if (E->get().getter)
+				return false;
+			p_cache.kind=InlineCache::KIND_SCRIPT_MEMBER;
+			p_cache.index=E->get().index;
+			return true;
+		}
+
+		for(const GDScript *sptr=script;sptr;sptr=sptr->_base) {
+			if (sptr->constants.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get))
+				return false;
+		}
+	}
+
+	//mirror ObjectTypeDB::get_property(), which calls the getter through Object::call()
+	const ObjectTypeDB::PropertySetGet *psg = ObjectTypeDB::get_property_setget(p_cache.type,p_name);
+	if (!psg || !psg->getter)
+		return false;
+
+	if (_inline_cache_script_has_function(script,psg->getter))
+		return false;
+
+	MethodBind *getter = ObjectTypeDB::get_method(p_cache.type,psg->getter);
+	if (!getter)
+		return false;
+
+	p_cache.kind=InlineCache::KIND_NATIVE_PROPERTY;
+	p_cache.method=getter;
+	p_cache.index=psg->index;
+	return true;
+}
+
+bool GDFunction::_inline_cache_fill_set(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const {
+
+	GDScript *script;
+	if (!_inline_cache_prepare(p_cache,p_object,p_version,&script))
+		return false;
+
+	if (script) {
+		//script members keep the regular path, it handles setters and marks the object as edited
+		if (script->member_indices.has(p_name))
+			return false;
+
+		if (_inline_cache_script_has_function(script,GDScriptLanguage::get_singleton()->strings._set))
+			return false;
+	}
+
+	//mirror ObjectTypeDB::set_property()
+	const ObjectTypeDB::PropertySetGet *psg = ObjectTypeDB::get_property_setget(p_cache.type,p_name);
+	if (!psg || !psg->setter || !psg->_setptr)
+		return false;
+
+	p_cache.kind=InlineCache::KIND_NATIVE_PROPERTY;
+	p_cache.method=psg->_setptr;
+	p_cache.index=psg->index;
+	return true;
+}
+
+bool GDFunction::_inline_cache_fill_call(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const {
+
+	if (p_name==CoreStringNames::get_singleton()->_free)
+		return false;
+
+	GDScript *script;
+	if (!_inline_cache_prepare(p_cache,p_object,p_version,&script))
+		return false;
+
+	//mirror Object::call()
+	if (_inline_cache_script_has_function(script,p_name))
+		return false;
+
+	MethodBind *method = ObjectTypeDB::get_method(p_cache.type,p_name);
+	if (!method)
+		return false;
+
+	p_cache.kind=InlineCache::KIND_NATIVE_METHOD;
+	p_cache.method=method;
+	return true;
+}
+
+/* A yielded call keeps its frame (the Variant stack and call argument space) until it is
+   resumed. Frames are recycled through a ThreadFreeList with a slot per power of two size,
+   so scripts yielding every frame don't go to the allocator for each yield. */
+
+enum {
+	GD_FRAME_POOL_MIN_SHIFT=6, // 64 bytes
+	GD_FRAME_POOL_CLASSES=7, // up to 4096 bytes, larger frames always use the allocator
+	GD_FRAME_POOL_CACHE_SIZE=64 // frames kept per size and thread
+};
+
+#ifdef THREAD_FREE_LIST_ENABLED
+static THREAD_FREE_LIST_LOCAL ThreadFreeList<GD_FRAME_POOL_CLASSES,GD_FRAME_POOL_CACHE_SIZE> _gd_frame_pool_cache;
+#endif
+
+static _FORCE_INLINE_ int _gd_frame_class(uint32_t p_size) {
+
+	int c=0;
+	while(c<GD_FRAME_POOL_CLASSES && (uint32_t(1)<<(GD_FRAME_POOL_MIN_SHIFT+c))<p_size)
+		c++;
+	return c; // GD_FRAME_POOL_CLASSES if too large
+}
+
+uint8_t *GDFunction::alloc_frame(uint32_t p_size) {
+
+	if (p_size==0)
+		return NULL;
+
+	int c=_gd_frame_class(p_size);
+	if (c==GD_FRAME_POOL_CLASSES)
+		return (uint8_t*)memalloc(p_size);
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	void *mem=_gd_frame_pool_cache.pop(c);
+	if (mem)
+		return (uint8_t*)mem;
+#endif
+	return (uint8_t*)memalloc(uint32_t(1)<<(GD_FRAME_POOL_MIN_SHIFT+c));
+}
+
+void GDFunction::free_frame(uint8_t *p_frame,uint32_t p_size) {
+
+	if (!p_frame)
+		return;
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	int c=_gd_frame_class(p_size);
+	if (c<GD_FRAME_POOL_CLASSES && _gd_frame_pool_cache.push(c,p_frame))
+		return;
+#endif
+	memfree(p_frame);
+}
+
+void GDFunction::release_frame_pool() {
+
+#ifdef THREAD_FREE_LIST_ENABLED
+	_gd_frame_pool_cache.release();
+#endif
+}
+
+// Opcodes are dispatched through a table of label addresses when the compiler supports
+// it (labels as values in GCC and Clang), so each handler ends with its own indirect jump
+// to the next one instead of going back to a single switch, which branch predictors handle
+// much better. Building with gdscript_threaded_dispatch=no uses the switch.
+
+#if defined(GDSCRIPT_THREADED_DISPATCH) && defined(__GNUC__)
+#define GDSCRIPT_USE_COMPUTED_GOTO
+#endif
+
+#ifdef GDSCRIPT_USE_COMPUTED_GOTO
+
+#ifdef DEBUG_ENABLED
+#define DISPATCH_OPCODE \
+	do { \
+		if (ip>=_code_size) \
+			goto OPSOUT; \
+		if (uint32_t(_code_ptr[ip])>OPCODE_END) { \
+			err_text="Illegal opcode "+itos(_code_ptr[ip])+" at address "+itos(ip); \
+			goto OPSEXIT; \
+		} \
+		goto *dispatch_table[_code_ptr[ip]]; \
+	} while(0)
+#else
+#define DISPATCH_OPCODE goto *dispatch_table[_code_ptr[ip]]
+#endif
+
+#define OPCODE(m_op) m_op
+#define OPCODE_WHILE(m_test)
+#define OPCODE_SWITCH(m_test) DISPATCH_OPCODE;
+#define OPCODE_BREAK goto OPSEXIT
+#define OPCODE_OUT goto OPSOUT
+#define OPCODES_END OPSEXIT:
+#define OPCODES_OUT OPSOUT:
+
+#else
+
+#define DISPATCH_OPCODE continue
+#define OPCODE(m_op) case m_op
+#define OPCODE_WHILE(m_test) while(m_test)
+#define OPCODE_SWITCH(m_test) switch(m_test)
+#define OPCODE_BREAK break
+#define OPCODE_OUT break
+#define OPCODES_END
+#define OPCODES_OUT
+
+#endif
+
+// ERR_BREAK, but leaving the opcode handler
+#define GD_ERR_BREAK(m_cond) \
+	{ if ( m_cond ) {	\
+		_err_print_error(FUNCTION_STR,__FILE__,__LINE__,"Condition ' " _STR(m_cond)" ' is true. Breaking..:");	\
+		OPCODE_BREAK;\
+	} else _err_error_exists=false;}
+
 Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError& r_err, CallState *p_state) {
 
 
@@ -170,11 +669,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 	if (p_state) {
 		//use existing (supplied) state (yielded)
-		stack=(Variant*)p_state->stack.ptr();
+		stack=(Variant*)p_state->stack;
 		call_args=(Variant**)&p_state->stack[sizeof(Variant)*p_state->stack_size];
 		line=p_state->line;
 		ip=p_state->ip;
-		alloca_size=p_state->stack.size();
+		alloca_size=p_state->alloca_size;
 		_class=p_state->_class;
 		p_instance=p_state->instance;
 		defarg=p_state->defarg;
@@ -249,29 +748,80 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 	String err_text;
 
+	//inline caches are shared by all callers of the function, only the main thread uses them
+	uint32_t inline_cache_version=0;
+	if (_inline_caches_ptr && Thread::get_caller_ID()==Thread::get_main_ID())
+		inline_cache_version=GDScriptLanguage::get_singleton()->get_inline_cache_version();
+
 #ifdef DEBUG_ENABLED
 
 	if (ScriptDebugger::get_singleton())
 		GDScriptLanguage::get_singleton()->enter_function(p_instance,this,stack,&ip,&line);
 
 #define CHECK_SPACE(m_space)\
-	ERR_BREAK((ip+m_space)>_code_size)
+	GD_ERR_BREAK((ip+m_space)>_code_size)
 
 #define GET_VARIANT_PTR(m_v,m_code_ofs) \
 	Variant *m_v; \
-	m_v = _get_variant(_code_ptr[ip+m_code_ofs],p_instance,_class,self,stack,err_text);\
+	{ \
+		int _address=_code_ptr[ip+m_code_ofs]; \
+		uint32_t _type=uint32_t(_address)>>ADDR_BITS; \
+		Variant *_base=_type<=ADDR_TYPE_NIL ? address_bases[_type] : NULL; \
+		m_v = _base ? _base+(_address&ADDR_MASK) : _get_variant(_address,p_instance,_class,self,stack,err_text); \
+	} \
 	if (!m_v)\
-	break;
-
+		OPCODE_BREAK;
 
 #else
 #define CHECK_SPACE(m_space)
 #define GET_VARIANT_PTR(m_v,m_code_ofs) \
 	Variant *m_v; \
-	m_v = _get_variant(_code_ptr[ip+m_code_ofs],p_instance,_class,self,stack,err_text);
+	{ \
+		int _address=_code_ptr[ip+m_code_ofs]; \
+		Variant *_base=address_bases[uint32_t(_address)>>ADDR_BITS]; \
+		m_v = _base ? _base+(_address&ADDR_MASK) : _get_variant(_address,p_instance,_class,self,stack,err_text); \
+	}
 
 #endif
 
+	//base pointer of each address type that needs no lookup, operands of those types are
+	//resolved without going through _get_variant(). stack and constant addresses are made
+	//by the compiler and always in range. members are left out in debug builds, where
+	//scripts can be reloaded (and instance members moved) while a function is running.
+	Variant *address_bases[ADDR_TYPE_NIL+1];
+	address_bases[ADDR_TYPE_SELF]=p_instance ? &self : NULL;
+	address_bases[ADDR_TYPE_CLASS]=&_class->_static_ref;
+#ifdef DEBUG_ENABLED
+	address_bases[ADDR_TYPE_MEMBER]=NULL;
+#else
+	address_bases[ADDR_TYPE_MEMBER]=p_instance && p_instance->members.size() ? p_instance->members.ptr() : NULL;
+#endif
+	address_bases[ADDR_TYPE_CLASS_CONSTANT]=NULL;
+	address_bases[ADDR_TYPE_LOCAL_CONSTANT]=_constants_ptr;
+	address_bases[ADDR_TYPE_STACK]=stack;
+	address_bases[ADDR_TYPE_STACK_VARIABLE]=stack;
+	address_bases[ADDR_TYPE_GLOBAL]=NULL; //the global array grows when globals are added
+	address_bases[ADDR_TYPE_NIL]=&nil;
+
+#ifdef GDSCRIPT_USE_COMPUTED_GOTO
+
+	//same order as GDFunction::Opcode
+	static const void *dispatch_table[]={
+		&&OPCODE_OPERATOR, &&OPCODE_OPERATOR_INT, &&OPCODE_OPERATOR_REAL,
+		&&OPCODE_OPERATOR_VECTOR2, &&OPCODE_OPERATOR_VECTOR3, &&OPCODE_EXTENDS_TEST, &&OPCODE_SET,
+		&&OPCODE_GET, &&OPCODE_SET_NAMED, &&OPCODE_GET_NAMED, &&OPCODE_ASSIGN, &&OPCODE_ASSIGN_TRUE,
+		&&OPCODE_ASSIGN_FALSE, &&OPCODE_CONSTRUCT, &&OPCODE_CONSTRUCT_ARRAY,
+		&&OPCODE_CONSTRUCT_DICTIONARY, &&OPCODE_CALL, &&OPCODE_CALL_RETURN, &&OPCODE_CALL_BUILT_IN,
+		&&OPCODE_CALL_SELF, &&OPCODE_CALL_SELF_BASE, &&OPCODE_YIELD, &&OPCODE_YIELD_SIGNAL,
+		&&OPCODE_YIELD_RESUME, &&OPCODE_JUMP, &&OPCODE_JUMP_IF, &&OPCODE_JUMP_IF_NOT,
+		&&OPCODE_JUMP_TO_DEF_ARGUMENT, &&OPCODE_RETURN, &&OPCODE_ITERATE_BEGIN, &&OPCODE_ITERATE,
+		&&OPCODE_ITERATE_RANGE_BEGIN, &&OPCODE_ITERATE_RANGE, &&OPCODE_ASSIGN_JUMP,
+		&&OPCODE_GET_NAMED_CALL, &&OPCODE_COMPARE_JUMP_IF_NOT, &&OPCODE_ASSERT, &&OPCODE_BREAKPOINT,
+		&&OPCODE_LINE, &&OPCODE_END
+	};
+
+	(void)sizeof(char[(sizeof(dispatch_table)/sizeof(*dispatch_table))==OPCODE_END+1 ? 1 : -1]); //fails to build when out of sync with Opcode
+#endif
 
 #ifdef DEBUG_ENABLED
 
@@ -284,22 +834,81 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 		profile.call_count++;
 		profile.frame_call_count++;
 	}
+
+	bool sampled=GDScriptLanguage::get_singleton()->is_sampling() && Thread::get_caller_ID()==Thread::get_main_ID();
+	if (sampled)
+		GDScriptLanguage::get_singleton()->sample_enter(this,&line);
 #endif
 	bool exit_ok=false;
+	bool stack_moved=false; //yielded, the stack now belongs to the function state
+
+	OPCODE_WHILE(ip<_code_size) {
+
+		OPCODE_SWITCH(_code_ptr[ip]) {
+
+			OPCODE(OPCODE_COMPARE_JUMP_IF_NOT): {
+
+				//numeric comparison fused with the JUMP_IF_NOT testing its result, which follows it
+				CHECK_SPACE(8);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip+1];
+
+				GET_VARIANT_PTR(a,2);
+				GET_VARIANT_PTR(b,3);
+				GET_VARIANT_PTR(dst,4);
 
-	while(ip<_code_size) {
+				bool result;
+				if (_compare_numbers(op,*a,*b,result)) {
 
+					dst->_set_bool(result);
+					if (result) {
+						ip+=8;
+					} else {
+						int to = _code_ptr[ip+7];
+						GD_ERR_BREAK(to<0 || to>_code_size);
+						ip=to;
+					}
+					DISPATCH_OPCODE;
+				}
 
-		int last_opcode=_code_ptr[ip];
-		switch(_code_ptr[ip]) {
+				//not numbers, run it as a regular operator followed by the jump
+			}
+			OPCODE(OPCODE_OPERATOR_INT):
+			OPCODE(OPCODE_OPERATOR_REAL):
+			OPCODE(OPCODE_OPERATOR_VECTOR2):
+			OPCODE(OPCODE_OPERATOR_VECTOR3): {
 
-			case OPCODE_OPERATOR: {
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip+1];
+
+				GET_VARIANT_PTR(a,2);
+				GET_VARIANT_PTR(b,3);
+				GET_VARIANT_PTR(dst,4);
+
+				bool done;
+				switch(_code_ptr[ip]) {
+					case OPCODE_OPERATOR_INT: done=_evaluate_int(op,*a,*b,*dst); break;
+					case OPCODE_OPERATOR_REAL: done=_evaluate_real(op,*a,*b,*dst); break;
+					case OPCODE_OPERATOR_VECTOR2: done=_evaluate_vector2(op,*a,*b,*dst); break;
+					case OPCODE_OPERATOR_VECTOR3: done=_evaluate_vector3(op,*a,*b,*dst); break;
+					default: done=false;
+				}
+
+				if (done) {
+					ip+=5;
+					DISPATCH_OPCODE;
+				}
+
+				//types did not match the guess, fall through to the generic operator
+			}
+			OPCODE(OPCODE_OPERATOR): {
 
 				CHECK_SPACE(5);
 
 				bool valid;
 				Variant::Operator op = (Variant::Operator)_code_ptr[ip+1];
-				ERR_BREAK(op>=Variant::OP_MAX);
+				GD_ERR_BREAK(op>=Variant::OP_MAX);
 
 				GET_VARIANT_PTR(a,2);
 				GET_VARIANT_PTR(b,3);
@@ -323,7 +932,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						err_text="Invalid operands '"+Variant::get_type_name(a->get_type())+"' and '"+Variant::get_type_name(b->get_type())+"' in operator '"+Variant::get_operator_name(op)+"'.";
 					}
 #endif
-					break;
+					OPCODE_BREAK;
 
 				}
 #ifdef DEBUG_ENABLED
@@ -332,8 +941,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=5;
 
-			} continue;
-			case OPCODE_EXTENDS_TEST: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_EXTENDS_TEST): {
 
 				CHECK_SPACE(4);
 
@@ -346,13 +955,13 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (a->get_type()!=Variant::OBJECT || a->operator Object*()==NULL) {
 
 					err_text="Left operand of 'extends' is not an instance of anything.";
-					break;
+					OPCODE_BREAK;
 
 				}
 				if (b->get_type()!=Variant::OBJECT || b->operator Object*()==NULL) {
 
 					err_text="Right operand of 'extends' is not a class.";
-					break;
+					OPCODE_BREAK;
 
 				}
 #endif
@@ -396,7 +1005,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					if (!nc) {
 
 						err_text="Right operand of 'extends' is not a class (type: '"+obj_B->get_type()+"').";
-						break;
+						OPCODE_BREAK;
 					}
 
 					extends_ok=ObjectTypeDB::is_type(obj_A->get_type_name(),nc->get_name());
@@ -405,8 +1014,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst=extends_ok;
 				ip+=4;
 
-			} continue;
-			case OPCODE_SET: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_SET): {
 
 				CHECK_SPACE(3);
 
@@ -425,12 +1034,12 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v="of type '"+_get_var_type(index)+"'";
 					}
 					err_text="Invalid set index "+v+" (on base: '"+_get_var_type(dst)+"').";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4;
-			} continue;
-			case OPCODE_GET: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_GET): {
 
 				CHECK_SPACE(3);
 
@@ -454,49 +1063,99 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v="of type '"+_get_var_type(index)+"'";
 					}
 					err_text="Invalid get index "+v+" (on base: '"+_get_var_type(src)+"').";
-					break;
+					OPCODE_BREAK;
 				}
 #ifdef DEBUG_ENABLED
 				*dst=ret;
 #endif
 				ip+=4;
-			} continue;
-			case OPCODE_SET_NAMED: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_SET_NAMED): {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(dst,1);
-				GET_VARIANT_PTR(value,3);
+				GET_VARIANT_PTR(value,4);
 
 				int indexname = _code_ptr[ip+2];
 
-				ERR_BREAK(indexname<0 || indexname>=_global_names_count);
+				GD_ERR_BREAK(indexname<0 || indexname>=_global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip+3];
+				GD_ERR_BREAK(cache_idx<0 || cache_idx>=_inline_cache_count);
+
 				bool valid;
-				dst->set_named(*index,*value,&valid);
+				Object *obj = inline_cache_version ? _inline_cache_get_object(dst) : NULL;
+
+				if (obj) {
+
+					InlineCache &cache = _inline_caches_ptr[cache_idx];
+					if (_inline_cache_hit(cache,obj,inline_cache_version) || _inline_cache_fill_set(cache,obj,*index,inline_cache_version)) {
+						obj->set_property_bind(cache.method,cache.index,*value,&valid);
+					} else {
+						dst->set_named(*index,*value,&valid);
+					}
+				} else {
+					dst->set_named(*index,*value,&valid);
+				}
 
 				if (!valid) {
 					String err_type;
 					err_text="Invalid set index '"+String(*index)+"' (on base: '"+_get_var_type(dst)+"').";
-					break;
+					OPCODE_BREAK;
 				}
 
-				ip+=4;
-			} continue;
-			case OPCODE_GET_NAMED: {
+				ip+=5;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_GET_NAMED_CALL):
+			OPCODE(OPCODE_GET_NAMED): {
 
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(src,1);
-				GET_VARIANT_PTR(dst,3);
+				GET_VARIANT_PTR(dst,4);
 
 				int indexname = _code_ptr[ip+2];
 
-				ERR_BREAK(indexname<0 || indexname>=_global_names_count);
+				GD_ERR_BREAK(indexname<0 || indexname>=_global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip+3];
+				GD_ERR_BREAK(cache_idx<0 || cache_idx>=_inline_cache_count);
+
+				Object *obj = inline_cache_version ? _inline_cache_get_object(src) : NULL;
+
+				if (obj) {
+
+					InlineCache &cache = _inline_caches_ptr[cache_idx];
+					if (_inline_cache_hit(cache,obj,inline_cache_version) || _inline_cache_fill_get(cache,obj,*index,inline_cache_version)) {
+
+						{
+							//fetch into a temporary first, src and dst may be the same stack position
+							Variant ret;
+							if (cache.kind==InlineCache::KIND_SCRIPT_MEMBER) {
+								ret = static_cast<GDInstance*>(obj->get_script_instance())->members[cache.index];
+							} else {
+								Variant::CallError ce;
+								if (cache.index>=0) {
+									Variant pindex=cache.index;
+									const Variant* arg[1]={&pindex};
+									ret = obj->call_method_bind(cache.method,arg,1,ce);
+								} else {
+									ret = obj->call_method_bind(cache.method,NULL,0,ce);
+								}
+							}
+							*dst=ret;
+						} //temporaries must be gone before dispatching, a computed goto does not destroy them
+						ip+=5;
+						if (_code_ptr[ip-5]==OPCODE_GET_NAMED_CALL)
+							goto call_after_get_named; //the call using the result follows
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -512,14 +1171,16 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					} else {
 						err_text="Invalid get index '"+index->operator String()+"' (on base: '"+_get_var_type(src)+"').";
 					}
-					break;
+					OPCODE_BREAK;
 				}
 #ifdef DEBUG_ENABLED
 				*dst=ret;
 #endif
-				ip+=4;
-			} continue;
-			case OPCODE_ASSIGN: {
+				ip+=5;
+				if (_code_ptr[ip-5]==OPCODE_GET_NAMED_CALL)
+					goto call_after_get_named;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN): {
 
 				CHECK_SPACE(3);
 				GET_VARIANT_PTR(dst,1);
@@ -529,8 +1190,22 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3;
 
-			} continue;
-			case OPCODE_ASSIGN_TRUE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_JUMP): {
+
+				//assign fused with the jump that follows it
+				CHECK_SPACE(5);
+				GET_VARIANT_PTR(dst,1);
+				GET_VARIANT_PTR(src,2);
+
+				*dst = *src;
+
+				int to = _code_ptr[ip+4];
+				GD_ERR_BREAK(to<0 || to>_code_size);
+				ip=to;
+
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_TRUE): {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst,1);
@@ -538,8 +1213,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = true;
 
 				ip+=2;
-			} continue;
-			case OPCODE_ASSIGN_FALSE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_FALSE): {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst,1);
@@ -547,8 +1222,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = false;
 
 				ip+=2;
-			} continue;
-			case OPCODE_CONSTRUCT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT): {
 
 				CHECK_SPACE(2);
 				Variant::Type t=Variant::Type(_code_ptr[ip+1]);
@@ -567,13 +1242,13 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (err.error!=Variant::CallError::CALL_OK) {
 
 					err_text=_get_call_error(err,"'"+Variant::get_type_name(t)+"' constructor",(const Variant**)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4+argc;
 				//construct a basic type
-			} continue;
-			case OPCODE_CONSTRUCT_ARRAY: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT_ARRAY): {
 
 				CHECK_SPACE(1);
 				int argc=_code_ptr[ip+1];
@@ -593,8 +1268,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3+argc;
 
-			} continue;
-			case OPCODE_CONSTRUCT_DICTIONARY: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT_DICTIONARY): {
 
 				CHECK_SPACE(1);
 				int argc=_code_ptr[ip+1];
@@ -616,10 +1291,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3+argc*2;
 
-			} continue;
-			case OPCODE_CALL_RETURN:
-			case OPCODE_CALL: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_RETURN):
+			OPCODE(OPCODE_CALL): {
 
+				call_after_get_named:
 
 				CHECK_SPACE(4);
 				bool call_ret = _code_ptr[ip]==OPCODE_CALL_RETURN;
@@ -628,12 +1304,12 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				GET_VARIANT_PTR(base,2);
 				int nameg=_code_ptr[ip+3];
 
-				ERR_BREAK(nameg<0 || nameg>=_global_names_count);
+				GD_ERR_BREAK(nameg<0 || nameg>=_global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
-				ERR_BREAK(argc<0);
+				GD_ERR_BREAK(argc<0);
 				ip+=4;
-				CHECK_SPACE(argc+1);
+				CHECK_SPACE(argc+2);
 				Variant **argptrs = call_args;
 
 				for(int i=0;i<argc;i++) {
@@ -641,6 +1317,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					argptrs[i]=v;
 				}
 
+				int cache_idx = _code_ptr[ip+argc];
+				GD_ERR_BREAK(cache_idx<0 || cache_idx>=_inline_cache_count);
+
 #ifdef DEBUG_ENABLED
 				uint64_t call_time;
 
@@ -650,9 +1329,26 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 #endif
 				Variant::CallError err;
-				if (call_ret) {
+				Object *obj = inline_cache_version ? _inline_cache_get_object(base) : NULL;
+				InlineCache *cache = NULL;
+
+				if (obj) {
+
+					cache = &_inline_caches_ptr[cache_idx];
+					if (!_inline_cache_hit(*cache,obj,inline_cache_version) && !_inline_cache_fill_call(*cache,obj,*methodname,inline_cache_version))
+						cache=NULL;
+				}
+
+				if (cache) {
+
+					Variant r = obj->call_method_bind(cache->method,(const Variant**)argptrs,argc,err);
+					if (call_ret && err.error==Variant::CallError::CALL_OK) {
+						GET_VARIANT_PTR(ret,argc+1);
+						*ret=r;
+					}
+				} else if (call_ret) {
 
-					GET_VARIANT_PTR(ret,argc);
+					GET_VARIANT_PTR(ret,argc+1);
 					base->call_ptr(*methodname,(const Variant**)argptrs,argc,ret,err);
 				} else {
 
@@ -683,29 +1379,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 							if (base->is_ref()) {
 								err_text="Attempted to free a reference.";
-								break;
+								OPCODE_BREAK;
 							} else if (base->get_type()==Variant::OBJECT) {
 
 								err_text="Attempted to free a locked object (calling or emitting).";
-								break;
+								OPCODE_BREAK;
 							}
 						}
 					}
 					err_text=_get_call_error(err,"function '"+methodstr+"' in base '"+basestr+"'",(const Variant**)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
-				ip+=argc+1;
+				ip+=argc+2;
 
-			} continue;
-			case OPCODE_CALL_BUILT_IN: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_BUILT_IN): {
 
 				CHECK_SPACE(4);
 
 				GDFunctions::Function func = GDFunctions::Function(_code_ptr[ip+1]);
 				int argc=_code_ptr[ip+2];
-				ERR_BREAK(argc<0);
+				GD_ERR_BREAK(argc<0);
 
 				ip+=3;
 				CHECK_SPACE(argc+1);
@@ -732,16 +1428,16 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					} else {
 						err_text=_get_call_error(err,"built-in function '"+methodstr+"'",(const Variant**)argptrs);
 					}
-					break;
+					OPCODE_BREAK;
 				}
 				ip+=argc+1;
 
-			} continue;
-			case OPCODE_CALL_SELF: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_SELF): {
 
 
-			} break;
-			case OPCODE_CALL_SELF_BASE: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_CALL_SELF_BASE): {
 
 				CHECK_SPACE(2);
 				int self_fun = _code_ptr[ip+1];
@@ -750,7 +1446,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (self_fun<0 || self_fun>=_global_names_count) {
 
 					err_text="compiler bug, function name not found";
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				const StringName *methodname = &_global_names_ptr[self_fun];
@@ -813,14 +1509,14 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					String methodstr = *methodname;
 					err_text=_get_call_error(err,"function '"+methodstr+"'",(const Variant**)argptrs);
 
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4+argc;
 
-			} continue;
-			case OPCODE_YIELD:
-			case OPCODE_YIELD_SIGNAL: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_YIELD):
+			OPCODE(OPCODE_YIELD_SIGNAL): {
 
 				int ipofs=1;
 				if (_code_ptr[ip]==OPCODE_YIELD_SIGNAL) {
@@ -834,11 +1530,17 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				Ref<GDFunctionState> gdfs = memnew( GDFunctionState );
 				gdfs->function=this;
 
-				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
-				for(int i=0;i<_stack_size;i++) {
-					memnew_placement(&gdfs->state.stack[sizeof(Variant)*i],Variant(stack[i]));
+				if (p_state) {
+					//yielding again after a resume, the frame is already off the native stack
+					gdfs->state.stack=p_state->stack;
+					p_state->stack=NULL;
+				} else {
+					//variants can be relocated, so the stack is moved bitwise and the originals are not destroyed
+					gdfs->state.stack=alloc_frame(alloca_size);
+					if (_stack_size)
+						copymem(gdfs->state.stack,stack,sizeof(Variant)*_stack_size);
 				}
+				stack_moved=true;
 				gdfs->state.stack_size=_stack_size;
 				gdfs->state.self=self;
 				gdfs->state.alloca_size=alloca_size;
@@ -861,11 +1563,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					if (argobj->get_type()!=Variant::OBJECT) {
 						err_text="First argument of yield() not of type object.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (argname->get_type()!=Variant::STRING) {
 						err_text="Second argument of yield() not a string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
 					Object *obj=argobj->operator Object *();
 					String signal = argname->operator String();
@@ -873,25 +1575,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					if (!obj) {
 						err_text="First argument of yield() is null.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (ScriptDebugger::get_singleton()) {
 						if (!ObjectDB::instance_validate(obj)) {
 							err_text="First argument of yield() is a previously freed instance.";
-							break;
+							OPCODE_BREAK;
 						}
 					}
 					if (signal.length()==0) {
 
 						err_text="Second argument of yield() is an empty string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
 
 #endif
-					Error err = obj->connect(signal,gdfs.ptr(),"_signal_callback",varray(gdfs),Object::CONNECT_ONESHOT);
-					if (err!=OK) {
-						err_text="Error connecting to signal: "+signal+" during yield().";
-						break;
+					//the main loop may resume these in one batch, no oneshot connection for every yield
+					MainLoop *main_loop=OS::get_singleton()->get_main_loop();
+					if (obj!=main_loop || !main_loop->queue_signal_resume(signal,gdfs)) {
+						Error err = obj->connect(signal,gdfs.ptr(),"_signal_callback",varray(gdfs),Object::CONNECT_ONESHOT);
+						if (err!=OK) {
+							err_text="Error connecting to signal: "+signal+" during yield().";
+							OPCODE_BREAK;
+						}
 					}
 
 
@@ -899,29 +1605,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				exit_ok=true;
 
-			} break;
-			case OPCODE_YIELD_RESUME: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_YIELD_RESUME): {
 
 				CHECK_SPACE(2);
 				if (!p_state) {
 					err_text=("Invalid Resume (bug?)");
-					break;
+					OPCODE_BREAK;
 				}
 				GET_VARIANT_PTR(result,1);
 				*result=p_state->result;
 				ip+=2;
 
-			} continue;
-			case OPCODE_JUMP: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP): {
 
 				CHECK_SPACE(2);
 				int to = _code_ptr[ip+1];
 
-				ERR_BREAK(to<0 || to>_code_size);
+				GD_ERR_BREAK(to<0 || to>_code_size);
 				ip=to;
 
-			} continue;
-			case OPCODE_JUMP_IF: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_IF): {
 
 				CHECK_SPACE(3);
 
@@ -933,18 +1639,18 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (result) {
 					int to = _code_ptr[ip+2];
-					ERR_BREAK(to<0 || to>_code_size);
+					GD_ERR_BREAK(to<0 || to>_code_size);
 					ip=to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip+=3;
-			} continue;
-			case OPCODE_JUMP_IF_NOT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_IF_NOT): {
 
 				CHECK_SPACE(3);
 
@@ -956,32 +1662,32 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (!result) {
 					int to = _code_ptr[ip+2];
-					ERR_BREAK(to<0 || to>_code_size);
+					GD_ERR_BREAK(to<0 || to>_code_size);
 					ip=to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip+=3;
-			} continue;
-			case OPCODE_JUMP_TO_DEF_ARGUMENT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT): {
 
 				CHECK_SPACE(2);
 				ip=_default_arg_ptr[defarg];
 
-			} continue;
-			case OPCODE_RETURN: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_RETURN): {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(r,1);
 				retvalue=*r;
 				exit_ok=true;
 
-			} break;
-			case OPCODE_ITERATE_BEGIN: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_ITERATE_BEGIN): {
 
 				CHECK_SPACE(8); //space for this an regular iterate
 
@@ -992,12 +1698,12 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!container->iter_init(*counter,valid)) {
 					if (!valid) {
 						err_text="Unable to iterate on object of type  "+Variant::get_type_name(container->get_type())+"'.";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto=_code_ptr[ip+3];
-					ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
 					ip=jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator,4);
 
@@ -1005,14 +1711,14 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*iterator=container->iter_get(*counter,valid);
 				if (!valid) {
 					err_text="Unable to obtain iterator object of type  "+Variant::get_type_name(container->get_type())+"'.";
-					break;
+					OPCODE_BREAK;
 				}
 
 
 				ip+=5; //skip regular iterate which is always next
 
-			} continue;
-			case OPCODE_ITERATE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE): {
 
 				CHECK_SPACE(4);
 
@@ -1023,24 +1729,91 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!container->iter_next(*counter,valid)) {
 					if (!valid) {
 						err_text="Unable to iterate on object of type  "+Variant::get_type_name(container->get_type())+"' (type changed since first iteration?).";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto=_code_ptr[ip+3];
-					ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
 					ip=jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator,4);
 
 				*iterator=container->iter_get(*counter,valid);
 				if (!valid) {
 					err_text="Unable to obtain iterator object of type  "+Variant::get_type_name(container->get_type())+"' (but was obtained on first iteration?).";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=5; //loop again
-			} continue;
-			case OPCODE_ASSERT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE_RANGE_BEGIN): {
+
+				CHECK_SPACE(15); //space for this and the range iterate
+
+				GET_VARIANT_PTR(counter,1);
+				GET_VARIANT_PTR(to,2);
+				GET_VARIANT_PTR(step,3);
+				GET_VARIANT_PTR(from_arg,4);
+				GET_VARIANT_PTR(to_arg,5);
+				GET_VARIANT_PTR(step_arg,6);
+
+				if (!from_arg->is_num() || !to_arg->is_num() || !step_arg->is_num()) {
+					err_text="Invalid arguments to built-in function 'range', numbers expected.";
+					OPCODE_BREAK;
+				}
+				//same conversions as range(), keep them in the hidden slots
+				int from_val=*from_arg;
+				int to_val=*to_arg;
+				int step_val=*step_arg;
+
+				if (step_val==0) {
+					err_text="Invalid step in built-in function 'range', step argument is zero!";
+					OPCODE_BREAK;
+				}
+
+				counter->_set_int(from_val);
+				to->_set_int(to_val);
+				step->_set_int(step_val);
+
+				if (step_val>0 ? from_val>=to_val : from_val<=to_val) {
+					int jumpto=_code_ptr[ip+7];
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					ip=jumpto;
+					DISPATCH_OPCODE;
+				}
+
+				GET_VARIANT_PTR(iterator,8);
+				iterator->_set_int(from_val);
+
+				ip+=9; //skip range iterate which is always next
+
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE_RANGE): {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter,1);
+				GET_VARIANT_PTR(to,2);
+				GET_VARIANT_PTR(step,3);
+
+				//the hidden slots were set to ints by OPCODE_ITERATE_RANGE_BEGIN
+				int step_val=step->_get_int();
+				int64_t next=int64_t(counter->_get_int())+step_val;
+
+				if (step_val>0 ? next>=to->_get_int() : next<=to->_get_int()) {
+					int jumpto=_code_ptr[ip+4];
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					ip=jumpto;
+					DISPATCH_OPCODE;
+				}
+
+				counter->_set_int(next);
+				GET_VARIANT_PTR(iterator,5);
+				iterator->_set_int(next);
+
+				ip+=6; //loop again
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSERT): {
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(test,1);
 
@@ -1052,29 +1825,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 
 
 				if (!result) {
 
 					err_text="Assertion failed.";
-					break;
+					OPCODE_BREAK;
 				}
 
 #endif
 
 				ip+=2;
-			} continue;
-			case OPCODE_BREAKPOINT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_BREAKPOINT): {
 #ifdef DEBUG_ENABLED
 				if (ScriptDebugger::get_singleton()) {
 					GDScriptLanguage::get_singleton()->debug_break("Breakpoint Statement",true);
 				}
 #endif
 				ip+=1;
-			} continue;
-			case OPCODE_LINE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_LINE): {
 				CHECK_SPACE(2);
 
 				line=_code_ptr[ip+1];
@@ -1102,22 +1875,26 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					ScriptDebugger::get_singleton()->line_poll();
 
 				}
-			} continue;
-			case OPCODE_END: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_END): {
 
 				exit_ok=true;
-				break;
+				OPCODE_BREAK;
 
-			} break;
+			} OPCODE_BREAK;
+#ifndef GDSCRIPT_USE_COMPUTED_GOTO
 			default: {
 
 				err_text="Illegal opcode "+itos(_code_ptr[ip])+" at address "+itos(ip);
-			} break;
+			} OPCODE_BREAK;
+#endif
 
 		}
 
+		OPCODES_END
+
 		if (exit_ok)
-			break;
+			OPCODE_OUT;
 		//error
 		// function, file, line, error, explanation
 		String err_file;
@@ -1132,7 +1909,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 			err_func=p_instance->script->name+"."+err_func;
 		int err_line=line;
 		if (err_text=="") {
-			err_text="Internal Script Error! - opcode #"+itos(last_opcode)+" (report please).";
+			err_text="Internal Script Error! - opcode #"+itos(ip<_code_size?_code_ptr[ip]:-1)+" (report please).";
 		}
 
 		if (!GDScriptLanguage::get_singleton()->debug_break(err_text,false)) {
@@ -1142,9 +1919,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 		}
 
 
-		break;
+		OPCODE_OUT;
 	}
 
+	OPCODES_OUT
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->profiling) {
 		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
@@ -1156,17 +1935,25 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 	}
 
+	if (sampled)
+		GDScriptLanguage::get_singleton()->sample_exit();
 #endif
 	if (ScriptDebugger::get_singleton())
 		GDScriptLanguage::get_singleton()->exit_function();
 
 
-	if (_stack_size) {
+	if (_stack_size && !stack_moved) {
 		//free stack
 		for(int i=0;i<_stack_size;i++)
 			stack[i].~Variant();
 	}
 
+	if (p_state && p_state->stack) {
+		//resumed and finished, the frame goes back to the pool
+		free_frame(p_state->stack,p_state->alloca_size);
+		p_state->stack=NULL;
+	}
+
 	return retvalue;
 
 }
@@ -1309,6 +2096,8 @@ GDFunction::GDFunction() : function_list(this) {
 
 	_stack_size=0;
 	_call_size=0;
+	_inline_caches_ptr=NULL;
+	_inline_cache_count=0;
 	rpc_mode=ScriptInstance::RPC_MODE_DISABLED;
 	name="<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1444,16 +2233,20 @@ void GDFunctionState::_bind_methods() {
 GDFunctionState::GDFunctionState() {
 
 	function=NULL;
+	state.stack=NULL;
+	state.stack_size=0;
+	state.alloca_size=0;
 }
 
 GDFunctionState::~GDFunctionState() {
 
-	if (function!=NULL) {
-		//never called, deinitialize stack
+	if (state.stack) {
+		//never resumed, deinitialize stack
 		for(int i=0;i<state.stack_size;i++) {
 			Variant *v=(Variant*)&state.stack[sizeof(Variant)*i];
 			v->~Variant();
 		}
+		GDFunction::free_frame(state.stack,state.alloca_size);
 	}
 }
 
@@ -18,6 +18,10 @@ public:
 
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT, // same operands as OPCODE_OPERATOR, emitted when the compiler guessed the operand types
+		OPCODE_OPERATOR_REAL,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_SET,
 		OPCODE_GET,
@@ -44,6 +48,11 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_RANGE_BEGIN, // for .. in range(), counts without building the array
+		OPCODE_ITERATE_RANGE,
+		OPCODE_ASSIGN_JUMP, // superinstructions, replace the opcode of the first of two instructions and keep the operands of both
+		OPCODE_GET_NAMED_CALL,
+		OPCODE_COMPARE_JUMP_IF_NOT,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -84,6 +93,32 @@ public:
 private:
 friend class GDCompiler;
 
+	// remembers how a named get, set or call resolved on the last object seen at a given instruction,
+	// so the next execution on an object of the same type and script skips the name lookups.
+	struct InlineCache {
+
+		enum Kind {
+			KIND_NONE,
+			KIND_SCRIPT_MEMBER, // get of a script member without getter, index is the member index
+			KIND_NATIVE_PROPERTY, // setget property, method is the getter or setter, index is the property index
+			KIND_NATIVE_METHOD // method bound in ObjectTypeDB
+		};
+
+		Kind kind;
+		uint32_t version;
+		StringName type;
+		GDScript *script;
+		MethodBind *method;
+		int index;
+		int misses;
+
+		InlineCache() { kind=KIND_NONE; version=0; script=NULL; method=NULL; index=-1; misses=0; }
+	};
+
+	enum {
+		INLINE_CACHE_MAX_MISSES=8 // give up on instructions that keep seeing different types
+	};
+
 	StringName source;
 
 	mutable Variant nil;
@@ -109,6 +144,9 @@ friend class GDCompiler;
 	Vector<StringName> global_names;
 	Vector<int> default_arguments;
 	Vector<int> code;
+	Vector<InlineCache> inline_caches;
+	mutable InlineCache *_inline_caches_ptr;
+	int _inline_cache_count;
 
 #ifdef TOOLS_ENABLED
 	Vector<StringName> arg_names;
@@ -119,6 +157,14 @@ friend class GDCompiler;
 	_FORCE_INLINE_ Variant *_get_variant(int p_address,GDInstance *p_instance,GDScript *p_script,Variant &self,Variant *p_stack,String& r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError& p_err, const String& p_where,const Variant**argptrs) const;
 
+	_FORCE_INLINE_ Object *_inline_cache_get_object(const Variant *p_base) const;
+	_FORCE_INLINE_ bool _inline_cache_hit(const InlineCache& p_cache,Object *p_object,uint32_t p_version) const;
+	bool _inline_cache_prepare(InlineCache& p_cache,Object *p_object,uint32_t p_version,GDScript **r_script) const;
+	static bool _inline_cache_script_has_function(const GDScript *p_script,const StringName& p_name);
+	bool _inline_cache_fill_get(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const;
+	bool _inline_cache_fill_set(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const;
+	bool _inline_cache_fill_call(InlineCache& p_cache,Object *p_object,const StringName& p_name,uint32_t p_version) const;
+
 friend class GDScriptLanguage;
 
 	SelfList<GDFunction> function_list;
@@ -151,7 +197,7 @@ public:
 		ObjectID script_id;
 
 		GDInstance *instance;
-		Vector<uint8_t> stack;
+		uint8_t *stack; //frame moved off the native stack, from the frame pool
 		int stack_size;
 		Variant self;
 		uint32_t alloca_size;
@@ -196,6 +242,10 @@ public:
 
 	Variant call(GDInstance *p_instance,const Variant **p_args, int p_argcount,Variant::CallError& r_err,CallState *p_state=NULL);
 
+	static uint8_t *alloc_frame(uint32_t p_size);
+	static void free_frame(uint8_t *p_frame,uint32_t p_size);
+	static void release_frame_pool(); // call from threads before they finish
+
 	_FORCE_INLINE_ ScriptInstance::RPCMode get_rpc_mode() const { return rpc_mode; }
 	GDFunction();
 	~GDFunction();
@@ -1433,6 +1433,19 @@ GDParser::Node* GDParser::_reduce_expression(Node *p_node,bool p_to_const) {
 
 				return op;
 
+			} else if (op->op==OperatorNode::OP_TERNARY_IF) {
+				//only the branch that is taken is kept
+
+				if (op->arguments[0]->type==Node::TYPE_CONSTANT) {
+
+					bool valid;
+					bool taken = static_cast<ConstantNode*>(op->arguments[0])->value.booleanize(valid);
+					if (valid)
+						return taken ? op->arguments[1] : op->arguments[2];
+				}
+
+				return op;
+
 			} else if (op->op==OperatorNode::OP_INDEX_NAMED) {
 
 				if (op->arguments[0]->type==Node::TYPE_CONSTANT && op->arguments[1]->type==Node::TYPE_IDENTIFIER) {
@@ -3404,6 +3417,390 @@ void GDParser::_parse_class(ClassNode *p_class) {
 }
 
 
+int GDParser::_estimate_code_size(const Node *p_node) {
+
+	//roughly the amount of instructions GDCompiler emits for a node, used to
+	//tell how much _fold_class() saved
+
+	if (!p_node)
+		return 0;
+
+	switch(p_node->type) {
+
+		case Node::TYPE_CLASS: {
+
+			const ClassNode *cn = static_cast<const ClassNode*>(p_node);
+			int size = _estimate_code_size(cn->initializer) + _estimate_code_size(cn->ready);
+			for(int i=0;i<cn->functions.size();i++) {
+				size+=_estimate_code_size(cn->functions[i]);
+			}
+			for(int i=0;i<cn->static_functions.size();i++) {
+				size+=_estimate_code_size(cn->static_functions[i]);
+			}
+			for(int i=0;i<cn->subclasses.size();i++) {
+				size+=_estimate_code_size(cn->subclasses[i]);
+			}
+			return size;
+		} break;
+		case Node::TYPE_FUNCTION: {
+
+			const FunctionNode *fn = static_cast<const FunctionNode*>(p_node);
+			int size = _estimate_code_size(fn->body);
+			for(int i=0;i<fn->default_values.size();i++) {
+				size+=_estimate_code_size(fn->default_values[i]);
+			}
+			return size;
+		} break;
+		case Node::TYPE_BLOCK: {
+
+			const BlockNode *bn = static_cast<const BlockNode*>(p_node);
+			int size=0;
+			for(const List<Node*>::Element *E=bn->statements.front();E;E=E->next()) {
+				size+=_estimate_code_size(E->get());
+			}
+			return size;
+		} break;
+		case Node::TYPE_ARRAY: {
+
+			const ArrayNode *an = static_cast<const ArrayNode*>(p_node);
+			int size=1;
+			for(int i=0;i<an->elements.size();i++) {
+				size+=_estimate_code_size(an->elements[i]);
+			}
+			return size;
+		} break;
+		case Node::TYPE_DICTIONARY: {
+
+			const DictionaryNode *dn = static_cast<const DictionaryNode*>(p_node);
+			int size=1;
+			for(int i=0;i<dn->elements.size();i++) {
+				size+=_estimate_code_size(dn->elements[i].key);
+				size+=_estimate_code_size(dn->elements[i].value);
+			}
+			return size;
+		} break;
+		case Node::TYPE_OPERATOR: {
+
+			const OperatorNode *op = static_cast<const OperatorNode*>(p_node);
+			int size=1;
+			switch(op->op) {
+				case OperatorNode::OP_AND:
+				case OperatorNode::OP_OR: size=4; break;
+				case OperatorNode::OP_TERNARY_IF: size=4; break;
+				default: {}
+			}
+			for(int i=0;i<op->arguments.size();i++) {
+				size+=_estimate_code_size(op->arguments[i]);
+			}
+			return size;
+		} break;
+		case Node::TYPE_CONTROL_FLOW: {
+
+			const ControlFlowNode *cf = static_cast<const ControlFlowNode*>(p_node);
+			int size=1;
+			switch(cf->cf_type) {
+				case ControlFlowNode::CF_IF: size = cf->body_else ? 3 : 2; break;
+				case ControlFlowNode::CF_FOR: size=5; break;
+				case ControlFlowNode::CF_WHILE: size=4; break;
+				default: {}
+			}
+			for(int i=0;i<cf->arguments.size();i++) {
+				size+=_estimate_code_size(cf->arguments[i]);
+			}
+			size+=_estimate_code_size(cf->body);
+			size+=_estimate_code_size(cf->body_else);
+			return size;
+		} break;
+		case Node::TYPE_ASSERT: {
+
+			return 1+_estimate_code_size(static_cast<const AssertNode*>(p_node)->condition);
+		} break;
+		case Node::TYPE_BREAKPOINT:
+		case Node::TYPE_NEWLINE: {
+
+			return 1;
+		} break;
+		default: {
+			//constants, identifiers, self, local variable declarations
+			return 0;
+		}
+	}
+}
+
+GDParser::Node* GDParser::_fold_constants(Node *p_node,const Map<StringName,Variant>& p_constants,const Set<StringName>& p_locals) {
+
+	//replace identifiers that name a class constant with the constant value
+
+	switch(p_node->type) {
+
+		case Node::TYPE_IDENTIFIER: {
+
+			const IdentifierNode *in = static_cast<const IdentifierNode*>(p_node);
+			if (p_locals.has(in->name))
+				return p_node;
+
+			const Map<StringName,Variant>::Element *E=p_constants.find(in->name);
+			if (!E)
+				return p_node;
+
+			ConstantNode *cn = alloc_node<ConstantNode>();
+			cn->value=E->get();
+			cn->line=p_node->line;
+			return cn;
+		} break;
+		case Node::TYPE_ARRAY: {
+
+			ArrayNode *an = static_cast<ArrayNode*>(p_node);
+			for(int i=0;i<an->elements.size();i++) {
+				an->elements[i]=_fold_constants(an->elements[i],p_constants,p_locals);
+			}
+		} break;
+		case Node::TYPE_DICTIONARY: {
+
+			DictionaryNode *dn = static_cast<DictionaryNode*>(p_node);
+			for(int i=0;i<dn->elements.size();i++) {
+				dn->elements[i].key=_fold_constants(dn->elements[i].key,p_constants,p_locals);
+				dn->elements[i].value=_fold_constants(dn->elements[i].value,p_constants,p_locals);
+			}
+		} break;
+		case Node::TYPE_OPERATOR: {
+
+			OperatorNode *op = static_cast<OperatorNode*>(p_node);
+			int from=0;
+			int skip=-1; //identifiers used as names, not values
+
+			switch(op->op) {
+
+				case OperatorNode::OP_CALL: {
+					if (op->arguments[0]->type!=Node::TYPE_TYPE && op->arguments[0]->type!=Node::TYPE_BUILT_IN_FUNCTION)
+						skip=1; //method name
+				} break;
+				case OperatorNode::OP_PARENT_CALL: {
+					from=1; //method name
+				} break;
+				case OperatorNode::OP_INDEX_NAMED:
+				case OperatorNode::OP_EXTENDS: {
+					skip=1;
+				} break;
+				case OperatorNode::OP_INIT_ASSIGN:
+				case OperatorNode::OP_ASSIGN:
+				case OperatorNode::OP_ASSIGN_ADD:
+				case OperatorNode::OP_ASSIGN_SUB:
+				case OperatorNode::OP_ASSIGN_MUL:
+				case OperatorNode::OP_ASSIGN_DIV:
+				case OperatorNode::OP_ASSIGN_MOD:
+				case OperatorNode::OP_ASSIGN_SHIFT_LEFT:
+				case OperatorNode::OP_ASSIGN_SHIFT_RIGHT:
+				case OperatorNode::OP_ASSIGN_BIT_AND:
+				case OperatorNode::OP_ASSIGN_BIT_OR:
+				case OperatorNode::OP_ASSIGN_BIT_XOR: {
+					if (op->arguments[0]->type==Node::TYPE_IDENTIFIER)
+						from=1; //assigned to, leave it to the compiler to complain
+				} break;
+				default: {}
+			}
+
+			for(int i=from;i<op->arguments.size();i++) {
+				if (i==skip)
+					continue;
+				op->arguments[i]=_fold_constants(op->arguments[i],p_constants,p_locals);
+			}
+		} break;
+		default: {}
+	}
+
+	return p_node;
+}
+
+GDParser::Node* GDParser::_fold_expression(Node *p_node,const Map<StringName,Variant>& p_constants,const Set<StringName>& p_locals) {
+
+	if (!p_node)
+		return NULL;
+
+	Node *n = _fold_constants(p_node,p_constants,p_locals);
+	n = _reduce_expression(n,false);
+
+	if (error_set) {
+		//an operation that can't be done on these constants is still a runtime
+		//error, as it was before folding. the node that failed is left as is.
+		error_set=false;
+		error="";
+		error_line=0;
+		error_column=0;
+	}
+
+	return n;
+}
+
+void GDParser::_fold_block(BlockNode *p_block,const Map<StringName,Variant>& p_constants,Set<StringName> p_locals) {
+
+	LocalVarNode *last_local=NULL;
+
+	for(List<Node*>::Element *E=p_block->statements.front();E;) {
+
+		List<Node*>::Element *N=E->next();
+		Node *s=E->get();
+
+		switch(s->type) {
+
+			case Node::TYPE_LOCAL_VAR: {
+
+				last_local=static_cast<LocalVarNode*>(s);
+				p_locals.insert(last_local->name);
+			} break;
+			case Node::TYPE_CONTROL_FLOW: {
+
+				ControlFlowNode *cf = static_cast<ControlFlowNode*>(s);
+
+				switch(cf->cf_type) {
+
+					case ControlFlowNode::CF_IF: {
+
+						cf->arguments[0]=_fold_expression(cf->arguments[0],p_constants,p_locals);
+						_fold_block(cf->body,p_constants,p_locals);
+						if (cf->body_else)
+							_fold_block(cf->body_else,p_constants,p_locals);
+
+						if (cf->arguments[0]->type==Node::TYPE_CONSTANT) {
+
+							bool valid;
+							bool taken = static_cast<ConstantNode*>(cf->arguments[0])->value.booleanize(valid);
+							if (valid) {
+								//the compiler runs a block statement in its own scope
+								if (taken)
+									E->get()=cf->body;
+								else if (cf->body_else)
+									E->get()=cf->body_else;
+								else
+									p_block->statements.erase(E);
+							}
+						}
+					} break;
+					case ControlFlowNode::CF_WHILE: {
+
+						cf->arguments[0]=_fold_expression(cf->arguments[0],p_constants,p_locals);
+						_fold_block(cf->body,p_constants,p_locals);
+
+						if (cf->arguments[0]->type==Node::TYPE_CONSTANT) {
+
+							bool valid;
+							bool taken = static_cast<ConstantNode*>(cf->arguments[0])->value.booleanize(valid);
+							if (valid && !taken)
+								p_block->statements.erase(E);
+						}
+					} break;
+					case ControlFlowNode::CF_FOR: {
+
+						cf->arguments[1]=_fold_expression(cf->arguments[1],p_constants,p_locals);
+
+						Set<StringName> locals=p_locals;
+						locals.insert(static_cast<IdentifierNode*>(cf->arguments[0])->name);
+						_fold_block(cf->body,p_constants,locals);
+					} break;
+					case ControlFlowNode::CF_BREAK:
+					case ControlFlowNode::CF_CONTINUE:
+					case ControlFlowNode::CF_RETURN: {
+
+						for(int i=0;i<cf->arguments.size();i++) {
+							cf->arguments[i]=_fold_expression(cf->arguments[i],p_constants,p_locals);
+						}
+
+						//nothing after this in the block can run
+						while(N) {
+							List<Node*>::Element *D=N;
+							N=N->next();
+							p_block->statements.erase(D);
+						}
+					} break;
+					default: {}
+				}
+			} break;
+			case Node::TYPE_ASSERT: {
+
+				AssertNode *as = static_cast<AssertNode*>(s);
+				as->condition=_fold_expression(as->condition,p_constants,p_locals);
+			} break;
+			case Node::TYPE_OPERATOR:
+			case Node::TYPE_ARRAY:
+			case Node::TYPE_DICTIONARY: {
+
+				Node *assigned = s->type==Node::TYPE_OPERATOR && static_cast<OperatorNode*>(s)->arguments.size()==2 ? static_cast<OperatorNode*>(s)->arguments[1] : NULL;
+
+				E->get()=_fold_expression(s,p_constants,p_locals);
+
+				if (last_local && assigned && last_local->assign==assigned) {
+					//keep the declaration in sync with its initialization, the compiler reads it for type guessing
+					last_local->assign=static_cast<OperatorNode*>(s)->arguments[1];
+				}
+				last_local=NULL;
+			} break;
+			default: {}
+		}
+
+		E=N;
+	}
+}
+
+void GDParser::_fold_class(ClassNode *p_class) {
+
+	Map<StringName,Variant> constants;
+
+	//constants of the script itself are looked up when running, so a script
+	//extending this one can shadow them. integer constants of the native base
+	//are put in the code by the compiler, those can be folded.
+	bool native_base = p_class->extends_used && p_class->extends_file==StringName() && p_class->extends_class.size()==1 && ObjectTypeDB::type_exists(p_class->extends_class[0]);
+
+	if (native_base) {
+
+		List<String> native_constants;
+		ObjectTypeDB::get_integer_constant_list(p_class->extends_class[0],&native_constants);
+		for(List<String>::Element *E=native_constants.front();E;E=E->next()) {
+			constants[E->get()]=ObjectTypeDB::get_integer_constant(p_class->extends_class[0],E->get());
+		}
+
+		//the compiler looks for these first
+		for(int i=0;i<p_class->variables.size();i++) {
+			constants.erase(p_class->variables[i].identifier);
+		}
+		for(int i=0;i<p_class->constant_expressions.size();i++) {
+			constants.erase(p_class->constant_expressions[i].identifier);
+		}
+		for(int i=0;i<p_class->subclasses.size();i++) {
+			constants.erase(p_class->subclasses[i]->name);
+		}
+	}
+
+	Set<StringName> locals;
+
+	_fold_block(p_class->initializer,constants,locals);
+	_fold_block(p_class->ready,constants,locals);
+
+	for(int f=0;f<2;f++) {
+
+		const Vector<FunctionNode*> &functions = f==0 ? p_class->functions : p_class->static_functions;
+
+		for(int i=0;i<functions.size();i++) {
+
+			FunctionNode *fn = functions[i];
+
+			Set<StringName> args;
+			for(int j=0;j<fn->arguments.size();j++) {
+				args.insert(fn->arguments[j]);
+			}
+
+			for(int j=0;j<fn->default_values.size();j++) {
+				fn->default_values[j]=_fold_expression(fn->default_values[j],constants,args);
+			}
+
+			_fold_block(fn->body,constants,args);
+		}
+	}
+
+	for(int i=0;i<p_class->subclasses.size();i++) {
+		_fold_class(p_class->subclasses[i]);
+	}
+}
+
 void GDParser::_set_error(const String& p_error, int p_line, int p_column) {
 
 
@@ -3436,6 +3833,8 @@ Error GDParser::_parse(const String& p_base_path) {
 
 	base_path=p_base_path;
 
+	bool fold = !validating && !for_completion; //clear() resets these
+
 	clear();
 
 	//assume class
@@ -3457,6 +3856,15 @@ Error GDParser::_parse(const String& p_base_path) {
 
 		return ERR_PARSE_ERROR;
 	}
+
+	if (fold) {
+		//the tree is only going to be compiled, fold what can be known now
+
+		int size = _estimate_code_size(main_class);
+		_fold_class(main_class);
+		saved_instructions = size - _estimate_code_size(main_class);
+	}
+
 	return OK;
 }
 
@@ -3521,6 +3929,11 @@ const GDParser::Node *GDParser::get_parse_tree() const {
 	return head;
 }
 
+int GDParser::get_saved_instruction_count() const {
+
+	return saved_instructions;
+}
+
 void GDParser::clear() {
 
 	while(list) {
@@ -3549,6 +3962,7 @@ void GDParser::clear() {
 	validating=false;
 	for_completion=false;
 	error_set=false;
+	saved_instructions=0;
 	tab_level.clear();
 	tab_level.push_back(0);
 	error_line=0;
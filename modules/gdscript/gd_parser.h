@@ -32,6 +32,7 @@
 #include "gd_tokenizer.h"
 #include "gd_functions.h"
 #include "map.h"
+#include "set.h"
 #include "object.h"
 #include "script_language.h"
 
@@ -456,6 +457,14 @@ private:
 	void _parse_class(ClassNode *p_class);
 	bool _end_statement();
 
+	int saved_instructions;
+
+	static int _estimate_code_size(const Node *p_node);
+	Node* _fold_constants(Node *p_node,const Map<StringName,Variant>& p_constants,const Set<StringName>& p_locals);
+	Node* _fold_expression(Node *p_node,const Map<StringName,Variant>& p_constants,const Set<StringName>& p_locals);
+	void _fold_block(BlockNode *p_block,const Map<StringName,Variant>& p_constants,Set<StringName> p_locals);
+	void _fold_class(ClassNode *p_class);
+
 	Error _parse(const String& p_base_path);
 
 public:
@@ -468,6 +477,7 @@ public:
 
 	bool is_tool_script() const;
 	const Node *get_parse_tree() const;
+	int get_saved_instruction_count() const;
 
 	//completion info
 
@@ -642,6 +642,10 @@ Error GDScript::reload(bool p_keep_state) {
 
 	valid=true;
 
+	if (OS::get_singleton()->is_stdout_verbose() && parser.get_saved_instruction_count()>0) {
+		print_line("GDScript: constant folding saved about "+itos(parser.get_saved_instruction_count())+" instructions in "+(path.empty()?String("built-in script"):path));
+	}
+
 	for(Map<StringName,Ref<GDScript> >::Element *E=subclasses.front();E;E=E->next()) {
 
 		_set_subclass_path(E->get(),path);
@@ -801,6 +805,24 @@ Error GDScript::load_byte_code(const String& p_path) {
 		basedir=basedir.get_base_dir();
 
 	valid=false;
+
+	if (GDCompiler::is_compiled_buffer(bytecode)) {
+
+		//exported together with its compiled form, parse the tokens only if that can't be used
+		Vector<uint8_t> tokens;
+		GDCompiler compiler;
+		if (compiler.load_compiled_buffer(bytecode,this,tokens)==OK) {
+
+			for(Map<StringName,Ref<GDScript> >::Element *E=subclasses.front();E;E=E->next()) {
+
+				_set_subclass_path(E->get(),path);
+			}
+			return OK;
+		}
+
+		bytecode=tokens;
+	}
+
 	GDParser parser;
 	Error err = parser.parse_bytecode(bytecode,basedir,get_path());
 	if (err) {
@@ -966,6 +988,8 @@ GDScript::~GDScript() {
 		E->get()->_owner=NULL; //bye, you are no longer owned cause I died
 	}
 
+	GDScriptLanguage::get_singleton()->invalidate_inline_caches(); //another script may be allocated at this address
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -1516,7 +1540,13 @@ Error GDScriptLanguage::execute_file(const String& p_path)  {
 }
 void GDScriptLanguage::finish()  {
 
+	sampling_stop();
+	GDFunction::release_frame_pool();
+}
+
+void GDScriptLanguage::thread_exit() {
 
+	GDFunction::release_frame_pool();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1638,6 +1668,247 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_i
 }
 
 
+bool GDScriptLanguage::SampleStack::operator<(const SampleStack& p_stack) const {
+
+	if (depth!=p_stack.depth)
+		return depth<p_stack.depth;
+
+	for(int i=0;i<depth;i++) {
+
+		if (function[i]!=p_stack.function[i])
+			return function[i]<p_stack.function[i];
+		if (line[i]!=p_stack.line[i])
+			return line[i]<p_stack.line[i];
+	}
+
+	return false;
+}
+
+void GDScriptLanguage::_sampler_thread_func(void *p_userdata) {
+
+	GDScriptLanguage *gdl=(GDScriptLanguage*)p_userdata;
+
+	while(!gdl->sampler_exit) {
+
+		OS::get_singleton()->delay_usec(gdl->sampling_interval);
+		gdl->_take_sample();
+	}
+}
+
+void GDScriptLanguage::_take_sample() {
+
+	//the main thread keeps running while the stack is read, so a sample may mix two neighbouring
+	//states of it. functions are only looked at when reporting, once they are known to still exist.
+	SampleStack s;
+	s.depth=MIN(int(_sample_stack_pos),int(SAMPLE_MAX_DEPTH));
+	for(int i=0;i<s.depth;i++) {
+
+		s.function[i]=_sample_stack[i].function;
+		s.line[i]=*_sample_stack[i].line;
+	}
+
+	sample_lock->lock();
+
+	sample_count++;
+	if (s.depth>0) {
+
+		Map<SampleStack,uint64_t>::Element *E=samples.find(s);
+		if (E)
+			E->get()++;
+		else
+			samples.insert(s,1);
+	}
+
+	sample_lock->unlock();
+}
+
+String GDScriptLanguage::_get_sample_frame_name(GDFunction *p_function,int p_line) const {
+
+	String source=p_function->get_source();
+	if (source==String())
+		source="<built-in>";
+	return String(p_function->get_name())+" ("+source+":"+itos(p_line)+")";
+}
+
+void GDScriptLanguage::sampling_start(int p_interval_usec) {
+
+#if defined(DEBUG_ENABLED) && !defined(NO_THREADS)
+	if (sampling)
+		sampling_stop();
+
+	sample_lock->lock();
+	samples.clear();
+	sample_count=0;
+	sample_lock->unlock();
+
+	sampling_interval=MAX(p_interval_usec,100);
+	sampler_exit=false;
+	sampling=true;
+	sampler_thread=Thread::create(_sampler_thread_func,this);
+#else
+	ERR_EXPLAIN("The sampling profiler needs a debug build with threads");
+	ERR_FAIL();
+#endif
+}
+
+void GDScriptLanguage::sampling_stop() {
+
+	if (!sampling)
+		return;
+
+	sampling=false;
+	sampler_exit=true;
+	Thread::wait_to_finish(sampler_thread);
+	memdelete(sampler_thread);
+	sampler_thread=NULL;
+}
+
+uint64_t GDScriptLanguage::sampling_get_sample_count() const {
+
+	return sample_count;
+}
+
+struct _GDSampledLine {
+
+	GDFunction *function;
+	int line;
+
+	bool operator<(const _GDSampledLine& p_line) const { return function==p_line.function ? line<p_line.line : function<p_line.function; }
+};
+
+struct _GDSampledLineSort {
+
+	bool operator()(const ScriptLanguage::SampledLineInfo& p_a,const ScriptLanguage::SampledLineInfo& p_b) const {
+
+		return p_a.self_samples==p_b.self_samples ? p_a.total_samples>p_b.total_samples : p_a.self_samples>p_b.self_samples;
+	}
+};
+
+int GDScriptLanguage::sampling_get_line_data(SampledLineInfo *p_info_arr,int p_info_max) {
+
+	int current=0;
+#ifdef DEBUG_ENABLED
+	Set<GDFunction*> live;
+	if (lock) {
+		lock->lock();
+	}
+
+	for(SelfList<GDFunction> *elem=function_list.first();elem;elem=elem->next()) {
+		live.insert(elem->self());
+	}
+
+	Map<_GDSampledLine,SampledLineInfo> lines;
+
+	if (sample_lock) {
+		sample_lock->lock();
+	}
+
+	for(Map<SampleStack,uint64_t>::Element *E=samples.front();E;E=E->next()) {
+
+		const SampleStack &s=E->key();
+		for(int i=0;i<s.depth;i++) {
+
+			if (!live.has(s.function[i]))
+				continue;
+
+			bool seen=false; //recursion, count lines once per sample
+			for(int j=0;j<i;j++) {
+				if (s.function[j]==s.function[i] && s.line[j]==s.line[i]) {
+					seen=true;
+					break;
+				}
+			}
+
+			_GDSampledLine key;
+			key.function=s.function[i];
+			key.line=s.line[i];
+
+			Map<_GDSampledLine,SampledLineInfo>::Element *L=lines.find(key);
+			if (!L) {
+				SampledLineInfo info;
+				info.source=s.function[i]->get_source();
+				info.function=s.function[i]->get_name();
+				info.line=s.line[i];
+				info.self_samples=0;
+				info.total_samples=0;
+				L=lines.insert(key,info);
+			}
+
+			if (!seen)
+				L->get().total_samples+=E->get();
+			if (i==s.depth-1)
+				L->get().self_samples+=E->get();
+		}
+	}
+
+	if (sample_lock) {
+		sample_lock->unlock();
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	Vector<SampledLineInfo> sorted;
+	for(Map<_GDSampledLine,SampledLineInfo>::Element *E=lines.front();E;E=E->next()) {
+		sorted.push_back(E->get());
+	}
+	sorted.sort_custom<_GDSampledLineSort>();
+
+	for(int i=0;i<sorted.size() && current<p_info_max;i++) {
+		p_info_arr[current++]=sorted[i];
+	}
+#endif
+
+	return current;
+}
+
+String GDScriptLanguage::sampling_get_collapsed_stacks() {
+
+	String ret;
+#ifdef DEBUG_ENABLED
+	Set<GDFunction*> live;
+	if (lock) {
+		lock->lock();
+	}
+
+	for(SelfList<GDFunction> *elem=function_list.first();elem;elem=elem->next()) {
+		live.insert(elem->self());
+	}
+
+	if (sample_lock) {
+		sample_lock->lock();
+	}
+
+	for(Map<SampleStack,uint64_t>::Element *E=samples.front();E;E=E->next()) {
+
+		const SampleStack &s=E->key();
+		String stack;
+		for(int i=0;i<s.depth;i++) {
+
+			if (i>0)
+				stack+=";";
+			if (live.has(s.function[i]))
+				stack+=_get_sample_frame_name(s.function[i],s.line[i]);
+			else
+				stack+="<freed>"; //script was unloaded since
+		}
+		ret+=stack+" "+itos(E->get())+"\n";
+	}
+
+	if (sample_lock) {
+		sample_lock->unlock();
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+#endif
+
+	return ret;
+}
+
+
 struct GDScriptDepSort {
 
 	//must support sorting so inheritance works properly (parent must be reloaded first)
@@ -1930,6 +2201,7 @@ GDScriptLanguage::GDScriptLanguage() {
 	strings._script_source=StaticCString::create("script/source");
 	_debug_parse_err_line=-1;
 	_debug_parse_err_file="";
+	inline_cache_version=1;
 
 #ifdef NO_THREADS
 	lock=NULL;
@@ -1939,6 +2211,23 @@ GDScriptLanguage::GDScriptLanguage() {
 	profiling=false;
 	script_frame_time=0;
 
+	sampling=false;
+	_sample_stack_pos=0;
+	_sample_no_line=0;
+	for(int i=0;i<SAMPLE_MAX_DEPTH;i++) {
+		_sample_stack[i].function=NULL;
+		_sample_stack[i].line=&_sample_no_line;
+	}
+	sample_count=0;
+	sampler_thread=NULL;
+	sampler_exit=false;
+	sampling_interval=1000;
+#ifdef NO_THREADS
+	sample_lock=NULL;
+#else
+	sample_lock=Mutex::create();
+#endif
+
 	_debug_call_stack_pos=0;
 	int dmcs=GLOBAL_DEF("debug/script_max_call_stack",1024);
 	if (ScriptDebugger::get_singleton()) {
@@ -1959,6 +2248,11 @@ GDScriptLanguage::GDScriptLanguage() {
 
 GDScriptLanguage::~GDScriptLanguage() {
 
+	sampling_stop();
+	if (sample_lock) {
+		memdelete(sample_lock);
+		sample_lock=NULL;
+	}
 
 	if (lock) {
 		memdelete(lock);
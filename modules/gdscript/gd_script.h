@@ -307,12 +307,54 @@ friend class GDFunction;
 	SelfList<GDFunction>::List function_list;
 	bool profiling;
 	uint64_t script_frame_time;
+
+	// functions running in the main thread and their current line, as seen by the sampler thread
+	struct SampleLevel {
+
+		GDFunction * volatile function;
+		int * volatile line;
+	};
+
+	enum {
+		SAMPLE_MAX_DEPTH=64 // deeper calls are sampled as their caller at this depth
+	};
+
+	SampleLevel _sample_stack[SAMPLE_MAX_DEPTH];
+	volatile int _sample_stack_pos;
+	int _sample_no_line;
+	volatile bool sampling;
+
+	struct SampleStack {
+
+		int depth;
+		GDFunction *function[SAMPLE_MAX_DEPTH];
+		int line[SAMPLE_MAX_DEPTH];
+
+		bool operator<(const SampleStack& p_stack) const;
+	};
+
+	Map<SampleStack,uint64_t> samples;
+	uint64_t sample_count;
+	Mutex *sample_lock;
+	Thread *sampler_thread;
+	volatile bool sampler_exit;
+	int sampling_interval;
+
+	static void _sampler_thread_func(void *p_userdata);
+	void _take_sample();
+	String _get_sample_frame_name(GDFunction *p_function,int p_line) const;
+
+	volatile uint32_t inline_cache_version;
 public:
 
 
 	int calls;
 
 	bool debug_break(const String& p_error,bool p_allow_continue=true);
+
+	// bumped whenever a script is compiled or destroyed, the inline caches in functions check it
+	_FORCE_INLINE_ void invalidate_inline_caches() { atomic_increment(&inline_cache_version); }
+	_FORCE_INLINE_ uint32_t get_inline_cache_version() const { return inline_cache_version; }
 	bool debug_break_parse(const String& p_file, int p_line,const String& p_error);
 
 	_FORCE_INLINE_ void enter_function(GDInstance *p_instance,GDFunction *p_function, Variant *p_stack, int *p_ip, int *p_line) {
@@ -338,6 +380,24 @@ public:
 		_debug_call_stack_pos++;
 	}
 
+	// only called from the main thread, while sampling
+	_FORCE_INLINE_ void sample_enter(GDFunction *p_function,int *p_line) {
+
+		int pos=_sample_stack_pos;
+		if (pos<SAMPLE_MAX_DEPTH) {
+			_sample_stack[pos].function=p_function;
+			_sample_stack[pos].line=p_line;
+		}
+		_sample_stack_pos=pos+1;
+	}
+
+	_FORCE_INLINE_ void sample_exit() {
+
+		_sample_stack_pos--;
+	}
+
+	_FORCE_INLINE_ bool is_sampling() const { return sampling; }
+
 	_FORCE_INLINE_ void exit_function() {
 
 		if (Thread::get_main_ID()!=Thread::get_caller_ID())
@@ -396,6 +456,7 @@ public:
 	virtual String get_extension() const;
 	virtual Error execute_file(const String& p_path) ;
 	virtual void finish();
+	virtual void thread_exit();
 
 	/* EDITOR FUNCTIONS */
 	virtual void get_reserved_words(List<String> *p_words) const;
@@ -441,6 +502,12 @@ public:
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr,int p_info_max);
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_info_max);
 
+	virtual void sampling_start(int p_interval_usec);
+	virtual void sampling_stop();
+	virtual uint64_t sampling_get_sample_count() const;
+	virtual int sampling_get_line_data(SampledLineInfo *p_info_arr,int p_info_max);
+	virtual String sampling_get_collapsed_stacks();
+
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
@@ -29,6 +29,7 @@
 #include "register_types.h"
 
 #include "gd_script.h"
+#include "gd_compiler.h"
 #include "io/resource_loader.h"
 #include "os/file_access.h"
 #include "io/file_access_encrypted.h"
@@ -67,6 +68,16 @@ public:
 
 				if (!file.empty()) {
 
+					//store the compiled script too, so it loads without parsing. only when it was
+					//compiled from the same text, scripts modified in the editor are exported as tokens.
+					Ref<GDScript> script = ResourceLoader::load(p_path);
+					if (script.is_valid() && script->is_valid() && script->get_source_code()==txt) {
+
+						Vector<uint8_t> compiled = GDCompiler::make_compiled_buffer(script.ptr(),file);
+						if (!compiled.empty())
+							file=compiled;
+					}
+
 					if (EditorImportExport::get_singleton()->script_get_action()==EditorImportExport::SCRIPT_ACTION_ENCRYPT) {
 
 						String tmp_path=EditorSettings::get_singleton()->get_settings_path().plus_file("tmp/script.gde");
@@ -1537,12 +1537,49 @@ void VisualScriptInstance::_dependency_step(VisualScriptNodeInstance* node,int p
 
 }
 
+void VisualScriptInstance::_report_call_error(const StringName& p_method,VisualScriptNodeInstance *p_node,int p_node_id,const Variant::CallError& p_error,String& error_str) {
+
+	// function, file, line, error, explanation
+	String err_file = script->get_path();
+	String err_func = p_method;
+	int err_line=p_node_id; //not a line but it works as one
+
+	if (p_node && (p_error.error!=Variant::CallError::CALL_ERROR_INVALID_METHOD || error_str==String())) {
+
+		if (error_str!=String()) {
+			error_str+=" ";
+		}
+
+		if (p_error.error==Variant::CallError::CALL_ERROR_INVALID_ARGUMENT) {
+			int errorarg=p_error.argument;
+			error_str+="Cannot convert argument "+itos(errorarg+1)+" to "+Variant::get_type_name(p_error.expected)+".";
+		} else if (p_error.error==Variant::CallError::CALL_ERROR_TOO_MANY_ARGUMENTS) {
+			error_str+="Expected "+itos(p_error.argument)+" arguments.";
+		} else if (p_error.error==Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS) {
+			error_str+="Expected "+itos(p_error.argument)+" arguments.";
+		} else if (p_error.error==Variant::CallError::CALL_ERROR_INVALID_METHOD) {
+			error_str+="Invalid Call.";
+		} else if (p_error.error==Variant::CallError::CALL_ERROR_INSTANCE_IS_NULL) {
+			error_str+="Base Instance is null";
+		}
+	}
+
+	if (!VisualScriptLanguage::singleton->debug_break(error_str,false)) {
+		// debugger break did not happen
+
+		_err_print_error(err_func.utf8().get_data(),err_file.utf8().get_data(),err_line,error_str.utf8().get_data(),ERR_HANDLER_SCRIPT);
+	}
+}
+
 Variant VisualScriptInstance::_call_internal(const StringName& p_method, void* p_stack, int p_stack_size, VisualScriptNodeInstance* p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield, Variant::CallError &r_error) {
 
 	Map<StringName,Function>::Element *F = functions.find(p_method);
 	ERR_FAIL_COND_V(!F,Variant());
 	Function *f=&F->get();
 
+	if (f->compiled)
+		return _call_compiled(f,p_method,p_stack,p_stack_size,p_node,p_flow_stack_pos,p_pass,p_resuming_yield,r_error);
+
 	//this call goes separate, so it can e yielded and suspended
 	Variant *variant_stack=(Variant*)p_stack;
 	bool *sequence_bits = (bool*)(variant_stack + f->max_stack);
@@ -1889,46 +1926,334 @@ Variant VisualScriptInstance::_call_internal(const StringName& p_method, void* p
 
 	if (error) {
 
-		//error
-		// function, file, line, error, explanation
-		String err_file = script->get_path();
-		String err_func = p_method;
-		int err_line=current_node_id; //not a line but it works as one
+		_report_call_error(p_method,node,current_node_id,r_error,error_str);
+	}
 
-		if (node && (r_error.error!=Variant::CallError::CALL_ERROR_INVALID_METHOD || error_str==String())) {
+#ifdef DEBUG_ENABLED
+	if (ScriptDebugger::get_singleton()) {
+		VisualScriptLanguage::singleton->exit_function();
+	}
+#endif
 
-			if (error_str!=String()) {
-				error_str+=" ";
+	//clean up variant stack
+	for(int i=0;i<f->max_stack;i++) {
+		variant_stack[i].~Variant();
+	}
+
+
+	return return_value;
+}
+
+
+Variant VisualScriptInstance::_call_compiled(Function *f,const StringName& p_method, void* p_stack, int p_stack_size, VisualScriptNodeInstance* p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield, Variant::CallError &r_error) {
+
+	//same as _call_internal(), but the graph was flattened into steps when the instance was
+	//created: ports and dependencies are resolved and the flow stack holds step indices
+
+	Variant *variant_stack=(Variant*)p_stack;
+	bool *sequence_bits = (bool*)(variant_stack + f->max_stack);
+	const Variant **input_args=(const Variant**)(sequence_bits+f->node_count);
+	Variant **output_args=(Variant**)(input_args + max_input_args);
+	int flow_max = f->flow_stack_size;
+	int* flow_stack = flow_max? (int*)(output_args + max_output_args) : (int*)NULL;
+
+	const Step *steps=f->steps.ptr();
+	const int *ports=f->step_ports.ptr();
+	const int *dependencies=f->step_dependencies.ptr();
+	const int *jumps=f->step_jumps.ptr();
+	const Variant *defaults=default_values.ptr();
+
+	String error_str;
+
+	VisualScriptNodeInstance* node=p_node;
+	int step_idx=p_node->sequence_index;
+	bool error=false;
+	int current_node_id=f->node;
+	Variant return_value;
+	Variant *working_mem=NULL;
+
+	int flow_stack_pos=p_flow_stack_pos;
+
+#ifdef DEBUG_ENABLED
+	if (ScriptDebugger::get_singleton()) {
+		VisualScriptLanguage::singleton->enter_function(this,&p_method,variant_stack,&working_mem,&current_node_id);
+	}
+#endif
+
+	while(true) {
+
+		p_pass++; //kept for yield states
+		const Step &step=steps[step_idx];
+		node=step.node;
+		current_node_id=node->id;
+
+		if (step_idx==f->function_step) {
+			//function arguments are at the begining of the stack
+
+			for(int i=0;i<f->argument_count;i++) {
+				input_args[i]=&variant_stack[i];
+			}
+		} else {
+
+			//run dependencies first
+			for(int i=0;i<step.dependency_count;i++) {
+
+				const Step &dep=steps[dependencies[step.dependency_ofs+i]];
+				VisualScriptNodeInstance *dep_node=dep.node;
+
+				const int *dep_inputs=&ports[dep.input_ofs];
+				for(int j=0;j<dep_node->input_port_count;j++) {
+					input_args[j]=dep_inputs[j]>=0 ? &variant_stack[dep_inputs[j]] : &defaults[-1-dep_inputs[j]];
+				}
+				const int *dep_outputs=&ports[dep.output_ofs];
+				for(int j=0;j<dep_node->output_port_count;j++) {
+					output_args[j]=&variant_stack[dep_outputs[j]];
+				}
+
+				Variant *dep_working_mem=dep_node->working_mem_idx>=0 ? &variant_stack[dep_node->working_mem_idx] : (Variant*)NULL;
+				dep_node->step(input_args,output_args,VisualScriptNodeInstance::START_MODE_BEGIN_SEQUENCE,dep_working_mem,r_error,error_str);
+				if (r_error.error!=Variant::CallError::CALL_OK) {
+					error=true;
+					node=dep_node;
+					current_node_id=dep_node->id;
+					break;
+				}
 			}
 
-			if (r_error.error==Variant::CallError::CALL_ERROR_INVALID_ARGUMENT) {
-				int errorarg=r_error.argument;
-				error_str+="Cannot convert argument "+itos(errorarg+1)+" to "+Variant::get_type_name(r_error.expected)+".";
-			} else if (r_error.error==Variant::CallError::CALL_ERROR_TOO_MANY_ARGUMENTS) {
-				error_str+="Expected "+itos(r_error.argument)+" arguments.";
-			} else if (r_error.error==Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS) {
-				error_str+="Expected "+itos(r_error.argument)+" arguments.";
-			} else if (r_error.error==Variant::CallError::CALL_ERROR_INVALID_METHOD) {
-				error_str+="Invalid Call.";
-			} else if (r_error.error==Variant::CallError::CALL_ERROR_INSTANCE_IS_NULL) {
-				error_str+="Base Instance is null";
+			if (error)
+				break;
+
+			const int *inputs=&ports[step.input_ofs];
+			for(int i=0;i<node->input_port_count;i++) {
+				input_args[i]=inputs[i]>=0 ? &variant_stack[inputs[i]] : &defaults[-1-inputs[i]];
 			}
 		}
 
+		const int *outputs=&ports[step.output_ofs];
+		for(int i=0;i<node->output_port_count;i++) {
+			output_args[i]=&variant_stack[outputs[i]];
+		}
+
+		working_mem=node->working_mem_idx>=0 ? &variant_stack[node->working_mem_idx] : (Variant*)NULL;
+
+		VisualScriptNodeInstance::StartMode start_mode;
+		if (p_resuming_yield)
+			start_mode=VisualScriptNodeInstance::START_MODE_RESUME_YIELD;
+		else if (!flow_stack || !(flow_stack[flow_stack_pos] & VisualScriptNodeInstance::FLOW_STACK_PUSHED_BIT)) //if there is a push bit, it means we are continuing a sequence
+			start_mode=VisualScriptNodeInstance::START_MODE_BEGIN_SEQUENCE;
+		else
+			start_mode=VisualScriptNodeInstance::START_MODE_CONTINUE_SEQUENCE;
 
-		//if (!GDScriptLanguage::get_singleton()->debug_break(err_text,false)) {
-			// debugger break did not happen
+		p_resuming_yield=false;
 
-		if (!VisualScriptLanguage::singleton->debug_break(error_str,false)) {
+		int ret = node->step(input_args,output_args,start_mode,working_mem,r_error,error_str);
 
-			_err_print_error(err_func.utf8().get_data(),err_file.utf8().get_data(),err_line,error_str.utf8().get_data(),ERR_HANDLER_SCRIPT);
+		if (r_error.error!=Variant::CallError::CALL_OK) {
+			//use error from step
+			error=true;
+			break;
 		}
 
-		//}
-	} else {
+		if (ret&VisualScriptNodeInstance::STEP_YIELD_BIT) {
+			//yielded!
+			if (node->get_working_memory_size()==0) {
+				r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+				error_str=RTR("A node yielded without working memory, please read the docs on how to yield properly!");
+				error=true;
+				break;
+
+			} else {
+				Ref<VisualScriptFunctionState> state = *working_mem;
+				if (!state.is_valid()) {
+
+					r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+					error_str=RTR("Node yielded, but did not return a function state in the first working memory.");
+					error=true;
+					break;
 
+				}
+
+				//step 1, capture all state
+				state->instance_id=get_owner_ptr()->get_instance_ID();
+				state->script_id=get_script()->get_instance_ID();
+				state->instance=this;
+				state->function=p_method;
+				state->working_mem_index=node->working_mem_idx;
+				state->variant_stack_size=f->max_stack;
+				state->node=node;
+				state->flow_stack_pos=flow_stack_pos;
+				state->stack.resize(p_stack_size);
+				state->pass=p_pass;
+				copymem(state->stack.ptr(),p_stack,p_stack_size);
+				//step 2, run away, return directly
+				r_error.error=Variant::CallError::CALL_OK;
+
+
+#ifdef DEBUG_ENABLED
+				//will re-enter later, so exiting
+				if (ScriptDebugger::get_singleton()) {
+					VisualScriptLanguage::singleton->exit_function();
+				}
+#endif
+
+				return state;
+
+			}
+		}
+
+#ifdef DEBUG_ENABLED
+		if (ScriptDebugger::get_singleton()) {
+			// line
+			bool do_break=false;
+
+			if (ScriptDebugger::get_singleton()->get_lines_left()>0) {
+
+				if (ScriptDebugger::get_singleton()->get_depth()<=0)
+					ScriptDebugger::get_singleton()->set_lines_left( ScriptDebugger::get_singleton()->get_lines_left() -1 );
+				if (ScriptDebugger::get_singleton()->get_lines_left()<=0)
+					do_break=true;
+			}
+
+			if (ScriptDebugger::get_singleton()->is_breakpoint(current_node_id,source))
+				do_break=true;
+
+			if (do_break) {
+				VisualScriptLanguage::singleton->debug_break("Breakpoint",true);
+			}
+
+			ScriptDebugger::get_singleton()->line_poll();
+
+		}
+#endif
+		int output = ret & VisualScriptNodeInstance::STEP_MASK;
+
+		if (ret & VisualScriptNodeInstance::STEP_EXIT_FUNCTION_BIT) {
+			if (node->get_working_memory_size()==0) {
+
+				r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+				error_str=RTR("Return value must be assigned to first element of node working memory! Fix your node please.");
+				error=true;
+			} else {
+				//assign from working memory, first element
+				return_value=*working_mem;
+			}
+
+			break; //exit function requested, bye
+		}
+
+		int next=-1; //next step
+
+		if ( (ret==output || ret&VisualScriptNodeInstance::STEP_FLAG_PUSH_STACK_BIT) && node->sequence_output_count) {
+			//if no exit bit was set, and has sequence outputs, guess next step
+			if (output<0 || output>=node->sequence_output_count) {
+				r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+				error_str=RTR("Node returned an invalid sequence output: ")+itos(output);
+				error=true;
+				break;
+			}
+
+			next=jumps[step.sequence_ofs+output];
+		}
+
+		if (flow_stack) {
+
+			//update flow stack pos (may have changed)
+			flow_stack[flow_stack_pos] = step_idx;
+
+			//add stack push bit if requested
+			if (ret & VisualScriptNodeInstance::STEP_FLAG_PUSH_STACK_BIT) {
+
+				flow_stack[flow_stack_pos] |= VisualScriptNodeInstance::FLOW_STACK_PUSHED_BIT;
+				sequence_bits[step_idx]=true; //remember sequence bit
+			} else {
+				sequence_bits[step_idx]=false; //forget sequence bit
+			}
+
+
+			if (ret & VisualScriptNodeInstance::STEP_FLAG_GO_BACK_BIT) {
+				//go back request
+
+				if (flow_stack_pos>0) {
+					flow_stack_pos--;
+					step_idx = flow_stack[flow_stack_pos] & VisualScriptNodeInstance::FLOW_STACK_MASK;
+				} else {
+					break; //simply exit without value or error
+				}
+			} else if (next>=0) {
+
+
+				if (sequence_bits[next]) {
+					// entering a node that is in the middle of a sequence from the front, the sequence
+					// is restarted and the stack rolls back to where this node started it (see _call_internal)
+
+					bool found = false;
+
+					for(int i=flow_stack_pos;i>=0;i--) {
+
+						if ( (flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK ) == next ) {
+							flow_stack_pos=i; //roll back and remove bit
+							flow_stack[i]=next;
+							sequence_bits[next]=false;
+							found=true;
+						}
+					}
+
+					if (!found) {
+						r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+						error_str=RTR("Found sequence bit but not the node in the stack, report bug!");
+						error=true;
+						break;
+					}
+
+					step_idx=next;
+
+				} else {
+					// check for stack overflow
+					if (flow_stack_pos+1 >= flow_max) {
+						r_error.error=Variant::CallError::CALL_ERROR_INVALID_METHOD;
+						error_str=RTR("Stack overflow with stack depth: ")+itos(output);
+						error=true;
+						break;
+					}
+
+					step_idx=next;
+
+					flow_stack_pos++;
+					flow_stack[flow_stack_pos]=step_idx;
+				}
+
+			} else {
+				//no next node, try to go back in stack to pushed bit
+
+				bool found = false;
+
+				for(int i=flow_stack_pos;i>=0;i--) {
+
+					if (flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_PUSHED_BIT) {
+
+						step_idx = flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK;
+						flow_stack_pos=i;
+						found=true;
+						break;
+					}
+				}
+
+				if (!found) {
+					break; //done, couldn't find a push stack bit
+				}
+			}
+		} else {
+
+			if (next<0)
+				break; //stackless mode, flow ends here
+			step_idx=next;
+		}
 
-		//return_value=
+	}
+
+	if (error) {
+
+		_report_call_error(p_method,node,current_node_id,r_error,error_str);
 	}
 
 #ifdef DEBUG_ENABLED
@@ -2005,7 +2330,7 @@ Variant VisualScriptInstance::call(const StringName& p_method, const Variant** p
 
 
 	if (flow_stack)	{
-		flow_stack[0]=node->get_id();
+		flow_stack[0]=f->compiled ? node->sequence_index : node->get_id();
 	}
 
 	VSDEBUG("ARGUMENTS: "+itos(f->argument_count)=" RECEIVED: "+itos(p_argcount));
@@ -2118,7 +2443,10 @@ void VisualScriptInstance::create(const Ref<VisualScript>& p_script,Object *p_ow
 		function.flow_stack_size=0;
 		function.pass_stack_size=0;
 		function.node_count=0;
+		function.compiled=false;
+		function.function_step=-1;
 		Map<StringName,int> local_var_indices;
+		Vector<VisualScriptNodeInstance*> function_nodes; //by sequence index
 
 		if (function.node<0) {
 			VisualScriptLanguage::singleton->debug_break_parse(get_script()->get_path(),0,"No start node in function: "+String(E->key()));
@@ -2216,6 +2544,7 @@ void VisualScriptInstance::create(const Ref<VisualScript>& p_script,Object *p_ow
 			max_output_args = MAX( max_output_args, instance->output_port_count );
 
 			instances[F->key()]=instance;
+			function_nodes.push_back(instance);
 
 
 		}
@@ -2300,10 +2629,78 @@ void VisualScriptInstance::create(const Ref<VisualScript>& p_script,Object *p_ow
 		}
 
 
+		//fifth pass, flatten into steps
+
+		if (VisualScriptLanguage::singleton->compile_functions) {
+			_compile_function(function,function_nodes);
+		}
+
 		functions[E->key()]=function;
 	}
 }
 
+void VisualScriptInstance::_add_dependency_steps(VisualScriptNodeInstance *p_node,Set<VisualScriptNodeInstance*>& r_visited,Vector<int>& r_steps) {
+
+	//same order _dependency_step() runs them in, each node once
+	for(int i=0;i<p_node->dependencies.size();i++) {
+
+		VisualScriptNodeInstance *dep=p_node->dependencies[i];
+		if (r_visited.has(dep))
+			continue;
+		r_visited.insert(dep);
+
+		_add_dependency_steps(dep,r_visited,r_steps);
+		r_steps.push_back(dep->sequence_index);
+	}
+}
+
+void VisualScriptInstance::_compile_function(Function& p_function,const Vector<VisualScriptNodeInstance*>& p_nodes) {
+
+	ERR_FAIL_COND(!instances.has(p_function.node));
+
+	p_function.steps.resize(p_nodes.size());
+
+	for(int i=0;i<p_nodes.size();i++) {
+
+		VisualScriptNodeInstance *node=p_nodes[i];
+		ERR_FAIL_COND(node->sequence_index!=i);
+
+		Step &step=p_function.steps[i];
+		step.node=node;
+
+		step.input_ofs=p_function.step_ports.size();
+		for(int j=0;j<node->input_port_count;j++) {
+
+			int port=node->input_ports[j];
+			if (port&VisualScriptNodeInstance::INPUT_DEFAULT_VALUE_BIT)
+				p_function.step_ports.push_back(-1-(port&VisualScriptNodeInstance::INPUT_MASK));
+			else
+				p_function.step_ports.push_back(port);
+		}
+
+		step.output_ofs=p_function.step_ports.size();
+		for(int j=0;j<node->output_port_count;j++) {
+			p_function.step_ports.push_back(node->output_ports[j]);
+		}
+
+		step.dependency_ofs=p_function.step_dependencies.size();
+		if (node->id!=p_function.node) {
+			//the function node takes its inputs from the arguments
+			Set<VisualScriptNodeInstance*> visited;
+			_add_dependency_steps(node,visited,p_function.step_dependencies);
+		}
+		step.dependency_count=p_function.step_dependencies.size()-step.dependency_ofs;
+
+		step.sequence_ofs=p_function.step_jumps.size();
+		for(int j=0;j<node->sequence_output_count;j++) {
+			p_function.step_jumps.push_back(node->sequence_outputs[j] ? node->sequence_outputs[j]->sequence_index : -1);
+		}
+	}
+
+	p_function.function_step=instances[p_function.node]->sequence_index;
+	p_function.compiled=true;
+}
+
 ScriptLanguage *VisualScriptInstance::get_language(){
 
 	return VisualScriptLanguage::singleton;
@@ -2816,6 +3213,7 @@ VisualScriptLanguage::VisualScriptLanguage() {
 	_debug_parse_err_file="";
 	_debug_call_stack_pos=0;
 	int dmcs=GLOBAL_DEF("debug/script_max_call_stack",1024);
+	compile_functions=GLOBAL_DEF("visual_script/compile_functions",true);
 	if (ScriptDebugger::get_singleton()) {
 		//debugging enabled!
 		_debug_max_call_stack = dmcs;
@@ -360,6 +360,16 @@ class VisualScriptInstance : public ScriptInstance {
 	Map<StringName,Variant> variables; //using variable path, not script
 	Map<int,VisualScriptNodeInstance*> instances;
 
+	// a node of a compiled function, steps are indexed by the sequence index of their node
+	struct Step {
+		VisualScriptNodeInstance *node;
+		int input_ofs; // into Function::step_ports, >=0 is a stack position, <0 is -1-default value index
+		int output_ofs; // into Function::step_ports, stack positions
+		int dependency_ofs; // into Function::step_dependencies, steps of nodes without sequence ports, in the order they run
+		int dependency_count;
+		int sequence_ofs; // into Function::step_jumps, the step each sequence output goes to, -1 if not connected
+	};
+
 	struct Function {
 		int node;
 		int max_stack;
@@ -370,6 +380,13 @@ class VisualScriptInstance : public ScriptInstance {
 		int node_count;
 		int argument_count;
 		bool valid;
+
+		bool compiled; // run through the steps below instead of walking the node instances
+		int function_step;
+		Vector<Step> steps;
+		Vector<int> step_ports;
+		Vector<int> step_dependencies;
+		Vector<int> step_jumps;
 	};
 
 	Map<StringName,Function> functions;
@@ -381,6 +398,10 @@ class VisualScriptInstance : public ScriptInstance {
 
 	void _dependency_step(VisualScriptNodeInstance* node, int p_pass, int *pass_stack, const Variant **input_args, Variant **output_args, Variant *variant_stack, Variant::CallError& r_error, String& error_str, VisualScriptNodeInstance **r_error_node);
 	Variant _call_internal(const StringName& p_method, void* p_stack,int p_stack_size, VisualScriptNodeInstance* p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield,Variant::CallError &r_error);
+	Variant _call_compiled(Function *f,const StringName& p_method, void* p_stack,int p_stack_size, VisualScriptNodeInstance* p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield,Variant::CallError &r_error);
+	void _report_call_error(const StringName& p_method,VisualScriptNodeInstance *p_node,int p_node_id,const Variant::CallError& p_error,String& error_str);
+	void _compile_function(Function& p_function,const Vector<VisualScriptNodeInstance*>& p_nodes);
+	static void _add_dependency_steps(VisualScriptNodeInstance *p_node,Set<VisualScriptNodeInstance*>& r_visited,Vector<int>& r_steps);
 
 
 	//Map<StringName,Function> functions;
@@ -494,6 +515,8 @@ public:
 	StringName _step;
 	StringName _subcall;
 
+	bool compile_functions; // visual_script/compile_functions, instances created from now on use it
+
 	static VisualScriptLanguage* singleton;
 
 	Mutex *lock;
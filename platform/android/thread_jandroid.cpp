@@ -49,6 +49,7 @@ void *ThreadAndroid::thread_callback(void *userdata) {
 	t->id=(ID)pthread_self();
 	t->callback(t->user);
 	ScriptServer::thread_exit();
+	Variant::release_thread_pools();
 	return NULL;
 }
 
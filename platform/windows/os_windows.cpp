@@ -30,6 +30,7 @@
 
 #include "os_windows.h"
 #include "drivers/unix/memory_pool_static_malloc.h"
+#include "drivers/unix/memory_pool_static_tcache.h"
 #include "os/memory_pool_dynamic_static.h"
 #include "drivers/windows/thread_windows.h"
 #include "drivers/windows/semaphore_windows.h"
@@ -195,7 +196,11 @@ void OS_Windows::initialize_core() {
 	StreamPeerWinsock::make_default();
 	PacketPeerUDPWinsock::make_default();
 
+#ifdef THREAD_CACHE_ALLOC_ENABLED
+	mempool_static = new MemoryPoolStaticTCache;
+#else
 	mempool_static = new MemoryPoolStaticMalloc;
+#endif
 #if 1
 	mempool_dynamic = memnew( MemoryPoolDynamicStatic );
 #else
@@ -159,6 +159,8 @@ protected:
 
 	void item_rect_changed(bool p_size_changed=true);
 
+	virtual bool _can_process_threaded() const { return false; } // transform changes go to the tree's xform_change_list and the VisualServer
+
 	void _notification(int p_what);
 	static void _bind_methods();
 public:
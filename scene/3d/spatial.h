@@ -123,6 +123,8 @@ protected:
 
 	_FORCE_INLINE_ void _update_local_transform() const;
 
+	virtual bool _can_process_threaded() const { return false; } // transform changes go to the tree's xform_change_list and the servers
+
 	void _notification(int p_what);
 	static void _bind_methods();
 
@@ -42,6 +42,12 @@ VARIANT_ENUM_CAST(Node::RPCMode);
 
 
 
+// tree changes requested while nodes process on threads are run once that phase is over
+static _FORCE_INLINE_ bool _defer_tree_change(const SceneTree *p_tree) {
+
+	return p_tree && p_tree->is_in_threaded_process();
+}
+
 void Node::_notification(int p_notification) {
 
 	switch(p_notification) {
@@ -116,6 +122,11 @@ void Node::_notification(int p_notification) {
 				memdelete(data.path_cache);
 				data.path_cache=NULL;
 			}
+			if (data.get_node_cache) {
+				memdelete_arr(data.get_node_cache);
+				data.get_node_cache=NULL;
+				data.get_node_cache_next=0;
+			}
 		} break;
 		case NOTIFICATION_PATH_CHANGED: {
 
@@ -198,6 +209,11 @@ void Node::_propagate_enter_tree() {
 		E->get().group=data.tree->add_to_group(E->key(),this);
 	}
 
+	if (data.fixed_process)
+		data.tree->_add_to_process_list(SceneTree::_get_process_list(true,data.threaded_process),this);
+	if (data.idle_process)
+		data.tree->_add_to_process_list(SceneTree::_get_process_list(false,data.threaded_process),this);
+
 
 	notification(NOTIFICATION_ENTER_TREE);
 
@@ -286,6 +302,11 @@ void Node::_propagate_exit_tree() {
 		E->get().group=NULL;
 	}
 
+	if (data.fixed_process)
+		data.tree->_remove_from_process_list(SceneTree::_get_process_list(true,data.threaded_process),this);
+	if (data.idle_process)
+		data.tree->_remove_from_process_list(SceneTree::_get_process_list(false,data.threaded_process),this);
+
 
 	data.viewport = NULL;
 
@@ -305,6 +326,10 @@ void Node::_propagate_exit_tree() {
 void Node::move_child(Node *p_child,int p_pos) {
 
 	ERR_FAIL_NULL(p_child);
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"move_child",p_child,p_pos);
+		return;
+	}
 	ERR_EXPLAIN("Invalid new child position: "+itos(p_pos));
 	ERR_FAIL_INDEX( p_pos, data.children.size()+1 );
 	ERR_EXPLAIN("child is not a child of this node.");
@@ -319,6 +344,7 @@ void Node::move_child(Node *p_child,int p_pos) {
 	data.children.insert( p_pos, p_child );
 
 	if (data.tree) {
+		data.tree->path_version++;
 		data.tree->tree_changed();
 	}
 
@@ -337,6 +363,10 @@ void Node::move_child(Node *p_child,int p_pos) {
 	for (const Map< StringName, GroupData>::Element *E=p_child->data.grouped.front();E;E=E->next()) {
 		E->get().group->changed=true;
 	}
+	if (data.tree) {
+		for(int i=0;i<SceneTree::PROCESS_LIST_MAX;i++)
+			data.tree->process_lists[i].changed=true;
+	}
 
 	data.blocked--;
 
@@ -383,14 +413,20 @@ void Node::set_fixed_process(bool p_process) {
 	if (data.fixed_process==p_process)
 		return;
 
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"set_fixed_process",p_process);
+		return;
+	}
+
 	data.fixed_process=p_process;
 
-	if (data.fixed_process)
-		add_to_group("fixed_process",false);
-	else
-		remove_from_group("fixed_process");
+	if (data.tree) {
+		if (data.fixed_process)
+			data.tree->_add_to_process_list(SceneTree::_get_process_list(true,data.threaded_process),this);
+		else
+			data.tree->_remove_from_process_list(SceneTree::_get_process_list(true,data.threaded_process),this);
+	}
 
-	data.fixed_process=p_process;
 	_change_notify("fixed_process");
 }
 
@@ -399,6 +435,11 @@ void Node::set_pause_mode(PauseMode p_mode) {
 	if (data.pause_mode==p_mode)
 		return;
 
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"set_pause_mode",p_mode);
+		return;
+	}
+
 	bool prev_inherits=data.pause_mode==PAUSE_MODE_INHERIT;
 	data.pause_mode=p_mode;
 	if (!is_inside_tree())
@@ -1113,17 +1154,57 @@ void Node::set_process(bool p_idle_process) {
 	if (data.idle_process==p_idle_process)
 		return;
 
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"set_process",p_idle_process);
+		return;
+	}
+
 	data.idle_process=p_idle_process;
 
-	if (data.idle_process)
-		add_to_group("idle_process",false);
-	else
-		remove_from_group("idle_process");
+	if (data.tree) {
+		if (data.idle_process)
+			data.tree->_add_to_process_list(SceneTree::_get_process_list(false,data.threaded_process),this);
+		else
+			data.tree->_remove_from_process_list(SceneTree::_get_process_list(false,data.threaded_process),this);
+	}
 
-	data.idle_process=p_idle_process;
 	_change_notify("idle_process");
 }
 
+void Node::set_process_threaded(bool p_enable) {
+
+	if (data.threaded_process==p_enable)
+		return;
+
+	if (p_enable && !_can_process_threaded()) {
+		ERR_EXPLAIN("Node '"+String(get_name())+"' ("+get_type()+") can't process on threads, changing its transform is not thread safe.");
+		ERR_FAIL();
+	}
+
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"set_process_threaded",p_enable);
+		return;
+	}
+
+	if (data.tree) {
+		if (data.fixed_process) {
+			data.tree->_remove_from_process_list(SceneTree::_get_process_list(true,data.threaded_process),this);
+			data.tree->_add_to_process_list(SceneTree::_get_process_list(true,p_enable),this);
+		}
+		if (data.idle_process) {
+			data.tree->_remove_from_process_list(SceneTree::_get_process_list(false,data.threaded_process),this);
+			data.tree->_add_to_process_list(SceneTree::_get_process_list(false,p_enable),this);
+		}
+	}
+
+	data.threaded_process=p_enable;
+}
+
+bool Node::is_processing_threaded() const {
+
+	return data.threaded_process;
+}
+
 float Node::get_process_delta_time() const {
 
 	if (data.tree)
@@ -1211,8 +1292,16 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName& p_name) {
 
+	StringName prev_name=data.name;
 	data.name=p_name;
 
+	if (data.parent) {
+		data.parent->_child_index_remove(this,prev_name);
+		data.parent->_child_index_add(this);
+	}
+
+	if (data.tree)
+		data.tree->path_version++;
 }
 
 void Node::set_name(const String& p_name) {
@@ -1220,13 +1309,23 @@ void Node::set_name(const String& p_name) {
 	String name=p_name.replace(":","").replace("/","").replace("@","");
 
 	ERR_FAIL_COND(name=="");
+	if (data.parent && _defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"set_name",p_name);
+		return;
+	}
+	StringName prev_name=data.name;
 	data.name=name;
 
 	if (data.parent) {
 
 		data.parent->_validate_child_name(this);
+		data.parent->_child_index_remove(this,prev_name);
+		data.parent->_child_index_add(this);
 	}
 
+	if (data.tree)
+		data.tree->path_version++;
+
 	propagate_notification(NOTIFICATION_PATH_CHANGED);
 
 	if (is_inside_tree()) {
@@ -1282,12 +1381,19 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 			Node **childs=data.children.ptr();
 			int cc = data.children.size();
 
-			for(int i=0;i<cc;i++) {
-				if (childs[i]==p_child)
-					continue;
-				if (childs[i]->data.name==p_child->data.name) {
-					unique=false;
-					break;
+			if (data.child_index) {
+
+				Node **E=data.child_index->getptr(p_child->data.name);
+				unique = !E || *E==p_child;
+			} else {
+
+				for(int i=0;i<cc;i++) {
+					if (childs[i]==p_child)
+						continue;
+					if (childs[i]->data.name==p_child->data.name) {
+						unique=false;
+						break;
+					}
 				}
 			}
 		}
@@ -1368,6 +1474,7 @@ void Node::_add_child_nocheck(Node* p_child,const StringName& p_name) {
 	p_child->data.name=p_name;
 	p_child->data.pos=data.children.size();
 	data.children.push_back( p_child );
+	_child_index_add(p_child);
 	p_child->data.parent=this;
 	p_child->notification(NOTIFICATION_PARENTED);
 
@@ -1387,6 +1494,10 @@ void Node::_add_child_nocheck(Node* p_child,const StringName& p_name) {
 void Node::add_child(Node *p_child, bool p_legible_unique_name) {
 
 	ERR_FAIL_NULL(p_child);
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"add_child",p_child,p_legible_unique_name);
+		return;
+	}
 	/* Fail if node has a parent */
 	if (p_child==this) {
 		ERR_EXPLAIN("Can't add child "+p_child->get_name()+" to itself.")
@@ -1461,22 +1572,35 @@ void Node::_propagate_validate_owner() {
 void Node::remove_child(Node *p_child) {
 
 	ERR_FAIL_NULL(p_child);
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"remove_child",p_child);
+		return;
+	}
 	if (data.blocked>0) {
 		ERR_EXPLAIN("Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\",child) instead.");
 		ERR_FAIL_COND(data.blocked>0);
 	}
 
 	int idx=-1;
-	for (int i=0;i<data.children.size();i++) {
+	if (p_child->data.parent==this && p_child->data.pos>=0 && p_child->data.pos<data.children.size() && data.children[p_child->data.pos]==p_child) {
 
-		if (data.children[i]==p_child) {
+		idx=p_child->data.pos;
+	} else {
 
-			idx=i;
-			break;
+		for (int i=0;i<data.children.size();i++) {
+
+			if (data.children[i]==p_child) {
+
+				idx=i;
+				break;
+			}
 		}
 	}
 
 	ERR_FAIL_COND( idx==-1 );
+
+	if (data.tree)
+		data.tree->path_version++;
 	//ERR_FAIL_COND( p_child->data.blocked > 0 );
 
 
@@ -1489,6 +1613,7 @@ void Node::remove_child(Node *p_child) {
 	p_child->notification(NOTIFICATION_UNPARENTED);
 
 	data.children.remove(idx);
+	_child_index_remove(p_child,p_child->data.name);
 
 	for (int i=idx;i<data.children.size();i++) {
 
@@ -1522,6 +1647,22 @@ Node *Node::_get_child_by_name(const StringName& p_name) const {
 	int cc=data.children.size();
 	Node* const* cd=data.children.ptr();
 
+	if (!data.child_index && cc>=CHILD_INDEX_MIN_CHILDREN && !(data.tree && data.tree->is_in_threaded_process())) {
+
+		// the first child with each name, which is what the scan below finds
+		data.child_index = memnew( ChildIndex );
+		for(int i=0;i<cc;i++) {
+			if (!data.child_index->has(cd[i]->data.name))
+				data.child_index->set(cd[i]->data.name,cd[i]);
+		}
+	}
+
+	if (data.child_index) {
+
+		Node **E=data.child_index->getptr(p_name);
+		return E?*E:NULL;
+	}
+
 	for(int i=0;i<cc;i++){
 		if (cd[i]->data.name==p_name)
 			return cd[i];
@@ -1530,6 +1671,33 @@ Node *Node::_get_child_by_name(const StringName& p_name) const {
 	return NULL;
 }
 
+void Node::_child_index_add(Node *p_child) {
+
+	if (data.child_index && !data.child_index->has(p_child->data.name))
+		data.child_index->set(p_child->data.name,p_child);
+}
+
+void Node::_child_index_remove(Node *p_child,const StringName& p_name) {
+
+	if (!data.child_index)
+		return;
+
+	Node **E=data.child_index->getptr(p_name);
+	if (!E || *E!=p_child)
+		return;
+
+	data.child_index->erase(p_name);
+
+	// another child may use the same name
+	for(int i=0;i<data.children.size();i++) {
+		Node *c=data.children[i];
+		if (c!=p_child && c->data.name==p_name) {
+			data.child_index->set(p_name,c);
+			break;
+		}
+	}
+}
+
 Node *Node::_get_node(const NodePath& p_path) const {
 
 	if (!data.inside_tree && p_path.is_absolute()) {
@@ -1537,6 +1705,19 @@ Node *Node::_get_node(const NodePath& p_path) const {
 		ERR_FAIL_V(NULL);
 	}
 
+	// paths of more than one name are cached while the tree doesn't change in a way that could
+	// resolve them differently. only found nodes are cached, adding nodes can't change those.
+	bool use_cache = data.inside_tree && p_path.get_name_count()>1;
+	if (use_cache && data.get_node_cache) {
+
+		uint64_t version=data.tree->path_version;
+		for(int i=0;i<GET_NODE_CACHE_SIZE;i++) {
+			const GetNodeCache &c=data.get_node_cache[i];
+			if (c.version==version && c.path==p_path)
+				return c.node;
+		}
+	}
+
 	Node *current=NULL;
 	Node *root=NULL;
 
@@ -1573,18 +1754,8 @@ Node *Node::_get_node(const NodePath& p_path) const {
 
 		} else {
 
-			next=NULL;
+			next=current->_get_child_by_name(name);
 
-			for(int j=0;j<current->data.children.size();j++) {
-
-				Node *child = current->data.children[j];
-
-				if ( child->data.name == name ) {
-
-					next = child;
-					break;
-				}
-			}
 			if (next == NULL) {
 				return NULL;
 			};
@@ -1592,6 +1763,18 @@ Node *Node::_get_node(const NodePath& p_path) const {
 		current=next;
 	}
 
+	if (use_cache && current && !data.tree->is_in_threaded_process()) {
+
+		if (!data.get_node_cache)
+			data.get_node_cache = memnew_arr( GetNodeCache, GET_NODE_CACHE_SIZE );
+
+		GetNodeCache &c=data.get_node_cache[data.get_node_cache_next];
+		c.path=p_path;
+		c.node=current;
+		c.version=data.tree->path_version;
+		data.get_node_cache_next=(data.get_node_cache_next+1)%GET_NODE_CACHE_SIZE;
+	}
+
 	return current;
 }
 
@@ -1893,6 +2076,11 @@ void Node::add_to_group(const StringName& p_identifier,bool p_persistent) {
 	if (data.grouped.has(p_identifier))
 		return;
 
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"add_to_group",p_identifier,p_persistent);
+		return;
+	}
+
 	GroupData gd;
 
 	if (data.tree) {
@@ -1912,6 +2100,10 @@ void Node::remove_from_group(const StringName& p_identifier) {
 
 	ERR_FAIL_COND(!data.grouped.has(p_identifier) );
 
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"remove_from_group",p_identifier);
+		return;
+	}
 
 	Map< StringName, GroupData>::Element *E=data.grouped.find(p_identifier);
 
@@ -2712,9 +2904,24 @@ void Node::print_stray_nodes() {
 #endif
 }
 
+bool Node::_can_delete_now() {
+
+	// threaded process may still run on siblings and removing the node from the tree is
+	// deferred, so the node must stay alive until then.
+	if (_defer_tree_change(data.tree)) {
+		queue_delete();
+		return false;
+	}
+	return true;
+}
+
 void Node::queue_delete() {
 
 	ERR_FAIL_COND( !is_inside_tree() );
+	if (_defer_tree_change(data.tree)) {
+		MessageQueue::get_singleton()->push_call(this,"queue_free");
+		return;
+	}
 	get_tree()->queue_delete(this);
 }
 
@@ -2852,6 +3059,8 @@ void Node::_bind_methods() {
 	ObjectTypeDB::bind_method(_MD("set_process","enable"),&Node::set_process);
 	ObjectTypeDB::bind_method(_MD("get_process_delta_time"),&Node::get_process_delta_time);
 	ObjectTypeDB::bind_method(_MD("is_processing"),&Node::is_processing);
+	ObjectTypeDB::bind_method(_MD("set_process_threaded","enable"),&Node::set_process_threaded);
+	ObjectTypeDB::bind_method(_MD("is_processing_threaded"),&Node::is_processing_threaded);
 	ObjectTypeDB::bind_method(_MD("set_process_input","enable"),&Node::set_process_input);
 	ObjectTypeDB::bind_method(_MD("is_processing_input"),&Node::is_processing_input);
 	ObjectTypeDB::bind_method(_MD("set_process_unhandled_input","enable"),&Node::set_process_unhandled_input);
@@ -2962,6 +3171,7 @@ void Node::_bind_methods() {
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/input" ), _SCS("set_process_input"),_SCS("is_processing_input" ) );
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/unhandled_input" ), _SCS("set_process_unhandled_input"),_SCS("is_processing_unhandled_input" ) );
 	ADD_PROPERTYNZ( PropertyInfo( Variant::INT, "process/pause_mode",PROPERTY_HINT_ENUM,"Inherit,Stop,Process" ), _SCS("set_pause_mode"),_SCS("get_pause_mode" ) );
+	ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/threaded" ), _SCS("set_process_threaded"),_SCS("is_processing_threaded" ) );
 	ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "editor/display_folded",PROPERTY_HINT_NONE,"",PROPERTY_USAGE_NOEDITOR ), _SCS("set_display_folded"),_SCS("is_displayed_folded" ) );
 
 	BIND_VMETHOD( MethodInfo("_process",PropertyInfo(Variant::REAL,"delta")) );
@@ -2998,6 +3208,9 @@ Node::Node() {
 	data.tree=NULL;
 	data.fixed_process=false;
 	data.idle_process=false;
+	data.threaded_process=false;
+	for(int i=0;i<SceneTree::PROCESS_LIST_MAX;i++)
+		data.process_index[i]=-1;
 	data.inside_tree=false;
 
 	data.owner=NULL;
@@ -3010,6 +3223,9 @@ Node::Node() {
 	data.network_mode=NETWORK_MODE_INHERIT;
 	data.network_owner=NULL;
 	data.path_cache=NULL;
+	data.child_index=NULL;
+	data.get_node_cache=NULL;
+	data.get_node_cache_next=0;
 	data.parent_owned=false;
 	data.in_constructor=true;
 	data.viewport=NULL;
@@ -3025,6 +3241,11 @@ Node::~Node() {
 	data.owned.clear();
 	data.children.clear();
 
+	if (data.child_index)
+		memdelete(data.child_index);
+	if (data.get_node_cache)
+		memdelete_arr(data.get_node_cache);
+
 
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
@@ -84,6 +84,22 @@ private:
 		GroupData() { persistent=false; }
 	};
 
+	enum {
+		CHILD_INDEX_MIN_CHILDREN=32, // index children by name from this many on
+		GET_NODE_CACHE_SIZE=4
+	};
+
+	typedef HashMap<StringName,Node*,StringNameHasher> ChildIndex;
+
+	// a get_node() result, valid while SceneTree::path_version doesn't change
+	struct GetNodeCache {
+
+		NodePath path;
+		Node *node;
+		uint64_t version;
+		GetNodeCache() { node=NULL; version=0; }
+	};
+
 
 
 	struct Data {
@@ -97,6 +113,7 @@ private:
 		Node *parent;
 		Node *owner;
 		Vector<Node*> children;	// list of children
+		mutable ChildIndex *child_index; // children by name, built on lookup for wide nodes
 		int pos;
 		int depth;
 		int blocked; // safeguard that throws an error when attempting to modify the tree in a harmful way while being traversed.
@@ -127,6 +144,8 @@ private:
 		//should move all the stuff below to bits
 		bool fixed_process;
 		bool idle_process;
+		bool threaded_process;
+		int process_index[SceneTree::PROCESS_LIST_MAX]; // slots in SceneTree::process_lists, -1 when not listed
 
 		bool input;
 		bool unhandled_input;
@@ -139,6 +158,8 @@ private:
 		bool display_folded;
 
 		mutable NodePath *path_cache;
+		mutable GetNodeCache *get_node_cache; // GET_NODE_CACHE_SIZE entries, allocated on first use
+		mutable int get_node_cache_next;
 
 	} data;
 
@@ -146,8 +167,11 @@ private:
 	void _print_tree(const Node *p_node);
 
 	virtual bool _use_builtin_script() const { return true; }
+	virtual bool _can_process_threaded() const { return true; } // see set_process_threaded()
 	Node *_get_node(const NodePath& p_path) const;
 	Node *_get_child_by_name(const StringName& p_name) const;
+	void _child_index_remove(Node *p_child,const StringName& p_name);
+	void _child_index_add(Node *p_child);
 
 	void _replace_connections_target(Node* p_new_target);
 
@@ -186,6 +210,7 @@ protected:
 	void _unblock()  { data.blocked--; }
 
 	void _notification(int p_notification);
+	virtual bool _can_delete_now();
 
 	virtual void add_child_notify(Node *p_child);
 	virtual void remove_child_notify(Node *p_child);
@@ -301,6 +326,9 @@ public:
 	float get_process_delta_time() const;
 	bool is_processing() const;
 
+	void set_process_threaded(bool p_enable);
+	bool is_processing_threaded() const;
+
 
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
@@ -30,6 +30,7 @@
 
 #include "print_string.h"
 #include "os/os.h"
+#include "os/thread.h"
 #include "message_queue.h"
 #include "node.h"
 #include "globals.h"
@@ -45,6 +46,9 @@
 #include "scene/resources/material.h"
 #include "scene/resources/mesh.h"
 #include "io/marshalls.h"
+#include "job_system.h"
+#include "script_language.h"
+#include "safe_refcount.h"
 
 void SceneTreeTimer::_bind_methods() {
 
@@ -521,7 +525,8 @@ bool SceneTree::iteration(float p_time) {
 
 	emit_signal("fixed_frame");
 
-	_notify_group_pause("fixed_process",Node::NOTIFICATION_FIXED_PROCESS);
+	_notify_process_list(PROCESS_LIST_FIXED,Node::NOTIFICATION_FIXED_PROCESS);
+	_notify_process_list_threaded(PROCESS_LIST_FIXED_THREADED,Node::NOTIFICATION_FIXED_PROCESS);
 	_flush_ugc();
 	_flush_transform_notifications();
 	call_group(GROUP_CALL_REALTIME,"_viewports","update_worlds");
@@ -548,10 +553,12 @@ bool SceneTree::idle(float p_time){
 	_network_poll();
 
 	emit_signal("idle_frame");
+	_flush_idle_frame_resumes();
 
 	_flush_transform_notifications();
 
-	_notify_group_pause("idle_process",Node::NOTIFICATION_PROCESS);
+	_notify_process_list(PROCESS_LIST_IDLE,Node::NOTIFICATION_PROCESS);
+	_notify_process_list_threaded(PROCESS_LIST_IDLE_THREADED,Node::NOTIFICATION_PROCESS);
 
 	Size2 win_size=Size2( OS::get_singleton()->get_video_mode().width, OS::get_singleton()->get_video_mode().height );
 	if(win_size!=last_screen_size) {
@@ -593,10 +600,39 @@ bool SceneTree::idle(float p_time){
 	return _quit;
 }
 
+bool SceneTree::queue_signal_resume(const StringName& p_signal,const Ref<Reference>& p_state) {
+
+	if (p_signal!=SceneStringNames::get_singleton()->idle_frame || Thread::get_caller_ID()!=Thread::get_main_ID())
+		return false;
+
+	ERR_FAIL_COND_V(p_state.is_null(),false);
+	idle_frame_resumes.push_back(p_state);
+	return true;
+}
+
+void SceneTree::_flush_idle_frame_resumes() {
+
+	if (idle_frame_resumes.empty())
+		return;
+
+	//states that yield for idle_frame again while resumed wait for the next frame
+	Vector<Ref<Reference> > resumes=idle_frame_resumes;
+	idle_frame_resumes.clear();
+
+	const StringName &resume=SceneStringNames::get_singleton()->resume;
+	for(int i=0;i<resumes.size();i++) {
+
+		Variant::CallError ce;
+		resumes[i]->call(resume,NULL,0,ce);
+	}
+}
+
 void SceneTree::finish() {
 
 	_flush_delete_queue();
 
+	idle_frame_resumes.clear();
+
 	_flush_ugc();
 
 	initialized=false;
@@ -910,43 +946,219 @@ void SceneTree::_call_input_pause(const StringName& p_group,const StringName& p_
 		call_skip.clear();
 }
 
-void SceneTree::_notify_group_pause(const StringName& p_group,int p_notification) {
+void SceneTree::_add_to_process_list(ProcessListType p_list,Node *p_node) {
 
-	Map<StringName,Group>::Element *E=group_map.find(p_group);
-	if (!E)
-		return;
-	Group &g=E->get();
-	if (g.nodes.empty())
+	ProcessList &l=process_lists[p_list];
+	ERR_FAIL_COND(p_node->data.process_index[p_list]!=-1);
+
+	if (!l.iterating && l.holes>l.nodes.size()/2)
+		_update_process_list(p_list); // too many cleared slots, compact now
+
+	// nodes usually enter the tree in order, so appending rarely needs a sort
+	if (!l.changed && l.nodes.size()) {
+		Node *last=l.nodes[l.nodes.size()-1];
+		if (!last || !p_node->is_greater_than(last))
+			l.changed=true;
+	}
+
+	p_node->data.process_index[p_list]=l.nodes.size();
+	l.nodes.push_back(p_node);
+}
+
+void SceneTree::_remove_from_process_list(ProcessListType p_list,Node *p_node) {
+
+	ProcessList &l=process_lists[p_list];
+	int idx=p_node->data.process_index[p_list];
+	ERR_FAIL_INDEX(idx,l.nodes.size());
+	ERR_FAIL_COND(l.nodes[idx]!=p_node);
+
+	l.nodes[idx]=NULL;
+	l.holes++;
+	p_node->data.process_index[p_list]=-1;
+}
+
+void SceneTree::_update_process_list(ProcessListType p_list) {
+
+	ProcessList &l=process_lists[p_list];
+	if (!l.holes && !l.changed)
 		return;
 
+	int node_count=l.nodes.size();
+	Node **nodes = l.nodes.ptr();
 
-	_update_group_order(g);
+	if (l.holes) {
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node*> nodes_copy = g.nodes;
+		int to=0;
+		for(int i=0;i<node_count;i++) {
+			if (nodes[i])
+				nodes[to++]=nodes[i];
+		}
+		node_count=to;
+		l.nodes.resize(node_count);
+		nodes = l.nodes.ptr();
+		l.holes=0;
+	}
 
-	int node_count=nodes_copy.size();
-	Node **nodes = &nodes_copy[0];
+	if (l.changed && node_count) {
 
-	call_lock++;
+		SortArray<Node*,Node::Comparator> node_sort;
+		node_sort.sort(nodes,node_count);
+	}
+	l.changed=false;
 
 	for(int i=0;i<node_count;i++) {
+		nodes[i]->data.process_index[p_list]=i;
+	}
+}
 
-		Node *n = nodes[i];
-		if (call_lock && call_skip.has(n))
+void SceneTree::_notify_process_list(ProcessListType p_list,int p_notification) {
+
+	ProcessList &l=process_lists[p_list];
+	ERR_FAIL_COND(l.iterating);
+
+	_update_process_list(p_list);
+
+	// nodes added while iterating are appended past node_count and wait for the next run,
+	// nodes removed leave a NULL behind.
+	int node_count=l.nodes.size();
+	int processed=0;
+
+	l.iterating=true;
+
+	for(int i=0;i<node_count;i++) {
+
+		Node *n = l.nodes.get(i);
+		if (!n)
 			continue;
 
-		if (!n->can_process())
+		if (pause && !n->can_process())
 			continue;
 
 		n->notification(p_notification);
-		//ERR_FAIL_COND(node_count != g.nodes.size());
+		processed++;
 	}
 
-	call_lock--;
-	if (call_lock==0)
-		call_skip.clear();
+	l.iterating=false;
+	l.processed=processed;
+}
+
+/* Nodes that enabled threaded processing run after the others, spread over the JobSystem
+   threads. Tree changes they request are deferred through the MessageQueue (see Node), and
+   scripts don't fill their inline caches meanwhile. CanvasItem and Spatial nodes can't
+   enable it, see Node::_can_process_threaded(). With debug/validate_threaded_process,
+   changes to other nodes made through set() or calls to non const methods are reported. */
+
+#ifdef DEBUG_ENABLED
+
+#ifdef NO_THREADS
+#define THREADED_PROCESS_THREAD_LOCAL
+#elif defined(__GNUC__)
+#define THREADED_PROCESS_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREADED_PROCESS_THREAD_LOCAL __declspec(thread)
+#endif
+
+static THREADED_PROCESS_THREAD_LOCAL Node *_threaded_process_node=NULL; // node processed by this thread
+
+void SceneTree::_threaded_write_check(Object *p_object,const StringName& p_name) {
+
+	Node *current=_threaded_process_node;
+	if (!current || p_object==current)
+		return;
+
+	Node *node=p_object->cast_to<Node>();
+	if (!node)
+		return;
+
+	// own children that don't process on their own belong to the node, tree changes are deferred.
+	// not when changing them notifies the tree or the servers, as moving a CanvasItem or Spatial does
+	if (node->_can_process_threaded() && current->is_a_parent_of(node) && !(node->data.threaded_process && (node->data.idle_process || node->data.fixed_process)))
+		return;
+	if (singleton->threaded_deferred_methods.has(p_name))
+		return;
+
+	if (atomic_increment(&singleton->threaded_write_errors)==1) {
+		ERR_PRINTS("Threaded process of '"+String(current->get_path())+"' changes another node: '"+String(node->get_path())+"', "+String(p_name)+". Use call_deferred() or process this node on the main thread.");
+	}
+}
+
+#endif
+
+struct SceneTree::ThreadedProcess {
+
+	Node **nodes;
+	int notification;
+	bool paused;
+	volatile uint32_t processed;
+};
+
+void SceneTree::_threaded_process_job(void *p_userdata,uint32_t p_index) {
+
+	ThreadedProcess *tp=(ThreadedProcess*)p_userdata;
+
+	Node *n=tp->nodes[p_index];
+	if (!n)
+		return;
+
+	if (tp->paused && !n->can_process())
+		return;
+
+#ifdef DEBUG_ENABLED
+	Node *prev=_threaded_process_node; // the thread may be waiting inside another node's callback
+	_threaded_process_node=n;
+#endif
+	n->notification(tp->notification);
+#ifdef DEBUG_ENABLED
+	_threaded_process_node=prev;
+#endif
+	atomic_increment(&tp->processed);
+}
+
+void SceneTree::_notify_process_list_threaded(ProcessListType p_list,int p_notification) {
+
+	ProcessList &l=process_lists[p_list];
+	ERR_FAIL_COND(l.iterating);
+
+	_update_process_list(p_list);
+
+	int node_count=l.nodes.size();
+	l.processed=0;
+	if (!node_count)
+		return;
+
+	ThreadedProcess tp;
+	tp.nodes=l.nodes.ptr();
+	tp.notification=p_notification;
+	tp.paused=pause;
+	tp.processed=0;
+
+	JobSystem *js=JobSystem::get_singleton();
+	uint32_t batch=MAX(16,node_count/(js->get_thread_count()*4));
+
+	l.iterating=true;
+	threaded_process=true;
+	ScriptServer::begin_threaded_calls();
+#ifdef DEBUG_ENABLED
+	if (validate_threaded_process) {
+		threaded_write_errors=0;
+		Object::write_check_func=_threaded_write_check;
+	}
+#endif
+
+	js->parallel_for(node_count,_threaded_process_job,&tp,batch);
+
+#ifdef DEBUG_ENABLED
+	if (validate_threaded_process) {
+		Object::write_check_func=NULL;
+		if (threaded_write_errors>1) {
+			ERR_PRINTS("Threaded process changed other nodes "+itos(threaded_write_errors-1)+" more times this frame.");
+		}
+	}
+#endif
+	ScriptServer::end_threaded_calls();
+	threaded_process=false;
+	l.iterating=false;
+	l.processed=tp.processed;
 }
 
 /*
@@ -1093,6 +1305,16 @@ int SceneTree::get_node_count() const {
 	return node_count;
 }
 
+int SceneTree::get_fixed_processed_node_count() const {
+
+	return process_lists[PROCESS_LIST_FIXED].processed+process_lists[PROCESS_LIST_FIXED_THREADED].processed;
+}
+
+int SceneTree::get_idle_processed_node_count() const {
+
+	return process_lists[PROCESS_LIST_IDLE].processed+process_lists[PROCESS_LIST_IDLE_THREADED].processed;
+}
+
 
 void SceneTree::_update_root_rect() {
 
@@ -2185,6 +2407,8 @@ void SceneTree::_bind_methods() {
 
 
 	ObjectTypeDB::bind_method(_MD("get_node_count"),&SceneTree::get_node_count);
+	ObjectTypeDB::bind_method(_MD("get_fixed_processed_node_count"),&SceneTree::get_fixed_processed_node_count);
+	ObjectTypeDB::bind_method(_MD("get_idle_processed_node_count"),&SceneTree::get_idle_processed_node_count);
 	ObjectTypeDB::bind_method(_MD("get_frame"),&SceneTree::get_frame);
 	ObjectTypeDB::bind_method(_MD("quit"),&SceneTree::quit);
 
@@ -2272,8 +2496,18 @@ SceneTree::SceneTree() {
 	debug_navigation_disabled_color=GLOBAL_DEF("debug/navigation_disabled_geometry_color",Color(1.0,0.7,0.1,0.4));
 	collision_debug_contacts=GLOBAL_DEF("debug/collision_max_contacts_displayed",10000);
 
+	threaded_process=false;
+	validate_threaded_process=GLOBAL_DEF("debug/validate_threaded_process",false);
+#ifdef DEBUG_ENABLED
+	threaded_write_errors=0;
+	static const char *deferred_methods[]={ "add_child","remove_child","move_child","raise","set_name","queue_free","set_process","set_fixed_process","set_process_threaded","set_pause_mode","add_to_group","remove_from_group",NULL };
+	for(int i=0;deferred_methods[i];i++)
+		threaded_deferred_methods.insert(deferred_methods[i]);
+#endif
+
 
 	tree_version=1;
+	path_version=1;
 	fixed_process_time=1;
 	idle_process_time=1;
 	last_id=1;
@@ -88,6 +88,15 @@ public:
 		STRETCH_ASPECT_KEEP_WIDTH,
 		STRETCH_ASPECT_KEEP_HEIGHT,
 	};
+
+	// Node keeps its index in each list, see Node::data.process_index
+	enum ProcessListType {
+		PROCESS_LIST_FIXED,
+		PROCESS_LIST_IDLE,
+		PROCESS_LIST_FIXED_THREADED,
+		PROCESS_LIST_IDLE_THREADED,
+		PROCESS_LIST_MAX
+	};
 private:
 
 
@@ -99,9 +108,28 @@ private:
 		Group() {  changed=false; };
 	};
 
+	static _FORCE_INLINE_ ProcessListType _get_process_list(bool p_fixed,bool p_threaded) {
+
+		return ProcessListType((p_fixed?PROCESS_LIST_FIXED:PROCESS_LIST_IDLE)+(p_threaded?PROCESS_LIST_FIXED_THREADED:0));
+	}
+
+	// nodes that receive NOTIFICATION_FIXED_PROCESS/NOTIFICATION_PROCESS, kept in tree order.
+	// nodes remember their index (Node::data.process_index), removal just clears the slot and
+	// the list is compacted before the next run, so it never has to be copied while iterating.
+	struct ProcessList {
+
+		Vector<Node*> nodes;
+		int holes; // cleared slots
+		bool changed; // needs sorting
+		bool iterating;
+		int processed; // nodes notified in the last run
+		ProcessList() { holes=0; changed=false; iterating=false; processed=0; }
+	};
+
 	Viewport *root;
 
 	uint64_t tree_version;
+	uint64_t path_version; // changes when nodes are removed, renamed or moved, see Node::_get_node()
 	float fixed_process_time;
 	float idle_process_time;
 	bool accept_quit;
@@ -114,6 +142,9 @@ private:
 	int root_lock;
 
 	Map<StringName,Group> group_map;
+	ProcessList process_lists[PROCESS_LIST_MAX];
+	bool threaded_process; // threaded lists are being processed
+	bool validate_threaded_process;
 	bool _quit;
 	bool initialized;
 	bool input_handled;
@@ -155,6 +186,7 @@ private:
 	void _flush_transform_notifications();
 
 	_FORCE_INLINE_ void _update_group_order(Group& g);
+	void _update_process_list(ProcessListType p_list);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName& p_group);
@@ -176,6 +208,9 @@ private:
 
 	List<Ref<SceneTreeTimer> > timers;
 
+	Vector<Ref<Reference> > idle_frame_resumes;
+	void _flush_idle_frame_resumes();
+
 
 	///network///
 
@@ -237,7 +272,18 @@ friend class Node;
 	Group* add_to_group(const StringName& p_group, Node *p_node);
 	void remove_from_group(const StringName& p_group, Node *p_node);
 
-	void _notify_group_pause(const StringName& p_group,int p_notification);
+	void _add_to_process_list(ProcessListType p_list,Node *p_node);
+	void _remove_from_process_list(ProcessListType p_list,Node *p_node);
+	void _notify_process_list(ProcessListType p_list,int p_notification);
+
+	struct ThreadedProcess;
+	static void _threaded_process_job(void *p_userdata,uint32_t p_index);
+	void _notify_process_list_threaded(ProcessListType p_list,int p_notification);
+#ifdef DEBUG_ENABLED
+	volatile uint32_t threaded_write_errors;
+	Set<StringName> threaded_deferred_methods;
+	static void _threaded_write_check(Object *p_object,const StringName& p_name);
+#endif
 	void _call_input_pause(const StringName& p_group,const StringName& p_method,const InputEvent& p_input);
 	Variant _call_group(const Variant** p_args, int p_argcount, Variant::CallError& r_error);
 
@@ -328,6 +374,7 @@ public:
 	uint32_t get_last_event_id() const;
 
 	void call_group(uint32_t p_call_flags,const StringName& p_group,const StringName& p_function,VARIANT_ARG_LIST);
+
 	void notify_group(uint32_t p_call_flags,const StringName& p_group,int p_notification);
 	void set_group(uint32_t p_call_flags,const StringName& p_group,const String& p_name,const Variant& p_value);
 
@@ -341,6 +388,8 @@ public:
 
 	virtual void finish();
 
+	virtual bool queue_signal_resume(const StringName& p_signal,const Ref<Reference>& p_state); // idle_frame on the main thread
+
 	void set_auto_accept_quit(bool p_enable);
 
 	void quit();
@@ -389,6 +438,9 @@ public:
 	int64_t get_frame() const;
 
 	int get_node_count() const;
+	int get_fixed_processed_node_count() const;
+	_FORCE_INLINE_ bool is_in_threaded_process() const { return threaded_process; }
+	int get_idle_processed_node_count() const;
 
 	void queue_delete(Object *p_object);
 
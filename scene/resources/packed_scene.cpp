@@ -34,6 +34,8 @@
 #include "scene/2d/node_2d.h"
 #include "scene/main/instance_placeholder.h"
 #include "core/core_string_names.h"
+#include "message_queue.h"
+#include "script_language.h"
 #define PACK_VERSION 2
 
 bool SceneState::can_instance() const {
@@ -1708,6 +1710,7 @@ SceneState::SceneState() {
 
 void PackedScene::_set_bundled_scene(const Dictionary& d) {
 
+	clear_pool();
 	state->set_bundled_scene(d);
 }
 
@@ -1719,11 +1722,13 @@ Dictionary PackedScene::_get_bundled_scene() const {
 
 Error PackedScene::pack(Node *p_scene) {
 
+	clear_pool();
 	return state->pack(p_scene);
 }
 
 void PackedScene::clear() {
 
+	clear_pool();
 	state->clear();
 }
 
@@ -1760,6 +1765,7 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 
 void PackedScene::replace_state(Ref<SceneState> p_by) {
 
+	clear_pool();
 	state=p_by;
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1770,6 +1776,7 @@ void PackedScene::replace_state(Ref<SceneState> p_by) {
 
 void PackedScene::recreate_state() {
 
+	clear_pool();
 	state = Ref<SceneState>( memnew( SceneState ));
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1782,6 +1789,167 @@ Ref<SceneState> PackedScene::get_state() {
 	return state;
 }
 
+volatile uint32_t PackedScene::pooled_instances=0;
+volatile uint32_t PackedScene::pool_reuses=0;
+volatile uint32_t PackedScene::pool_misses=0;
+
+void PackedScene::_pool_capture(Node *p_node) {
+
+	PoolNodeState ns;
+	ns.name=p_node->get_name();
+	ns.type=p_node->get_type();
+	ns.child_count=p_node->get_child_count();
+
+	List<PropertyInfo> plist;
+	p_node->get_property_list(&plist);
+	for(List<PropertyInfo>::Element *E=plist.front();E;E=E->next()) {
+
+		if (!(E->get().usage&PROPERTY_USAGE_STORAGE) || E->get().name=="script/script")
+			continue;
+		Pair<StringName,Variant> p;
+		p.first=E->get().name;
+		p.second=p_node->get(E->get().name);
+		ns.properties.push_back(p);
+	}
+
+	pool_reset_state.push_back(ns);
+
+	for(int i=0;i<p_node->get_child_count();i++)
+		_pool_capture(p_node->get_child(i));
+}
+
+bool PackedScene::_pool_reset(Node *p_node,int &r_idx) {
+
+	// nodes added or removed since instancing can't be reset
+	if (r_idx>=pool_reset_state.size())
+		return false;
+
+	const PoolNodeState &ns=pool_reset_state[r_idx++];
+	if (ns.child_count!=p_node->get_child_count() || ns.type!=p_node->get_type())
+		return false;
+
+	if (p_node->get_name()!=ns.name)
+		p_node->set_name(ns.name);
+
+	for(const List<Pair<StringName,Variant> >::Element *E=ns.properties.front();E;E=E->next()) {
+		p_node->set(E->get().first,E->get().second);
+	}
+
+	for(int i=0;i<p_node->get_child_count();i++) {
+		if (!_pool_reset(p_node->get_child(i),r_idx))
+			return false;
+	}
+
+	return true;
+}
+
+Node *PackedScene::instance_from_pool() {
+
+	// the pool is not shared with the threaded process phase, instance normally there
+	if (ScriptServer::is_calling_threaded())
+		return instance();
+
+	if (pool.size()) {
+
+		Node *n=pool[pool.size()-1];
+		pool.resize(pool.size()-1);
+		atomic_decrement(&pooled_instances);
+		atomic_increment(&pool_reuses);
+		return n;
+	}
+
+	Node *n=instance();
+	if (n && pool_reset_state.empty())
+		_pool_capture(n);
+
+	atomic_increment(&pool_misses);
+	return n;
+}
+
+void PackedScene::release_to_pool(Node *p_node) {
+
+	ERR_FAIL_NULL(p_node);
+
+	if (ScriptServer::is_calling_threaded()) {
+		MessageQueue::get_singleton()->push_call(this,"release_to_pool",p_node);
+		return;
+	}
+
+	// only live instances of this scene, anything else is left to its owner
+	String filename = get_path().find("::")==-1 ? get_path() : String(); // see instance()
+	if (p_node->is_queued_for_deletion() || p_node->get_filename()!=filename || (pool_reset_state.size() && p_node->get_type()!=String(pool_reset_state[0].type))) {
+		ERR_EXPLAIN("Node '"+String(p_node->get_name())+"' is not an instance of '"+get_path()+"' or is being deleted, can't pool it.");
+		ERR_FAIL();
+	}
+
+	// the node may be releasing itself from one of its callbacks, so it's never deleted here
+	SceneTree *tree=p_node->get_tree();
+	if (p_node->get_parent())
+		p_node->get_parent()->remove_child(p_node);
+
+	int idx=0;
+	if (pool.size()>=pool_max_size || pool_reset_state.empty() || !_pool_reset(p_node,idx) || idx!=pool_reset_state.size()) {
+		if (!tree)
+			tree=SceneTree::get_singleton();
+		if (tree)
+			tree->queue_delete(p_node);
+		else
+			memdelete(p_node); // no tree to flush the queue
+		return;
+	}
+
+	pool.push_back(p_node);
+	atomic_increment(&pooled_instances);
+}
+
+void PackedScene::fill_pool() {
+
+	ERR_FAIL_COND(ScriptServer::is_calling_threaded());
+
+	while(pool.size()<pool_max_size) {
+
+		Node *n=instance();
+		ERR_FAIL_COND(!n);
+		if (pool_reset_state.empty())
+			_pool_capture(n);
+
+		pool.push_back(n);
+		atomic_increment(&pooled_instances);
+	}
+}
+
+void PackedScene::clear_pool() {
+
+	for(int i=0;i<pool.size();i++) {
+		memdelete(pool[i]);
+	}
+	atomic_add(&pooled_instances,uint32_t(-pool.size()));
+	pool.clear();
+	pool_reset_state.clear();
+}
+
+void PackedScene::set_pool_max_size(int p_size) {
+
+	ERR_FAIL_COND(p_size<0);
+	pool_max_size=p_size;
+
+	while(pool.size()>pool_max_size) {
+		memdelete(pool[pool.size()-1]);
+		pool.resize(pool.size()-1);
+		atomic_decrement(&pooled_instances);
+	}
+}
+
+int PackedScene::get_pool_max_size() const {
+
+	return pool_max_size;
+}
+
+int PackedScene::get_pooled_count() const {
+
+	return pool.size();
+}
+
 void PackedScene::set_path(const String& p_path,bool p_take_over) {
 
 	state->set_path(p_path);
@@ -1797,6 +1965,13 @@ void PackedScene::_bind_methods() {
 	ObjectTypeDB::bind_method(_MD("_set_bundled_scene"),&PackedScene::_set_bundled_scene);
 	ObjectTypeDB::bind_method(_MD("_get_bundled_scene"),&PackedScene::_get_bundled_scene);
 	ObjectTypeDB::bind_method(_MD("get_state:SceneState"),&PackedScene::get_state);
+	ObjectTypeDB::bind_method(_MD("instance_from_pool:Node"),&PackedScene::instance_from_pool);
+	ObjectTypeDB::bind_method(_MD("release_to_pool","node:Node"),&PackedScene::release_to_pool);
+	ObjectTypeDB::bind_method(_MD("fill_pool"),&PackedScene::fill_pool);
+	ObjectTypeDB::bind_method(_MD("clear_pool"),&PackedScene::clear_pool);
+	ObjectTypeDB::bind_method(_MD("set_pool_max_size","size"),&PackedScene::set_pool_max_size);
+	ObjectTypeDB::bind_method(_MD("get_pool_max_size"),&PackedScene::get_pool_max_size);
+	ObjectTypeDB::bind_method(_MD("get_pooled_count"),&PackedScene::get_pooled_count);
 
 	ADD_PROPERTY( PropertyInfo(Variant::DICTIONARY,"_bundled"),_SCS("_set_bundled_scene"),_SCS("_get_bundled_scene"));
 
@@ -1805,5 +1980,11 @@ void PackedScene::_bind_methods() {
 PackedScene::PackedScene() {
 
 	state = Ref<SceneState>( memnew( SceneState ));
+	pool_max_size=64;
+
+}
+
+PackedScene::~PackedScene() {
 
+	clear_pool();
 }
@@ -194,6 +194,29 @@ class PackedScene : public Resource {
 
 	Ref<SceneState> state;
 
+	// released instances are kept detached and reset to the values captured from a fresh
+	// instance (the state's stored values, and defaults for everything else), so reusing
+	// one doesn't allocate nodes, script instances or server resources again.
+	struct PoolNodeState {
+
+		StringName name;
+		StringName type;
+		int child_count;
+		List<Pair<StringName,Variant> > properties;
+	};
+
+	Vector<Node*> pool;
+	Vector<PoolNodeState> pool_reset_state; // nodes of an instance in tree order
+	int pool_max_size;
+
+	// shared by every scene, updated with atomic_*() as pools may be used from several threads
+	static volatile uint32_t pooled_instances;
+	static volatile uint32_t pool_reuses;
+	static volatile uint32_t pool_misses;
+
+	void _pool_capture(Node *p_node);
+	bool _pool_reset(Node *p_node,int &r_idx);
+
 	void _set_bundled_scene(const Dictionary& p_scene);
 	Dictionary _get_bundled_scene() const;
 
@@ -214,6 +237,18 @@ public:
 	void recreate_state();
 	void replace_state(Ref<SceneState> p_by);
 
+	Node *instance_from_pool();
+	void release_to_pool(Node *p_node);
+	void fill_pool();
+	void clear_pool();
+	void set_pool_max_size(int p_size);
+	int get_pool_max_size() const;
+	int get_pooled_count() const;
+
+	static int get_pooled_instance_count() { return int(pooled_instances); }
+	static uint64_t get_pool_reuse_count() { return pool_reuses; }
+	static uint64_t get_pool_miss_count() { return pool_misses; }
+
 	virtual void set_path(const String& p_path,bool p_take_over=false);
 #ifdef TOOLS_ENABLED
 	virtual void set_last_modified_time(uint64_t p_time) { state->set_last_modified_time(p_time); }
@@ -222,6 +257,7 @@ public:
 	Ref<SceneState> get_state();
 
 	PackedScene();
+	~PackedScene();
 
 };
 
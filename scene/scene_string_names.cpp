@@ -51,6 +51,8 @@ SceneStringNames::SceneStringNames() {
 	sleeping_state_changed=StaticCString::create("sleeping_state_changed");
 
 	finished=StaticCString::create("finished");
+	resume=StaticCString::create("resume");
+	idle_frame=StaticCString::create("idle_frame");
 	animation_changed=StaticCString::create("animation_changed");
 	animation_started=StaticCString::create("animation_started");
 
@@ -78,6 +78,8 @@ public:
 	StringName sort_children;
 
 	StringName finished;
+	StringName resume;
+	StringName idle_frame;
 	StringName animation_changed;
 	StringName animation_started;
 
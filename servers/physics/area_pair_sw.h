@@ -44,6 +44,7 @@ public:
 
 	bool setup(float p_step);
 	void solve(float p_step);
+	bool is_island_local() const { return !area->has_monitor_callback(); }
 
 	AreaPairSW(BodySW *p_body,int p_body_shape, AreaSW *p_area,int p_area_shape);
 	~AreaPairSW();
@@ -61,6 +62,7 @@ public:
 
 	bool setup(float p_step);
 	void solve(float p_step);
+	bool is_island_local() const { return false; }
 
 	Area2PairSW(AreaSW *p_area_a,int p_shape_a, AreaSW *p_area_b,int p_shape_b);
 	~Area2PairSW();
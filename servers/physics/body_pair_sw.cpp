@@ -387,6 +387,21 @@ bool BodyPairSW::setup(float p_step) {
 	return true;
 }
 
+bool BodyPairSW::is_island_local() const {
+
+#ifdef DEBUG_ENABLED
+	if (space->is_debugging_contacts())
+		return false;
+#endif
+	//static and kinematic bodies are not part of any island, so their contact reports are shared
+	if (A->get_mode()<=PhysicsServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode()<=PhysicsServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+
+	return true;
+}
+
 void BodyPairSW::solve(float p_step) {
 
 	if (!collided)
@@ -90,6 +90,7 @@ public:
 
 	bool setup(float p_step);
 	void solve(float p_step);
+	bool is_island_local() const;
 
 	BodyPairSW(BodySW *p_A, int p_shape_A,BodySW *p_B, int p_shape_B);
 	~BodyPairSW();
@@ -401,7 +401,7 @@ void BodySW::_compute_area_gravity_and_dampenings(const AreaSW *p_area) {
 	area_angular_damp += p_area->get_angular_damp();
 }
 
-void BodySW::integrate_forces(real_t p_step) {
+void BodySW::integrate_forces(real_t p_step,bool p_defer_space_update) {
 
 
 	if (mode==PhysicsServer::BODY_MODE_STATIC)
@@ -523,7 +523,12 @@ void BodySW::integrate_forces(real_t p_step) {
 
 
 	if (do_motion) {//shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
+		if (p_defer_space_update) {
+			deferred_motion=motion;
+			deferred_update|=DEFERRED_UPDATE_SHAPES_WITH_MOTION;
+		} else {
+			_update_shapes_with_motion(motion);
+		}
 	}
 
 
@@ -532,20 +537,29 @@ void BodySW::integrate_forces(real_t p_step) {
 
 }
 
-void BodySW::integrate_velocities(real_t p_step) {
+void BodySW::integrate_velocities(real_t p_step,bool p_defer_space_update) {
 
 	if (mode==PhysicsServer::BODY_MODE_STATIC)
 		return;
 
-	if (fi_callback)
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	if (fi_callback) {
+		if (p_defer_space_update)
+			deferred_update|=DEFERRED_UPDATE_STATE_QUERY;
+		else
+			get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	}
 
 	if (mode==PhysicsServer::BODY_MODE_KINEMATIC) {
 
 		_set_transform(new_transform,false);
 		_set_inv_transform(new_transform.affine_inverse());
-		if (contacts.size()==0 && linear_velocity==Vector3() && angular_velocity==Vector3())
-			set_active(false); //stopped moving, deactivate
+		if (contacts.size()==0 && linear_velocity==Vector3() && angular_velocity==Vector3()) {
+			//stopped moving, deactivate
+			if (p_defer_space_update)
+				deferred_update|=DEFERRED_UPDATE_DEACTIVATE;
+			else
+				set_active(false);
+		}
 
 		return;
 	}
@@ -595,7 +609,9 @@ void BodySW::integrate_velocities(real_t p_step) {
 
 	transform.origin+=total_linear_velocity * p_step;
 
-	_set_transform(transform);
+	_set_transform(transform,!p_defer_space_update);
+	if (p_defer_space_update)
+		deferred_update|=DEFERRED_UPDATE_SHAPES;
 	_set_inv_transform(get_transform().inverse());
 
 	_update_inertia_tensor();
@@ -606,6 +622,28 @@ void BodySW::integrate_velocities(real_t p_step) {
 	//
 }
 
+void BodySW::flush_deferred_space_update() {
+
+	if (!deferred_update)
+		return;
+
+	// same order integrate_forces/integrate_velocities would have used
+
+	if (deferred_update&DEFERRED_UPDATE_SHAPES_WITH_MOTION)
+		_update_shapes_with_motion(deferred_motion);
+
+	if (deferred_update&DEFERRED_UPDATE_STATE_QUERY)
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+
+	if (deferred_update&DEFERRED_UPDATE_SHAPES)
+		_update_shapes();
+
+	if (deferred_update&DEFERRED_UPDATE_DEACTIVATE)
+		set_active(false);
+
+	deferred_update=0;
+}
+
 /*
 void BodySW::simulate_motion(const Transform& p_xform,real_t p_step) {
 
@@ -753,6 +791,7 @@ BodySW::BodySW() : CollisionObjectSW(TYPE_BODY), active_list(this), inertia_upda
 	island_list_next=NULL;
 	first_time_kinematic=false;
 	first_integration=false;
+	deferred_update=0;
 	_set_static(false);
 
 	contact_count=0;
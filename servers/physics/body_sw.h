@@ -81,6 +81,16 @@ class BodySW : public CollisionObjectSW {
 
 	bool first_integration;
 
+	enum DeferredUpdate {
+		DEFERRED_UPDATE_SHAPES=1,
+		DEFERRED_UPDATE_SHAPES_WITH_MOTION=2,
+		DEFERRED_UPDATE_STATE_QUERY=4,
+		DEFERRED_UPDATE_DEACTIVATE=8
+	};
+
+	uint32_t deferred_update;
+	Vector3 deferred_motion;
+
 	bool continuous_cd;
 	bool can_sleep;
 	bool first_time_kinematic;
@@ -199,20 +209,30 @@ public:
 	_FORCE_INLINE_ const Vector3& get_biased_linear_velocity() const { return biased_linear_velocity; }
 	_FORCE_INLINE_ const Vector3& get_biased_angular_velocity() const { return biased_angular_velocity; }
 
+	// impulses can't move static and kinematic bodies, so they are left untouched. islands
+	// solved on different threads share them (see StepSW::step()), and only read them.
+	_FORCE_INLINE_ bool _is_shared_by_islands() const { return mode==PhysicsServer::BODY_MODE_STATIC || mode==PhysicsServer::BODY_MODE_KINEMATIC; }
+
 	_FORCE_INLINE_ void apply_impulse(const Vector3& p_pos, const Vector3& p_j) {
 
+		if (_is_shared_by_islands())
+			return;
 		linear_velocity += p_j * _inv_mass;
 		angular_velocity += _inv_inertia_tensor.xform( p_pos.cross(p_j) );
 	}
 
 	_FORCE_INLINE_ void apply_bias_impulse(const Vector3& p_pos, const Vector3& p_j) {
 
+		if (_is_shared_by_islands())
+			return;
 		biased_linear_velocity += p_j * _inv_mass;
 		biased_angular_velocity += _inv_inertia_tensor.xform( p_pos.cross(p_j) );
 	}
 
 	_FORCE_INLINE_ void apply_torque_impulse(const Vector3& p_j) {
 
+		if (_is_shared_by_islands())
+			return;
 		angular_velocity += _inv_inertia_tensor.xform(p_j);
 	}
 
@@ -263,8 +283,9 @@ public:
 	_FORCE_INLINE_ void set_axis_lock(PhysicsServer::BodyAxisLock p_lock) { axis_lock=p_lock; }
 	_FORCE_INLINE_ PhysicsServer::BodyAxisLock get_axis_lock() const { return axis_lock; }
 
-	void integrate_forces(real_t p_step);
-	void integrate_velocities(real_t p_step);
+	void integrate_forces(real_t p_step,bool p_defer_space_update=false);
+	void integrate_velocities(real_t p_step,bool p_defer_space_update=false);
+	void flush_deferred_space_update(); // broadphase and space list changes left pending by a deferred integrate
 
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3& rel_pos) const {
 
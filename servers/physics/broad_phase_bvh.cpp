@@ -0,0 +1,706 @@
+/*************************************************************************/
+/*  broad_phase_bvh.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "broad_phase_bvh.h"
+#include "collision_object_sw.h"
+#include "globals.h"
+
+#define AABB_DISPLACEMENT_MULTIPLIER 2.0
+
+int BroadPhaseBVH::_alloc_node() {
+
+	if (free_node==-1) {
+
+		int old_capacity=node_capacity;
+		node_capacity=node_capacity?node_capacity*2:64;
+		if (nodes)
+			nodes=(Node*)memrealloc(nodes,sizeof(Node)*node_capacity);
+		else
+			nodes=(Node*)memalloc(sizeof(Node)*node_capacity);
+
+		for(int i=old_capacity;i<node_capacity;i++) {
+			nodes[i].parent=(i+1<node_capacity)?i+1:-1;
+			nodes[i].height=-1;
+		}
+		free_node=old_capacity;
+	}
+
+	int n=free_node;
+	free_node=nodes[n].parent;
+	nodes[n].parent=-1;
+	nodes[n].children[0]=-1;
+	nodes[n].children[1]=-1;
+	nodes[n].height=0;
+	nodes[n].element=0;
+	return n;
+}
+
+void BroadPhaseBVH::_free_node(int p_node) {
+
+	nodes[p_node].parent=free_node;
+	nodes[p_node].height=-1;
+	free_node=p_node;
+}
+
+void BroadPhaseBVH::_insert_leaf(Tree p_tree,int p_leaf) {
+
+	if (root[p_tree]==-1) {
+
+		root[p_tree]=p_leaf;
+		nodes[p_leaf].parent=-1;
+		return;
+	}
+
+	//find the best sibling using the surface area heuristic
+
+	AABB leaf_aabb=nodes[p_leaf].aabb;
+	int index=root[p_tree];
+
+	while(!nodes[index].is_leaf()) {
+
+		int child0=nodes[index].children[0];
+		int child1=nodes[index].children[1];
+
+		real_t area=_surface(nodes[index].aabb);
+		real_t combined_area=_surface(nodes[index].aabb.merge(leaf_aabb));
+
+		real_t cost=2.0*combined_area; // new parent for this node and the leaf
+		real_t inheritance_cost=2.0*(combined_area-area); // minimum cost of pushing the leaf further down
+
+		real_t cost0=_surface(nodes[child0].aabb.merge(leaf_aabb))+inheritance_cost;
+		if (!nodes[child0].is_leaf())
+			cost0-=_surface(nodes[child0].aabb);
+
+		real_t cost1=_surface(nodes[child1].aabb.merge(leaf_aabb))+inheritance_cost;
+		if (!nodes[child1].is_leaf())
+			cost1-=_surface(nodes[child1].aabb);
+
+		if (cost<cost0 && cost<cost1)
+			break;
+
+		index=(cost0<cost1)?child0:child1;
+	}
+
+	int sibling=index;
+	int old_parent=nodes[sibling].parent;
+	int new_parent=_alloc_node();
+
+	nodes[new_parent].parent=old_parent;
+	nodes[new_parent].aabb=leaf_aabb.merge(nodes[sibling].aabb);
+	nodes[new_parent].height=nodes[sibling].height+1;
+	nodes[new_parent].children[0]=sibling;
+	nodes[new_parent].children[1]=p_leaf;
+	nodes[sibling].parent=new_parent;
+	nodes[p_leaf].parent=new_parent;
+
+	if (old_parent!=-1) {
+
+		if (nodes[old_parent].children[0]==sibling)
+			nodes[old_parent].children[0]=new_parent;
+		else
+			nodes[old_parent].children[1]=new_parent;
+	} else {
+
+		root[p_tree]=new_parent;
+	}
+
+	//refit and rebalance the ancestors
+
+	index=nodes[p_leaf].parent;
+	while(index!=-1) {
+
+		index=_balance(p_tree,index);
+
+		int child0=nodes[index].children[0];
+		int child1=nodes[index].children[1];
+		nodes[index].height=1+MAX(nodes[child0].height,nodes[child1].height);
+		nodes[index].aabb=nodes[child0].aabb.merge(nodes[child1].aabb);
+
+		index=nodes[index].parent;
+	}
+}
+
+void BroadPhaseBVH::_remove_leaf(Tree p_tree,int p_leaf) {
+
+	if (p_leaf==root[p_tree]) {
+
+		root[p_tree]=-1;
+		return;
+	}
+
+	int parent=nodes[p_leaf].parent;
+	int grand_parent=nodes[parent].parent;
+	int sibling=(nodes[parent].children[0]==p_leaf)?nodes[parent].children[1]:nodes[parent].children[0];
+
+	if (grand_parent!=-1) {
+
+		//destroy the parent and connect the sibling to the grand parent
+		if (nodes[grand_parent].children[0]==parent)
+			nodes[grand_parent].children[0]=sibling;
+		else
+			nodes[grand_parent].children[1]=sibling;
+
+		nodes[sibling].parent=grand_parent;
+		_free_node(parent);
+
+		int index=grand_parent;
+		while(index!=-1) {
+
+			index=_balance(p_tree,index);
+
+			int child0=nodes[index].children[0];
+			int child1=nodes[index].children[1];
+			nodes[index].aabb=nodes[child0].aabb.merge(nodes[child1].aabb);
+			nodes[index].height=1+MAX(nodes[child0].height,nodes[child1].height);
+
+			index=nodes[index].parent;
+		}
+	} else {
+
+		root[p_tree]=sibling;
+		nodes[sibling].parent=-1;
+		_free_node(parent);
+	}
+
+	nodes[p_leaf].parent=-1;
+}
+
+int BroadPhaseBVH::_balance(Tree p_tree,int p_node) {
+
+	//rotate the taller child up if the subtree is unbalanced, returns the new subtree root
+
+	int iA=p_node;
+	Node *A=&nodes[iA];
+	if (A->is_leaf() || A->height<2)
+		return iA;
+
+	int iB=A->children[0];
+	int iC=A->children[1];
+	Node *B=&nodes[iB];
+	Node *C=&nodes[iC];
+
+	int balance=C->height-B->height;
+
+	if (balance>1) {
+
+		//rotate C up
+		int iF=C->children[0];
+		int iG=C->children[1];
+		Node *F=&nodes[iF];
+		Node *G=&nodes[iG];
+
+		C->children[0]=iA;
+		C->parent=A->parent;
+		A->parent=iC;
+
+		if (C->parent!=-1) {
+			if (nodes[C->parent].children[0]==iA)
+				nodes[C->parent].children[0]=iC;
+			else
+				nodes[C->parent].children[1]=iC;
+		} else {
+			root[p_tree]=iC;
+		}
+
+		if (F->height>G->height) {
+
+			C->children[1]=iF;
+			A->children[1]=iG;
+			G->parent=iA;
+			A->aabb=B->aabb.merge(G->aabb);
+			C->aabb=A->aabb.merge(F->aabb);
+			A->height=1+MAX(B->height,G->height);
+			C->height=1+MAX(A->height,F->height);
+		} else {
+
+			C->children[1]=iG;
+			A->children[1]=iF;
+			F->parent=iA;
+			A->aabb=B->aabb.merge(F->aabb);
+			C->aabb=A->aabb.merge(G->aabb);
+			A->height=1+MAX(B->height,F->height);
+			C->height=1+MAX(A->height,G->height);
+		}
+
+		return iC;
+	}
+
+	if (balance<-1) {
+
+		//rotate B up
+		int iD=B->children[0];
+		int iE=B->children[1];
+		Node *D=&nodes[iD];
+		Node *E=&nodes[iE];
+
+		B->children[0]=iA;
+		B->parent=A->parent;
+		A->parent=iB;
+
+		if (B->parent!=-1) {
+			if (nodes[B->parent].children[0]==iA)
+				nodes[B->parent].children[0]=iB;
+			else
+				nodes[B->parent].children[1]=iB;
+		} else {
+			root[p_tree]=iB;
+		}
+
+		if (D->height>E->height) {
+
+			B->children[1]=iD;
+			A->children[0]=iE;
+			E->parent=iA;
+			A->aabb=C->aabb.merge(E->aabb);
+			B->aabb=A->aabb.merge(D->aabb);
+			A->height=1+MAX(C->height,E->height);
+			B->height=1+MAX(A->height,D->height);
+		} else {
+
+			B->children[1]=iE;
+			A->children[0]=iD;
+			D->parent=iA;
+			A->aabb=C->aabb.merge(D->aabb);
+			B->aabb=A->aabb.merge(E->aabb);
+			A->height=1+MAX(C->height,D->height);
+			B->height=1+MAX(A->height,E->height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+void BroadPhaseBVH::_add_pairs(ID p_id) {
+
+	Element &e=elements[p_id-1];
+	AABB fat=nodes[e.node].aabb;
+
+	int stack[MAX_STACK];
+
+	for(int t=0;t<TREE_MAX;t++) {
+
+		if (root[t]==-1 || (e._static && t==TREE_STATIC))
+			continue; //static objects don't pair with each other
+
+		int sp=0;
+		stack[sp++]=root[t];
+
+		while(sp) {
+
+			int n=stack[--sp];
+			if (!nodes[n].aabb.intersects_inclusive(fat))
+				continue;
+
+			if (nodes[n].is_leaf()) {
+
+				ID other=nodes[n].element;
+				if (other==p_id)
+					continue;
+
+				Element &o=elements[other-1];
+				if (o.owner==e.owner)
+					continue; //shapes of the same object don't pair
+
+				uint64_t key=_pair_key(p_id,other);
+				if (pair_map.has(key))
+					continue;
+
+				PairData pd;
+				pd.A=p_id;
+				pd.B=other;
+				pd.intersect=false;
+				pd.ud=NULL;
+				pair_map.set(key,pd);
+
+				PairData *p=pair_map.getptr(key);
+				e.pairs.push_back(p);
+				o.pairs.push_back(p);
+
+			} else {
+
+				ERR_CONTINUE(sp+2>MAX_STACK);
+				stack[sp++]=nodes[n].children[0];
+				stack[sp++]=nodes[n].children[1];
+			}
+		}
+	}
+}
+
+void BroadPhaseBVH::_prune_pairs(ID p_id,bool p_all) {
+
+	Element &e=elements[p_id-1];
+
+	for(int i=e.pairs.size()-1;i>=0;i--) {
+
+		PairData *p=e.pairs[i];
+		ID other=(p->A==p_id)?p->B:p->A;
+		Element &o=elements[other-1];
+
+		if (!p_all && !(e._static && o._static) && nodes[e.node].aabb.intersects_inclusive(nodes[o.node].aabb))
+			continue; //still a candidate
+
+		if (p->intersect) {
+
+			if (unpair_callback) {
+				const Element &a=elements[p->A-1];
+				const Element &b=elements[p->B-1];
+				unpair_callback(a.owner,a.subindex,b.owner,b.subindex,p->ud,unpair_userdata);
+			}
+			pair_count--;
+		}
+
+		int idx=o.pairs.find(p);
+		if (idx!=-1)
+			o.pairs.remove(idx);
+		e.pairs.remove(i);
+		pair_map.erase(_pair_key(p_id,other));
+	}
+}
+
+void BroadPhaseBVH::_check_pairs(ID p_id) {
+
+	Element &e=elements[p_id-1];
+
+	for(int i=0;i<e.pairs.size();i++) {
+
+		PairData *p=e.pairs[i];
+		const Element &a=elements[p->A-1];
+		const Element &b=elements[p->B-1];
+
+		bool intersect=a.aabb.intersects_inclusive(b.aabb);
+		if (intersect==p->intersect)
+			continue;
+
+		if (intersect) {
+
+			if (pair_callback)
+				p->ud=pair_callback(a.owner,a.subindex,b.owner,b.subindex,pair_userdata);
+			pair_count++;
+		} else {
+
+			if (unpair_callback)
+				unpair_callback(a.owner,a.subindex,b.owner,b.subindex,p->ud,unpair_userdata);
+			pair_count--;
+		}
+
+		p->intersect=intersect;
+	}
+}
+
+BroadPhaseSW::ID BroadPhaseBVH::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(!p_object,0);
+
+	ID id;
+	if (free_element!=-1) {
+
+		id=free_element+1;
+		free_element=elements[free_element].node;
+	} else {
+
+		elements.push_back(Element());
+		id=elements.size();
+	}
+
+	Element &e=elements[id-1];
+	e.owner=p_object;
+	e.subindex=p_subindex;
+	e._static=false;
+	e.used=true;
+	e.aabb=AABB();
+	e.node=-1;
+
+	return id;
+}
+
+void BroadPhaseBVH::move(ID p_id, const AABB& p_aabb) {
+
+	ERR_FAIL_COND(p_id==0 || p_id>(ID)elements.size());
+	Element &e=elements[p_id-1];
+	ERR_FAIL_COND(!e.used);
+
+	AABB prev_aabb=e.aabb;
+	e.aabb=p_aabb;
+	Tree tree=e._static?TREE_STATIC:TREE_DYNAMIC;
+
+	if (p_aabb.has_no_surface()) {
+
+		if (e.node!=-1) {
+			_prune_pairs(p_id,true);
+			_remove_leaf(tree,e.node);
+			_free_node(e.node);
+			e.node=-1;
+		}
+		return;
+	}
+
+	if (e.node==-1) {
+
+		int leaf=_alloc_node();
+		nodes[leaf].aabb=p_aabb.grow(fat_margin);
+		nodes[leaf].element=p_id;
+		_insert_leaf(tree,leaf);
+		e.node=leaf;
+		_add_pairs(p_id);
+
+	} else if (!nodes[e.node].aabb.encloses(p_aabb)) {
+
+		//left the fat aabb, reinsert it, stretched towards where it's moving
+		AABB fat=p_aabb.grow(fat_margin);
+		Vector3 d=(p_aabb.pos-prev_aabb.pos)*AABB_DISPLACEMENT_MULTIPLIER;
+		for(int i=0;i<3;i++) {
+			if (d[i]<0)
+				fat.pos[i]+=d[i];
+			fat.size[i]+=Math::abs(d[i]);
+		}
+
+		_remove_leaf(tree,e.node);
+		nodes[e.node].aabb=fat;
+		_insert_leaf(tree,e.node);
+		_prune_pairs(p_id,false);
+		_add_pairs(p_id);
+	}
+
+	_check_pairs(p_id);
+}
+
+void BroadPhaseBVH::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_COND(p_id==0 || p_id>(ID)elements.size());
+	Element &e=elements[p_id-1];
+	ERR_FAIL_COND(!e.used);
+
+	if (e._static==p_static)
+		return;
+
+	if (e.node==-1) {
+		e._static=p_static;
+		return;
+	}
+
+	_remove_leaf(e._static?TREE_STATIC:TREE_DYNAMIC,e.node);
+	e._static=p_static;
+	_insert_leaf(p_static?TREE_STATIC:TREE_DYNAMIC,e.node);
+
+	if (p_static)
+		_prune_pairs(p_id,false); //no longer pairs with other static objects
+	else
+		_add_pairs(p_id); //now pairs with static objects
+
+	_check_pairs(p_id);
+}
+
+void BroadPhaseBVH::remove(ID p_id) {
+
+	ERR_FAIL_COND(p_id==0 || p_id>(ID)elements.size());
+	Element &e=elements[p_id-1];
+	ERR_FAIL_COND(!e.used);
+
+	if (e.node!=-1) {
+		//unpair must be done immediately on removal to avoid potential invalid pointers
+		_prune_pairs(p_id,true);
+		_remove_leaf(e._static?TREE_STATIC:TREE_DYNAMIC,e.node);
+		_free_node(e.node);
+	}
+
+	e.used=false;
+	e.owner=NULL;
+	e.pairs.clear();
+	e.node=free_element;
+	free_element=p_id-1;
+}
+
+CollisionObjectSW *BroadPhaseBVH::get_object(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id==0 || p_id>(ID)elements.size(),NULL);
+	const Element &e=elements[p_id-1];
+	ERR_FAIL_COND_V(!e.used,NULL);
+	return e.owner;
+}
+
+bool BroadPhaseBVH::is_static(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id==0 || p_id>(ID)elements.size(),false);
+	const Element &e=elements[p_id-1];
+	ERR_FAIL_COND_V(!e.used,false);
+	return e._static;
+}
+
+int BroadPhaseBVH::get_subindex(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id==0 || p_id>(ID)elements.size(),-1);
+	const Element &e=elements[p_id-1];
+	ERR_FAIL_COND_V(!e.used,-1);
+	return e.subindex;
+}
+
+int BroadPhaseBVH::cull_segment(const Vector3& p_from, const Vector3& p_to,CollisionObjectSW** p_results,int p_max_results,int *p_result_indices) {
+
+	int rc=0;
+	int stack[MAX_STACK];
+
+	for(int t=0;t<TREE_MAX;t++) {
+
+		if (root[t]==-1)
+			continue;
+
+		int sp=0;
+		stack[sp++]=root[t];
+
+		while(sp) {
+
+			const Node &n=nodes[stack[--sp]];
+			if (!n.aabb.intersects_segment(p_from,p_to))
+				continue;
+
+			if (n.is_leaf()) {
+
+				const Element &e=elements[n.element-1];
+				if (!e.aabb.intersects_segment(p_from,p_to))
+					continue;
+
+				p_results[rc]=e.owner;
+				if (p_result_indices)
+					p_result_indices[rc]=e.subindex;
+				rc++;
+				if (rc>=p_max_results)
+					return rc;
+
+			} else {
+
+				ERR_CONTINUE(sp+2>MAX_STACK);
+				stack[sp++]=n.children[0];
+				stack[sp++]=n.children[1];
+			}
+		}
+	}
+
+	return rc;
+}
+
+int BroadPhaseBVH::cull_aabb(const AABB& p_aabb,CollisionObjectSW** p_results,int p_max_results,int *p_result_indices) {
+
+	int rc=0;
+	int stack[MAX_STACK];
+
+	for(int t=0;t<TREE_MAX;t++) {
+
+		if (root[t]==-1)
+			continue;
+
+		int sp=0;
+		stack[sp++]=root[t];
+
+		while(sp) {
+
+			const Node &n=nodes[stack[--sp]];
+			if (!n.aabb.intersects_inclusive(p_aabb))
+				continue;
+
+			if (n.is_leaf()) {
+
+				const Element &e=elements[n.element-1];
+				if (!e.aabb.intersects_inclusive(p_aabb))
+					continue;
+
+				p_results[rc]=e.owner;
+				if (p_result_indices)
+					p_result_indices[rc]=e.subindex;
+				rc++;
+				if (rc>=p_max_results)
+					return rc;
+
+			} else {
+
+				ERR_CONTINUE(sp+2>MAX_STACK);
+				stack[sp++]=n.children[0];
+				stack[sp++]=n.children[1];
+			}
+		}
+	}
+
+	return rc;
+}
+
+void BroadPhaseBVH::set_pair_callback(PairCallback p_pair_callback,void *p_userdata) {
+
+	pair_callback=p_pair_callback;
+	pair_userdata=p_userdata;
+}
+
+void BroadPhaseBVH::set_unpair_callback(UnpairCallback p_unpair_callback,void *p_userdata) {
+
+	unpair_callback=p_unpair_callback;
+	unpair_userdata=p_userdata;
+}
+
+void BroadPhaseBVH::update() {
+
+	//pairs are reported as objects move, nothing to do
+}
+
+int BroadPhaseBVH::get_tree_height() const {
+
+	int height=0;
+	for(int t=0;t<TREE_MAX;t++) {
+		if (root[t]!=-1)
+			height=MAX(height,nodes[root[t]].height);
+	}
+	return height;
+}
+
+BroadPhaseSW *BroadPhaseBVH::_create() {
+
+	return memnew( BroadPhaseBVH );
+}
+
+BroadPhaseBVH::BroadPhaseBVH() {
+
+	free_element=-1;
+	nodes=NULL;
+	node_capacity=0;
+	free_node=-1;
+	for(int t=0;t<TREE_MAX;t++)
+		root[t]=-1;
+	pair_count=0;
+
+	fat_margin=GLOBAL_DEF("physics/bvh_fat_margin",0.1);
+
+	pair_callback=NULL;
+	pair_userdata=NULL;
+	unpair_callback=NULL;
+	unpair_userdata=NULL;
+}
+
+BroadPhaseBVH::~BroadPhaseBVH() {
+
+	if (nodes)
+		memfree(nodes);
+}
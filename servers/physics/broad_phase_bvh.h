@@ -0,0 +1,149 @@
+/*************************************************************************/
+/*  broad_phase_bvh.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2016 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef BROAD_PHASE_BVH_H
+#define BROAD_PHASE_BVH_H
+
+#include "broad_phase_sw.h"
+#include "hash_map.h"
+#include "vector.h"
+
+/**
+ * Dynamic AABB tree broadphase. Leaves store enlarged ("fat") AABBs so that
+ * small motions don't touch the tree; when an object leaves its fat AABB the
+ * leaf is reinserted and the ancestors refitted. Static and dynamic objects
+ * live in separate trees, as static objects only need to be tested against
+ * dynamic ones.
+ *
+ * Pair candidates are kept while fat AABBs overlap, and the pair/unpair
+ * callbacks are called when the actual AABBs start or stop overlapping,
+ * just like BroadPhaseOctree.
+ */
+
+class BroadPhaseBVH : public BroadPhaseSW {
+
+	enum Tree {
+		TREE_STATIC,
+		TREE_DYNAMIC,
+		TREE_MAX
+	};
+
+	enum {
+		MAX_STACK=128
+	};
+
+	struct PairData {
+
+		ID A;
+		ID B;
+		bool intersect;
+		void *ud;
+	};
+
+	struct Element {
+
+		CollisionObjectSW *owner;
+		int subindex;
+		bool _static;
+		bool used;
+		AABB aabb;
+		int node; // leaf node, -1 if not in a tree. Next free element when unused.
+		Vector<PairData*> pairs;
+	};
+
+	struct Node {
+
+		AABB aabb;
+		int parent; // next free node when unused
+		int children[2];
+		int height; // 0 for leaves, -1 when unused
+		ID element;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0]==-1; }
+	};
+
+	Vector<Element> elements; // ID is index+1
+	int free_element;
+
+	Node *nodes;
+	int node_capacity;
+	int free_node;
+	int root[TREE_MAX];
+
+	HashMap<uint64_t,PairData> pair_map;
+	int pair_count;
+
+	real_t fat_margin;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	_FORCE_INLINE_ static uint64_t _pair_key(ID p_a,ID p_b) { return p_a<p_b ? ((uint64_t(p_a)<<32)|p_b) : ((uint64_t(p_b)<<32)|p_a); }
+	_FORCE_INLINE_ static real_t _surface(const AABB& p_aabb) { return 2.0*(p_aabb.size.x*p_aabb.size.y+p_aabb.size.y*p_aabb.size.z+p_aabb.size.z*p_aabb.size.x); }
+
+	int _alloc_node();
+	void _free_node(int p_node);
+	void _insert_leaf(Tree p_tree,int p_leaf);
+	void _remove_leaf(Tree p_tree,int p_leaf);
+	int _balance(Tree p_tree,int p_node);
+
+	void _add_pairs(ID p_id);
+	void _prune_pairs(ID p_id,bool p_all);
+	void _check_pairs(ID p_id);
+
+public:
+
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object_, int p_subindex=0);
+	virtual void move(ID p_id, const AABB& p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_segment(const Vector3& p_from, const Vector3& p_to,CollisionObjectSW** p_results,int p_max_results,int *p_result_indices=NULL);
+	virtual int cull_aabb(const AABB& p_aabb,CollisionObjectSW** p_results,int p_max_results,int *p_result_indices=NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback,void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback,void *p_userdata);
+
+	virtual void update();
+
+	int get_pair_count() const { return pair_count; }
+	int get_tree_height() const;
+
+	static BroadPhaseSW *_create();
+	BroadPhaseBVH();
+	~BroadPhaseBVH();
+};
+
+#endif // BROAD_PHASE_BVH_H
@@ -70,6 +70,9 @@ public:
 	virtual bool setup(float p_step)=0;
 	virtual void solve(float p_step)=0;
 
+	// false when setup/solve write to objects shared between islands (areas, static or kinematic bodies reporting contacts), so the island must be stepped serially
+	virtual bool is_island_local() const { return true; }
+
 	virtual ~ConstraintSW() {}
 };
 
@@ -29,6 +29,7 @@
 #include "physics_server_sw.h"
 #include "broad_phase_basic.h"
 #include "broad_phase_octree.h"
+#include "broad_phase_bvh.h"
 #include "joints/pin_joint_sw.h"
 #include "joints/hinge_joint_sw.h"
 #include "joints/slider_joint_sw.h"
@@ -36,6 +37,7 @@
 #include "joints/generic_6dof_joint_sw.h"
 #include "script_language.h"
 #include "os/os.h"
+#include "globals.h"
 
 RID PhysicsServerSW::shape_create(ShapeType p_shape) {
 
@@ -1471,6 +1473,9 @@ void PhysicsServerSW::init() {
 	last_step=0.001;
 	iterations=8;// 8?
 	stepper = memnew( StepSW );
+
+	stepper->set_parallel(GLOBAL_DEF("physics/parallel_step",false)); //solve islands on the core job system
+
 	direct_state = memnew( PhysicsDirectBodyStateSW );
 };
 
@@ -1628,7 +1633,14 @@ void PhysicsServerSW::_shape_col_cbk(const Vector3& p_point_A,const Vector3& p_p
 
 PhysicsServerSW::PhysicsServerSW() {
 
-	BroadPhaseSW::create_func=BroadPhaseOctree::_create;
+	String broadphase=GLOBAL_DEF("physics/broadphase","octree");
+	Globals::get_singleton()->set_custom_property_info("physics/broadphase",PropertyInfo(Variant::STRING,"physics/broadphase",PROPERTY_HINT_ENUM,"octree,bvh"));
+
+	if (broadphase=="bvh")
+		BroadPhaseSW::create_func=BroadPhaseBVH::_create;
+	else
+		BroadPhaseSW::create_func=BroadPhaseOctree::_create;
+
 	island_count=0;
 	active_objects=0;
 	collision_pairs=0;
@@ -1580,14 +1580,169 @@ void HeightMapShapeSW::project_range(const Vector3& p_normal, const Transform& p
 
 Vector3 HeightMapShapeSW::get_support(const Vector3& p_normal) const {
 
+	if (heights.size()==0)
+		return Vector3();
 
-	//not very useful, but not very used either
-	return get_aabb().get_support(p_normal);
+	DVector<real_t>::Read r = heights.read();
+
+	Vector3 support;
+	real_t best=0;
+
+	for(int i=0;i<depth;i++) {
+
+		for(int j=0;j<width;j++) {
+
+			Vector3 p=_get_point(r.ptr(),j,i);
+			real_t d=p_normal.dot(p);
+			if ((i==0 && j==0) || d>best) {
+				best=d;
+				support=p;
+			}
+		}
+	}
 
+	return support;
+
+}
+
+void HeightMapShapeSW::_get_cell_faces(const real_t *p_heights,int p_x,int p_z,Vector3 r_faces[2][3]) const {
+
+	// each cell is split along the diagonal from (x+1,z) to (x,z+1), both faces point up
+	Vector3 p00=_get_point(p_heights,p_x,p_z);
+	Vector3 p10=_get_point(p_heights,p_x+1,p_z);
+	Vector3 p01=_get_point(p_heights,p_x,p_z+1);
+	Vector3 p11=_get_point(p_heights,p_x+1,p_z+1);
+
+	r_faces[0][0]=p00;
+	r_faces[0][1]=p10;
+	r_faces[0][2]=p01;
+
+	r_faces[1][0]=p10;
+	r_faces[1][1]=p11;
+	r_faces[1][2]=p01;
+}
+
+bool HeightMapShapeSW::_intersect_cell(const real_t *p_heights,int p_x,int p_z,const Vector3& p_begin,const Vector3& p_end,Vector3 &r_point, Vector3 &r_normal) const {
+
+	Vector3 faces[2][3];
+	_get_cell_faces(p_heights,p_x,p_z,faces);
+
+	Vector3 dir=p_end-p_begin;
+	real_t min_d=1e20;
+	bool found=false;
+
+	for(int i=0;i<2;i++) {
+
+		Vector3 res;
+		if (!Geometry::segment_intersects_triangle(p_begin,p_end,faces[i][0],faces[i][1],faces[i][2],&res))
+			continue;
+
+		real_t d=dir.dot(res-p_begin);
+		if (d<min_d) {
+
+			min_d=d;
+			r_point=res;
+			r_normal=Plane(faces[i][0],faces[i][1],faces[i][2]).normal;
+			if (r_normal.dot(dir)>0)
+				r_normal=-r_normal;
+			found=true;
+		}
+	}
+
+	return found;
 }
 
 bool HeightMapShapeSW::intersect_segment(const Vector3& p_begin,const Vector3& p_end,Vector3 &r_point, Vector3 &r_normal) const {
 
+	if (width<2 || depth<2)
+		return false;
+
+	Vector3 dir=p_end-p_begin;
+
+	// clip the segment against the bounds
+	real_t t_min=0;
+	real_t t_max=1;
+	AABB aabb=get_aabb();
+
+	for(int i=0;i<3;i++) {
+
+		real_t from=aabb.pos[i];
+		real_t to=aabb.pos[i]+aabb.size[i];
+
+		if (Math::abs(dir[i])<CMP_EPSILON) {
+
+			if (p_begin[i]<from || p_begin[i]>to)
+				return false;
+			continue;
+		}
+
+		real_t t0=(from-p_begin[i])/dir[i];
+		real_t t1=(to-p_begin[i])/dir[i];
+		if (t0>t1)
+			SWAP(t0,t1);
+		t_min=MAX(t_min,t0);
+		t_max=MIN(t_max,t1);
+		if (t_min>t_max)
+			return false;
+	}
+
+	DVector<real_t>::Read r = heights.read();
+	const real_t *h=r.ptr();
+
+	// walk the cells crossed by the segment in the XZ plane (DDA), in order, so the first hit is the closest
+	Vector3 from=p_begin+dir*t_min;
+	int x=CLAMP(int(Math::floor(from.x/cell_size)),0,width-2);
+	int z=CLAMP(int(Math::floor(from.z/cell_size)),0,depth-2);
+
+	int step_x=dir.x>CMP_EPSILON?1:(dir.x<-CMP_EPSILON?-1:0);
+	int step_z=dir.z>CMP_EPSILON?1:(dir.z<-CMP_EPSILON?-1:0);
+
+	real_t t_delta_x=step_x?cell_size/Math::abs(dir.x):1e20;
+	real_t t_delta_z=step_z?cell_size/Math::abs(dir.z):1e20;
+	real_t t_next_x=step_x?((x+(step_x>0?1:0))*cell_size-p_begin.x)/dir.x:1e20;
+	real_t t_next_z=step_z?((z+(step_z>0?1:0))*cell_size-p_begin.z)/dir.z:1e20;
+
+	real_t t=t_min;
+
+	while(true) {
+
+		real_t t_exit=MIN(MIN(t_next_x,t_next_z),t_max);
+
+		// skip cells the segment passes above or below
+		real_t y0=p_begin.y+dir.y*t;
+		real_t y1=p_begin.y+dir.y*t_exit;
+		real_t h00=h[z*width+x];
+		real_t h10=h[z*width+x+1];
+		real_t h01=h[(z+1)*width+x];
+		real_t h11=h[(z+1)*width+x+1];
+		real_t cell_min=MIN(MIN(h00,h10),MIN(h01,h11));
+		real_t cell_max=MAX(MAX(h00,h10),MAX(h01,h11));
+
+		if (MIN(y0,y1)<=cell_max+CMP_EPSILON && MAX(y0,y1)>=cell_min-CMP_EPSILON) {
+
+			if (_intersect_cell(h,x,z,p_begin,p_end,r_point,r_normal))
+				return true;
+		}
+
+		if (t_exit>=t_max)
+			break;
+
+		if (t_next_x<t_next_z) {
+
+			x+=step_x;
+			if (x<0 || x>=width-1)
+				break;
+			t=t_next_x;
+			t_next_x+=t_delta_x;
+		} else {
+
+			z+=step_z;
+			if (z<0 || z>=depth-1)
+				break;
+			t=t_next_z;
+			t_next_z+=t_delta_z;
+		}
+	}
 
 	return false;
 }
@@ -1595,7 +1750,48 @@ bool HeightMapShapeSW::intersect_segment(const Vector3& p_begin,const Vector3& p
 
 void HeightMapShapeSW::cull(const AABB& p_local_aabb,Callback p_callback,void* p_userdata) const {
 
+	if (width<2 || depth<2)
+		return;
+
+	// only the cells under the query are visited, faces are built on the fly
+	int from_x=MAX(int(Math::floor(p_local_aabb.pos.x/cell_size)),0);
+	int from_z=MAX(int(Math::floor(p_local_aabb.pos.z/cell_size)),0);
+	int to_x=MIN(int(Math::ceil((p_local_aabb.pos.x+p_local_aabb.size.x)/cell_size))-1,width-2);
+	int to_z=MIN(int(Math::ceil((p_local_aabb.pos.z+p_local_aabb.size.z)/cell_size))-1,depth-2);
+
+	if (from_x>to_x || from_z>to_z)
+		return;
+
+	real_t min_y=p_local_aabb.pos.y;
+	real_t max_y=p_local_aabb.pos.y+p_local_aabb.size.y;
+
+	DVector<real_t>::Read r = heights.read();
+	const real_t *h=r.ptr();
+
+	FaceShapeSW face; // use this to send in the callback
+
+	for(int i=from_z;i<=to_z;i++) {
+
+		for(int j=from_x;j<=to_x;j++) {
+
+			Vector3 faces[2][3];
+			_get_cell_faces(h,j,i,faces);
+
+			for(int k=0;k<2;k++) {
+
+				real_t face_min=MIN(MIN(faces[k][0].y,faces[k][1].y),faces[k][2].y);
+				real_t face_max=MAX(MAX(faces[k][0].y,faces[k][1].y),faces[k][2].y);
+				if (face_min>max_y || face_max<min_y) //touching counts, so flat ground under a resting body is reported
+					continue;
 
+				face.vertex[0]=faces[k][0];
+				face.vertex[1]=faces[k][1];
+				face.vertex[2]=faces[k][2];
+				face.normal=Plane(faces[k][0],faces[k][1],faces[k][2]).normal;
+				p_callback(p_userdata,&face);
+			}
+		}
+	}
 
 }
 
@@ -1632,7 +1828,7 @@ void HeightMapShapeSW::_setup(DVector<real_t> p_heights,int p_width,int p_depth,
 			float h = r[i*width+j];
 
 			Vector3 pos( j*cell_size, h, i*cell_size );
-			if (i==0 || j==0)
+			if (i==0 && j==0)
 				aabb.pos=pos;
 			else
 				aabb.expand_to(pos);
@@ -1668,7 +1864,12 @@ void HeightMapShapeSW::set_data(const Variant& p_data) {
 
 Variant HeightMapShapeSW::get_data() const {
 
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"]=width;
+	d["depth"]=depth;
+	d["cell_size"]=cell_size;
+	d["heights"]=heights;
+	return d;
 
 }
 
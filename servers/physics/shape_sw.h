@@ -357,8 +357,9 @@ struct HeightMapShapeSW : public ConcaveShapeSW {
 	int depth;
 	float cell_size;
 
-//	void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-//	void _cull(int p_idx,_CullParams *p_params) const;
+	_FORCE_INLINE_ Vector3 _get_point(const real_t *p_heights,int p_x,int p_z) const { return Vector3(p_x*cell_size,p_heights[p_z*width+p_x],p_z*cell_size); }
+	void _get_cell_faces(const real_t *p_heights,int p_x,int p_z,Vector3 r_faces[2][3]) const;
+	bool _intersect_cell(const real_t *p_heights,int p_x,int p_z,const Vector3& p_begin,const Vector3& p_end,Vector3 &r_point, Vector3 &r_normal) const;
 
 	void _setup(DVector<float> p_heights,int p_width,int p_depth,float p_cell_size);
 public:
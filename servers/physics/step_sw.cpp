@@ -30,6 +30,7 @@
 #include "joints_sw.h"
 
 #include "os/os.h"
+#include "job_system.h"
 
 void StepSW::_populate_island(BodySW* p_body,BodySW** p_island,ConstraintSW **p_constraint_island) {
 
@@ -145,6 +146,77 @@ void StepSW::_check_suspend(BodySW *p_island,float p_delta) {
 	}
 }
 
+bool StepSW::_is_island_local(ConstraintSW *p_island) const {
+
+	ConstraintSW *ci=p_island;
+	while(ci) {
+		if (!ci->is_island_local())
+			return false;
+		ci=ci->get_island_next();
+	}
+	return true;
+}
+
+void StepSW::_work_func(void *p_userdata,uint32_t p_index) {
+
+	StepSW *step = (StepSW*)p_userdata;
+
+	switch(step->work) {
+
+		case WORK_INTEGRATE_FORCES: {
+
+			int from=p_index*BODY_RANGE_SIZE;
+			int to=MIN(from+BODY_RANGE_SIZE,step->work_body_count);
+			for(int i=from;i<to;i++)
+				step->work_bodies[i]->integrate_forces(step->work_delta,true);
+
+		} break;
+		case WORK_SETUP_ISLANDS: {
+
+			step->_setup_island(step->work_islands[p_index],step->work_delta);
+		} break;
+		case WORK_SOLVE_ISLANDS: {
+
+			step->_solve_island(step->work_islands[p_index],step->work_iterations,step->work_delta);
+		} break;
+		case WORK_INTEGRATE_VELOCITIES: {
+
+			int from=p_index*BODY_RANGE_SIZE;
+			int to=MIN(from+BODY_RANGE_SIZE,step->work_body_count);
+			for(int i=from;i<to;i++)
+				step->work_bodies[i]->integrate_velocities(step->work_delta,true);
+
+		} break;
+	}
+}
+
+bool StepSW::_use_jobs() const {
+
+	return parallel && JobSystem::get_singleton() && JobSystem::get_singleton()->get_thread_count()>1;
+}
+
+void StepSW::_run_parallel(Work p_work,int p_count,float p_delta,int p_iterations) {
+
+	if (p_count==0)
+		return;
+
+	work=p_work;
+	work_delta=p_delta;
+	work_iterations=p_iterations;
+
+	JobSystem::get_singleton()->parallel_for(p_count,_work_func,this);
+}
+
+void StepSW::set_parallel(bool p_enable) {
+
+	parallel=p_enable;
+}
+
+bool StepSW::is_parallel() const {
+
+	return parallel;
+}
+
 void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 
 	p_space->lock(); // can't access space during this
@@ -161,11 +233,37 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 	int active_count=0;
 
 	const SelfList<BodySW>*b = body_list->first();
-	while(b) {
 
-		b->self()->integrate_forces(p_delta);
-		b=b->next();
-		active_count++;
+	if (_use_jobs()) {
+
+		// integrate in parallel, then apply broadphase and list changes in body order
+		while(b) {
+			b=b->next();
+			active_count++;
+		}
+
+		body_array.resize(active_count);
+		work_bodies=body_array.ptr();
+		work_body_count=active_count;
+		b = body_list->first();
+		for(int i=0;i<active_count;i++) {
+			work_bodies[i]=b->self();
+			b=b->next();
+		}
+
+		_run_parallel(WORK_INTEGRATE_FORCES,(active_count+BODY_RANGE_SIZE-1)/BODY_RANGE_SIZE,p_delta);
+
+		for(int i=0;i<active_count;i++)
+			work_bodies[i]->flush_deferred_space_update();
+
+	} else {
+
+		while(b) {
+
+			b->self()->integrate_forces(p_delta);
+			b=b->next();
+			active_count++;
+		}
 	}
 
 	p_space->set_active_objects(active_count);
@@ -226,6 +324,46 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 		p_space->area_remove_from_moved_list((SelfList<AreaSW>*)aml.first()); //faster to remove here
 	}
 
+	int parallel_count=0;
+
+	if (_use_jobs()) {
+
+		// islands share no bodies, but the ones writing to shared objects (areas, contact reports of
+		// static/kinematic bodies) stay on the serial list so those writes keep happening in list order.
+		// Static and kinematic bodies are in several islands too, the solvers only read them
+		// (BodySW ignores impulses applied to them).
+
+		int total=0;
+		ConstraintSW *ci=constraint_island_list;
+		while(ci) {
+			ci=ci->get_island_list_next();
+			total++;
+		}
+
+		parallel_islands.resize(total);
+		ConstraintSW **islands=parallel_islands.ptr();
+		ConstraintSW *serial_list=NULL;
+		ConstraintSW *serial_last=NULL;
+		ci=constraint_island_list;
+		while(ci) {
+			ConstraintSW *next=ci->get_island_list_next();
+			if (_is_island_local(ci)) {
+				islands[parallel_count++]=ci;
+			} else {
+				ci->set_island_list_next(NULL);
+				if (serial_last)
+					serial_last->set_island_list_next(ci);
+				else
+					serial_list=ci;
+				serial_last=ci;
+			}
+			ci=next;
+		}
+
+		constraint_island_list=serial_list;
+		work_islands=islands;
+	}
+
 	{ //profile
 		profile_endtime=OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_GENERATE_ISLANDS,profile_endtime-profile_begtime);
@@ -236,6 +374,8 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 //	print_line("island count: "+itos(island_count)+" active count: "+itos(active_count));
 	/* SETUP CONSTRAINT ISLANDS */
 
+	_run_parallel(WORK_SETUP_ISLANDS,parallel_count,p_delta);
+
 	{
 		ConstraintSW *ci=constraint_island_list;
 		while(ci) {
@@ -253,6 +393,8 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
+	_run_parallel(WORK_SOLVE_ISLANDS,parallel_count,p_delta,p_iterations);
+
 	{
 		ConstraintSW *ci=constraint_island_list;
 		while(ci) {
@@ -272,10 +414,37 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 	/* INTEGRATE VELOCITIES */
 
 	b = body_list->first();
-	while(b) {
-		const SelfList<BodySW>*n=b->next();
-		b->self()->integrate_velocities(p_delta);
-		b=n;
+
+	if (_use_jobs()) {
+
+		// the active list may have grown since forces were integrated
+		int count=0;
+		while(b) {
+			b=b->next();
+			count++;
+		}
+
+		body_array.resize(count);
+		work_bodies=body_array.ptr();
+		work_body_count=count;
+		b = body_list->first();
+		for(int i=0;i<count;i++) {
+			work_bodies[i]=b->self();
+			b=b->next();
+		}
+
+		_run_parallel(WORK_INTEGRATE_VELOCITIES,(count+BODY_RANGE_SIZE-1)/BODY_RANGE_SIZE,p_delta);
+
+		for(int i=0;i<count;i++)
+			work_bodies[i]->flush_deferred_space_update();
+
+	} else {
+
+		while(b) {
+			const SelfList<BodySW>*n=b->next();
+			b->self()->integrate_velocities(p_delta);
+			b=n;
+		}
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
@@ -306,4 +475,15 @@ void StepSW::step(SpaceSW* p_space,float p_delta,int p_iterations) {
 StepSW::StepSW() {
 
 	_step=1;
+	parallel=false;
+	work=WORK_INTEGRATE_FORCES;
+	work_delta=0;
+	work_iterations=0;
+	work_bodies=NULL;
+	work_body_count=0;
+	work_islands=NULL;
+}
+
+StepSW::~StepSW() {
+
 }
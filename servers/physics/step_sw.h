@@ -35,14 +35,46 @@ class StepSW {
 
 	uint64_t _step;
 
+	enum Work {
+		WORK_INTEGRATE_FORCES,
+		WORK_SETUP_ISLANDS,
+		WORK_SOLVE_ISLANDS,
+		WORK_INTEGRATE_VELOCITIES
+	};
+
+	enum {
+		BODY_RANGE_SIZE=32 // bodies integrated by a single work item
+	};
+
+	bool parallel;
+
+	Work work;
+	float work_delta;
+	int work_iterations;
+	BodySW **work_bodies;
+	int work_body_count;
+	ConstraintSW **work_islands;
+
+	Vector<BodySW*> body_array;
+	Vector<ConstraintSW*> parallel_islands;
+
+	static void _work_func(void *p_userdata,uint32_t p_index);
+	bool _use_jobs() const;
+	void _run_parallel(Work p_work,int p_count,float p_delta,int p_iterations=0);
+
 	void _populate_island(BodySW* p_body,BodySW** p_island,ConstraintSW **p_constraint_island);
 	void _setup_island(ConstraintSW *p_island,float p_delta);
 	void _solve_island(ConstraintSW *p_island,int p_iterations,float p_delta);
 	void _check_suspend(BodySW *p_island,float p_delta);
+	bool _is_island_local(ConstraintSW *p_island) const;
 public:
 
+	void set_parallel(bool p_enable);
+	bool is_parallel() const;
+
 	void step(SpaceSW* p_space,float p_delta,int p_iterations);
 	StepSW();
+	~StepSW();
 };
 
 #endif // STEP__SW_H
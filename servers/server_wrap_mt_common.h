@@ -43,27 +43,37 @@
 #define FUNCRID(m_type)\
 	int m_type##allocn() {\
 		for(int i=0;i<m_type##_pool_max_size;i++) {\
-			m_type##_id_pool.push_back( server_name->m_type##_create() );\
+			RID rid=server_name->m_type##_create();\
+			alloc_mutex->lock();\
+			m_type##_id_pool.push_back( rid );\
+			alloc_mutex->unlock();\
 		}\
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create() { \
 		if (Thread::get_caller_ID()!=server_thread) {\
 			RID rid;\
 			alloc_mutex->lock();\
-			if (m_type##_id_pool.size()==0) {\
+			while (m_type##_id_pool.size()==0) {\
+				alloc_mutex->unlock();\
 				int ret;\
 				command_queue.push_and_ret( this, &ServerNameWrapMT::m_type##allocn,&ret);\
+				alloc_mutex->lock();\
 			}\
 			rid=m_type##_id_pool.front()->get();\
 			m_type##_id_pool.pop_front();\
+			bool refill=m_type##_id_pool.size()==m_type##_pool_max_size/2;\
 			alloc_mutex->unlock();\
+			if (refill) /* top up before it runs dry, without waiting */\
+				command_queue.push( this, &ServerNameWrapMT::m_type##allocn);\
 			return rid;\
 		} else {\
 			return server_name->m_type##_create();\
@@ -78,10 +88,12 @@
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create(m_arg1 p1) { \
 		if (Thread::get_caller_ID()!=server_thread) {\
@@ -108,10 +120,12 @@
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create(m_arg1 p1,m_arg2 p2) { \
 		if (Thread::get_caller_ID()!=server_thread) {\
@@ -138,10 +152,12 @@
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create(m_arg1 p1,m_arg2 p2,m_arg3 p3) { \
 		if (Thread::get_caller_ID()!=server_thread) {\
@@ -169,10 +185,12 @@
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create(m_arg1 p1,m_arg2 p2,m_arg3 p3,m_arg4 p4) { \
 		if (Thread::get_caller_ID()!=server_thread) {\
@@ -200,10 +218,12 @@
 		return 0;\
 	}\
 	void m_type##_free_cached_ids() {\
+		alloc_mutex->lock();\
 		while (m_type##_id_pool.size()) {\
 			free(m_type##_id_pool.front()->get());\
 			m_type##_id_pool.pop_front();\
 		}\
+		alloc_mutex->unlock();\
 	}\
 	virtual RID m_type##_create(m_arg1 p1,m_arg2 p2,m_arg3 p3,m_arg4 p4,m_arg5 p5) { \
 		if (Thread::get_caller_ID()!=server_thread) {\
@@ -32,6 +32,7 @@
 #include "default_mouse_cursor.xpm"
 #include "sort.h"
 #include "io/marshalls.h"
+#include "job_system.h"
 // careful, these may run in different threads than the visual server
 
 BalloonAllocator<> *VisualServerRaster::OctreeAllocator::allocator=NULL;
@@ -2769,7 +2770,7 @@ Vector<RID> VisualServerRaster::instances_cull_convex(const Vector<Plane>& p_con
 	Instance *cull[1024];
 
 
-	culled=scenario->octree.cull_convex(p_convex,cull,1024);
+	culled=const_cast<VisualServerRaster*>(this)->_cull_convex(scenario,p_convex,cull,1024);
 
 	for (int i=0;i<culled;i++) {
 
@@ -5129,7 +5130,7 @@ void VisualServerRaster::_light_instance_update_pssm_shadow(Instance *p_light,Sc
 		light_frustum_planes[4]=Plane( z_vec, z_max+1e6 );
 		light_frustum_planes[5]=Plane( -z_vec, -z_min ); // z_min is ok, since casters further than far-light plane are not needed
 
-		int caster_cull_count = p_scenario->octree.cull_convex(light_frustum_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
+		int caster_cull_count = _cull_convex(p_scenario,light_frustum_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
 
 		// a pre pass will need to be needed to determine the actual z-near to be used
 		for(int j=0;j<caster_cull_count;j++) {
@@ -5228,7 +5229,7 @@ void VisualServerRaster::_light_instance_update_lispsm_shadow(Instance *p_light,
 	float near_dist=1;
 
 	Vector<Plane> light_frustum_planes = _camera_generate_orthogonal_planes(p_light,p_camera,p_cull_range.min,p_cull_range.max);
-	int caster_count = p_scenario->octree.cull_convex(light_frustum_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
+	int caster_count = _cull_convex(p_scenario,light_frustum_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
 
 	// this could be faster by just getting supports from the AABBs..
 	// but, safer to do as the original implementation explains for now..
@@ -5485,7 +5486,7 @@ void VisualServerRaster::_light_instance_update_lispsm_shadow(Instance *p_light,
 
 	/* STEP 3: CULL CASTERS */
 
-	int caster_count = p_scenario->octree.cull_convex(light_cull_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
+	int caster_count = _cull_convex(p_scenario,light_cull_planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
 
 	/* STEP 4: ADJUST FAR Z PLANE */
 
@@ -5625,7 +5626,7 @@ void VisualServerRaster::_light_instance_update_shadow(Instance *p_light,Scenari
 			cm.set_perspective( angle*2.0, 1.0, 0.001, far );
 
 			Vector<Plane> planes = cm.get_projection_planes(p_light->data.transform);
-			int cull_count = p_scenario->octree.cull_convex(planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
+			int cull_count = _cull_convex(p_scenario,planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
 
 
 			for (int i=0;i<cull_count;i++) {
@@ -5666,7 +5667,7 @@ void VisualServerRaster::_light_instance_update_shadow(Instance *p_light,Scenari
 					planes[4]=p_light->data.transform.xform(Plane(Vector3(0,-1,z).normalized(),radius));
 
 
-					int cull_count = p_scenario->octree.cull_convex(planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
+					int cull_count = _cull_convex(p_scenario,planes,instance_shadow_cull_result,MAX_INSTANCE_CULL,INSTANCE_GEOMETRY_MASK);
 
 
 					for (int j=0;j<cull_count;j++) {
@@ -6444,6 +6445,188 @@ void VisualServerRaster::_process_sampled_light(const Transform& p_camera,Instan
 }
 
 
+struct VisualServerRaster::CullConvexJob {
+
+	const Plane *planes;
+	int plane_count;
+	const Scenario::Octree::CullCandidate *candidates;
+	Instance **results;
+	int *result_counts;
+	int count;
+	int chunks;
+};
+
+struct VisualServerRaster::CullGeometryJob {
+
+	const VisualServerRaster *vs;
+	Instance **instances;
+	uint8_t *keep;
+	int count;
+	int chunks;
+	uint32_t camera_layer_mask;
+	const CullRange *cull_range;
+	float *range_min;
+	float *range_max;
+};
+
+bool VisualServerRaster::_use_parallel_cull(int p_count) const {
+
+	if (!parallel_cull || p_count<CULL_PARALLEL_THRESHOLD)
+		return false;
+
+	JobSystem *js=JobSystem::get_singleton();
+	return js && js->get_thread_count()>1;
+}
+
+void VisualServerRaster::_cull_convex_job(void *p_userdata,uint32_t p_index) {
+
+	CullConvexJob *job=(CullConvexJob*)p_userdata;
+
+	// each chunk writes its hits at its own offset, so chunks never share output
+	int from=p_index*job->count/job->chunks;
+	int to=(p_index+1)*job->count/job->chunks;
+	Instance **results=&job->results[from];
+	int result_count=0;
+
+	for(int i=from;i<to;i++) {
+
+		const Scenario::Octree::CullCandidate &c=job->candidates[i];
+		if (c.aabb->intersects_convex_shape(job->planes,job->plane_count))
+			results[result_count++]=c.userdata;
+	}
+
+	job->result_counts[p_index]=result_count;
+}
+
+int VisualServerRaster::_cull_convex(Scenario *p_scenario,const Vector<Plane>& p_convex,Instance** p_result_array,int p_result_max,uint32_t p_mask) {
+
+	if (!_use_parallel_cull(CULL_PARALLEL_THRESHOLD))
+		return p_scenario->octree.cull_convex(p_convex,p_result_array,p_result_max,p_mask);
+
+	// the octree is walked on this thread, only the instance tests are split
+	int count=p_scenario->octree.cull_convex_candidates(p_convex,cull_candidates,p_mask);
+
+	const Scenario::Octree::CullCandidate *candidates=cull_candidates.ptr();
+	int result_count=0;
+
+	if (!_use_parallel_cull(count)) {
+
+		for(int i=0;i<count && result_count<p_result_max;i++) {
+
+			if (candidates[i].aabb->intersects_convex_shape(&p_convex[0],p_convex.size()))
+				p_result_array[result_count++]=candidates[i].userdata;
+		}
+
+		return result_count;
+	}
+
+	JobSystem *js=JobSystem::get_singleton();
+	int chunks=MIN(js->get_thread_count()*4,(int)MAX_CULL_JOBS);
+	int chunk_counts[MAX_CULL_JOBS];
+
+	cull_job_results.resize(count);
+
+	CullConvexJob job;
+	job.planes=&p_convex[0];
+	job.plane_count=p_convex.size();
+	job.candidates=candidates;
+	job.results=cull_job_results.ptr();
+	job.result_counts=chunk_counts;
+	job.count=count;
+	job.chunks=chunks;
+
+	js->parallel_for(chunks,_cull_convex_job,&job);
+
+	// merge in chunk order, which is the order the serial cull produces
+	const Instance * const *results=cull_job_results.ptr();
+
+	for(int i=0;i<chunks && result_count<p_result_max;i++) {
+
+		int from=i*count/chunks;
+		int amount=MIN(chunk_counts[i],p_result_max-result_count);
+
+		for(int j=0;j<amount;j++)
+			p_result_array[result_count++]=const_cast<Instance*>(results[from+j]);
+	}
+
+	return result_count;
+}
+
+bool VisualServerRaster::_cull_geometry_keep(Instance *p_instance,const CullRange& p_cull_range,uint32_t p_camera_layer_mask) const {
+
+	Instance *ins=p_instance;
+
+	if ((p_camera_layer_mask&ins->layer_mask)==0)
+		return false;
+
+	if (!((1<<ins->base_type)&INSTANCE_GEOMETRY_MASK) || !ins->visible || ins->data.cast_shadows==VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY)
+		return false;
+
+	if (ins->draw_range_end>0) {
+
+		float d = p_cull_range.nearp.distance_to(ins->data.transform.origin);
+		if (d<0)
+			d=0;
+		if (d<ins->draw_range_begin || d>=ins->draw_range_end)
+			return false;
+	}
+
+	// test if this geometry should be visible
+
+	if (!room_cull_enabled)
+		return true;
+
+	if (ins->visible_in_all_rooms)
+		return true;
+
+	if (ins->room)
+		return ins->room->room_info->last_visited_pass==render_pass;
+
+	if (ins->auto_rooms.size()) {
+
+		for(Set<Instance*>::Element *E=ins->auto_rooms.front();E;E=E->next()) {
+
+			if (E->get()->room_info->last_visited_pass==render_pass)
+				return true;
+		}
+
+		return false;
+	}
+
+	return exterior_visited;
+}
+
+void VisualServerRaster::_cull_geometry_job(void *p_userdata,uint32_t p_index) {
+
+	CullGeometryJob *job=(CullGeometryJob*)p_userdata;
+
+	int from=p_index*job->count/job->chunks;
+	int to=(p_index+1)*job->count/job->chunks;
+	float range_min=job->cull_range->min;
+	float range_max=job->cull_range->max;
+
+	for(int i=from;i<to;i++) {
+
+		Instance *ins=job->instances[i];
+		bool keep=ins->base_type!=INSTANCE_LIGHT && job->vs->_cull_geometry_keep(ins,*job->cull_range,job->camera_layer_mask);
+		job->keep[i]=keep;
+
+		if (keep) {
+
+			float min,max;
+			ins->transformed_aabb.project_range_in_plane(job->cull_range->nearp,min,max);
+
+			if (min<range_min)
+				range_min=min;
+			if (max>range_max)
+				range_max=max;
+		}
+	}
+
+	job->range_min[p_index]=range_min;
+	job->range_max[p_index]=range_max;
+}
+
 void VisualServerRaster::_render_no_camera(Viewport *p_viewport,Camera *p_camera, Scenario *p_scenario) {
 	RID environment;
 	if (p_scenario->environment.is_valid())
@@ -6509,7 +6692,7 @@ void VisualServerRaster::_render_camera(Viewport *p_viewport,Camera *p_camera, S
 	cull_range.max=cull_range.z_near;
 
 	/* STEP 2 - CULL */
-	int cull_count = p_scenario->octree.cull_convex(planes,instance_cull_result,MAX_INSTANCE_CULL);
+	int cull_count = _cull_convex(p_scenario,planes,instance_cull_result,MAX_INSTANCE_CULL);
 	light_cull_count=0;
 	light_samplers_culled=0;
 
@@ -6605,6 +6788,41 @@ void VisualServerRaster::_render_camera(Viewport *p_viewport,Camera *p_camera, S
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
+	uint8_t *keep_flags=NULL;
+
+	if (_use_parallel_cull(cull_count)) {
+
+		// geometry visibility and depth range do not depend on each other, so they are computed on the workers
+		JobSystem *js=JobSystem::get_singleton();
+		int chunks=MIN(js->get_thread_count()*4,(int)MAX_CULL_JOBS);
+		float chunk_min[MAX_CULL_JOBS];
+		float chunk_max[MAX_CULL_JOBS];
+
+		cull_keep.resize(MAX_INSTANCE_CULL);
+		keep_flags=cull_keep.ptr();
+
+		CullGeometryJob job;
+		job.vs=this;
+		job.instances=instance_cull_result;
+		job.keep=keep_flags;
+		job.count=cull_count;
+		job.chunks=chunks;
+		job.camera_layer_mask=camera_layer_mask;
+		job.cull_range=&cull_range;
+		job.range_min=chunk_min;
+		job.range_max=chunk_max;
+
+		js->parallel_for(chunks,_cull_geometry_job,&job);
+
+		for(int i=0;i<chunks;i++) {
+
+			if (chunk_min[i]<cull_range.min)
+				cull_range.min=chunk_min[i];
+			if (chunk_max[i]>cull_range.max)
+				cull_range.max=chunk_max[i];
+		}
+	}
+
 	for(int i=0;i<cull_count;i++) {
 
 		Instance *ins = instance_cull_result[i];
@@ -6628,65 +6846,23 @@ void VisualServerRaster::_render_camera(Viewport *p_viewport,Camera *p_camera, S
 				}
 			}
 
-		} else if ((1<<ins->base_type)&INSTANCE_GEOMETRY_MASK && ins->visible && ins->data.cast_shadows!=VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-
-
-			bool discarded=false;
-
-			if (ins->draw_range_end>0) {
-
-				float d = cull_range.nearp.distance_to(ins->data.transform.origin);
-				if (d<0)
-					d=0;
-				discarded=(d<ins->draw_range_begin || d>=ins->draw_range_end);
-
-
-			}
-
-			if (!discarded) {
-
-				// test if this geometry should be visible
-
-				if (room_cull_enabled) {
-
-
-					if (ins->visible_in_all_rooms) {
-						keep=true;
-					} else if (ins->room) {
+		} else {
 
-						if (ins->room->room_info->last_visited_pass==render_pass)
-							keep=true;
-					} else if (ins->auto_rooms.size()) {
+			keep = keep_flags ? keep_flags[i]!=0 : _cull_geometry_keep(ins,cull_range,camera_layer_mask);
 
+			if (keep) {
 
-						for(Set<Instance*>::Element *E=ins->auto_rooms.front();E;E=E->next()) {
+				if (!keep_flags) {
+					// update cull range
+					float min,max;
+					ins->transformed_aabb.project_range_in_plane(cull_range.nearp,min,max);
 
-							if (E->get()->room_info->last_visited_pass==render_pass) {
-								keep=true;
-								break;
-							}
-						}
-					} else if(exterior_visited)
-						keep=true;
-				} else {
-
-					keep=true;
+					if (min<cull_range.min)
+						cull_range.min=min;
+					if (max>cull_range.max)
+						cull_range.max=max;
 				}
 
-
-			}
-
-
-			if (keep) {
-				// update cull range
-				float min,max;
-				ins->transformed_aabb.project_range_in_plane(cull_range.nearp,min,max);
-
-				if (min<cull_range.min)
-					cull_range.min=min;
-				if (max>cull_range.max)
-					cull_range.max=max;
-
 				if (ins->sampled_light && ins->sampled_light->baked_light_sampler_info->last_pass!=render_pass) {
 					if (light_samplers_culled<MAX_LIGHT_SAMPLERS) {
 						light_sampler_cull_result[light_samplers_culled++]=ins->sampled_light;
@@ -6701,6 +6877,8 @@ void VisualServerRaster::_render_camera(Viewport *p_viewport,Camera *p_camera, S
 			// remove, no reason to keep
 			cull_count--;
 			SWAP( instance_cull_result[i], instance_cull_result[ cull_count ] );
+			if (keep_flags)
+				SWAP( keep_flags[i], keep_flags[ cull_count ] );
 			i--;
 			ins->last_render_pass=0; // make invalid
 		} else {
@@ -7585,6 +7763,7 @@ void VisualServerRaster::draw() {
 	shadows_enabled=GLOBAL_DEF("render/shadows_enabled",true);
 	room_cull_enabled = GLOBAL_DEF("render/room_cull_enabled",true);
 	light_discard_enabled = GLOBAL_DEF("render/light_discard_enabled",true);
+	parallel_cull = GLOBAL_DEF("render/parallel_cull",false);
 	rasterizer->begin_frame();
 	_draw_viewports();
 	_draw_cursors_and_margins();
@@ -7599,6 +7778,8 @@ bool VisualServerRaster::has_changed() const {
 
 int VisualServerRaster::get_render_info(RenderInfo p_info) {
 
+	if (p_info==INFO_SYNC_STALLS_IN_FRAME)
+		return 0; // no render thread, nothing to wait for
 	return rasterizer->get_render_info(p_info);
 }
 
@@ -7764,6 +7945,7 @@ VisualServerRaster::VisualServerRaster(Rasterizer *p_rasterizer) {
 	clear_color=Color(0.3,0.3,0.3,1.0);
 	OctreeAllocator::allocator=&octree_allocator;
 	draw_extra_frame=false;
+	parallel_cull=false;
 
 }
 
@@ -52,6 +52,8 @@ class VisualServerRaster : public VisualServer {
 		MAX_ROOM_CULL=32,
 		MAX_EXTERIOR_PORTALS=128,
 		MAX_LIGHT_SAMPLERS=256,
+		MAX_CULL_JOBS=64,
+		CULL_PARALLEL_THRESHOLD=512, //below this many instances, culling stays on the calling thread
 		INSTANCE_ROOMLESS_MASK=(1<<20)
 
 
@@ -578,6 +580,7 @@ class VisualServerRaster : public VisualServer {
 	bool room_cull_enabled;
 	bool light_discard_enabled;
 	bool shadows_enabled;
+	bool parallel_cull;
 	int black_margin[4];
 	RID black_image[4];
 
@@ -631,6 +634,19 @@ class VisualServerRaster : public VisualServer {
 	void _cull_room(Camera *p_camera, Instance *p_room,Instance *p_from_portal=NULL);
 	void _process_sampled_light(const Transform &p_camera, Instance *p_sampled_light, bool p_linear_colorspace);
 
+	struct CullConvexJob;
+	struct CullGeometryJob;
+
+	Vector<Scenario::Octree::CullCandidate> cull_candidates;
+	Vector<Instance*> cull_job_results;
+	Vector<uint8_t> cull_keep;
+
+	bool _use_parallel_cull(int p_count) const;
+	static void _cull_convex_job(void *p_userdata,uint32_t p_index);
+	int _cull_convex(Scenario *p_scenario,const Vector<Plane>& p_convex,Instance** p_result_array,int p_result_max,uint32_t p_mask=0xFFFFFFFF);
+	bool _cull_geometry_keep(Instance *p_instance,const CullRange& p_cull_range,uint32_t p_camera_layer_mask) const;
+	static void _cull_geometry_job(void *p_userdata,uint32_t p_index);
+
 	void _render_no_camera(Viewport *p_viewport,Camera *p_camera, Scenario *p_scenario);
 	void _render_camera(Viewport *p_viewport,Camera *p_camera, Scenario *p_scenario);
 	static void _render_canvas_item_viewport(VisualServer* p_self,void *p_vp,const Rect2& p_rect);
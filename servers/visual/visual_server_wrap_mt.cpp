@@ -64,6 +64,158 @@ void VisualServerWrapMT::thread_flush() {
 
 
 
+int VisualServerWrapMT::shader_allocn() {
+
+	for(int i=0;i<shader_pool_max_size;i++) {
+
+		RID rid=visual_server->shader_create();
+		alloc_mutex->lock();
+		shader_id_pool.push_back(rid);
+		alloc_mutex->unlock();
+	}
+	return 0;
+}
+
+void VisualServerWrapMT::shader_free_cached_ids() {
+
+	alloc_mutex->lock();
+	while(shader_id_pool.size()) {
+		free(shader_id_pool.front()->get());
+		shader_id_pool.pop_front();
+	}
+	alloc_mutex->unlock();
+}
+
+RID VisualServerWrapMT::shader_create(ShaderMode p_mode) {
+
+	if (Thread::get_caller_ID()==server_thread)
+		return visual_server->shader_create(p_mode);
+
+	RID rid;
+	alloc_mutex->lock();
+	while(shader_id_pool.size()==0) {
+		alloc_mutex->unlock();
+		int ret;
+		command_queue.push_and_ret( this, &VisualServerWrapMT::shader_allocn,&ret);
+		alloc_mutex->lock();
+	}
+	rid=shader_id_pool.front()->get();
+	shader_id_pool.pop_front();
+	bool refill=shader_id_pool.size()==shader_pool_max_size/2;
+	alloc_mutex->unlock();
+
+	if (refill)
+		command_queue.push( this, &VisualServerWrapMT::shader_allocn);
+	// pooled shaders are created as material shaders, queued commands keep the order
+	if (p_mode!=SHADER_MATERIAL)
+		command_queue.push( visual_server, &VisualServer::shader_set_mode,rid,p_mode);
+	return rid;
+}
+
+int VisualServerWrapMT::light_allocn(LightType p_type) {
+
+	for(int i=0;i<light_pool_max_size;i++) {
+
+		RID rid=visual_server->light_create(p_type);
+		alloc_mutex->lock();
+		light_id_pool[p_type].push_back(rid);
+		alloc_mutex->unlock();
+	}
+	return 0;
+}
+
+void VisualServerWrapMT::light_free_cached_ids() {
+
+	alloc_mutex->lock();
+	for(int i=0;i<3;i++) {
+		while(light_id_pool[i].size()) {
+			free(light_id_pool[i].front()->get());
+			light_id_pool[i].pop_front();
+		}
+	}
+	alloc_mutex->unlock();
+}
+
+RID VisualServerWrapMT::light_create(LightType p_type) {
+
+	if (Thread::get_caller_ID()==server_thread)
+		return visual_server->light_create(p_type);
+
+	ERR_FAIL_INDEX_V(p_type,3,RID());
+
+	RID rid;
+	alloc_mutex->lock();
+	while(light_id_pool[p_type].size()==0) {
+		alloc_mutex->unlock();
+		int ret;
+		command_queue.push_and_ret( this, &VisualServerWrapMT::light_allocn,p_type,&ret);
+		alloc_mutex->lock();
+	}
+	rid=light_id_pool[p_type].front()->get();
+	light_id_pool[p_type].pop_front();
+	bool refill=light_id_pool[p_type].size()==light_pool_max_size/2;
+	alloc_mutex->unlock();
+
+	if (refill)
+		command_queue.push( this, &VisualServerWrapMT::light_allocn,p_type);
+	return rid;
+}
+
+void VisualServerWrapMT::_rid_pools_alloc() {
+
+	// types created all the time while playing, the others fill their small pools
+	// the first time one is created (see FUNCRID)
+	textureallocn();
+	meshallocn();
+	materialallocn();
+	fixed_materialallocn();
+	instanceallocn();
+	canvas_itemallocn();
+}
+
+void VisualServerWrapMT::_rid_pools_free() {
+
+	texture_free_cached_ids();
+	mesh_free_cached_ids();
+	shader_free_cached_ids();
+	material_free_cached_ids();
+	fixed_material_free_cached_ids();
+	multimesh_free_cached_ids();
+	immediate_free_cached_ids();
+	particles_free_cached_ids();
+	skeleton_free_cached_ids();
+	room_free_cached_ids();
+	portal_free_cached_ids();
+	baked_light_free_cached_ids();
+	baked_light_sampler_free_cached_ids();
+	camera_free_cached_ids();
+	viewport_free_cached_ids();
+	environment_free_cached_ids();
+	scenario_free_cached_ids();
+	instance_free_cached_ids();
+	canvas_free_cached_ids();
+	canvas_item_free_cached_ids();
+	canvas_light_free_cached_ids();
+	canvas_light_occluder_free_cached_ids();
+	canvas_occluder_polygon_free_cached_ids();
+	canvas_item_material_free_cached_ids();
+	light_free_cached_ids();
+}
+
+int VisualServerWrapMT::get_render_info(RenderInfo p_info) {
+
+	if (p_info==INFO_SYNC_STALLS_IN_FRAME)
+		return sync_stalls_in_frame; // answered here, asking the server would stall again
+
+	if (Thread::get_caller_ID()!=server_thread) {
+		int ret;
+		command_queue.push_and_ret( visual_server, &VisualServer::get_render_info,p_info,&ret);
+		return ret;
+	} else {
+		return visual_server->get_render_info(p_info);
+	}
+}
+
 void VisualServerWrapMT::_thread_callback(void *_instance) {
 
 	VisualServerWrapMT *vsmt = reinterpret_cast<VisualServerWrapMT*>(_instance);
@@ -80,11 +232,13 @@ void VisualServerWrapMT::thread_loop() {
 
 	visual_server->init();
 
+	_rid_pools_alloc();
+
 	exit=false;
 	draw_thread_up=true;
 	while(!exit) {
-		// flush commands one by one, until exit is requested
-		command_queue.wait_and_flush_one();
+		// flush commands as they are published, until exit is requested
+		command_queue.wait_and_flush();
 	}
 
 	command_queue.flush_all(); // flush all
@@ -118,6 +272,7 @@ void VisualServerWrapMT::sync() {
 
 void VisualServerWrapMT::draw() {
 
+	sync_stalls_in_frame=command_queue.get_and_reset_sync_stalls();
 
 	if (create_thread) {
 
@@ -163,14 +318,12 @@ void VisualServerWrapMT::finish() {
 
 	if (thread) {
 
+		// freed on the server thread, after the refills still in the queue
+		command_queue.push( this, &VisualServerWrapMT::_rid_pools_free);
 		command_queue.push( this, &VisualServerWrapMT::thread_exit);
 		Thread::wait_to_finish( thread );
 		memdelete(thread);
 
-
-		texture_free_cached_ids();
-		mesh_free_cached_ids();
-
 		thread=NULL;
 	} else {
 		visual_server->finish();
@@ -193,6 +346,33 @@ VisualServerWrapMT::VisualServerWrapMT(VisualServer* p_contained,bool p_create_t
 	alloc_mutex=Mutex::create();
 	texture_pool_max_size=GLOBAL_DEF("render/thread_textures_prealloc",5);
 	mesh_pool_max_size=GLOBAL_DEF("core/rid_pool_prealloc",20);
+	mesh_pool_max_size=MAX(1,mesh_pool_max_size); // an empty pool would never refill
+	texture_pool_max_size=MAX(1,texture_pool_max_size);
+	material_pool_max_size=mesh_pool_max_size;
+	fixed_material_pool_max_size=mesh_pool_max_size;
+	instance_pool_max_size=mesh_pool_max_size;
+	canvas_item_pool_max_size=mesh_pool_max_size;
+	int rare_pool_max_size=MIN(mesh_pool_max_size,RARE_RID_POOL_MAX_SIZE); // not preallocated
+	shader_pool_max_size=rare_pool_max_size;
+	multimesh_pool_max_size=rare_pool_max_size;
+	immediate_pool_max_size=rare_pool_max_size;
+	particles_pool_max_size=rare_pool_max_size;
+	skeleton_pool_max_size=rare_pool_max_size;
+	room_pool_max_size=rare_pool_max_size;
+	portal_pool_max_size=rare_pool_max_size;
+	baked_light_pool_max_size=rare_pool_max_size;
+	baked_light_sampler_pool_max_size=rare_pool_max_size;
+	camera_pool_max_size=rare_pool_max_size;
+	viewport_pool_max_size=rare_pool_max_size;
+	environment_pool_max_size=rare_pool_max_size;
+	scenario_pool_max_size=rare_pool_max_size;
+	canvas_pool_max_size=rare_pool_max_size;
+	canvas_light_pool_max_size=rare_pool_max_size;
+	canvas_light_occluder_pool_max_size=rare_pool_max_size;
+	canvas_occluder_polygon_pool_max_size=rare_pool_max_size;
+	canvas_item_material_pool_max_size=rare_pool_max_size;
+	light_pool_max_size=rare_pool_max_size;
+	sync_stalls_in_frame=0;
 	if (!p_create_thread) {
 		server_thread=Thread::get_caller_ID();
 	} else {
@@ -62,6 +62,9 @@ class VisualServerWrapMT : public VisualServer {
 
 	Mutex*alloc_mutex;
 
+	enum {
+		RARE_RID_POOL_MAX_SIZE=2 // types seldom created don't need core/rid_pool_prealloc ids waiting
+	};
 
 	int texture_pool_max_size;
 	List<RID> texture_id_pool;
@@ -69,6 +72,84 @@ class VisualServerWrapMT : public VisualServer {
 	int mesh_pool_max_size;
 	List<RID> mesh_id_pool;
 
+	/* every resource created from the main thread is taken from a pool of
+	   ids allocated ahead of time by the server thread, so creating things
+	   never needs to wait for the server */
+
+	int shader_pool_max_size;
+	List<RID> shader_id_pool;
+
+	int material_pool_max_size;
+	List<RID> material_id_pool;
+
+	int fixed_material_pool_max_size;
+	List<RID> fixed_material_id_pool;
+
+	int multimesh_pool_max_size;
+	List<RID> multimesh_id_pool;
+
+	int immediate_pool_max_size;
+	List<RID> immediate_id_pool;
+
+	int particles_pool_max_size;
+	List<RID> particles_id_pool;
+
+	int skeleton_pool_max_size;
+	List<RID> skeleton_id_pool;
+
+	int room_pool_max_size;
+	List<RID> room_id_pool;
+
+	int portal_pool_max_size;
+	List<RID> portal_id_pool;
+
+	int baked_light_pool_max_size;
+	List<RID> baked_light_id_pool;
+
+	int baked_light_sampler_pool_max_size;
+	List<RID> baked_light_sampler_id_pool;
+
+	int camera_pool_max_size;
+	List<RID> camera_id_pool;
+
+	int viewport_pool_max_size;
+	List<RID> viewport_id_pool;
+
+	int environment_pool_max_size;
+	List<RID> environment_id_pool;
+
+	int scenario_pool_max_size;
+	List<RID> scenario_id_pool;
+
+	int instance_pool_max_size;
+	List<RID> instance_id_pool;
+
+	int canvas_pool_max_size;
+	List<RID> canvas_id_pool;
+
+	int canvas_item_pool_max_size;
+	List<RID> canvas_item_id_pool;
+
+	int canvas_light_pool_max_size;
+	List<RID> canvas_light_id_pool;
+
+	int canvas_light_occluder_pool_max_size;
+	List<RID> canvas_light_occluder_id_pool;
+
+	int canvas_occluder_polygon_pool_max_size;
+	List<RID> canvas_occluder_polygon_id_pool;
+
+	int canvas_item_material_pool_max_size;
+	List<RID> canvas_item_material_id_pool;
+
+	int light_pool_max_size;
+	List<RID> light_id_pool[3]; // one per LightType
+
+	int sync_stalls_in_frame;
+
+	void _rid_pools_alloc();
+	void _rid_pools_free();
+
 //#define DEBUG_SYNC
 
 #ifdef DEBUG_SYNC
@@ -111,7 +192,9 @@ public:
 
 	/* SHADER API */
 
-	FUNC1R(RID,shader_create,ShaderMode);
+	int shader_allocn();
+	void shader_free_cached_ids();
+	virtual RID shader_create(ShaderMode p_mode=SHADER_MATERIAL);
 	FUNC2(shader_set_mode,RID,ShaderMode);
 	FUNC1RC(ShaderMode,shader_get_mode,RID);
 	FUNC7(shader_set_code,RID,const String&,const String&,const String&,int,int,int);
@@ -137,7 +220,7 @@ public:
 
 	/* COMMON MATERIAL API */
 
-	FUNC0R(RID,material_create);
+	FUNCRID(material);
 	FUNC2(material_set_shader,RID,RID);
 	FUNC1RC(RID,material_get_shader,RID);
 
@@ -159,7 +242,7 @@ public:
 	/* FIXED MATERIAL */
 
 
-	FUNC0R(RID,fixed_material_create);
+	FUNCRID(fixed_material);
 
 	FUNC3(fixed_material_set_flag,RID, FixedMaterialFlags , bool );
 	FUNC2RC(bool, fixed_material_get_flag,RID, FixedMaterialFlags);
@@ -219,7 +302,7 @@ public:
 
 	/* MULTIMESH API */
 
-	FUNC0R(RID,multimesh_create);
+	FUNCRID(multimesh);
 	FUNC2(multimesh_set_instance_count,RID,int);
 	FUNC1RC(int,multimesh_get_instance_count,RID);
 
@@ -239,7 +322,7 @@ public:
 	/* IMMEDIATE API */
 
 
-	FUNC0R(RID,immediate_create);
+	FUNCRID(immediate);
 	FUNC3(immediate_begin,RID,PrimitiveType,RID);
 	FUNC2(immediate_vertex,RID,const Vector3&);
 	FUNC2(immediate_normal,RID,const Vector3&);
@@ -255,7 +338,7 @@ public:
 
 	/* PARTICLES API */
 
-	FUNC0R(RID,particles_create);
+	FUNCRID(particles);
 
 	FUNC2(particles_set_amount,RID, int );
 	FUNC1RC(int,particles_get_amount,RID);
@@ -314,7 +397,9 @@ public:
 
 	/* Light API */
 
-	FUNC1R(RID,light_create,LightType);
+	int light_allocn(LightType p_type);
+	void light_free_cached_ids();
+	virtual RID light_create(LightType p_type);
 	FUNC1RC(LightType,light_get_type,RID);
 
 	FUNC3(light_set_color,RID,LightColor , const Color& );
@@ -347,7 +432,7 @@ public:
 
 	/* SKELETON API */
 
-	FUNC0R(RID,skeleton_create);
+	FUNCRID(skeleton);
 	FUNC2(skeleton_resize,RID,int );
 	FUNC1RC(int,skeleton_get_bone_count,RID) ;
 	FUNC3(skeleton_bone_set_transform,RID,int, const Transform&);
@@ -355,13 +440,13 @@ public:
 
 	/* ROOM API */
 
-	FUNC0R(RID,room_create);
+	FUNCRID(room);
 	FUNC2(room_set_bounds,RID, const BSP_Tree&);
 	FUNC1RC(BSP_Tree,room_get_bounds,RID);
 
 	/* PORTAL API */
 
-	FUNC0R(RID,portal_create);
+	FUNCRID(portal);
 	FUNC2(portal_set_shape,RID,const Vector<Point2>&);
 	FUNC1RC(Vector<Point2>,portal_get_shape,RID);
 	FUNC2(portal_set_enabled,RID, bool);
@@ -374,7 +459,7 @@ public:
 	FUNC1RC(float,portal_get_connect_range,RID);
 
 
-	FUNC0R(RID,baked_light_create);
+	FUNCRID(baked_light);
 	FUNC2(baked_light_set_mode,RID,BakedLightMode);
 	FUNC1RC(BakedLightMode,baked_light_get_mode,RID);
 
@@ -402,7 +487,7 @@ public:
 	FUNC2(baked_light_set_realtime_energy, RID, const float);
 	FUNC1RC(float, baked_light_get_realtime_energy, RID);
 
-	FUNC0R(RID,baked_light_sampler_create);
+	FUNCRID(baked_light_sampler);
 
 	FUNC3(baked_light_sampler_set_param,RID, BakedLightSamplerParam , float );
 	FUNC2RC(float,baked_light_sampler_get_param,RID, BakedLightSamplerParam );
@@ -412,7 +497,7 @@ public:
 
 	/* CAMERA API */
 
-	FUNC0R(RID,camera_create);
+	FUNCRID(camera);
 	FUNC4(camera_set_perspective,RID,float , float , float );
 	FUNC4(camera_set_orthogonal,RID,float, float , float );
 	FUNC2(camera_set_transform,RID,const Transform& );
@@ -430,7 +515,7 @@ public:
 
 	/* VIEWPORT API */
 
-	FUNC0R(RID,viewport_create);
+	FUNCRID(viewport);
 
 	FUNC2(viewport_attach_to_screen,RID,int );
 	FUNC1(viewport_detach,RID);
@@ -475,7 +560,7 @@ public:
 
 	/* ENVIRONMENT API */
 
-	FUNC0R(RID,environment_create);
+	FUNCRID(environment);
 
 	FUNC2(environment_set_background,RID,EnvironmentBG);
 	FUNC1RC(EnvironmentBG,environment_get_background,RID);
@@ -493,7 +578,7 @@ public:
 
 	/* SCENARIO API */
 
-	FUNC0R(RID,scenario_create);
+	FUNCRID(scenario);
 
 	FUNC2(scenario_set_debug,RID,ScenarioDebugMode);
 	FUNC2(scenario_set_environment,RID, RID);
@@ -503,7 +588,7 @@ public:
 
 	/* INSTANCING API */
 
-	FUNC0R(RID,instance_create);
+	FUNCRID(instance);
 
 	FUNC2(instance_set_base,RID, RID);
 	FUNC1RC(RID,instance_get_base,RID);
@@ -570,13 +655,13 @@ public:
 
 	/* CANVAS (2D) */
 
-	FUNC0R(RID,canvas_create);
+	FUNCRID(canvas);
 	FUNC3(canvas_set_item_mirroring,RID,RID,const Point2&);
 	FUNC2RC(Point2,canvas_get_item_mirroring,RID,RID);
 	FUNC2(canvas_set_modulate,RID,const Color&);
 
 
-	FUNC0R(RID,canvas_item_create);
+	FUNCRID(canvas_item);
 
 	FUNC2(canvas_item_set_parent,RID,RID );
 	FUNC1RC(RID,canvas_item_get_parent,RID);
@@ -632,7 +717,7 @@ public:
 	FUNC1(canvas_item_raise,RID);
 
 	/* CANVAS LIGHT */
-	FUNC0R(RID,canvas_light_create);
+	FUNCRID(canvas_light);
 	FUNC2(canvas_light_attach_to_canvas,RID,RID);
 	FUNC2(canvas_light_set_enabled,RID,bool);
 	FUNC2(canvas_light_set_transform,RID,const Matrix32&);
@@ -657,7 +742,7 @@ public:
 
 	/* CANVAS OCCLUDER */
 
-	FUNC0R(RID,canvas_light_occluder_create);
+	FUNCRID(canvas_light_occluder);
 	FUNC2(canvas_light_occluder_attach_to_canvas,RID,RID);
 	FUNC2(canvas_light_occluder_set_enabled,RID,bool);
 	FUNC2(canvas_light_occluder_set_polygon,RID,RID);
@@ -665,14 +750,14 @@ public:
 	FUNC2(canvas_light_occluder_set_light_mask,RID,int);
 
 
-	FUNC0R(RID,canvas_occluder_polygon_create);
+	FUNCRID(canvas_occluder_polygon);
 	FUNC3(canvas_occluder_polygon_set_shape,RID,const DVector<Vector2>&,bool);
 	FUNC2(canvas_occluder_polygon_set_shape_as_lines,RID,const DVector<Vector2>&);
 	FUNC2(canvas_occluder_polygon_set_cull_mode,RID,CanvasOccluderPolygonCullMode);
 
 	/* CANVAS MATERIAL */
 
-	FUNC0R(RID,canvas_item_material_create);
+	FUNCRID(canvas_item_material);
 	FUNC2(canvas_item_material_set_shader,RID,RID);
 	FUNC3(canvas_item_material_set_shader_param,RID,const StringName&,const Variant&);
 	FUNC2RC(Variant,canvas_item_material_get_shader_param,RID,const StringName&);
@@ -713,7 +798,7 @@ public:
 
 	/* RENDER INFO */
 
-	FUNC1R(int,get_render_info,RenderInfo );
+	virtual int get_render_info(RenderInfo p_info);
 	virtual bool has_feature(Features p_feature) const { return visual_server->has_feature(p_feature); }
 
 	FUNC3(set_boot_image,const Image& , const Color&,bool );
@@ -703,6 +703,7 @@ void VisualServer::_bind_methods() {
 	BIND_CONSTANT( INFO_VIDEO_MEM_USED );
 	BIND_CONSTANT( INFO_TEXTURE_MEM_USED );
 	BIND_CONSTANT( INFO_VERTEX_MEM_USED );
+	BIND_CONSTANT( INFO_SYNC_STALLS_IN_FRAME );
 
 
 }
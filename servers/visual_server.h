@@ -1156,6 +1156,7 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_SYNC_STALLS_IN_FRAME, // times the main thread had to wait for the render thread
 	};
 
 	virtual int get_render_info(RenderInfo p_info)=0;